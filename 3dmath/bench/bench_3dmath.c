@@ -0,0 +1,1164 @@
+// Times the 3dmath API over a warm data set, which stays in L1/L2, and
+// a cold one, which is larger than the last-level cache.
+//
+//   bench_3dmath [--backend NAME] [--filter TEXT] [--min-time MS]
+//                [--json FILE] [--baseline FILE] [--threshold PERCENT]
+//
+// --json writes the results, one per line, in a format that --baseline
+// reads back. With --baseline, every result that is more than
+// --threshold percent slower than its baseline is reported and the
+// exit status is 1.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_CYCLES 1
+#endif
+
+#include "bvh.h"
+#include "frustum.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "ray.h"
+#include "scalar.h"
+#include "simd.h"
+#include "skinning.h"
+#include "transform.h"
+#include "vector.h"
+#include "vector_soa.h"
+
+#define BENCH_WARM_COUNT 256
+#define BENCH_COLD_COUNT (1 << 18)
+#define BENCH_REPETITIONS 5
+#define BENCH_MAX_RESULTS 256
+#define BENCH_NAME_LENGTH 64
+// Rays cast per pass of the ray query cases.
+#define BENCH_RAY_COUNT 64
+// Joints in the skinning palette, and threads for the threaded cases.
+#define BENCH_SKIN_JOINTS 64
+#define BENCH_SKIN_THREADS 4
+
+typedef struct BenchData {
+    size_t      count;
+    TmScalar   *scalars;
+    TmScalar   *scalarDest;
+    TmScalar   *cosineDest;
+    TmVec2     *vec2s;
+    TmVec2     *vec2Dest;
+    TmVec3     *vec3s;
+    TmVec3     *vec3Dest;
+    TmVec4     *vec4s;
+    TmVec4     *vec4Dest;
+    TmMat2     *mat2s;
+    TmMat2     *mat2Dest;
+    TmMat3     *mat3s;
+    TmMat3     *mat3Dest;
+    TmMat4     *mat4s;
+    TmMat4     *mat4Dest;
+    TmQuat     *quats;
+    TmQuat     *quatDest;
+    TmSphere   *spheres;
+    TmAabb     *boxes;
+    TmTriangle *triangles;
+    uint32_t   *visible;
+    TmFrustum   frustum;
+    TmBvh       bvh;
+    TmRay       rays[BENCH_RAY_COUNT];
+    TmTransformHierarchy transforms;
+    // Skins vec3s, which double as normals, into vec3Dest and
+    // skinNormalDest.
+    TmSkinMesh  skinMesh;
+    uint16_t   *skinJoints;
+    TmVec4     *skinWeights;
+    TmVec3     *skinNormalDest;
+    TmMat4      skinMatrices[BENCH_SKIN_JOINTS];
+    TmDualQuat  skinDualQuats[BENCH_SKIN_JOINTS];
+    TmVec3SoA   vec3SoA;
+    TmVec3SoA   vec3SoADest;
+    TmVec4SoA   vec4SoA;
+    TmVec4SoA   vec4SoADest;
+} BenchData;
+
+// Each case makes one pass over the data set and returns the number of
+// operations it performed.
+typedef struct BenchCase {
+    char const *name;
+    size_t    (*run)(BenchData *data);
+} BenchCase;
+
+typedef struct BenchResult {
+    char        name[BENCH_NAME_LENGTH];
+    char        dataSet[8];
+    double      nsPerOp;
+    double      cyclesPerOp;
+} BenchResult;
+
+// Scalar results are accumulated here so the calls cannot be discarded.
+static volatile TmScalar s_sink;
+
+#define MIRROR(data, i) ((data)->count - 1 - (i))
+
+#define BENCH_SCALAR_UNARY(fn, field)                                   \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        TmScalar sum = 0.0f;                                            \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            sum += fn(&data->field[i]);                                 \
+        }                                                               \
+        s_sink = sum;                                                   \
+        return data->count;                                             \
+    }
+
+#define BENCH_SCALAR_BINARY(fn, field)                                  \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        TmScalar sum = 0.0f;                                            \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            sum += fn(&data->field[i], &data->field[MIRROR(data, i)]);  \
+        }                                                               \
+        s_sink = sum;                                                   \
+        return data->count;                                             \
+    }
+
+#define BENCH_UNARY(fn, field, dest)                                    \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            fn(&data->dest[i], &data->field[i]);                        \
+        }                                                               \
+        return data->count;                                             \
+    }
+
+#define BENCH_BINARY(fn, field, dest)                                   \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            fn(&data->dest[i], &data->field[i],                         \
+               &data->field[MIRROR(data, i)]);                          \
+        }                                                               \
+        return data->count;                                             \
+    }
+
+#define BENCH_SCALE(fn, field, dest)                                    \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            fn(&data->dest[i], data->scalars[i], &data->field[i]);      \
+        }                                                               \
+        return data->count;                                             \
+    }
+
+#define BENCH_MATRIX_SCALE(fn, field, dest)                             \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            fn(&data->dest[i], &data->field[i], data->scalars[i]);      \
+        }                                                               \
+        return data->count;                                             \
+    }
+
+BENCH_BINARY(tmVec2Add, vec2s, vec2Dest)
+BENCH_SCALAR_BINARY(tmVec2Distance, vec2s)
+BENCH_SCALAR_BINARY(tmVec2Dot, vec2s)
+BENCH_SCALAR_UNARY(tmVec2Length, vec2s)
+BENCH_UNARY(tmVec2Normalize, vec2s, vec2Dest)
+BENCH_BINARY(tmVec2Projection, vec2s, vec2Dest)
+BENCH_SCALE(tmVec2Scale, vec2s, vec2Dest)
+BENCH_SCALAR_UNARY(tmVec2SqLength, vec2s)
+BENCH_BINARY(tmVec2Sub, vec2s, vec2Dest)
+
+BENCH_BINARY(tmVec3Add, vec3s, vec3Dest)
+BENCH_BINARY(tmVec3Cross, vec3s, vec3Dest)
+BENCH_SCALAR_BINARY(tmVec3Distance, vec3s)
+BENCH_SCALAR_BINARY(tmVec3Dot, vec3s)
+BENCH_SCALAR_UNARY(tmVec3Length, vec3s)
+BENCH_UNARY(tmVec3Normalize, vec3s, vec3Dest)
+BENCH_BINARY(tmVec3Projection, vec3s, vec3Dest)
+BENCH_SCALE(tmVec3Scale, vec3s, vec3Dest)
+BENCH_SCALAR_UNARY(tmVec3SqLength, vec3s)
+BENCH_BINARY(tmVec3Sub, vec3s, vec3Dest)
+
+BENCH_BINARY(tmVec4Add, vec4s, vec4Dest)
+BENCH_SCALAR_BINARY(tmVec4Distance, vec4s)
+BENCH_SCALAR_BINARY(tmVec4Dot, vec4s)
+BENCH_SCALAR_UNARY(tmVec4Length, vec4s)
+BENCH_UNARY(tmVec4Normalize, vec4s, vec4Dest)
+BENCH_BINARY(tmVec4Projection, vec4s, vec4Dest)
+BENCH_SCALE(tmVec4Scale, vec4s, vec4Dest)
+BENCH_SCALAR_UNARY(tmVec4SqLength, vec4s)
+BENCH_BINARY(tmVec4Sub, vec4s, vec4Dest)
+
+BENCH_BINARY(tmMat2Add, mat2s, mat2Dest)
+BENCH_SCALAR_UNARY(tmMat2Determinant, mat2s)
+BENCH_UNARY(tmMat2Inverse, mat2s, mat2Dest)
+BENCH_BINARY(tmMat2Multiply, mat2s, mat2Dest)
+BENCH_MATRIX_SCALE(tmMat2ScalarMultiply, mat2s, mat2Dest)
+BENCH_UNARY(tmMat2Transpose, mat2s, mat2Dest)
+
+BENCH_BINARY(tmMat3Add, mat3s, mat3Dest)
+BENCH_SCALAR_UNARY(tmMat3Determinant, mat3s)
+BENCH_UNARY(tmMat3Inverse, mat3s, mat3Dest)
+BENCH_BINARY(tmMat3Multiply, mat3s, mat3Dest)
+BENCH_MATRIX_SCALE(tmMat3ScalarMultiply, mat3s, mat3Dest)
+BENCH_UNARY(tmMat3Transpose, mat3s, mat3Dest)
+
+// tmMat4LookAt and tmMat4Perspective are unfinished and assert, so
+// they are not timed.
+BENCH_BINARY(tmMat4Add, mat4s, mat4Dest)
+BENCH_SCALAR_UNARY(tmMat4Determinant, mat4s)
+BENCH_UNARY(tmMat4Inverse, mat4s, mat4Dest)
+BENCH_UNARY(tmMat4InverseAffine, mat4s, mat4Dest)
+BENCH_UNARY(tmMat4InverseRigid, mat4s, mat4Dest)
+BENCH_BINARY(tmMat4Multiply, mat4s, mat4Dest)
+BENCH_MATRIX_SCALE(tmMat4ScalarMultiply, mat4s, mat4Dest)
+BENCH_UNARY(tmMat4Transpose, mat4s, mat4Dest)
+
+static size_t
+bench_tmScalarMix(BenchData *data)
+{
+    TmScalar sum = 0.0f;
+
+    for (size_t i = 0; i < data->count; ++i) {
+        sum += tmScalarMix(data->scalars[i], data->scalars[MIRROR(data, i)], 0.25f);
+    }
+    s_sink = sum;
+
+    return data->count;
+}
+
+// libm next to the TM_FAST_MATH polynomials, whatever tmScalarSin and
+// friends are mapped to in this build.
+#define BENCH_TRIG(fn)                                                  \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        TmScalar sum = 0.0f;                                            \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            sum += fn(data->scalars[i]);                                \
+        }                                                               \
+        s_sink = sum;                                                   \
+        return data->count;                                             \
+    }
+
+#define BENCH_SINCOS(fn)                                                \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        for (size_t i = 0; i < data->count; ++i) {                      \
+            fn(data->scalars[i],                                        \
+               &data->scalarDest[i],                                    \
+               &data->cosineDest[i]);                                   \
+        }                                                               \
+        return data->count;                                             \
+    }
+
+BENCH_TRIG(tmScalarLibmSin)
+BENCH_TRIG(tmScalarLibmCos)
+BENCH_TRIG(tmScalarLibmTan)
+BENCH_TRIG(tmScalarFastSin)
+BENCH_TRIG(tmScalarFastCos)
+BENCH_TRIG(tmScalarFastTan)
+BENCH_SINCOS(tmScalarLibmSinCos)
+
+// The fast sincos functions write floats.
+#if TM_SCALAR_TYPE == TM_SCALAR_TYPE_FLOAT
+BENCH_SINCOS(tmScalarFastSinCos)
+
+static size_t
+bench_tmScalarFastSinCosBatch(BenchData *data)
+{
+    tmScalarFastSinCosBatch(data->scalarDest, data->cosineDest, data->scalars, data->count);
+
+    return data->count;
+}
+#endif
+
+static size_t
+bench_tmMat4Identity(BenchData *data)
+{
+    for (size_t i = 0; i < data->count; ++i) {
+        tmMat4Identity(&data->mat4Dest[i]);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmMat4Rotation(BenchData *data)
+{
+    for (size_t i = 0; i < data->count; ++i) {
+        tmMat4Rotation(&data->mat4Dest[i], &data->vec3s[i], data->scalars[i]);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmMat4MultiplyBatch(BenchData *data)
+{
+    tmMat4MultiplyBatch(data->mat4Dest, data->mat4s, data->mat4s, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmMat4TransformVec4Batch(BenchData *data)
+{
+    tmMat4TransformVec4Batch(data->vec4Dest, &data->mat4s[0], data->vec4s, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmMat4TransformPointsVec3Batch(BenchData *data)
+{
+    tmMat4TransformPointsVec3Batch(data->vec3Dest, &data->mat4s[0], data->vec3s, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec3SoAAdd(BenchData *data)
+{
+    tmVec3SoAAdd(&data->vec3SoADest, &data->vec3SoA, &data->vec3SoA);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec3SoACross(BenchData *data)
+{
+    tmVec3SoACross(&data->vec3SoADest, &data->vec3SoA, &data->vec3SoA);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec3SoADot(BenchData *data)
+{
+    tmVec3SoADot(data->scalarDest, &data->vec3SoA, &data->vec3SoA);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec3SoANormalize(BenchData *data)
+{
+    tmVec3SoANormalize(&data->vec3SoADest, &data->vec3SoA);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec3SoAFromAoS(BenchData *data)
+{
+    tmVec3SoAFromAoS(&data->vec3SoADest, data->vec3s);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec3SoAToAoS(BenchData *data)
+{
+    tmVec3SoAToAoS(data->vec3Dest, &data->vec3SoA);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec4SoADot(BenchData *data)
+{
+    tmVec4SoADot(data->scalarDest, &data->vec4SoA, &data->vec4SoA);
+
+    return data->count;
+}
+
+static size_t
+bench_tmVec4SoANormalize(BenchData *data)
+{
+    tmVec4SoANormalize(&data->vec4SoADest, &data->vec4SoA);
+
+    return data->count;
+}
+
+// The interpolation cost does not depend on the inputs, so interpolating
+// each quaternion with itself is representative.
+static size_t
+bench_tmQuatNlerpBatch(BenchData *data)
+{
+    tmQuatNlerpBatch(data->quatDest, data->quats, data->quats, data->scalars, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmQuatSlerpBatch(BenchData *data)
+{
+    tmQuatSlerpBatch(data->quatDest, data->quats, data->quats, data->scalars, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmFrustumCullAabbBatch(BenchData *data)
+{
+    tmFrustumCullAabbBatch(data->visible, &data->frustum, data->boxes, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmFrustumCullSphereBatch(BenchData *data)
+{
+    tmFrustumCullSphereBatch(data->visible, &data->frustum, data->spheres, data->count);
+
+    return data->count;
+}
+
+static size_t
+bench_tmBvhBuild(BenchData *data)
+{
+    TmBvh bvh;
+
+    if (tmBvhBuild(&bvh, data->boxes, data->count, 1)) {
+        tmBvhFree(&bvh);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmBvhRefit(BenchData *data)
+{
+    tmBvhRefit(&data->bvh, data->boxes);
+
+    return data->count;
+}
+
+// Culls the same boxes as tmFrustumCullAabbBatch, so the two compare
+// directly.
+static size_t
+bench_tmBvhCullFrustum(BenchData *data)
+{
+    tmBvhCullFrustum(data->visible, &data->bvh, &data->frustum);
+
+    return data->count;
+}
+
+static bool
+closestHit(void *context, uint32_t primitive, TmScalar tNear, TmScalar *tMax)
+{
+    (void)context;
+    (void)primitive;
+    *tMax = tNear;
+
+    return true;
+}
+
+// Closest hit along each ray, one operation per ray.
+static size_t
+bench_tmBvhQueryRay(BenchData *data)
+{
+    size_t hits = 0;
+
+    for (int i = 0; i < BENCH_RAY_COUNT; ++i) {
+        hits += tmBvhQueryRay(&data->bvh, &data->rays[i], INFINITY, closestHit, NULL);
+    }
+    s_sink = (TmScalar)hits;
+
+    return BENCH_RAY_COUNT;
+}
+
+// The ray cases below cast every ray at the whole data set and count
+// one operation per ray, like the BVH query above.
+#define BENCH_RAY_SINGLE(fn, field)                                     \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        size_t hits = 0;                                                \
+                                                                        \
+        for (int i = 0; i < BENCH_RAY_COUNT; ++i) {                     \
+            for (size_t j = 0; j < data->count; ++j) {                  \
+                TmScalar t;                                             \
+                                                                        \
+                hits += fn(&data->rays[i], &data->field[j], INFINITY, &t); \
+            }                                                           \
+        }                                                               \
+        s_sink = (TmScalar)hits;                                        \
+                                                                        \
+        return BENCH_RAY_COUNT;                                         \
+    }
+
+#define BENCH_RAY_BATCH(fn, field)                                      \
+    static size_t                                                       \
+    bench_##fn(BenchData *data)                                         \
+    {                                                                   \
+        size_t hits = 0;                                                \
+                                                                        \
+        for (int i = 0; i < BENCH_RAY_COUNT; ++i) {                     \
+            hits += fn(data->scalarDest, &data->rays[i], INFINITY, data->field, data->count); \
+        }                                                               \
+        s_sink = (TmScalar)hits;                                        \
+                                                                        \
+        return BENCH_RAY_COUNT;                                         \
+    }
+
+// Every node moved, as when rebuilding all matrices each frame.
+static size_t
+bench_tmTransformHierarchyUpdate(BenchData *data)
+{
+    tmTransformHierarchyMarkDirty(&data->transforms, 0, data->count);
+    tmTransformHierarchyUpdate(&data->transforms);
+
+    return data->count;
+}
+
+// Only the last 1/64 of the nodes, all leaves, moved; the rest is
+// static. Still counts every node in the hierarchy.
+static size_t
+bench_tmTransformHierarchyUpdateStatic(BenchData *data)
+{
+    size_t const moving = (data->count + 63) / 64;
+
+    tmTransformHierarchyMarkDirty(&data->transforms, data->count - moving, moving);
+    tmTransformHierarchyUpdate(&data->transforms);
+
+    return data->count;
+}
+
+// One operation per vertex, skinning positions and normals.
+#define BENCH_SKIN(name, fn, palette, threadCount)                      \
+    static size_t                                                       \
+    bench_##name(BenchData *data)                                       \
+    {                                                                   \
+        fn(data->vec3Dest, data->skinNormalDest, &data->skinMesh,       \
+           data->palette, threadCount);                                 \
+                                                                        \
+        return data->count;                                             \
+    }
+
+BENCH_SKIN(tmSkinLinear, tmSkinLinear, skinMatrices, 1)
+BENCH_SKIN(tmSkinLinearThreaded, tmSkinLinear, skinMatrices, BENCH_SKIN_THREADS)
+BENCH_SKIN(tmSkinDualQuat, tmSkinDualQuat, skinDualQuats, 1)
+BENCH_SKIN(tmSkinDualQuatThreaded, tmSkinDualQuat, skinDualQuats, BENCH_SKIN_THREADS)
+
+BENCH_RAY_SINGLE(tmRayIntersectAabb, boxes)
+BENCH_RAY_BATCH(tmRayIntersectAabbBatch, boxes)
+BENCH_RAY_SINGLE(tmRayIntersectSphere, spheres)
+BENCH_RAY_BATCH(tmRayIntersectSphereBatch, spheres)
+BENCH_RAY_SINGLE(tmRayIntersectTriangle, triangles)
+BENCH_RAY_BATCH(tmRayIntersectTriangleBatch, triangles)
+
+#ifdef TM_INLINE_API
+// The inline API next to the out-of-line cases above shows what
+// inlining and passing by value buys.
+static size_t
+bench_tmiVec3Dot(BenchData *data)
+{
+    TmScalar sum = 0.0f;
+
+    for (size_t i = 0; i < data->count; ++i) {
+        sum += tmiVec3Dot(data->vec3s[i], data->vec3s[MIRROR(data, i)]);
+    }
+    s_sink = sum;
+
+    return data->count;
+}
+
+static size_t
+bench_tmiVec3Cross(BenchData *data)
+{
+    for (size_t i = 0; i < data->count; ++i) {
+        data->vec3Dest[i] = tmiVec3Cross(data->vec3s[i], data->vec3s[MIRROR(data, i)]);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmiVec3Normalize(BenchData *data)
+{
+    for (size_t i = 0; i < data->count; ++i) {
+        data->vec3Dest[i] = tmiVec3Normalize(data->vec3s[i]);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmiMat4Multiply(BenchData *data)
+{
+    for (size_t i = 0; i < data->count; ++i) {
+        data->mat4Dest[i] = tmiMat4Multiply(data->mat4s[i], data->mat4s[MIRROR(data, i)]);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmiMat4InverseAffine(BenchData *data)
+{
+    for (size_t i = 0; i < data->count; ++i) {
+        data->mat4Dest[i] = tmiMat4InverseAffine(data->mat4s[i]);
+    }
+
+    return data->count;
+}
+
+static size_t
+bench_tmiMat4TransformPoint(BenchData *data)
+{
+    TmMat4 const m = data->mat4s[0];
+
+    for (size_t i = 0; i < data->count; ++i) {
+        data->vec3Dest[i] = tmiMat4TransformPoint(m, data->vec3s[i]);
+    }
+
+    return data->count;
+}
+#endif
+
+#define BENCH_CASE(fn) {#fn, bench_##fn}
+
+static BenchCase const sk_cases[] = {
+    BENCH_CASE(tmScalarMix),
+    BENCH_CASE(tmScalarLibmSin),
+    BENCH_CASE(tmScalarLibmCos),
+    BENCH_CASE(tmScalarLibmTan),
+    BENCH_CASE(tmScalarFastSin),
+    BENCH_CASE(tmScalarFastCos),
+    BENCH_CASE(tmScalarFastTan),
+    BENCH_CASE(tmScalarLibmSinCos),
+#if TM_SCALAR_TYPE == TM_SCALAR_TYPE_FLOAT
+    BENCH_CASE(tmScalarFastSinCos),
+    BENCH_CASE(tmScalarFastSinCosBatch),
+#endif
+    BENCH_CASE(tmVec2Add),
+    BENCH_CASE(tmVec2Distance),
+    BENCH_CASE(tmVec2Dot),
+    BENCH_CASE(tmVec2Length),
+    BENCH_CASE(tmVec2Normalize),
+    BENCH_CASE(tmVec2Projection),
+    BENCH_CASE(tmVec2Scale),
+    BENCH_CASE(tmVec2SqLength),
+    BENCH_CASE(tmVec2Sub),
+    BENCH_CASE(tmVec3Add),
+    BENCH_CASE(tmVec3Cross),
+    BENCH_CASE(tmVec3Distance),
+    BENCH_CASE(tmVec3Dot),
+    BENCH_CASE(tmVec3Length),
+    BENCH_CASE(tmVec3Normalize),
+    BENCH_CASE(tmVec3Projection),
+    BENCH_CASE(tmVec3Scale),
+    BENCH_CASE(tmVec3SqLength),
+    BENCH_CASE(tmVec3Sub),
+    BENCH_CASE(tmVec4Add),
+    BENCH_CASE(tmVec4Distance),
+    BENCH_CASE(tmVec4Dot),
+    BENCH_CASE(tmVec4Length),
+    BENCH_CASE(tmVec4Normalize),
+    BENCH_CASE(tmVec4Projection),
+    BENCH_CASE(tmVec4Scale),
+    BENCH_CASE(tmVec4SqLength),
+    BENCH_CASE(tmVec4Sub),
+    BENCH_CASE(tmMat2Add),
+    BENCH_CASE(tmMat2Determinant),
+    BENCH_CASE(tmMat2Inverse),
+    BENCH_CASE(tmMat2Multiply),
+    BENCH_CASE(tmMat2ScalarMultiply),
+    BENCH_CASE(tmMat2Transpose),
+    BENCH_CASE(tmMat3Add),
+    BENCH_CASE(tmMat3Determinant),
+    BENCH_CASE(tmMat3Inverse),
+    BENCH_CASE(tmMat3Multiply),
+    BENCH_CASE(tmMat3ScalarMultiply),
+    BENCH_CASE(tmMat3Transpose),
+    BENCH_CASE(tmMat4Add),
+    BENCH_CASE(tmMat4Determinant),
+    BENCH_CASE(tmMat4Identity),
+    BENCH_CASE(tmMat4Inverse),
+    BENCH_CASE(tmMat4InverseAffine),
+    BENCH_CASE(tmMat4InverseRigid),
+    BENCH_CASE(tmMat4Multiply),
+    BENCH_CASE(tmMat4Rotation),
+    BENCH_CASE(tmMat4ScalarMultiply),
+    BENCH_CASE(tmMat4Transpose),
+    BENCH_CASE(tmMat4MultiplyBatch),
+    BENCH_CASE(tmMat4TransformVec4Batch),
+    BENCH_CASE(tmMat4TransformPointsVec3Batch),
+    BENCH_CASE(tmVec3SoAAdd),
+    BENCH_CASE(tmVec3SoACross),
+    BENCH_CASE(tmVec3SoADot),
+    BENCH_CASE(tmVec3SoANormalize),
+    BENCH_CASE(tmVec3SoAFromAoS),
+    BENCH_CASE(tmVec3SoAToAoS),
+    BENCH_CASE(tmVec4SoADot),
+    BENCH_CASE(tmVec4SoANormalize),
+    BENCH_CASE(tmQuatNlerpBatch),
+    BENCH_CASE(tmQuatSlerpBatch),
+    BENCH_CASE(tmFrustumCullAabbBatch),
+    BENCH_CASE(tmFrustumCullSphereBatch),
+    BENCH_CASE(tmBvhBuild),
+    BENCH_CASE(tmBvhRefit),
+    BENCH_CASE(tmBvhCullFrustum),
+    BENCH_CASE(tmBvhQueryRay),
+    BENCH_CASE(tmTransformHierarchyUpdate),
+    BENCH_CASE(tmTransformHierarchyUpdateStatic),
+    BENCH_CASE(tmSkinLinear),
+    BENCH_CASE(tmSkinLinearThreaded),
+    BENCH_CASE(tmSkinDualQuat),
+    BENCH_CASE(tmSkinDualQuatThreaded),
+    BENCH_CASE(tmRayIntersectAabb),
+    BENCH_CASE(tmRayIntersectAabbBatch),
+    BENCH_CASE(tmRayIntersectSphere),
+    BENCH_CASE(tmRayIntersectSphereBatch),
+    BENCH_CASE(tmRayIntersectTriangle),
+    BENCH_CASE(tmRayIntersectTriangleBatch),
+#ifdef TM_INLINE_API
+    BENCH_CASE(tmiVec3Dot),
+    BENCH_CASE(tmiVec3Cross),
+    BENCH_CASE(tmiVec3Normalize),
+    BENCH_CASE(tmiMat4Multiply),
+    BENCH_CASE(tmiMat4InverseAffine),
+    BENCH_CASE(tmiMat4TransformPoint),
+#endif
+};
+
+#undef BENCH_CASE
+
+static double
+nowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+static uint64_t
+nowCycles(void)
+{
+#ifdef BENCH_HAVE_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Deterministic, well conditioned inputs: every vector is non-zero and
+// every matrix is diagonally dominant with an affine bottom row, so the
+// normalize and inverse cases never assert. The bounding volumes are
+// scattered in and around a 90 degree frustum, so some are culled by
+// each plane, and the rays start near the camera and fan out into it.
+static void
+fillData(BenchData *data)
+{
+    TmMat4 const cameraToClip = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 46.0f / -44.0f, -1.0f,
+        0.0f, 0.0f, 90.0f / -44.0f, 0.0f
+    };
+    uint32_t state = 0x9e3779b9u;
+
+    for (size_t i = 0; i < data->count; ++i) {
+        TmScalar r[16];
+
+        for (int j = 0; j < 16; ++j) {
+            // xorshift32, mapped to [-0.5, 0.5)
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            r[j] = (TmScalar)(state >> 8) / (TmScalar)(1u << 24) - 0.5f;
+        }
+        data->scalars[i] = r[0] + 1.0f;
+        data->vec2s[i] = (TmVec2){r[1] + 1.0f, r[2]};
+        data->vec3s[i] = (TmVec3){r[3] + 1.0f, r[4], r[5]};
+        data->vec4s[i] = (TmVec4){r[6] + 1.0f, r[7], r[8], r[9]};
+        data->mat2s[i] = (TmMat2){r[10] + 2.0f, r[11], r[12], r[13] + 2.0f};
+        data->mat3s[i] = (TmMat3){r[1] + 2.0f, r[2], r[3],
+                                  r[4], r[5] + 2.0f, r[6],
+                                  r[7], r[8], r[9] + 2.0f};
+        data->mat4s[i] = (TmMat4){r[10] + 2.0f, r[11], r[12], 0.0f,
+                                  r[13], r[14] + 2.0f, r[15], 0.0f,
+                                  r[0], r[1], r[2] + 2.0f, 0.0f,
+                                  r[3], r[4], r[5], 1.0f};
+        tmVec4Normalize((TmVec4 *)&data->quats[i], &data->vec4s[i]);
+        data->spheres[i].center = (TmVec3){80.0f * r[1], 80.0f * r[2], 80.0f * r[3] - 20.0f};
+        data->spheres[i].radius = 4.0f * (r[4] + 0.5f);
+        data->boxes[i].min = data->spheres[i].center;
+        tmVec3Add(&data->boxes[i].max, &data->boxes[i].min, &(TmVec3){r[5] + 1.0f, r[6] + 1.0f, r[7] + 1.0f});
+        data->triangles[i].a = data->boxes[i].min;
+        data->triangles[i].b = (TmVec3){data->boxes[i].max.x, data->boxes[i].min.y, data->boxes[i].min.z};
+        data->triangles[i].c = (TmVec3){data->boxes[i].min.x, data->boxes[i].max.y, data->boxes[i].max.z};
+        // Two strong and two weak influences, summing to one.
+        for (int k = 0; k < TM_SKIN_INFLUENCES; ++k) {
+            data->skinJoints[TM_SKIN_INFLUENCES * i + (size_t)k] = (uint16_t)((r[k] + 0.5f) * BENCH_SKIN_JOINTS);
+        }
+        data->skinWeights[i] = (TmVec4){0.45f + 0.5f * r[8], 0.35f - 0.5f * r[8], 0.1f + 0.1f * r[9], 0.1f - 0.1f * r[9]};
+    }
+    for (int i = 0; i < BENCH_SKIN_JOINTS; ++i) {
+        TmVec3 const unitScale = {1.0f, 1.0f, 1.0f};
+
+        tmTransformCompose(&data->skinMatrices[i], &data->vec3s[i], &data->quats[i], &unitScale);
+        tmDualQuatFromRotationTranslation(&data->skinDualQuats[i], &data->quats[i], &data->vec3s[i]);
+    }
+    data->skinMesh = (TmSkinMesh){data->vec3s, data->vec3s, data->skinJoints, data->skinWeights, data->count};
+    for (int i = 0; i < BENCH_RAY_COUNT; ++i) {
+        data->rays[i].origin = data->vec3s[i];
+        data->rays[i].direction = (TmVec3){data->vec3s[i].y, data->vec3s[i].z, -1.0f};
+    }
+    tmFrustumFromMat4(&data->frustum, &cameraToClip);
+    tmVec3SoAFromAoS(&data->vec3SoA, data->vec3s);
+    tmVec4SoAFromAoS(&data->vec4SoA, data->vec4s);
+}
+
+static bool
+allocData(BenchData *data, size_t count)
+{
+    memset(data, 0, sizeof(*data));
+    data->count = count;
+    data->scalars = malloc(count * sizeof(*data->scalars));
+    data->scalarDest = malloc(count * sizeof(*data->scalarDest));
+    data->cosineDest = malloc(count * sizeof(*data->cosineDest));
+    data->vec2s = malloc(count * sizeof(*data->vec2s));
+    data->vec2Dest = malloc(count * sizeof(*data->vec2Dest));
+    data->vec3s = malloc(count * sizeof(*data->vec3s));
+    data->vec3Dest = malloc(count * sizeof(*data->vec3Dest));
+    data->vec4s = malloc(count * sizeof(*data->vec4s));
+    data->vec4Dest = malloc(count * sizeof(*data->vec4Dest));
+    data->mat2s = malloc(count * sizeof(*data->mat2s));
+    data->mat2Dest = malloc(count * sizeof(*data->mat2Dest));
+    data->mat3s = malloc(count * sizeof(*data->mat3s));
+    data->mat3Dest = malloc(count * sizeof(*data->mat3Dest));
+    data->mat4s = malloc(count * sizeof(*data->mat4s));
+    data->mat4Dest = malloc(count * sizeof(*data->mat4Dest));
+    data->quats = malloc(count * sizeof(*data->quats));
+    data->quatDest = malloc(count * sizeof(*data->quatDest));
+    data->spheres = malloc(count * sizeof(*data->spheres));
+    data->boxes = malloc(count * sizeof(*data->boxes));
+    data->triangles = malloc(count * sizeof(*data->triangles));
+    data->visible = malloc(TM_FRUSTUM_MASK_WORDS(count) * sizeof(*data->visible));
+    data->skinJoints = malloc(count * TM_SKIN_INFLUENCES * sizeof(*data->skinJoints));
+    data->skinWeights = malloc(count * sizeof(*data->skinWeights));
+    data->skinNormalDest = malloc(count * sizeof(*data->skinNormalDest));
+    if (data->scalars == NULL || data->scalarDest == NULL || data->cosineDest == NULL ||
+        data->vec2s == NULL || data->vec2Dest == NULL ||
+        data->vec3s == NULL || data->vec3Dest == NULL ||
+        data->vec4s == NULL || data->vec4Dest == NULL ||
+        data->mat2s == NULL || data->mat2Dest == NULL ||
+        data->mat3s == NULL || data->mat3Dest == NULL ||
+        data->mat4s == NULL || data->mat4Dest == NULL ||
+        data->quats == NULL || data->quatDest == NULL ||
+        data->spheres == NULL || data->boxes == NULL || data->triangles == NULL ||
+        data->visible == NULL ||
+        data->skinJoints == NULL || data->skinWeights == NULL || data->skinNormalDest == NULL ||
+        !tmVec3SoAAlloc(&data->vec3SoA, count) ||
+        !tmVec3SoAAlloc(&data->vec3SoADest, count) ||
+        !tmVec4SoAAlloc(&data->vec4SoA, count) ||
+        !tmVec4SoAAlloc(&data->vec4SoADest, count) ||
+        !tmTransformHierarchyInit(&data->transforms, count)) {
+        return false;
+    }
+    fillData(data);
+    // A tree with four children per node, so leaves come last.
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t const node = tmTransformHierarchyAdd(&data->transforms,
+                                                      (i > 0) ? (uint32_t)((i - 1) / 4) : TM_TRANSFORM_NO_PARENT);
+
+        tmTransformHierarchySetTranslation(&data->transforms, node, &data->vec3s[i]);
+        tmTransformHierarchySetRotation(&data->transforms, node, &data->quats[i]);
+    }
+
+    return tmBvhBuild(&data->bvh, data->boxes, count, 1);
+}
+
+static void
+freeData(BenchData *data)
+{
+    free(data->scalars);
+    free(data->scalarDest);
+    free(data->cosineDest);
+    free(data->vec2s);
+    free(data->vec2Dest);
+    free(data->vec3s);
+    free(data->vec3Dest);
+    free(data->vec4s);
+    free(data->vec4Dest);
+    free(data->mat2s);
+    free(data->mat2Dest);
+    free(data->mat3s);
+    free(data->mat3Dest);
+    free(data->mat4s);
+    free(data->mat4Dest);
+    free(data->quats);
+    free(data->quatDest);
+    free(data->spheres);
+    free(data->boxes);
+    free(data->triangles);
+    free(data->visible);
+    free(data->skinJoints);
+    free(data->skinWeights);
+    free(data->skinNormalDest);
+    tmBvhFree(&data->bvh);
+    tmTransformHierarchyFree(&data->transforms);
+    if (data->vec3SoA.x != NULL) {
+        tmVec3SoAFree(&data->vec3SoA);
+    }
+    if (data->vec3SoADest.x != NULL) {
+        tmVec3SoAFree(&data->vec3SoADest);
+    }
+    if (data->vec4SoA.x != NULL) {
+        tmVec4SoAFree(&data->vec4SoA);
+    }
+    if (data->vec4SoADest.x != NULL) {
+        tmVec4SoAFree(&data->vec4SoADest);
+    }
+}
+
+// Best of BENCH_REPETITIONS runs, each of which repeats whole passes
+// until it has lasted minTimeNs / BENCH_REPETITIONS.
+static void
+runCase(BenchResult *result, BenchCase const *benchCase, BenchData *data, double minTimeNs)
+{
+    double const runNs = minTimeNs / BENCH_REPETITIONS;
+
+    result->nsPerOp = -1.0;
+    result->cyclesPerOp = -1.0;
+    benchCase->run(data);
+    for (int repetition = 0; repetition < BENCH_REPETITIONS; ++repetition) {
+        double const startNs = nowNs();
+        uint64_t const startCycles = nowCycles();
+        double elapsedNs;
+        size_t ops = 0;
+        double nsPerOp;
+
+        do {
+            ops += benchCase->run(data);
+            elapsedNs = nowNs() - startNs;
+        } while (elapsedNs < runNs);
+
+        nsPerOp = elapsedNs / (double)ops;
+        if (result->nsPerOp < 0.0 || nsPerOp < result->nsPerOp) {
+            result->nsPerOp = nsPerOp;
+#ifdef BENCH_HAVE_CYCLES
+            // Time stamp counter ticks, which track the nominal clock
+            // rather than the actual core clock under frequency scaling.
+            result->cyclesPerOp = (double)(nowCycles() - startCycles) / (double)ops;
+#else
+            (void)startCycles;
+#endif
+        }
+    }
+}
+
+static bool
+writeJson(char const *path, BenchResult const *results, size_t resultCount)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "{\n  \"backend\": \"%s\",\n  \"results\": [\n", tmSimdBackendName(tmSimdBackend()));
+    for (size_t i = 0; i < resultCount; ++i) {
+        fprintf(file, "    {\"name\": \"%s\", \"dataset\": \"%s\", \"ns_per_op\": %.4f, \"ops_per_sec\": %.1f, ",
+                results[i].name, results[i].dataSet,
+                results[i].nsPerOp, 1e9 / results[i].nsPerOp);
+        if (results[i].cyclesPerOp >= 0.0) {
+            fprintf(file, "\"cycles_per_op\": %.3f}", results[i].cyclesPerOp);
+        } else {
+            fprintf(file, "\"cycles_per_op\": null}");
+        }
+        fprintf(file, "%s\n", (i + 1 < resultCount) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+// Reads a file written by writeJson. Returns the number of results or
+// -1 if the file cannot be opened.
+static int
+readBaseline(char const *path, BenchResult *results, size_t maxResults)
+{
+    FILE *file = fopen(path, "r");
+    char line[512];
+    size_t resultCount = 0;
+
+    if (file == NULL) {
+        return -1;
+    }
+    while (resultCount < maxResults && fgets(line, sizeof(line), file) != NULL) {
+        BenchResult *result = &results[resultCount];
+
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"dataset\": \"%7[^\"]\", \"ns_per_op\": %lf",
+                   result->name, result->dataSet, &result->nsPerOp) == 3) {
+            ++resultCount;
+        }
+    }
+    fclose(file);
+
+    return (int)resultCount;
+}
+
+static int
+compareWithBaseline(BenchResult const *results, size_t resultCount,
+                    BenchResult const *baseline, size_t baselineCount,
+                    double thresholdPercent)
+{
+    int regressions = 0;
+
+    printf("\n%-34s %-5s %10s %10s %8s\n", "function", "data", "baseline", "ns/op", "change");
+    for (size_t i = 0; i < resultCount; ++i) {
+        for (size_t j = 0; j < baselineCount; ++j) {
+            double change;
+
+            if (strcmp(results[i].name, baseline[j].name) != 0 ||
+                strcmp(results[i].dataSet, baseline[j].dataSet) != 0) {
+                continue;
+            }
+            change = 100.0 * (results[i].nsPerOp - baseline[j].nsPerOp) / baseline[j].nsPerOp;
+            printf("%-34s %-5s %10.3f %10.3f %+7.1f%%%s\n",
+                   results[i].name, results[i].dataSet,
+                   baseline[j].nsPerOp, results[i].nsPerOp, change,
+                   (change > thresholdPercent) ? "  REGRESSION" : "");
+            if (change > thresholdPercent) {
+                ++regressions;
+            }
+            break;
+        }
+    }
+
+    return regressions;
+}
+
+static void
+usage(char const *program)
+{
+    fprintf(stderr,
+            "usage: %s [--backend NAME] [--filter TEXT] [--min-time MS]\n"
+            "          [--json FILE] [--baseline FILE] [--threshold PERCENT]\n",
+            program);
+}
+
+int
+main(int argc, char *argv[])
+{
+    char const *filter = NULL;
+    char const *jsonPath = NULL;
+    char const *baselinePath = NULL;
+    double minTimeNs = 100e6;
+    double thresholdPercent = 10.0;
+    size_t const dataSetCounts[2] = {BENCH_WARM_COUNT, BENCH_COLD_COUNT};
+    char const *const dataSetNames[2] = {"warm", "cold"};
+    static BenchResult results[BENCH_MAX_RESULTS];
+    static BenchResult baseline[BENCH_MAX_RESULTS];
+    size_t resultCount = 0;
+    int status = EXIT_SUCCESS;
+
+    for (int i = 1; i < argc; ++i) {
+        bool const hasValue = (i + 1 < argc);
+
+        if (strcmp(argv[i], "--backend") == 0 && hasValue) {
+            char const *name = argv[++i];
+            TmSimdBackend backend = TM_SIMD_BACKEND_COUNT;
+
+            for (int b = 0; b < TM_SIMD_BACKEND_COUNT; ++b) {
+                if (strcmp(name, tmSimdBackendName((TmSimdBackend)b)) == 0) {
+                    backend = (TmSimdBackend)b;
+                }
+            }
+            if (!tmSimdSetBackend(backend)) {
+                fprintf(stderr, "backend %s is not available\n", name);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            minTimeNs = atof(argv[++i]) * 1e6;
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+            thresholdPercent = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("backend: %s\n\n", tmSimdBackendName(tmSimdBackend()));
+    printf("%-34s %-5s %10s %12s %10s\n", "function", "data", "ns/op", "Mops/s", "cycles/op");
+    for (int set = 0; set < 2; ++set) {
+        BenchData data;
+
+        if (!allocData(&data, dataSetCounts[set])) {
+            fprintf(stderr, "out of memory for the %s data set\n", dataSetNames[set]);
+            freeData(&data);
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < sizeof(sk_cases)/sizeof(sk_cases[0]); ++i) {
+            BenchResult *result = &results[resultCount];
+
+            if (filter != NULL && strstr(sk_cases[i].name, filter) == NULL) {
+                continue;
+            }
+            if (resultCount == BENCH_MAX_RESULTS) {
+                break;
+            }
+            runCase(result, &sk_cases[i], &data, minTimeNs);
+            snprintf(result->name, sizeof(result->name), "%s", sk_cases[i].name);
+            snprintf(result->dataSet, sizeof(result->dataSet), "%s", dataSetNames[set]);
+            printf("%-34s %-5s %10.3f %12.2f ", result->name, result->dataSet,
+                   result->nsPerOp, 1e3 / result->nsPerOp);
+            if (result->cyclesPerOp >= 0.0) {
+                printf("%10.2f\n", result->cyclesPerOp);
+            } else {
+                printf("%10s\n", "n/a");
+            }
+            ++resultCount;
+        }
+        freeData(&data);
+    }
+
+    if (jsonPath != NULL && !writeJson(jsonPath, results, resultCount)) {
+        fprintf(stderr, "could not write %s\n", jsonPath);
+        status = EXIT_FAILURE;
+    }
+    if (baselinePath != NULL) {
+        int const baselineCount = readBaseline(baselinePath, baseline, BENCH_MAX_RESULTS);
+        int regressions;
+
+        if (baselineCount < 0) {
+            fprintf(stderr, "could not read %s\n", baselinePath);
+            return EXIT_FAILURE;
+        }
+        regressions = compareWithBaseline(results, resultCount,
+                                          baseline, (size_t)baselineCount,
+                                          thresholdPercent);
+        if (regressions > 0) {
+            printf("\n%d result(s) more than %.1f%% slower than the baseline\n",
+                   regressions, thresholdPercent);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,19 @@
+#ifndef GRAPHICS_MATH_BOUNDS_H
+#define GRAPHICS_MATH_BOUNDS_H
+
+#include "scalar.h"
+#include "vector.h"
+
+// Bounding volumes shared by the frustum, ray and BVH modules.
+
+typedef struct TmSphere {
+    TmVec3   center;
+    TmScalar radius;
+} TmSphere;
+
+typedef struct TmAabb {
+    TmVec3 min;
+    TmVec3 max;
+} TmAabb;
+
+#endif /* GRAPHICS_MATH_BOUNDS_H */
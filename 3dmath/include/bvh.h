@@ -0,0 +1,79 @@
+#ifndef GRAPHICS_MATH_BVH_H
+#define GRAPHICS_MATH_BVH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bounds.h"
+#include "frustum.h"
+#include "ray.h"
+#include "scalar.h"
+
+// Bounding volume hierarchy over an array of primitive boxes, built with
+// the surface area heuristic evaluated over TM_BVH_BINS bins per axis.
+//
+// Nodes are stored depth first: an interior node's first child directly
+// follows it and offset is the index of the second; a leaf covers count
+// entries of boxes and primitives starting at offset. The primitive
+// boxes are copied in leaf order so leaves read them sequentially.
+// Primitives are reported by their index in the array the BVH was built
+// from.
+
+#define TM_BVH_BINS 16
+// Leaves never hold more primitives than this.
+#define TM_BVH_MAX_LEAF_SIZE 8
+// Traversal uses a fixed stack; the builder never goes deeper.
+#define TM_BVH_MAX_DEPTH 64
+
+typedef struct TmBvhNode {
+    TmAabb      bounds;
+    uint32_t    offset;
+    uint32_t    count;
+} TmBvhNode;
+
+typedef struct TmBvh {
+    TmBvhNode  *nodes;
+    TmAabb     *boxes;
+    uint32_t   *primitives;
+    size_t      nodeCount;
+    size_t      count;
+} TmBvh;
+
+// Called for each primitive whose box the ray enters at tNear. Lowering
+// *tMax prunes everything farther away, which turns the query into a
+// closest hit search. Returning false ends the query.
+typedef bool (*TmBvhRayVisitor)(void *context, uint32_t primitive, TmScalar tNear, TmScalar *tMax);
+// Called for each primitive whose box overlaps the query box. Returning
+// false ends the query.
+typedef bool (*TmBvhOverlapVisitor)(void *context, uint32_t primitive);
+
+// Subtrees of large inputs are built on up to threadCount threads, which
+// gives the same tree as building on one. Returns false when out of
+// memory; count must be non-zero and below UINT32_MAX.
+bool         tmBvhBuild(TmBvh *bvh, TmAabb const *boxes, size_t count, unsigned threadCount);
+void         tmBvhFree(TmBvh *bvh);
+// Recomputes every bound for moved primitives without changing the
+// topology. boxes is indexed like the array given to tmBvhBuild. The
+// tree degrades as primitives move away from where it was built, so
+// rebuild after large changes.
+TmBvh       *tmBvhRefit(TmBvh *bvh, TmAabb const *boxes);
+
+// Same bits and count as tmFrustumCullAabbBatch on the primitive boxes,
+// but whole subtrees are accepted or rejected at once. That pays off
+// when most of the scene is out of view; the batched test is faster when
+// most of it is visible. visible must hold
+// TM_FRUSTUM_MASK_WORDS(bvh->count) words.
+size_t       tmBvhCullFrustum(uint32_t *visible, TmBvh const *bvh, TmFrustum const *frustum);
+// Return the number of primitives passed to the visitor. Ray queries
+// visit nearer subtrees first.
+size_t       tmBvhQueryAabb(TmBvh const *bvh,
+                            TmAabb const *box,
+                            TmBvhOverlapVisitor visit,
+                            void *context);
+size_t       tmBvhQueryRay(TmBvh const *bvh,
+                           TmRay const *ray,
+                           TmScalar tMax,
+                           TmBvhRayVisitor visit,
+                           void *context);
+
+#endif /* GRAPHICS_MATH_BVH_H */
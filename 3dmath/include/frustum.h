@@ -0,0 +1,59 @@
+#ifndef GRAPHICS_MATH_FRUSTUM_H
+#define GRAPHICS_MATH_FRUSTUM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bounds.h"
+#include "matrix.h"
+#include "scalar.h"
+#include "vector.h"
+
+// View frustums as six planes, each stored as (a, b, c, d) with unit
+// normal (a, b, c) pointing inwards, so a x + b y + c z + d is the
+// signed distance of (x, y, z) from the plane.
+//
+// tmFrustumFromMat4 extracts the planes from a matrix that maps to
+// OpenGL clip space (-w <= x, y, z <= w), in the space the matrix maps
+// from: camera-to-clip gives camera space planes, camera-to-clip times
+// model-to-camera gives model space planes.
+//
+// The tests are conservative. Nothing inside the frustum is ever
+// rejected, but volumes just outside a corner may be reported visible.
+
+typedef enum TmFrustumPlane {
+    TM_FRUSTUM_PLANE_LEFT,
+    TM_FRUSTUM_PLANE_RIGHT,
+    TM_FRUSTUM_PLANE_BOTTOM,
+    TM_FRUSTUM_PLANE_TOP,
+    TM_FRUSTUM_PLANE_NEAR,
+    TM_FRUSTUM_PLANE_FAR,
+    TM_FRUSTUM_PLANE_COUNT
+} TmFrustumPlane;
+
+typedef struct TmFrustum {
+    TmVec4 planes[TM_FRUSTUM_PLANE_COUNT];
+} TmFrustum;
+
+// Number of uint32_t words in a visibility mask of count elements.
+#define TM_FRUSTUM_MASK_WORDS(count) (((count) + 31) / 32)
+
+TmFrustum   *tmFrustumFromMat4(TmFrustum *dest, TmMat4 const *m);
+bool         tmFrustumTestAabb(TmFrustum const *frustum, TmAabb const *box);
+bool         tmFrustumTestSphere(TmFrustum const *frustum, TmSphere const *sphere);
+
+// Batched tests. Bit i % 32 of visible[i / 32] is set when element i may
+// be visible; visible must hold TM_FRUSTUM_MASK_WORDS(count) words and
+// the unused high bits of the last word are cleared. The masks match the
+// single-element tests on every SIMD backend. Returns the number of
+// visible elements.
+size_t       tmFrustumCullAabbBatch(uint32_t *visible,
+                                    TmFrustum const *frustum,
+                                    TmAabb const *boxes,
+                                    size_t count);
+size_t       tmFrustumCullSphereBatch(uint32_t *visible,
+                                      TmFrustum const *frustum,
+                                      TmSphere const *spheres,
+                                      size_t count);
+
+#endif /* GRAPHICS_MATH_FRUSTUM_H */
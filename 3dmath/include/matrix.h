@@ -1,6 +1,7 @@
 #ifndef GRAPHICS_MATH_MATRIX_H
 #define GRAPHICS_MATH_MATRIX_H
 
+#include <stddef.h>
 #include "scalar.h"
 #include "vector.h"
 
@@ -53,6 +54,31 @@ typedef struct TmMat4 {
     TmScalar m44;
 } TmMat4;
 
+// Always single precision, whatever TmScalar is, in the layout GL
+// expects from glUniformMatrix4fv.
+typedef struct TmMat4f {
+    // column 1
+    float m11;
+    float m21;
+    float m31;
+    float m41;
+    // column 2
+    float m12;
+    float m22;
+    float m32;
+    float m42;
+    // column 3
+    float m13;
+    float m23;
+    float m33;
+    float m43;
+    // column 4
+    float m14;
+    float m24;
+    float m34;
+    float m44;
+} TmMat4f;
+
 #define TM_MAT2_ZERO_INITIALIZER {.m11=0.0f, .m12=0.0f, \
                                   .m21=0.0f, .m22=0.0f}
 #define TM_MAT2_ZERO ((TmMat2)TM_MAT2_ZERO_INITIALIZER)
@@ -96,6 +122,11 @@ TmMat4      *tmMat4Add(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b);
 TmScalar     tmMat4Determinant(TmMat4 const *a);
 TmMat4      *tmMat4Identity(TmMat4 *dest);
 TmMat4      *tmMat4Inverse(TmMat4 *dest, TmMat4 const *a);
+// Cheaper inverses for model and view matrices. Affine requires the
+// bottom row to be (0, 0, 0, 1); rigid additionally requires the upper
+// 3x3 block to be a pure rotation. Neither checks its precondition.
+TmMat4      *tmMat4InverseAffine(TmMat4 *dest, TmMat4 const *a);
+TmMat4      *tmMat4InverseRigid(TmMat4 *dest, TmMat4 const *a);
 TmMat4      *tmMat4Multiply(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b);
 TmMat4      *tmMat4Rotation(TmMat4 *dest, TmVec3 const *normal, TmScalar angle);
 TmMat4      *tmMat4ScalarMultiply(TmMat4 *dest, TmMat4 const *a, TmScalar x);
@@ -110,4 +141,48 @@ TmMat4      *tmMat4Perspective(TmMat4 *dest,
                                TmScalar zNear,
                                TmScalar zFar);
 
+// Batched variants. Element i of dest may be the same object as element
+// i of an input array, but the arrays must not otherwise overlap. No
+// alignment beyond that of TmScalar is required. AVX2 works on two
+// matrices or vectors at once, one in each 128-bit half. SSE2 and NEON
+// registers hold a single column, so those backends interleave two
+// products per iteration, and transpose four vectors so that each lane
+// holds one. Points are transposed the same way on every backend.
+TmMat4      *tmMat4MultiplyBatch(TmMat4 *dest,
+                                 TmMat4 const *a,
+                                 TmMat4 const *b,
+                                 size_t count);
+TmVec4      *tmMat4TransformVec4Batch(TmVec4 *dest,
+                                      TmMat4 const *m,
+                                      TmVec4 const *vectors,
+                                      size_t count);
+// Treats each point as (x, y, z, 1) and drops the resulting w, so m
+// should be affine. Use tmMat4TransformVec4Batch for projections.
+TmVec3      *tmMat4TransformPointsVec3Batch(TmVec3 *dest,
+                                            TmMat4 const *m,
+                                            TmVec3 const *points,
+                                            size_t count);
+
+// Conversions to single precision for upload. With double scalars, large
+// world coordinates lose too much precision as floats, so objects far
+// from the origin jitter. Instead, subtract the eye position from each
+// model-to-world matrix while still in TmScalar precision, and drop the
+// translation from the view matrix:
+//
+//   tmMat4ToFloatCameraRelativeBatch(models, worlds, &eye, count);
+//   view.m14 = view.m24 = view.m34 = 0.0f;
+//   tmMat4ToFloat(&viewRotation, &view);
+//
+// dest[i] is translation(-eye) * world[i], rounded to float.
+TmMat4f     *tmMat4ToFloat(TmMat4f *dest, TmMat4 const *a);
+TmMat4f     *tmMat4ToFloatCameraRelativeBatch(TmMat4f *dest,
+                                              TmMat4 const *world,
+                                              TmVec3 const *eye,
+                                              size_t count);
+
+// Opt-in header-only API, enabled by the TM_INLINE_API CMake option.
+#ifdef TM_INLINE_API
+#include "matrix_inline.h"
+#endif
+
 #endif /* GRAPHICS_MATH_MATRIX_H */
@@ -0,0 +1,161 @@
+#ifndef GRAPHICS_MATH_MATRIX_INLINE_H
+#define GRAPHICS_MATH_MATRIX_INLINE_H
+
+#include <assert.h>
+#include "matrix.h"
+#include "scalar.h"
+#include "vector.h"
+
+// Header-only, pass-by-value counterparts of the TmMat4 functions in
+// matrix.h. Results are identical to the scalar backend; the general
+// inverse is left out because the SIMD backends round it differently,
+// so use tmMat4Inverse for that.
+
+static inline TmMat4
+tmiMat4Identity(void)
+{
+    return TM_MAT4_IDENTITY;
+}
+
+static inline TmMat4
+tmiMat4Add(TmMat4 a, TmMat4 b)
+{
+    TmScalar const *pA = (TmScalar const *)&a;
+    TmScalar const *pB = (TmScalar const *)&b;
+    TmMat4 sum;
+    TmScalar *pSum = (TmScalar *)&sum;
+
+    for (int i = 0; i < 16; ++i) {
+        pSum[i] = pA[i] + pB[i];
+    }
+
+    return sum;
+}
+
+static inline TmMat4
+tmiMat4ScalarMultiply(TmMat4 a, TmScalar x)
+{
+    TmScalar const *pA = (TmScalar const *)&a;
+    TmMat4 product;
+    TmScalar *pProduct = (TmScalar *)&product;
+
+    for (int i = 0; i < 16; ++i) {
+        pProduct[i] = pA[i] * x;
+    }
+
+    return product;
+}
+
+static inline TmMat4
+tmiMat4Multiply(TmMat4 a, TmMat4 b)
+{
+    TmScalar const *pA = (TmScalar const *)&a;
+    TmScalar const *pB = (TmScalar const *)&b;
+    TmMat4 product;
+    TmScalar *pProduct = (TmScalar *)&product;
+
+    for (int column = 0; column < 4; ++column) {
+        TmScalar const *bColumn = pB + 4 * column;
+
+        for (int row = 0; row < 4; ++row) {
+            pProduct[4 * column + row] = ((pA[row] * bColumn[0]) +
+                                          (pA[4 + row] * bColumn[1]) +
+                                          (pA[8 + row] * bColumn[2]) +
+                                          (pA[12 + row] * bColumn[3]));
+        }
+    }
+
+    return product;
+}
+
+static inline TmMat4
+tmiMat4Transpose(TmMat4 a)
+{
+    return (TmMat4){a.m11, a.m12, a.m13, a.m14,
+                    a.m21, a.m22, a.m23, a.m24,
+                    a.m31, a.m32, a.m33, a.m34,
+                    a.m41, a.m42, a.m43, a.m44};
+}
+
+static inline TmVec4
+tmiMat4TransformVec4(TmMat4 m, TmVec4 v)
+{
+    return (TmVec4){(m.m11 * v.x) + (m.m12 * v.y) + (m.m13 * v.z) + (m.m14 * v.w),
+                    (m.m21 * v.x) + (m.m22 * v.y) + (m.m23 * v.z) + (m.m24 * v.w),
+                    (m.m31 * v.x) + (m.m32 * v.y) + (m.m33 * v.z) + (m.m34 * v.w),
+                    (m.m41 * v.x) + (m.m42 * v.y) + (m.m43 * v.z) + (m.m44 * v.w)};
+}
+
+// Treats p as (x, y, z, 1) and drops w, like tmMat4TransformPointsVec3Batch.
+static inline TmVec3
+tmiMat4TransformPoint(TmMat4 m, TmVec3 p)
+{
+    return (TmVec3){(m.m11 * p.x) + (m.m12 * p.y) + (m.m13 * p.z) + m.m14,
+                    (m.m21 * p.x) + (m.m22 * p.y) + (m.m23 * p.z) + m.m24,
+                    (m.m31 * p.x) + (m.m32 * p.y) + (m.m33 * p.z) + m.m34};
+}
+
+static inline TmMat4
+tmiMat4InverseAffine(TmMat4 a)
+{
+    TmMat4 inverse;
+    TmScalar determinant;
+    TmScalar invDeterminant;
+
+    inverse.m11 = (a.m22 * a.m33) - (a.m32 * a.m23);
+    inverse.m12 = (a.m32 * a.m13) - (a.m12 * a.m33);
+    inverse.m13 = (a.m12 * a.m23) - (a.m22 * a.m13);
+    determinant = (a.m11 * inverse.m11) + (a.m21 * inverse.m12) + (a.m31 * inverse.m13);
+    assert(determinant != 0.0f);
+    invDeterminant = 1.0f / determinant;
+
+    inverse.m11 *= invDeterminant;
+    inverse.m12 *= invDeterminant;
+    inverse.m13 *= invDeterminant;
+    inverse.m21 = ((a.m31 * a.m23) - (a.m21 * a.m33)) * invDeterminant;
+    inverse.m22 = ((a.m11 * a.m33) - (a.m31 * a.m13)) * invDeterminant;
+    inverse.m23 = ((a.m21 * a.m13) - (a.m11 * a.m23)) * invDeterminant;
+    inverse.m31 = ((a.m21 * a.m32) - (a.m31 * a.m22)) * invDeterminant;
+    inverse.m32 = ((a.m31 * a.m12) - (a.m11 * a.m32)) * invDeterminant;
+    inverse.m33 = ((a.m11 * a.m22) - (a.m21 * a.m12)) * invDeterminant;
+
+    inverse.m14 = -((inverse.m11 * a.m14) + (inverse.m12 * a.m24) + (inverse.m13 * a.m34));
+    inverse.m24 = -((inverse.m21 * a.m14) + (inverse.m22 * a.m24) + (inverse.m23 * a.m34));
+    inverse.m34 = -((inverse.m31 * a.m14) + (inverse.m32 * a.m24) + (inverse.m33 * a.m34));
+
+    inverse.m41 = 0.0f;
+    inverse.m42 = 0.0f;
+    inverse.m43 = 0.0f;
+    inverse.m44 = 1.0f;
+
+    return inverse;
+}
+
+static inline TmMat4
+tmiMat4InverseRigid(TmMat4 a)
+{
+    TmMat4 inverse;
+
+    inverse.m11 = a.m11;
+    inverse.m12 = a.m21;
+    inverse.m13 = a.m31;
+    inverse.m21 = a.m12;
+    inverse.m22 = a.m22;
+    inverse.m23 = a.m32;
+    inverse.m31 = a.m13;
+    inverse.m32 = a.m23;
+    inverse.m33 = a.m33;
+
+    inverse.m14 = -((inverse.m11 * a.m14) + (inverse.m12 * a.m24) + (inverse.m13 * a.m34));
+    inverse.m24 = -((inverse.m21 * a.m14) + (inverse.m22 * a.m24) + (inverse.m23 * a.m34));
+    inverse.m34 = -((inverse.m31 * a.m14) + (inverse.m32 * a.m24) + (inverse.m33 * a.m34));
+
+    inverse.m41 = 0.0f;
+    inverse.m42 = 0.0f;
+    inverse.m43 = 0.0f;
+    inverse.m44 = 1.0f;
+
+    return inverse;
+}
+
+#endif /* GRAPHICS_MATH_MATRIX_INLINE_H */
@@ -0,0 +1,73 @@
+#ifndef GRAPHICS_MATH_QUATERNION_H
+#define GRAPHICS_MATH_QUATERNION_H
+
+#include <stddef.h>
+#include "matrix.h"
+#include "scalar.h"
+#include "vector.h"
+
+// Rotation quaternions, stored as (x, y, z, w) with w the scalar part.
+// They rotate the same way as tmMat4Rotation for the same axis and
+// angle, and tmQuatMultiply(dest, a, b) applies b first, like
+// tmMat4Multiply.
+
+typedef struct TmQuat {
+    TmScalar x;
+    TmScalar y;
+    TmScalar z;
+    TmScalar w;
+} TmQuat;
+
+#define TM_QUAT_IDENTITY_INITIALIZER {.x=0.0f, .y=0.0f, .z=0.0f, .w=1.0f}
+#define TM_QUAT_IDENTITY ((TmQuat)TM_QUAT_IDENTITY_INITIALIZER)
+
+TmQuat      *tmQuatConjugate(TmQuat *dest, TmQuat const *q);
+TmScalar     tmQuatDot(TmQuat const *p, TmQuat const *q);
+TmQuat      *tmQuatFromAxisAngle(TmQuat *dest, TmVec3 const *normal, TmScalar angle);
+// m must be a pure rotation.
+TmQuat      *tmQuatFromMat4(TmQuat *dest, TmMat4 const *m);
+TmQuat      *tmQuatMultiply(TmQuat *dest, TmQuat const *a, TmQuat const *b);
+TmQuat      *tmQuatNormalize(TmQuat *dest, TmQuat const *q);
+TmVec3      *tmQuatRotateVec3(TmVec3 *dest, TmQuat const *q, TmVec3 const *v);
+// q must be unit length.
+TmMat4      *tmQuatToMat4(TmMat4 *dest, TmQuat const *q);
+
+// Both interpolations take the shorter arc, negating q when p . q < 0,
+// and expect unit quaternions. tmQuatSlerp evaluates sin(t theta) /
+// sin(theta) with a polynomial in cos(theta) instead of calling acos
+// and sin; its weights are within 2e-6 of the exact ones. tmQuatNlerp
+// is cheaper but does not move at constant angular speed.
+TmQuat      *tmQuatNlerp(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar t);
+TmQuat      *tmQuatSlerp(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar t);
+
+// Batched variants with one t per element. Element i of dest may be the
+// same object as element i of p or q, but the arrays must not otherwise
+// overlap. Results are identical to the single-element functions.
+TmQuat      *tmQuatNlerpBatch(TmQuat *dest,
+                              TmQuat const *p,
+                              TmQuat const *q,
+                              TmScalar const *t,
+                              size_t count);
+TmQuat      *tmQuatSlerpBatch(TmQuat *dest,
+                              TmQuat const *p,
+                              TmQuat const *q,
+                              TmScalar const *t,
+                              size_t count);
+
+// Rigid transforms as dual quaternions real + e dual, where real is the
+// rotation and dual is (translation, 0) * real / 2. A normalized blend
+// of several is still rigid, which dual quaternion skinning relies on.
+typedef struct TmDualQuat {
+    TmQuat  real;
+    TmQuat  dual;
+} TmDualQuat;
+
+// rotation must be unit length and m rigid.
+TmDualQuat  *tmDualQuatFromMat4(TmDualQuat *dest, TmMat4 const *m);
+TmDualQuat  *tmDualQuatFromRotationTranslation(TmDualQuat *dest,
+                                               TmQuat const *rotation,
+                                               TmVec3 const *translation);
+// Rotates p and then translates it; dq must have a unit real part.
+TmVec3      *tmDualQuatTransformPoint(TmVec3 *dest, TmDualQuat const *dq, TmVec3 const *p);
+
+#endif /* GRAPHICS_MATH_QUATERNION_H */
@@ -0,0 +1,53 @@
+#ifndef GRAPHICS_MATH_RAY_H
+#define GRAPHICS_MATH_RAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "bounds.h"
+#include "scalar.h"
+#include "vector.h"
+
+// Rays are origin + t direction for t >= 0. The direction need not be
+// unit length, in which case t is not a distance. Zero direction
+// components are allowed.
+
+typedef struct TmRay {
+    TmVec3 origin;
+    TmVec3 direction;
+} TmRay;
+
+typedef struct TmTriangle {
+    TmVec3 a;
+    TmVec3 b;
+    TmVec3 c;
+} TmTriangle;
+
+// On a hit within [0, tMax], these store the entry t in *tNear, which
+// is 0 when the origin is inside the volume. Boxes use the slab test.
+bool         tmRayIntersectAabb(TmRay const *ray, TmAabb const *box, TmScalar tMax, TmScalar *tNear);
+bool         tmRayIntersectSphere(TmRay const *ray, TmSphere const *sphere, TmScalar tMax, TmScalar *tNear);
+// Moller-Trumbore, hitting both faces. Rays in the triangle's plane
+// miss it.
+bool         tmRayIntersectTriangle(TmRay const *ray, TmTriangle const *triangle, TmScalar tMax, TmScalar *t);
+
+// One ray against many primitives. t[i] receives what the test above
+// would store for primitive i, or INFINITY on a miss, so the smallest
+// t is the closest hit. The results match the single-primitive tests
+// on every SIMD backend. Returns the number of hits.
+size_t       tmRayIntersectAabbBatch(TmScalar *t,
+                                     TmRay const *ray,
+                                     TmScalar tMax,
+                                     TmAabb const *boxes,
+                                     size_t count);
+size_t       tmRayIntersectSphereBatch(TmScalar *t,
+                                       TmRay const *ray,
+                                       TmScalar tMax,
+                                       TmSphere const *spheres,
+                                       size_t count);
+size_t       tmRayIntersectTriangleBatch(TmScalar *t,
+                                         TmRay const *ray,
+                                         TmScalar tMax,
+                                         TmTriangle const *triangles,
+                                         size_t count);
+
+#endif /* GRAPHICS_MATH_RAY_H */
@@ -1,30 +1,92 @@
 #ifndef GRAPHICS_MATH_SCALAR_H
 #define GRAPHICS_MATH_SCALAR_H
 
+#include <stddef.h>
+
 #define TM_SCALAR_TYPE_FLOAT 0x2
 #define TM_SCALAR_TYPE_DOUBLE 0x4 
 #define TM_SCALAR_TYPE_LONG_DOUBLE 0x8
 
+// Set by the build, see TM_SCALAR_TYPE in CMakeLists.txt. Only float
+// builds have SIMD backends; the others always use the scalar one.
+#ifndef TM_SCALAR_TYPE
 #define TM_SCALAR_TYPE TM_SCALAR_TYPE_FLOAT
+#endif
 
+// <tgmath.h> should do the right thing, but does not work correctly on
+// FreeBSD's headers. These defines should be updated if the scalar
+// typedef changes.
 #if TM_SCALAR_TYPE == TM_SCALAR_TYPE_FLOAT
 typedef float TmScalar;
 
 #define TM_SCALAR_PI 3.14159265358979323846f
 
-// <tgmath.h> should do the right thing, but does not work correctly on
-// FreeBSD's headers. These defines should be updated if the scalar
-// typedef changes.
-#define tmScalarFabs fabsf
-#define tmScalarSqrt sqrtf
-#define tmScalarTan  tanf
-#define tmScalarCos  cosf
-#define tmScalarSin  sinf
+#define tmScalarFabs    fabsf
+#define tmScalarSqrt    sqrtf
+#define tmScalarLibmTan tanf
+#define tmScalarLibmCos cosf
+#define tmScalarLibmSin sinf
 
-TmScalar    tmScalarMix(TmScalar x, TmScalar y, TmScalar a);
+#elif TM_SCALAR_TYPE == TM_SCALAR_TYPE_DOUBLE
+typedef double TmScalar;
+
+#define TM_SCALAR_PI 3.14159265358979323846
+
+#define tmScalarFabs    fabs
+#define tmScalarSqrt    sqrt
+#define tmScalarLibmTan tan
+#define tmScalarLibmCos cos
+#define tmScalarLibmSin sin
+
+#elif TM_SCALAR_TYPE == TM_SCALAR_TYPE_LONG_DOUBLE
+typedef long double TmScalar;
+
+#define TM_SCALAR_PI 3.14159265358979323846264338327950288L
+
+#define tmScalarFabs    fabsl
+#define tmScalarSqrt    sqrtl
+#define tmScalarLibmTan tanl
+#define tmScalarLibmCos cosl
+#define tmScalarLibmSin sinl
 
 #else
 #error "TM_SCALAR_TYPE set to an invalid value"
 #endif
 
+// With TM_FAST_MATH the trigonometric functions use the polynomial
+// approximations below instead of libm.
+#ifdef TM_FAST_MATH
+#if TM_SCALAR_TYPE != TM_SCALAR_TYPE_FLOAT
+#error "TM_FAST_MATH is only accurate enough for float scalars"
+#endif
+#define tmScalarTan    tmScalarFastTan
+#define tmScalarCos    tmScalarFastCos
+#define tmScalarSin    tmScalarFastSin
+#define tmScalarSinCos tmScalarFastSinCos
+#else
+#define tmScalarTan    tmScalarLibmTan
+#define tmScalarCos    tmScalarLibmCos
+#define tmScalarSin    tmScalarLibmSin
+#define tmScalarSinCos tmScalarLibmSinCos
+#endif
+
+TmScalar    tmScalarMix(TmScalar x, TmScalar y, TmScalar a);
+
+// Minimax polynomials after reducing x to [-pi/4, pi/4]. For |x| <= 8192
+// sin and cos are within 2e-7 of libm, and tan is within
+// 2e-7 (1 + tan(x)^2) of it, as if x were off by 2e-7. Larger arguments
+// lose accuracy. They work in single precision whatever TmScalar is.
+float       tmScalarFastCos(float x);
+float       tmScalarFastSin(float x);
+void        tmScalarFastSinCos(float x, float *sine, float *cosine);
+float       tmScalarFastTan(float x);
+// sines[i] and cosines[i] are tmScalarFastSinCos(angles[i]) on every
+// SIMD backend, which process 4 or 8 angles at a time.
+void        tmScalarFastSinCosBatch(float *sines,
+                                    float *cosines,
+                                    float const *angles,
+                                    size_t count);
+
+void        tmScalarLibmSinCos(TmScalar x, TmScalar *sine, TmScalar *cosine);
+
 #endif /* GRAPHICS_MATH_SCALAR_H */
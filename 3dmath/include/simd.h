@@ -0,0 +1,26 @@
+#ifndef GRAPHICS_MATH_SIMD_H
+#define GRAPHICS_MATH_SIMD_H
+
+#include <stdbool.h>
+
+// The TmMat4 family, the TmVec*SoA streams, the batched TmQuat
+// interpolations, tmScalarFastSinCosBatch, the batched frustum and ray
+// tests and skinning are implemented by several backends. The best one the CPU
+// supports is picked the first time a dispatched function is called.
+// The scalar backend is always available and is the reference the
+// others are tested against.
+
+typedef enum TmSimdBackend {
+    TM_SIMD_BACKEND_SCALAR,
+    TM_SIMD_BACKEND_SSE2,
+    TM_SIMD_BACKEND_AVX2,
+    TM_SIMD_BACKEND_NEON,
+    TM_SIMD_BACKEND_COUNT
+} TmSimdBackend;
+
+TmSimdBackend    tmSimdBackend(void);
+char const      *tmSimdBackendName(TmSimdBackend backend);
+bool             tmSimdBackendIsSupported(TmSimdBackend backend);
+bool             tmSimdSetBackend(TmSimdBackend backend);
+
+#endif /* GRAPHICS_MATH_SIMD_H */
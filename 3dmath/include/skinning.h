@@ -0,0 +1,50 @@
+#ifndef GRAPHICS_MATH_SKINNING_H
+#define GRAPHICS_MATH_SKINNING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+// CPU skinning of bind pose vertices by a palette of joint transforms.
+// Every vertex blends exactly TM_SKIN_INFLUENCES joints; pad unused
+// ones with weight zero. Weights should sum to one.
+//
+// Linear blend skinning sums the weighted matrices and transforms by the
+// result. Normals go through its upper 3x3 block and are renormalized,
+// which is only exact without non-uniform scale. Dual quaternion
+// skinning blends rigid transforms along the shorter arc and keeps
+// volume around twisting joints, but cannot scale.
+//
+// Every backend gives the same results as the scalar one, on any number
+// of threads.
+
+#define TM_SKIN_INFLUENCES 4
+
+typedef struct TmSkinMesh {
+    TmVec3 const   *positions;
+    // May be NULL, in which case no normals are written.
+    TmVec3 const   *normals;
+    // TM_SKIN_INFLUENCES palette indices and weights per vertex.
+    uint16_t const *joints;
+    TmVec4 const   *weights;
+    size_t          count;
+} TmSkinMesh;
+
+// Write mesh->count skinned positions, and normals when the mesh has
+// them, using up to threadCount threads. The outputs must not overlap
+// the mesh.
+void         tmSkinLinear(TmVec3 *positions,
+                          TmVec3 *normals,
+                          TmSkinMesh const *mesh,
+                          TmMat4 const *palette,
+                          unsigned threadCount);
+void         tmSkinDualQuat(TmVec3 *positions,
+                            TmVec3 *normals,
+                            TmSkinMesh const *mesh,
+                            TmDualQuat const *palette,
+                            unsigned threadCount);
+
+#endif /* GRAPHICS_MATH_SKINNING_H */
@@ -0,0 +1,72 @@
+#ifndef GRAPHICS_MATH_TRANSFORM_H
+#define GRAPHICS_MATH_TRANSFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+// Flat transform hierarchy. Nodes are stored in arrays indexed by node,
+// and every node comes after its parent, so one forward pass computes
+// all world matrices. Local transforms are kept as translation,
+// rotation and scale, composed as T * R * S, and a world matrix is its
+// parent's world matrix times the local one.
+//
+// tmTransformHierarchyUpdate only recomputes nodes whose local transform
+// changed since the last update, and their descendants. It starts at
+// the lowest changed node, so nodes that never move cost nothing when
+// they are added before the animated ones.
+//
+// The local arrays may be written directly, for example by a batched
+// animation pass, followed by tmTransformHierarchyMarkDirty for the
+// range written. Adding nodes may move every array.
+
+// Parent of root nodes.
+#define TM_TRANSFORM_NO_PARENT UINT32_MAX
+
+typedef struct TmTransformHierarchy {
+    TmVec3     *translations;
+    TmQuat     *rotations;
+    TmVec3     *scales;
+    uint32_t   *parents;
+    TmMat4     *locals;
+    TmMat4     *worlds;
+    uint8_t    *flags;
+    size_t      count;
+    size_t      capacity;
+    // Lowest node changed since the last update, count if none.
+    size_t      firstDirty;
+} TmTransformHierarchy;
+
+// Returns false when out of memory.
+bool         tmTransformHierarchyInit(TmTransformHierarchy *hierarchy, size_t capacity);
+void         tmTransformHierarchyFree(TmTransformHierarchy *hierarchy);
+// Adds a node with an identity local transform under parent, which must
+// be TM_TRANSFORM_NO_PARENT or an existing node. Returns its index, or
+// TM_TRANSFORM_NO_PARENT when out of memory.
+uint32_t     tmTransformHierarchyAdd(TmTransformHierarchy *hierarchy, uint32_t parent);
+void         tmTransformHierarchyMarkDirty(TmTransformHierarchy *hierarchy, size_t first, size_t count);
+void         tmTransformHierarchySetTranslation(TmTransformHierarchy *hierarchy,
+                                                uint32_t node,
+                                                TmVec3 const *translation);
+// rotation must be unit length.
+void         tmTransformHierarchySetRotation(TmTransformHierarchy *hierarchy,
+                                             uint32_t node,
+                                             TmQuat const *rotation);
+void         tmTransformHierarchySetScale(TmTransformHierarchy *hierarchy,
+                                          uint32_t node,
+                                          TmVec3 const *scale);
+// Brings every world matrix up to date and returns the number of nodes
+// recomputed.
+size_t       tmTransformHierarchyUpdate(TmTransformHierarchy *hierarchy);
+
+// T * R * S for a unit rotation, without the matrix products.
+TmMat4      *tmTransformCompose(TmMat4 *dest,
+                                TmVec3 const *translation,
+                                TmQuat const *rotation,
+                                TmVec3 const *scale);
+
+#endif /* GRAPHICS_MATH_TRANSFORM_H */
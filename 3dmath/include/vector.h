@@ -54,4 +54,9 @@ TmVec4      *tmVec4Scale(TmVec4 *dest, TmScalar scale, TmVec4 const *q);
 TmScalar     tmVec4SqLength(TmVec4 const *p);
 TmVec4      *tmVec4Sub(TmVec4 *dest, TmVec4 const *p, TmVec4 const *q);
 
+// Opt-in header-only API, enabled by the TM_INLINE_API CMake option.
+#ifdef TM_INLINE_API
+#include "vector_inline.h"
+#endif
+
 #endif /* GRAPHICS_MATH_VECTOR_H */
@@ -0,0 +1,207 @@
+#ifndef GRAPHICS_MATH_VECTOR_INLINE_H
+#define GRAPHICS_MATH_VECTOR_INLINE_H
+
+#include <assert.h>
+#include <math.h>
+#include "scalar.h"
+#include "vector.h"
+
+// Header-only, pass-by-value counterparts of the vector.h functions.
+// They are defined here so the compiler can inline them and keep the
+// operands in registers. Each one evaluates the same expressions in the
+// same order as its out-of-line counterpart, so the results are
+// identical.
+
+static inline TmVec2
+tmiVec2Add(TmVec2 p, TmVec2 q)
+{
+    return (TmVec2){p.x + q.x, p.y + q.y};
+}
+
+static inline TmVec2
+tmiVec2Sub(TmVec2 p, TmVec2 q)
+{
+    return (TmVec2){p.x - q.x, p.y - q.y};
+}
+
+static inline TmVec2
+tmiVec2Scale(TmScalar scale, TmVec2 p)
+{
+    return (TmVec2){scale * p.x, scale * p.y};
+}
+
+static inline TmScalar
+tmiVec2Dot(TmVec2 p, TmVec2 q)
+{
+    return ((p.x * q.x) + (p.y * q.y));
+}
+
+static inline TmScalar
+tmiVec2SqLength(TmVec2 p)
+{
+    return ((p.x * p.x) + (p.y * p.y));
+}
+
+static inline TmScalar
+tmiVec2Length(TmVec2 p)
+{
+    return tmScalarSqrt(tmiVec2SqLength(p));
+}
+
+static inline TmScalar
+tmiVec2Distance(TmVec2 p, TmVec2 q)
+{
+    return tmiVec2Length(tmiVec2Sub(p, q));
+}
+
+static inline TmVec2
+tmiVec2Normalize(TmVec2 p)
+{
+    TmScalar const length = tmiVec2Length(p);
+
+    assert(length != 0.0f);
+
+    return (TmVec2){p.x / length, p.y / length};
+}
+
+static inline TmVec2
+tmiVec2Projection(TmVec2 p, TmVec2 q)
+{
+    return tmiVec2Scale(tmiVec2Dot(p, q) / tmiVec2SqLength(q), q);
+}
+
+static inline TmVec3
+tmiVec3Add(TmVec3 p, TmVec3 q)
+{
+    return (TmVec3){p.x + q.x, p.y + q.y, p.z + q.z};
+}
+
+static inline TmVec3
+tmiVec3Sub(TmVec3 p, TmVec3 q)
+{
+    return (TmVec3){p.x - q.x, p.y - q.y, p.z - q.z};
+}
+
+static inline TmVec3
+tmiVec3Scale(TmScalar scale, TmVec3 p)
+{
+    return (TmVec3){scale * p.x, scale * p.y, scale * p.z};
+}
+
+static inline TmVec3
+tmiVec3Cross(TmVec3 p, TmVec3 q)
+{
+    return (TmVec3){(p.y * q.z) - (p.z * q.y),
+                    (p.z * q.x) - (p.x * q.z),
+                    (p.x * q.y) - (p.y * q.x)};
+}
+
+static inline TmScalar
+tmiVec3Dot(TmVec3 p, TmVec3 q)
+{
+    return ((p.x * q.x) +
+            (p.y * q.y) +
+            (p.z * q.z));
+}
+
+static inline TmScalar
+tmiVec3SqLength(TmVec3 p)
+{
+    return ((p.x * p.x) +
+            (p.y * p.y) +
+            (p.z * p.z));
+}
+
+static inline TmScalar
+tmiVec3Length(TmVec3 p)
+{
+    return tmScalarSqrt(tmiVec3SqLength(p));
+}
+
+static inline TmScalar
+tmiVec3Distance(TmVec3 p, TmVec3 q)
+{
+    return tmiVec3Length(tmiVec3Sub(p, q));
+}
+
+static inline TmVec3
+tmiVec3Normalize(TmVec3 p)
+{
+    TmScalar const length = tmiVec3Length(p);
+
+    assert(length != 0.0f);
+
+    return (TmVec3){p.x / length, p.y / length, p.z / length};
+}
+
+static inline TmVec3
+tmiVec3Projection(TmVec3 p, TmVec3 q)
+{
+    return tmiVec3Scale(tmiVec3Dot(p, q) / tmiVec3SqLength(q), q);
+}
+
+static inline TmVec4
+tmiVec4Add(TmVec4 p, TmVec4 q)
+{
+    return (TmVec4){p.x + q.x, p.y + q.y, p.z + q.z, p.w + q.w};
+}
+
+static inline TmVec4
+tmiVec4Sub(TmVec4 p, TmVec4 q)
+{
+    return (TmVec4){p.x - q.x, p.y - q.y, p.z - q.z, p.w - q.w};
+}
+
+static inline TmVec4
+tmiVec4Scale(TmScalar scale, TmVec4 p)
+{
+    return (TmVec4){scale * p.x, scale * p.y, scale * p.z, scale * p.w};
+}
+
+static inline TmScalar
+tmiVec4Dot(TmVec4 p, TmVec4 q)
+{
+    return ((p.x * q.x) +
+            (p.y * q.y) +
+            (p.z * q.z) +
+            (p.w * q.w));
+}
+
+static inline TmScalar
+tmiVec4SqLength(TmVec4 p)
+{
+    return ((p.x * p.x) +
+            (p.y * p.y) +
+            (p.z * p.z) +
+            (p.w * p.w));
+}
+
+static inline TmScalar
+tmiVec4Length(TmVec4 p)
+{
+    return tmScalarSqrt(tmiVec4SqLength(p));
+}
+
+static inline TmScalar
+tmiVec4Distance(TmVec4 p, TmVec4 q)
+{
+    return tmiVec4Length(tmiVec4Sub(p, q));
+}
+
+static inline TmVec4
+tmiVec4Normalize(TmVec4 p)
+{
+    TmScalar const length = tmiVec4Length(p);
+
+    assert(length != 0.0f);
+
+    return (TmVec4){p.x / length, p.y / length, p.z / length, p.w / length};
+}
+
+static inline TmVec4
+tmiVec4Projection(TmVec4 p, TmVec4 q)
+{
+    return tmiVec4Scale(tmiVec4Dot(p, q) / tmiVec4SqLength(q), q);
+}
+
+#endif /* GRAPHICS_MATH_VECTOR_INLINE_H */
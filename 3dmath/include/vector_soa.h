@@ -0,0 +1,66 @@
+#ifndef GRAPHICS_MATH_VECTOR_SOA_H
+#define GRAPHICS_MATH_VECTOR_SOA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "scalar.h"
+#include "vector.h"
+
+// Structure-of-arrays streams of vectors. Each component lives in its
+// own array, so the kernels below process 4 or 8 vectors per
+// instruction. Streams made by tmVec*SoAAlloc own a single block that
+// starts at x; every component array is TM_SOA_ALIGNMENT aligned.
+//
+// The operations match the semantics of their vector.h counterparts
+// element by element. All streams passed to one call must have the same
+// count, and dest may be the same stream as an input.
+
+#define TM_SOA_ALIGNMENT 32
+
+typedef struct TmVec3SoA {
+    TmScalar   *x;
+    TmScalar   *y;
+    TmScalar   *z;
+    size_t      count;
+} TmVec3SoA;
+
+typedef struct TmVec4SoA {
+    TmScalar   *x;
+    TmScalar   *y;
+    TmScalar   *z;
+    TmScalar   *w;
+    size_t      count;
+} TmVec4SoA;
+
+bool         tmVec3SoAAlloc(TmVec3SoA *soa, size_t count);
+void         tmVec3SoAFree(TmVec3SoA *soa);
+TmVec3SoA   *tmVec3SoAFromAoS(TmVec3SoA *dest, TmVec3 const *src);
+TmVec3      *tmVec3SoAToAoS(TmVec3 *dest, TmVec3SoA const *src);
+
+TmVec3SoA   *tmVec3SoAAdd(TmVec3SoA *dest, TmVec3SoA const *p, TmVec3SoA const *q);
+TmVec3SoA   *tmVec3SoACross(TmVec3SoA *dest, TmVec3SoA const *p, TmVec3SoA const *q);
+TmScalar    *tmVec3SoADot(TmScalar *dest, TmVec3SoA const *p, TmVec3SoA const *q);
+TmScalar    *tmVec3SoALength(TmScalar *dest, TmVec3SoA const *p);
+TmVec3SoA   *tmVec3SoANormalize(TmVec3SoA *dest, TmVec3SoA const *p);
+TmVec3SoA   *tmVec3SoAProjection(TmVec3SoA *pOntoQ,
+                                 TmVec3SoA const *p,
+                                 TmVec3SoA const *q);
+TmVec3SoA   *tmVec3SoAScale(TmVec3SoA *dest, TmScalar scale, TmVec3SoA const *p);
+TmVec3SoA   *tmVec3SoASub(TmVec3SoA *dest, TmVec3SoA const *p, TmVec3SoA const *q);
+
+bool         tmVec4SoAAlloc(TmVec4SoA *soa, size_t count);
+void         tmVec4SoAFree(TmVec4SoA *soa);
+TmVec4SoA   *tmVec4SoAFromAoS(TmVec4SoA *dest, TmVec4 const *src);
+TmVec4      *tmVec4SoAToAoS(TmVec4 *dest, TmVec4SoA const *src);
+
+TmVec4SoA   *tmVec4SoAAdd(TmVec4SoA *dest, TmVec4SoA const *p, TmVec4SoA const *q);
+TmScalar    *tmVec4SoADot(TmScalar *dest, TmVec4SoA const *p, TmVec4SoA const *q);
+TmScalar    *tmVec4SoALength(TmScalar *dest, TmVec4SoA const *p);
+TmVec4SoA   *tmVec4SoANormalize(TmVec4SoA *dest, TmVec4SoA const *p);
+TmVec4SoA   *tmVec4SoAProjection(TmVec4SoA *pOntoQ,
+                                 TmVec4SoA const *p,
+                                 TmVec4SoA const *q);
+TmVec4SoA   *tmVec4SoAScale(TmVec4SoA *dest, TmScalar scale, TmVec4SoA const *p);
+TmVec4SoA   *tmVec4SoASub(TmVec4SoA *dest, TmVec4SoA const *p, TmVec4SoA const *q);
+
+#endif /* GRAPHICS_MATH_VECTOR_SOA_H */
@@ -0,0 +1,584 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "bvh.h"
+#include "ray_private.h"
+
+static_assert(sizeof(TmAabb) == sizeof(TmScalar[6]),
+              "TmAabb has unexpected padding");
+
+// Subtrees with at least this many primitives are handed to a new
+// thread while the current one builds their sibling.
+#define BVH_PARALLEL_MIN_COUNT 4096
+// Deeper nodes split their range in half instead of using the SAH,
+// which keeps any tree of fewer than 2^32 primitives within
+// TM_BVH_MAX_DEPTH levels.
+#define BVH_SAH_MAX_DEPTH 32
+// Cost of visiting a node relative to testing one primitive.
+#define BVH_TRAVERSAL_COST 1.0f
+
+// While building, each node with n primitives owns the 2 n - 2 slots
+// after its reserved position for its descendants: its two children come
+// first, then the slots of the first child's subtree, then the second's.
+// Subtrees therefore never share slots or primitives and can be built
+// concurrently. The slots are compacted into depth first order at the
+// end.
+typedef struct BvhBuilder {
+    TmAabb const   *boxes;
+    TmVec3         *centroids;
+    uint32_t       *primitives;
+    TmBvhNode      *slots;
+} BvhBuilder;
+
+typedef struct BvhTask {
+    BvhBuilder const   *builder;
+    uint32_t            slot;
+    uint32_t            firstDescendant;
+    uint32_t            begin;
+    uint32_t            end;
+    uint32_t            depth;
+    unsigned            threadCount;
+} BvhTask;
+
+typedef struct BvhBin {
+    TmAabb      bounds;
+    uint32_t    count;
+} BvhBin;
+
+typedef enum BvhClassification {
+    BVH_OUTSIDE,
+    BVH_INTERSECTING,
+    BVH_INSIDE
+} BvhClassification;
+
+static TmAabb
+aabbEmpty(void)
+{
+    return (TmAabb){{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+}
+
+static void
+aabbGrow(TmAabb *box, TmAabb const *other)
+{
+    box->min.x = (other->min.x < box->min.x) ? other->min.x : box->min.x;
+    box->min.y = (other->min.y < box->min.y) ? other->min.y : box->min.y;
+    box->min.z = (other->min.z < box->min.z) ? other->min.z : box->min.z;
+    box->max.x = (other->max.x > box->max.x) ? other->max.x : box->max.x;
+    box->max.y = (other->max.y > box->max.y) ? other->max.y : box->max.y;
+    box->max.z = (other->max.z > box->max.z) ? other->max.z : box->max.z;
+}
+
+static void
+aabbGrowPoint(TmAabb *box, TmVec3 const *point)
+{
+    TmAabb const pointBox = {*point, *point};
+
+    aabbGrow(box, &pointBox);
+}
+
+// Half the surface area, which is all the SAH needs. Empty boxes have
+// none.
+static TmScalar
+aabbHalfArea(TmAabb const *box)
+{
+    TmScalar const dx = box->max.x - box->min.x;
+    TmScalar const dy = box->max.y - box->min.y;
+    TmScalar const dz = box->max.z - box->min.z;
+
+    if (dx < 0.0f) {
+        return 0.0f;
+    }
+
+    return (dx * dy) + (dy * dz) + (dz * dx);
+}
+
+static bool
+aabbOverlap(TmAabb const *a, TmAabb const *b)
+{
+    return a->min.x <= b->max.x && b->min.x <= a->max.x
+        && a->min.y <= b->max.y && b->min.y <= a->max.y
+        && a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+static TmScalar
+vec3Component(TmVec3 const *v, int axis)
+{
+    return (axis == 0) ? v->x : (axis == 1) ? v->y : v->z;
+}
+
+static int
+binIndex(TmScalar centroid, TmScalar minimum, TmScalar scale, int binCount)
+{
+    int const bin = (int)((centroid - minimum) * scale);
+
+    return (bin < binCount) ? bin : binCount - 1;
+}
+
+// Returns where [begin, end) splits, or end to make a leaf. The
+// primitives are partitioned around the returned index.
+static uint32_t
+findSplit(BvhBuilder const *builder, uint32_t begin, uint32_t end, uint32_t depth, TmAabb const *bounds, TmAabb const *centroidBounds)
+{
+    uint32_t const count = end - begin;
+    // Small nodes use fewer bins, so setting up and sweeping them does
+    // not dominate the cost of binning the primitives.
+    int const binCount = (count < TM_BVH_BINS) ? (int)count : TM_BVH_BINS;
+    // Costs are left multiplied by the parent's area, which keeps them
+    // finite for flat boxes.
+    TmScalar const leafCost = (TmScalar)count * aabbHalfArea(bounds);
+    TmScalar bestCost = INFINITY;
+    int bestAxis = -1;
+    int bestBin = 0;
+    uint32_t *primitives = builder->primitives;
+    uint32_t middle;
+
+    for (int axis = 0; axis < 3 && depth < BVH_SAH_MAX_DEPTH; ++axis) {
+        TmScalar const minimum = vec3Component(&centroidBounds->min, axis);
+        TmScalar const extent = vec3Component(&centroidBounds->max, axis) - minimum;
+        BvhBin bins[TM_BVH_BINS];
+        TmScalar rightCosts[TM_BVH_BINS];
+        TmAabb sweep = aabbEmpty();
+        uint32_t sweepCount = 0;
+        TmScalar scale;
+
+        if (extent <= 0.0f) {
+            continue;
+        }
+        scale = (TmScalar)binCount / extent;
+        for (int i = 0; i < binCount; ++i) {
+            bins[i].bounds = aabbEmpty();
+            bins[i].count = 0;
+        }
+        for (uint32_t i = begin; i < end; ++i) {
+            uint32_t const primitive = primitives[i];
+            BvhBin *bin = &bins[binIndex(vec3Component(&builder->centroids[primitive], axis), minimum, scale, binCount)];
+
+            aabbGrow(&bin->bounds, &builder->boxes[primitive]);
+            ++bin->count;
+        }
+
+        // rightCosts[i] covers bins i + 1 and up.
+        for (int i = binCount - 1; i > 0; --i) {
+            aabbGrow(&sweep, &bins[i].bounds);
+            sweepCount += bins[i].count;
+            rightCosts[i - 1] = (TmScalar)sweepCount * aabbHalfArea(&sweep);
+        }
+        sweep = aabbEmpty();
+        sweepCount = 0;
+        for (int i = 0; i < binCount - 1; ++i) {
+            TmScalar cost;
+
+            aabbGrow(&sweep, &bins[i].bounds);
+            sweepCount += bins[i].count;
+            if (sweepCount == 0 || sweepCount == count) {
+                continue;
+            }
+            cost = (BVH_TRAVERSAL_COST * aabbHalfArea(bounds))
+                 + (TmScalar)sweepCount * aabbHalfArea(&sweep) + rightCosts[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = i;
+            }
+        }
+    }
+
+    if (count <= TM_BVH_MAX_LEAF_SIZE && (bestAxis < 0 || bestCost >= leafCost)) {
+        return end;
+    }
+    if (bestAxis < 0) {
+        // Too deep, or every centroid coincides: any halving will do.
+        return begin + count / 2;
+    }
+
+    {
+        TmScalar const minimum = vec3Component(&centroidBounds->min, bestAxis);
+        TmScalar const scale = (TmScalar)binCount
+                             / (vec3Component(&centroidBounds->max, bestAxis) - minimum);
+        uint32_t left = begin;
+        uint32_t right = end;
+
+        while (left < right) {
+            TmScalar const centroid = vec3Component(&builder->centroids[primitives[left]], bestAxis);
+
+            if (binIndex(centroid, minimum, scale, binCount) <= bestBin) {
+                ++left;
+            } else {
+                uint32_t const swap = primitives[left];
+
+                primitives[left] = primitives[--right];
+                primitives[right] = swap;
+            }
+        }
+        middle = left;
+    }
+    assert(middle > begin && middle < end);
+
+    return middle;
+}
+
+static int buildTaskThread(void *taskPtr);
+
+static void
+buildTask(BvhTask const *task)
+{
+    BvhBuilder const *builder = task->builder;
+    TmBvhNode *node = &builder->slots[task->slot];
+    TmAabb bounds = aabbEmpty();
+    TmAabb centroidBounds = aabbEmpty();
+    uint32_t middle;
+
+    for (uint32_t i = task->begin; i < task->end; ++i) {
+        uint32_t const primitive = builder->primitives[i];
+
+        aabbGrow(&bounds, &builder->boxes[primitive]);
+        aabbGrowPoint(&centroidBounds, &builder->centroids[primitive]);
+    }
+    node->bounds = bounds;
+
+    middle = (task->end - task->begin == 1)
+           ? task->end
+           : findSplit(builder, task->begin, task->end, task->depth, &bounds, &centroidBounds);
+    if (middle == task->end) {
+        node->offset = task->begin;
+        node->count = task->end - task->begin;
+        return;
+    }
+
+    {
+        uint32_t const leftCount = middle - task->begin;
+        // Large subtrees split the thread budget between the children;
+        // the first child then gets a thread of its own.
+        bool const isSplittingThreads = task->threadCount > 1
+                                     && task->end - task->begin >= BVH_PARALLEL_MIN_COUNT;
+        unsigned const leftThreads = isSplittingThreads ? task->threadCount / 2 : task->threadCount;
+        BvhTask left = {
+            .builder = builder,
+            .slot = task->firstDescendant,
+            .firstDescendant = task->firstDescendant + 2,
+            .begin = task->begin,
+            .end = middle,
+            .depth = task->depth + 1,
+            .threadCount = leftThreads
+        };
+        BvhTask const right = {
+            .builder = builder,
+            .slot = task->firstDescendant + 1,
+            .firstDescendant = task->firstDescendant + 2 * leftCount,
+            .begin = middle,
+            .end = task->end,
+            .depth = task->depth + 1,
+            .threadCount = isSplittingThreads ? task->threadCount - leftThreads : task->threadCount
+        };
+        thrd_t leftThread;
+        bool const isParallel = isSplittingThreads
+                             && thrd_create(&leftThread, buildTaskThread, &left) == thrd_success;
+
+        node->offset = left.slot;
+        node->count = 0;
+        if (!isParallel) {
+            buildTask(&left);
+        }
+        buildTask(&right);
+        if (isParallel) {
+            thrd_join(leftThread, NULL);
+        }
+    }
+}
+
+static int
+buildTaskThread(void *taskPtr)
+{
+    buildTask(taskPtr);
+
+    return 0;
+}
+
+// Copies the subtree at slot into bvh->nodes in depth first order and
+// returns its new index.
+static uint32_t
+emitNode(TmBvh *bvh, TmBvhNode const *slots, uint32_t slot)
+{
+    uint32_t const index = (uint32_t)bvh->nodeCount++;
+    TmBvhNode const *node = &slots[slot];
+
+    bvh->nodes[index] = *node;
+    if (node->count == 0) {
+        emitNode(bvh, slots, node->offset);
+        bvh->nodes[index].offset = emitNode(bvh, slots, node->offset + 1);
+    }
+
+    return index;
+}
+
+bool
+tmBvhBuild(TmBvh *bvh, TmAabb const *boxes, size_t count, unsigned threadCount)
+{
+    size_t const slotCount = 2 * count - 1;
+    BvhBuilder builder;
+    BvhTask root;
+    TmBvhNode *shrunk;
+
+    assert(count > 0 && count < UINT32_MAX);
+    memset(bvh, 0, sizeof(*bvh));
+    builder.boxes = boxes;
+    builder.centroids = malloc(count * sizeof(*builder.centroids));
+    builder.primitives = malloc(count * sizeof(*builder.primitives));
+    builder.slots = malloc(slotCount * sizeof(*builder.slots));
+    bvh->nodes = malloc(slotCount * sizeof(*bvh->nodes));
+    bvh->boxes = malloc(count * sizeof(*bvh->boxes));
+    if (builder.centroids == NULL || builder.primitives == NULL || builder.slots == NULL ||
+        bvh->nodes == NULL || bvh->boxes == NULL) {
+        free(builder.centroids);
+        free(builder.primitives);
+        free(builder.slots);
+        tmBvhFree(bvh);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        builder.centroids[i].x = (boxes[i].min.x + boxes[i].max.x) * 0.5f;
+        builder.centroids[i].y = (boxes[i].min.y + boxes[i].max.y) * 0.5f;
+        builder.centroids[i].z = (boxes[i].min.z + boxes[i].max.z) * 0.5f;
+        builder.primitives[i] = (uint32_t)i;
+    }
+    root = (BvhTask){
+        .builder = &builder,
+        .slot = 0,
+        .firstDescendant = 1,
+        .begin = 0,
+        .end = (uint32_t)count,
+        .depth = 0,
+        .threadCount = (threadCount > 0) ? threadCount : 1
+    };
+    buildTask(&root);
+
+    emitNode(bvh, builder.slots, 0);
+    shrunk = realloc(bvh->nodes, bvh->nodeCount * sizeof(*bvh->nodes));
+    if (shrunk != NULL) {
+        bvh->nodes = shrunk;
+    }
+    bvh->primitives = builder.primitives;
+    bvh->count = count;
+    for (size_t i = 0; i < count; ++i) {
+        bvh->boxes[i] = boxes[bvh->primitives[i]];
+    }
+    free(builder.centroids);
+    free(builder.slots);
+
+    return true;
+}
+
+void
+tmBvhFree(TmBvh *bvh)
+{
+    free(bvh->nodes);
+    free(bvh->boxes);
+    free(bvh->primitives);
+    memset(bvh, 0, sizeof(*bvh));
+}
+
+TmBvh *
+tmBvhRefit(TmBvh *bvh, TmAabb const *boxes)
+{
+    for (size_t i = 0; i < bvh->count; ++i) {
+        bvh->boxes[i] = boxes[bvh->primitives[i]];
+    }
+    // Children always follow their parent, so a backwards pass sees
+    // them first.
+    for (size_t i = bvh->nodeCount; i-- > 0;) {
+        TmBvhNode *node = &bvh->nodes[i];
+        TmAabb bounds = aabbEmpty();
+
+        if (node->count > 0) {
+            for (uint32_t j = node->offset; j < node->offset + node->count; ++j) {
+                aabbGrow(&bounds, &bvh->boxes[j]);
+            }
+        } else {
+            aabbGrow(&bounds, &bvh->nodes[i + 1].bounds);
+            aabbGrow(&bounds, &bvh->nodes[node->offset].bounds);
+        }
+        node->bounds = bounds;
+    }
+
+    return bvh;
+}
+
+// Like the frustum tests, but also reports boxes that no plane cuts.
+static BvhClassification
+classifyAabb(TmFrustum const *frustum, TmAabb const *box)
+{
+    TmScalar const centerX = (box->min.x + box->max.x) * 0.5f;
+    TmScalar const centerY = (box->min.y + box->max.y) * 0.5f;
+    TmScalar const centerZ = (box->min.z + box->max.z) * 0.5f;
+    TmScalar const extentX = (box->max.x - box->min.x) * 0.5f;
+    TmScalar const extentY = (box->max.y - box->min.y) * 0.5f;
+    TmScalar const extentZ = (box->max.z - box->min.z) * 0.5f;
+    BvhClassification result = BVH_INSIDE;
+
+    for (int i = 0; i < TM_FRUSTUM_PLANE_COUNT; ++i) {
+        TmVec4 const *plane = &frustum->planes[i];
+        TmScalar const distance = (plane->x * centerX) + (plane->y * centerY)
+                                + (plane->z * centerZ) + plane->w;
+        TmScalar const radius = (tmScalarFabs(plane->x) * extentX) + (tmScalarFabs(plane->y) * extentY)
+                              + (tmScalarFabs(plane->z) * extentZ);
+
+        if (distance < -radius) {
+            return BVH_OUTSIDE;
+        }
+        if (distance < radius) {
+            result = BVH_INTERSECTING;
+        }
+    }
+
+    return result;
+}
+
+size_t
+tmBvhCullFrustum(uint32_t *visible, TmBvh const *bvh, TmFrustum const *frustum)
+{
+    uint32_t stack[TM_BVH_MAX_DEPTH];
+    size_t stackSize = 0;
+    size_t total = 0;
+
+    memset(visible, 0, TM_FRUSTUM_MASK_WORDS(bvh->count) * sizeof(*visible));
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        uint32_t const index = stack[--stackSize];
+        TmBvhNode const *node = &bvh->nodes[index];
+        BvhClassification const classification = classifyAabb(frustum, &node->bounds);
+        uint32_t first;
+        uint32_t last;
+
+        if (classification == BVH_OUTSIDE) {
+            continue;
+        }
+        if (classification == BVH_INTERSECTING && node->count == 0) {
+            stack[stackSize++] = node->offset;
+            stack[stackSize++] = index + 1;
+            continue;
+        }
+
+        // A subtree's primitives are contiguous, from its first leaf to
+        // its last.
+        first = index;
+        while (bvh->nodes[first].count == 0) {
+            ++first;
+        }
+        last = index;
+        while (bvh->nodes[last].count == 0) {
+            last = bvh->nodes[last].offset;
+        }
+        for (uint32_t i = bvh->nodes[first].offset; i < bvh->nodes[last].offset + bvh->nodes[last].count; ++i) {
+            if (classification == BVH_INSIDE || tmFrustumTestAabb(frustum, &bvh->boxes[i])) {
+                uint32_t const primitive = bvh->primitives[i];
+
+                visible[primitive / 32] |= UINT32_C(1) << (primitive % 32);
+                ++total;
+            }
+        }
+    }
+
+    return total;
+}
+
+size_t
+tmBvhQueryAabb(TmBvh const *bvh, TmAabb const *box, TmBvhOverlapVisitor visit, void *context)
+{
+    uint32_t stack[TM_BVH_MAX_DEPTH];
+    size_t stackSize = 0;
+    size_t visits = 0;
+
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        uint32_t const index = stack[--stackSize];
+        TmBvhNode const *node = &bvh->nodes[index];
+
+        if (!aabbOverlap(&node->bounds, box)) {
+            continue;
+        }
+        if (node->count == 0) {
+            stack[stackSize++] = node->offset;
+            stack[stackSize++] = index + 1;
+            continue;
+        }
+        for (uint32_t i = node->offset; i < node->offset + node->count; ++i) {
+            if (aabbOverlap(&bvh->boxes[i], box)) {
+                ++visits;
+                if (!visit(context, bvh->primitives[i])) {
+                    return visits;
+                }
+            }
+        }
+    }
+
+    return visits;
+}
+
+size_t
+tmBvhQueryRay(TmBvh const *bvh, TmRay const *ray, TmScalar tMax, TmBvhRayVisitor visit, void *context)
+{
+    TmVec3 const inverseDirection = rayInverseDirection(ray);
+    // Nodes waiting to be visited, with the t at which the ray enters
+    // them, so that they can be skipped once tMax drops below it.
+    struct {
+        uint32_t index;
+        TmScalar tNear;
+    } stack[TM_BVH_MAX_DEPTH];
+    size_t stackSize = 0;
+    size_t visits = 0;
+    TmScalar tNear;
+
+    if (!raySlabTest(&ray->origin, &inverseDirection, &bvh->nodes[0].bounds, tMax, &tNear)) {
+        return 0;
+    }
+    stack[stackSize].index = 0;
+    stack[stackSize++].tNear = tNear;
+    while (stackSize > 0) {
+        uint32_t const index = stack[--stackSize].index;
+        TmBvhNode const *node = &bvh->nodes[index];
+        uint32_t children[2];
+        TmScalar tChildren[2];
+        bool hits[2];
+
+        if (stack[stackSize].tNear > tMax) {
+            // A visitor has since found something nearer.
+            continue;
+        }
+        if (node->count > 0) {
+            for (uint32_t i = node->offset; i < node->offset + node->count; ++i) {
+                if (raySlabTest(&ray->origin, &inverseDirection, &bvh->boxes[i], tMax, &tNear)) {
+                    ++visits;
+                    if (!visit(context, bvh->primitives[i], tNear, &tMax)) {
+                        return visits;
+                    }
+                }
+            }
+            continue;
+        }
+
+        children[0] = index + 1;
+        children[1] = node->offset;
+        for (int i = 0; i < 2; ++i) {
+            hits[i] = raySlabTest(&ray->origin, &inverseDirection, &bvh->nodes[children[i]].bounds, tMax, &tChildren[i]);
+        }
+        // The nearer child goes on top.
+        if (hits[0] && hits[1] && tChildren[0] < tChildren[1]) {
+            stack[stackSize].index = children[1];
+            stack[stackSize++].tNear = tChildren[1];
+            stack[stackSize].index = children[0];
+            stack[stackSize++].tNear = tChildren[0];
+            continue;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (hits[i]) {
+                stack[stackSize].index = children[i];
+                stack[stackSize++].tNear = tChildren[i];
+            }
+        }
+    }
+
+    return visits;
+}
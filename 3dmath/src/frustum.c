@@ -0,0 +1,152 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include "frustum.h"
+#include "simd_private.h"
+
+static_assert(sizeof(TmSphere) == sizeof(TmScalar[4]),
+              "TmSphere has unexpected padding");
+static_assert(sizeof(TmAabb) == sizeof(TmScalar[6]),
+              "TmAabb has unexpected padding");
+
+// The SIMD backends evaluate exactly these expressions, in this order,
+// for each lane. A volume is culled as soon as it lies entirely on the
+// outer side of one plane.
+static bool
+sphereOutsidePlane(TmVec4 const *plane, TmSphere const *sphere)
+{
+    TmScalar const distance = (plane->x * sphere->center.x) + (plane->y * sphere->center.y)
+                            + (plane->z * sphere->center.z) + plane->w;
+
+    return distance < -sphere->radius;
+}
+
+// Tests the box as its center and half extents, whose projection onto
+// the plane normal is the largest distance any corner reaches inwards.
+static bool
+aabbOutsidePlane(TmVec4 const *plane, TmAabb const *box)
+{
+    TmScalar const centerX = (box->min.x + box->max.x) * 0.5f;
+    TmScalar const centerY = (box->min.y + box->max.y) * 0.5f;
+    TmScalar const centerZ = (box->min.z + box->max.z) * 0.5f;
+    TmScalar const extentX = (box->max.x - box->min.x) * 0.5f;
+    TmScalar const extentY = (box->max.y - box->min.y) * 0.5f;
+    TmScalar const extentZ = (box->max.z - box->min.z) * 0.5f;
+    TmScalar const distance = (plane->x * centerX) + (plane->y * centerY)
+                            + (plane->z * centerZ) + plane->w;
+    TmScalar const radius = (tmScalarFabs(plane->x) * extentX) + (tmScalarFabs(plane->y) * extentY)
+                          + (tmScalarFabs(plane->z) * extentZ);
+
+    return distance < -radius;
+}
+
+static void
+cullAabbBatchScalar(uint32_t *visible, TmFrustum const *frustum, TmAabb const *boxes, size_t first, size_t count)
+{
+    for (size_t i = first; i < count; ++i) {
+        if (tmFrustumTestAabb(frustum, &boxes[i])) {
+            visible[i / 32] |= UINT32_C(1) << (i % 32);
+        }
+    }
+}
+
+static void
+cullSphereBatchScalar(uint32_t *visible, TmFrustum const *frustum, TmSphere const *spheres, size_t first, size_t count)
+{
+    for (size_t i = first; i < count; ++i) {
+        if (tmFrustumTestSphere(frustum, &spheres[i])) {
+            visible[i / 32] |= UINT32_C(1) << (i % 32);
+        }
+    }
+}
+
+TmFrustumKernels const tmFrustumKernelsScalar = {
+    .cullAabbBatch = cullAabbBatchScalar,
+    .cullSphereBatch = cullSphereBatchScalar
+};
+
+static size_t
+countVisible(uint32_t const *visible, size_t count)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < TM_FRUSTUM_MASK_WORDS(count); ++i) {
+        total += (size_t)__builtin_popcount(visible[i]);
+    }
+
+    return total;
+}
+
+TmFrustum *
+tmFrustumFromMat4(TmFrustum *dest, TmMat4 const *m)
+{
+    // Gribb and Hartmann: a clip space point is inside when
+    // -w <= x, y, z <= w, and each of those six inequalities is a plane
+    // made of the fourth row plus or minus one of the others.
+    TmVec4 const row1 = {m->m11, m->m12, m->m13, m->m14};
+    TmVec4 const row2 = {m->m21, m->m22, m->m23, m->m24};
+    TmVec4 const row3 = {m->m31, m->m32, m->m33, m->m34};
+    TmVec4 const row4 = {m->m41, m->m42, m->m43, m->m44};
+
+    tmVec4Add(&dest->planes[TM_FRUSTUM_PLANE_LEFT], &row4, &row1);
+    tmVec4Sub(&dest->planes[TM_FRUSTUM_PLANE_RIGHT], &row4, &row1);
+    tmVec4Add(&dest->planes[TM_FRUSTUM_PLANE_BOTTOM], &row4, &row2);
+    tmVec4Sub(&dest->planes[TM_FRUSTUM_PLANE_TOP], &row4, &row2);
+    tmVec4Add(&dest->planes[TM_FRUSTUM_PLANE_NEAR], &row4, &row3);
+    tmVec4Sub(&dest->planes[TM_FRUSTUM_PLANE_FAR], &row4, &row3);
+
+    for (int i = 0; i < TM_FRUSTUM_PLANE_COUNT; ++i) {
+        TmVec4 *plane = &dest->planes[i];
+        TmScalar const length = tmScalarSqrt((plane->x * plane->x) + (plane->y * plane->y)
+                                             + (plane->z * plane->z));
+
+        // An infinite far plane has no normal and never culls anything.
+        if (length != 0.0f) {
+            tmVec4Scale(plane, 1.0f / length, plane);
+        }
+    }
+
+    return dest;
+}
+
+bool
+tmFrustumTestAabb(TmFrustum const *frustum, TmAabb const *box)
+{
+    for (int i = 0; i < TM_FRUSTUM_PLANE_COUNT; ++i) {
+        if (aabbOutsidePlane(&frustum->planes[i], box)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+tmFrustumTestSphere(TmFrustum const *frustum, TmSphere const *sphere)
+{
+    for (int i = 0; i < TM_FRUSTUM_PLANE_COUNT; ++i) {
+        if (sphereOutsidePlane(&frustum->planes[i], sphere)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t
+tmFrustumCullAabbBatch(uint32_t *visible, TmFrustum const *frustum, TmAabb const *boxes, size_t count)
+{
+    memset(visible, 0, TM_FRUSTUM_MASK_WORDS(count) * sizeof(*visible));
+    tmSimdFrustumKernels()->cullAabbBatch(visible, frustum, boxes, 0, count);
+
+    return countVisible(visible, count);
+}
+
+size_t
+tmFrustumCullSphereBatch(uint32_t *visible, TmFrustum const *frustum, TmSphere const *spheres, size_t count)
+{
+    memset(visible, 0, TM_FRUSTUM_MASK_WORDS(count) * sizeof(*visible));
+    tmSimdFrustumKernels()->cullSphereBatch(visible, frustum, spheres, 0, count);
+
+    return countVisible(visible, count);
+}
@@ -0,0 +1,101 @@
+#include <assert.h>
+#include <math.h>
+#include <immintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// Eight volumes are transposed into component registers and tested
+// against each plane in turn with the same operations, in the same
+// order, as the scalar kernels in frustum.c. A lane is culled once any
+// plane has it outside. Tails fall back to those kernels.
+
+static __m256
+combineHalvesAvx2(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+static __m256
+planeDistanceAvx2(TmVec4 const *plane, __m256 x, __m256 y, __m256 z)
+{
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane->x), x),
+                                                     _mm256_mul_ps(_mm256_set1_ps(plane->y), y)),
+                                       _mm256_mul_ps(_mm256_set1_ps(plane->z), z)),
+                         _mm256_set1_ps(plane->w));
+}
+
+static __m256
+negateAvx2(__m256 v)
+{
+    return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f));
+}
+
+static void
+cullAabbBatchAvx2(uint32_t *visible, TmFrustum const *frustum, TmAabb const *boxes, size_t first, size_t count)
+{
+    __m256 const half = _mm256_set1_ps(0.5f);
+    size_t i = first;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128 lowMin[3], lowMax[3], highMin[3], highMax[3];
+        __m256 center[3], extent[3];
+        __m256 outside = _mm256_setzero_ps();
+
+        sseLoadAabb4(lowMin, lowMax, &boxes[i]);
+        sseLoadAabb4(highMin, highMax, &boxes[i + 4]);
+        for (int k = 0; k < 3; ++k) {
+            __m256 const min = combineHalvesAvx2(lowMin[k], highMin[k]);
+            __m256 const max = combineHalvesAvx2(lowMax[k], highMax[k]);
+
+            center[k] = _mm256_mul_ps(_mm256_add_ps(min, max), half);
+            extent[k] = _mm256_mul_ps(_mm256_sub_ps(max, min), half);
+        }
+
+        for (int j = 0; j < TM_FRUSTUM_PLANE_COUNT; ++j) {
+            TmVec4 const *plane = &frustum->planes[j];
+            __m256 const distance = planeDistanceAvx2(plane, center[0], center[1], center[2]);
+            __m256 const radiusX = _mm256_mul_ps(_mm256_set1_ps(tmScalarFabs(plane->x)), extent[0]);
+            __m256 const radiusY = _mm256_mul_ps(_mm256_set1_ps(tmScalarFabs(plane->y)), extent[1]);
+            __m256 const radiusZ = _mm256_mul_ps(_mm256_set1_ps(tmScalarFabs(plane->z)), extent[2]);
+            __m256 const radius = _mm256_add_ps(_mm256_add_ps(radiusX, radiusY), radiusZ);
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negateAvx2(radius), _CMP_LT_OQ));
+        }
+        visible[i / 32] |= (uint32_t)(~_mm256_movemask_ps(outside) & 0xff) << (i % 32);
+    }
+    tmFrustumKernelsScalar.cullAabbBatch(visible, frustum, boxes, i, count);
+}
+
+static void
+cullSphereBatchAvx2(uint32_t *visible, TmFrustum const *frustum, TmSphere const *spheres, size_t first, size_t count)
+{
+    size_t i = first;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128 x0, y0, z0, r0, x1, y1, z1, r1;
+        __m256 x, y, z, negativeRadius;
+        __m256 outside = _mm256_setzero_ps();
+
+        sseLoadVec4x4(&x0, &y0, &z0, &r0, (TmVec4 const *)&spheres[i]);
+        sseLoadVec4x4(&x1, &y1, &z1, &r1, (TmVec4 const *)&spheres[i + 4]);
+        x = combineHalvesAvx2(x0, x1);
+        y = combineHalvesAvx2(y0, y1);
+        z = combineHalvesAvx2(z0, z1);
+        negativeRadius = negateAvx2(combineHalvesAvx2(r0, r1));
+        for (int j = 0; j < TM_FRUSTUM_PLANE_COUNT; ++j) {
+            __m256 const distance = planeDistanceAvx2(&frustum->planes[j], x, y, z);
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+        }
+        visible[i / 32] |= (uint32_t)(~_mm256_movemask_ps(outside) & 0xff) << (i % 32);
+    }
+    tmFrustumKernelsScalar.cullSphereBatch(visible, frustum, spheres, i, count);
+}
+
+TmFrustumKernels const tmFrustumKernelsAvx2 = {
+    .cullAabbBatch = cullAabbBatchAvx2,
+    .cullSphereBatch = cullSphereBatchAvx2
+};
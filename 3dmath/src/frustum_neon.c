@@ -0,0 +1,92 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include <math.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// vld3q and vld4q transpose four volumes into component registers,
+// which are tested against each plane in turn with the same operations,
+// in the same order, as the scalar kernels in frustum.c. A lane is
+// culled once any plane has it outside. Tails fall back to those
+// kernels.
+
+static float32x4_t
+planeDistanceNeon(TmVec4 const *plane, float32x4_t x, float32x4_t y, float32x4_t z)
+{
+    return vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(vdupq_n_f32(plane->x), x),
+                                         vmulq_f32(vdupq_n_f32(plane->y), y)),
+                               vmulq_f32(vdupq_n_f32(plane->z), z)),
+                     vdupq_n_f32(plane->w));
+}
+
+// One bit per lane of a comparison result, lane 0 lowest.
+static uint32_t
+visibleBitsNeon(uint32x4_t outside)
+{
+    static uint32_t const sk_laneBits[4] = {1, 2, 4, 8};
+
+    return vaddvq_u32(vandq_u32(vmvnq_u32(outside), vld1q_u32(sk_laneBits)));
+}
+
+static void
+cullAabbBatchNeon(uint32_t *visible, TmFrustum const *frustum, TmAabb const *boxes, size_t first, size_t count)
+{
+    float32x4_t const half = vdupq_n_f32(0.5f);
+    size_t i = first;
+
+    for (; i + 4 <= count; i += 4) {
+        // Each load yields (min, max, min, max) of two boxes.
+        float32x4x3_t const first2 = vld3q_f32((float const *)&boxes[i]);
+        float32x4x3_t const second2 = vld3q_f32((float const *)&boxes[i + 2]);
+        float32x4_t center[3];
+        float32x4_t extent[3];
+        uint32x4_t outside = vdupq_n_u32(0);
+
+        for (int k = 0; k < 3; ++k) {
+            float32x4_t const min = vuzp1q_f32(first2.val[k], second2.val[k]);
+            float32x4_t const max = vuzp2q_f32(first2.val[k], second2.val[k]);
+
+            center[k] = vmulq_f32(vaddq_f32(min, max), half);
+            extent[k] = vmulq_f32(vsubq_f32(max, min), half);
+        }
+
+        for (int j = 0; j < TM_FRUSTUM_PLANE_COUNT; ++j) {
+            TmVec4 const *plane = &frustum->planes[j];
+            float32x4_t const distance = planeDistanceNeon(plane, center[0], center[1], center[2]);
+            float32x4_t const radius = vaddq_f32(vaddq_f32(vmulq_f32(vdupq_n_f32(tmScalarFabs(plane->x)), extent[0]),
+                                                           vmulq_f32(vdupq_n_f32(tmScalarFabs(plane->y)), extent[1])),
+                                                 vmulq_f32(vdupq_n_f32(tmScalarFabs(plane->z)), extent[2]));
+
+            outside = vorrq_u32(outside, vcltq_f32(distance, vnegq_f32(radius)));
+        }
+        visible[i / 32] |= visibleBitsNeon(outside) << (i % 32);
+    }
+    tmFrustumKernelsScalar.cullAabbBatch(visible, frustum, boxes, i, count);
+}
+
+static void
+cullSphereBatchNeon(uint32_t *visible, TmFrustum const *frustum, TmSphere const *spheres, size_t first, size_t count)
+{
+    size_t i = first;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t const s = vld4q_f32((float const *)&spheres[i]);
+        float32x4_t const negativeRadius = vnegq_f32(s.val[3]);
+        uint32x4_t outside = vdupq_n_u32(0);
+
+        for (int j = 0; j < TM_FRUSTUM_PLANE_COUNT; ++j) {
+            float32x4_t const distance = planeDistanceNeon(&frustum->planes[j], s.val[0], s.val[1], s.val[2]);
+
+            outside = vorrq_u32(outside, vcltq_f32(distance, negativeRadius));
+        }
+        visible[i / 32] |= visibleBitsNeon(outside) << (i % 32);
+    }
+    tmFrustumKernelsScalar.cullSphereBatch(visible, frustum, spheres, i, count);
+}
+
+TmFrustumKernels const tmFrustumKernelsNeon = {
+    .cullAabbBatch = cullAabbBatchNeon,
+    .cullSphereBatch = cullSphereBatchNeon
+};
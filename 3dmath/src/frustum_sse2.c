@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <math.h>
+#include <emmintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// Four volumes are transposed into component registers and tested
+// against each plane in turn with the same operations, in the same
+// order, as the scalar kernels in frustum.c. A lane is culled once any
+// plane has it outside. Tails fall back to those kernels.
+
+static __m128
+planeDistanceSse2(TmVec4 const *plane, __m128 x, __m128 y, __m128 z)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane->x), x),
+                                            _mm_mul_ps(_mm_set1_ps(plane->y), y)),
+                                 _mm_mul_ps(_mm_set1_ps(plane->z), z)),
+                      _mm_set1_ps(plane->w));
+}
+
+static __m128
+negateSse2(__m128 v)
+{
+    return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+}
+
+static void
+cullAabbBatchSse2(uint32_t *visible, TmFrustum const *frustum, TmAabb const *boxes, size_t first, size_t count)
+{
+    __m128 const half = _mm_set1_ps(0.5f);
+    size_t i = first;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x01, y01, z01, x23, y23, z23;
+        __m128 minX, minY, minZ, maxX, maxY, maxZ;
+        __m128 centerX, centerY, centerZ, extentX, extentY, extentZ;
+        __m128 outside = _mm_setzero_ps();
+
+        // Each load yields (min, max, min, max) of two boxes.
+        sseLoadVec3x4(&x01, &y01, &z01, (TmVec3 const *)&boxes[i]);
+        sseLoadVec3x4(&x23, &y23, &z23, (TmVec3 const *)&boxes[i + 2]);
+        minX = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(2, 0, 2, 0));
+        minY = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 2, 0));
+        minZ = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0));
+        maxX = _mm_shuffle_ps(x01, x23, _MM_SHUFFLE(3, 1, 3, 1));
+        maxY = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(3, 1, 3, 1));
+        maxZ = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(3, 1, 3, 1));
+        centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+        centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+        centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+        extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+        extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+        extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+        for (int j = 0; j < TM_FRUSTUM_PLANE_COUNT; ++j) {
+            TmVec4 const *plane = &frustum->planes[j];
+            __m128 const distance = planeDistanceSse2(plane, centerX, centerY, centerZ);
+            __m128 const radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(tmScalarFabs(plane->x)), extentX),
+                                                        _mm_mul_ps(_mm_set1_ps(tmScalarFabs(plane->y)), extentY)),
+                                             _mm_mul_ps(_mm_set1_ps(tmScalarFabs(plane->z)), extentZ));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negateSse2(radius)));
+        }
+        visible[i / 32] |= (uint32_t)(~_mm_movemask_ps(outside) & 0xf) << (i % 32);
+    }
+    tmFrustumKernelsScalar.cullAabbBatch(visible, frustum, boxes, i, count);
+}
+
+static void
+cullSphereBatchSse2(uint32_t *visible, TmFrustum const *frustum, TmSphere const *spheres, size_t first, size_t count)
+{
+    size_t i = first;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z, radius, negativeRadius;
+        __m128 outside = _mm_setzero_ps();
+
+        sseLoadVec4x4(&x, &y, &z, &radius, (TmVec4 const *)&spheres[i]);
+        negativeRadius = negateSse2(radius);
+        for (int j = 0; j < TM_FRUSTUM_PLANE_COUNT; ++j) {
+            __m128 const distance = planeDistanceSse2(&frustum->planes[j], x, y, z);
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+        }
+        visible[i / 32] |= (uint32_t)(~_mm_movemask_ps(outside) & 0xf) << (i % 32);
+    }
+    tmFrustumKernelsScalar.cullSphereBatch(visible, frustum, spheres, i, count);
+}
+
+TmFrustumKernels const tmFrustumKernelsSse2 = {
+    .cullAabbBatch = cullAabbBatchSse2,
+    .cullSphereBatch = cullSphereBatchSse2
+};
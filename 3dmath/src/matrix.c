@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <math.h>
 #include "matrix.h"
+#include "simd_private.h"
 #include "vector.h"
 
 static_assert(sizeof(TmMat2) == sizeof(TmScalar[4]),
@@ -9,6 +10,8 @@ static_assert(sizeof(TmMat3) == sizeof(TmScalar[9]),
               "TmMat3 has unexpected padding");
 static_assert(sizeof(TmMat4) == sizeof(TmScalar[16]),
               "TmMat4 has unexpected padding");
+static_assert(sizeof(TmMat4f) == sizeof(float[16]),
+              "TmMat4f has unexpected padding");
 
 TmMat2 *
 tmMat2Add(TmMat2 *dest, TmMat2 const *a, TmMat2 const *b)
@@ -182,13 +185,13 @@ tmMat3Inverse(TmMat3 *dest, TmMat3 const *a)
     cofactors.m33 = +((a->m11 * a->m22) - (a->m21 * a->m12));
 
     tmMat3Transpose(&adjoint, &cofactors);
-    tmMat3ScalarMultiply(dest, dest, 1.0f / determinant);
+    tmMat3ScalarMultiply(dest, &adjoint, 1.0f / determinant);
 
     return dest;
 }
 
-TmMat4 *
-tmMat4Add(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+static TmMat4 *
+mat4AddScalar(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
 {
     dest->m11 = a->m11 + b->m11;
     dest->m21 = a->m21 + b->m21;
@@ -197,7 +200,7 @@ tmMat4Add(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
     dest->m12 = a->m12 + b->m12;
     dest->m22 = a->m22 + b->m22;
     dest->m32 = a->m32 + b->m32;
-    dest->m42 = a->m41 + b->m42;
+    dest->m42 = a->m42 + b->m42;
     dest->m13 = a->m13 + b->m13;
     dest->m23 = a->m23 + b->m23;
     dest->m33 = a->m33 + b->m33;
@@ -210,73 +213,77 @@ tmMat4Add(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
     return dest;
 }
 
-TmMat4 *
-tmMat4Multiply(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+static TmMat4 *
+mat4MultiplyScalar(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
 {
-    dest->m11 = ((a->m11 * b->m11) +
-                 (a->m12 * b->m21) +
-                 (a->m13 * b->m31) +
-                 (a->m14 * b->m41));
-    dest->m21 = ((a->m21 * b->m11) +
-                 (a->m22 * b->m21) +
-                 (a->m23 * b->m31) +
-                 (a->m24 * b->m41));
-    dest->m31 = ((a->m31 * b->m11) +
-                 (a->m32 * b->m21) +
-                 (a->m33 * b->m31) +
-                 (a->m34 * b->m41));
-    dest->m41 = ((a->m41 * b->m11) +
-                 (a->m42 * b->m21) +
-                 (a->m43 * b->m31) +
-                 (a->m44 * b->m41));
-    dest->m12 = ((a->m11 * b->m12) +
-                 (a->m12 * b->m22) +
-                 (a->m13 * b->m32) +
-                 (a->m14 * b->m42));
-    dest->m22 = ((a->m21 * b->m12) +
-                 (a->m22 * b->m22) +
-                 (a->m23 * b->m32) +
-                 (a->m24 * b->m42));
-    dest->m32 = ((a->m31 * b->m12) +
-                 (a->m32 * b->m22) +
-                 (a->m33 * b->m32) +
-                 (a->m34 * b->m42));
-    dest->m42 = ((a->m41 * b->m12) +
-                 (a->m42 * b->m22) +
-                 (a->m43 * b->m32) +
-                 (a->m44 * b->m42));
-    dest->m13 = ((a->m11 * b->m13) +
-                 (a->m12 * b->m23) +
-                 (a->m13 * b->m33) +
-                 (a->m14 * b->m43));
-    dest->m23 = ((a->m21 * b->m13) +
-                 (a->m22 * b->m23) +
-                 (a->m23 * b->m33) +
-                 (a->m24 * b->m43));
-    dest->m33 = ((a->m31 * b->m13) +
-                 (a->m32 * b->m23) +
-                 (a->m33 * b->m33) +
-                 (a->m34 * b->m43));
-    dest->m43 = ((a->m41 * b->m13) +
-                 (a->m42 * b->m23) +
-                 (a->m43 * b->m33) +
-                 (a->m44 * b->m43));
-    dest->m14 = ((a->m11 * b->m14) +
-                 (a->m12 * b->m24) +
-                 (a->m13 * b->m34) +
-                 (a->m14 * b->m44));
-    dest->m24 = ((a->m21 * b->m14) +
-                 (a->m22 * b->m24) +
-                 (a->m23 * b->m34) +
-                 (a->m24 * b->m44));
-    dest->m34 = ((a->m31 * b->m14) +
-                 (a->m32 * b->m24) +
-                 (a->m33 * b->m34) +
-                 (a->m34 * b->m44));
-    dest->m44 = ((a->m41 * b->m14) +
-                 (a->m42 * b->m24) +
-                 (a->m43 * b->m34) +
-                 (a->m44 * b->m44));
+    TmMat4 product;
+
+    product.m11 = ((a->m11 * b->m11) +
+                   (a->m12 * b->m21) +
+                   (a->m13 * b->m31) +
+                   (a->m14 * b->m41));
+    product.m21 = ((a->m21 * b->m11) +
+                   (a->m22 * b->m21) +
+                   (a->m23 * b->m31) +
+                   (a->m24 * b->m41));
+    product.m31 = ((a->m31 * b->m11) +
+                   (a->m32 * b->m21) +
+                   (a->m33 * b->m31) +
+                   (a->m34 * b->m41));
+    product.m41 = ((a->m41 * b->m11) +
+                   (a->m42 * b->m21) +
+                   (a->m43 * b->m31) +
+                   (a->m44 * b->m41));
+    product.m12 = ((a->m11 * b->m12) +
+                   (a->m12 * b->m22) +
+                   (a->m13 * b->m32) +
+                   (a->m14 * b->m42));
+    product.m22 = ((a->m21 * b->m12) +
+                   (a->m22 * b->m22) +
+                   (a->m23 * b->m32) +
+                   (a->m24 * b->m42));
+    product.m32 = ((a->m31 * b->m12) +
+                   (a->m32 * b->m22) +
+                   (a->m33 * b->m32) +
+                   (a->m34 * b->m42));
+    product.m42 = ((a->m41 * b->m12) +
+                   (a->m42 * b->m22) +
+                   (a->m43 * b->m32) +
+                   (a->m44 * b->m42));
+    product.m13 = ((a->m11 * b->m13) +
+                   (a->m12 * b->m23) +
+                   (a->m13 * b->m33) +
+                   (a->m14 * b->m43));
+    product.m23 = ((a->m21 * b->m13) +
+                   (a->m22 * b->m23) +
+                   (a->m23 * b->m33) +
+                   (a->m24 * b->m43));
+    product.m33 = ((a->m31 * b->m13) +
+                   (a->m32 * b->m23) +
+                   (a->m33 * b->m33) +
+                   (a->m34 * b->m43));
+    product.m43 = ((a->m41 * b->m13) +
+                   (a->m42 * b->m23) +
+                   (a->m43 * b->m33) +
+                   (a->m44 * b->m43));
+    product.m14 = ((a->m11 * b->m14) +
+                   (a->m12 * b->m24) +
+                   (a->m13 * b->m34) +
+                   (a->m14 * b->m44));
+    product.m24 = ((a->m21 * b->m14) +
+                   (a->m22 * b->m24) +
+                   (a->m23 * b->m34) +
+                   (a->m24 * b->m44));
+    product.m34 = ((a->m31 * b->m14) +
+                   (a->m32 * b->m24) +
+                   (a->m33 * b->m34) +
+                   (a->m34 * b->m44));
+    product.m44 = ((a->m41 * b->m14) +
+                   (a->m42 * b->m24) +
+                   (a->m43 * b->m34) +
+                   (a->m44 * b->m44));
+
+    *dest = product;
 
     return dest;
 }
@@ -291,8 +298,7 @@ tmMat4Rotation(TmMat4 *dest, TmVec3 const *normal, TmScalar angle)
     TmScalar normalXTimesNormalZ;
     TmScalar normalYTimesNormalZ;
 
-    angleCos = tmScalarCos(angle);
-    angleSin = tmScalarSin(angle);
+    tmScalarSinCos(angle, &angleSin, &angleCos);
     oneMinusAngleCos = 1.0f - angleCos;
     normalXTimesNormalY = normal->x * normal->y;
     normalXTimesNormalZ = normal->x * normal->z;
@@ -321,8 +327,8 @@ tmMat4Rotation(TmMat4 *dest, TmVec3 const *normal, TmScalar angle)
     return dest;
 }
 
-TmMat4 *
-tmMat4ScalarMultiply(TmMat4 *dest, TmMat4 const *a, TmScalar x)
+static TmMat4 *
+mat4ScalarMultiplyScalar(TmMat4 *dest, TmMat4 const *a, TmScalar x)
 {
     dest->m11 = a->m11 * x;
     dest->m21 = a->m21 * x;
@@ -344,68 +350,246 @@ tmMat4ScalarMultiply(TmMat4 *dest, TmMat4 const *a, TmScalar x)
     return dest;
 }
 
+static TmMat4 *
+mat4TransposeScalar(TmMat4 *dest, TmMat4 const *a)
+{
+    TmMat4 transpose;
+
+    transpose.m11 = a->m11;
+    transpose.m21 = a->m12;
+    transpose.m31 = a->m13;
+    transpose.m41 = a->m14;
+    transpose.m12 = a->m21;
+    transpose.m22 = a->m22;
+    transpose.m32 = a->m23;
+    transpose.m42 = a->m24;
+    transpose.m13 = a->m31;
+    transpose.m23 = a->m32;
+    transpose.m33 = a->m33;
+    transpose.m43 = a->m34;
+    transpose.m14 = a->m41;
+    transpose.m24 = a->m42;
+    transpose.m34 = a->m43;
+    transpose.m44 = a->m44;
+
+    *dest = transpose;
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplyBatchScalar(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        mat4MultiplyScalar(&dest[i], &a[i], &b[i]);
+    }
+
+    return dest;
+}
+
+static TmVec4 *
+mat4TransformVec4BatchScalar(TmVec4 *dest, TmMat4 const *m, TmVec4 const *vectors, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        TmVec4 const v = vectors[i];
+
+        dest[i].x = (m->m11 * v.x) + (m->m12 * v.y) + (m->m13 * v.z) + (m->m14 * v.w);
+        dest[i].y = (m->m21 * v.x) + (m->m22 * v.y) + (m->m23 * v.z) + (m->m24 * v.w);
+        dest[i].z = (m->m31 * v.x) + (m->m32 * v.y) + (m->m33 * v.z) + (m->m34 * v.w);
+        dest[i].w = (m->m41 * v.x) + (m->m42 * v.y) + (m->m43 * v.z) + (m->m44 * v.w);
+    }
+
+    return dest;
+}
+
+static TmVec3 *
+mat4TransformPointsVec3BatchScalar(TmVec3 *dest, TmMat4 const *m, TmVec3 const *points, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        TmVec3 const p = points[i];
+
+        dest[i].x = (m->m11 * p.x) + (m->m12 * p.y) + (m->m13 * p.z) + m->m14;
+        dest[i].y = (m->m21 * p.x) + (m->m22 * p.y) + (m->m23 * p.z) + m->m24;
+        dest[i].z = (m->m31 * p.x) + (m->m32 * p.y) + (m->m33 * p.z) + m->m34;
+    }
+
+    return dest;
+}
+
+// 2x2 determinants of the top two rows and of the bottom two rows, for
+// every pair of columns in the order 12, 13, 14, 23, 24, 34. Each 3x3
+// minor of the matrix is a combination of three of them, so computing
+// them once is enough for both the determinant and the inverse.
+static void
+mat4SubDeterminants(TmScalar top[6], TmScalar bottom[6], TmMat4 const *a)
+{
+    top[0] = (a->m11 * a->m22) - (a->m21 * a->m12);
+    top[1] = (a->m11 * a->m23) - (a->m21 * a->m13);
+    top[2] = (a->m11 * a->m24) - (a->m21 * a->m14);
+    top[3] = (a->m12 * a->m23) - (a->m22 * a->m13);
+    top[4] = (a->m12 * a->m24) - (a->m22 * a->m14);
+    top[5] = (a->m13 * a->m24) - (a->m23 * a->m14);
+
+    bottom[0] = (a->m31 * a->m42) - (a->m41 * a->m32);
+    bottom[1] = (a->m31 * a->m43) - (a->m41 * a->m33);
+    bottom[2] = (a->m31 * a->m44) - (a->m41 * a->m34);
+    bottom[3] = (a->m32 * a->m43) - (a->m42 * a->m33);
+    bottom[4] = (a->m32 * a->m44) - (a->m42 * a->m34);
+    bottom[5] = (a->m33 * a->m44) - (a->m43 * a->m34);
+}
+
+static TmScalar
+mat4DeterminantFromSubDeterminants(TmScalar const top[6], TmScalar const bottom[6])
+{
+    return ((top[0] * bottom[5]) -
+            (top[1] * bottom[4]) +
+            (top[2] * bottom[3]) +
+            (top[3] * bottom[2]) -
+            (top[4] * bottom[1]) +
+            (top[5] * bottom[0]));
+}
+
+static TmMat4 *
+mat4InverseScalar(TmMat4 *dest, TmMat4 const *a)
+{
+    TmMat4 inverse;
+    TmScalar top[6];
+    TmScalar bottom[6];
+    TmScalar determinant;
+    TmScalar invDeterminant;
+
+    mat4SubDeterminants(top, bottom, a);
+    determinant = mat4DeterminantFromSubDeterminants(top, bottom);
+    assert(determinant != 0.0f);
+    invDeterminant = 1.0f / determinant;
+
+    // Transposed cofactors (the adjoint) scaled by 1 / determinant
+    inverse.m11 = (+(a->m22 * bottom[5]) - (a->m23 * bottom[4]) + (a->m24 * bottom[3])) * invDeterminant;
+    inverse.m12 = (-(a->m12 * bottom[5]) + (a->m13 * bottom[4]) - (a->m14 * bottom[3])) * invDeterminant;
+    inverse.m13 = (+(a->m42 * top[5]) - (a->m43 * top[4]) + (a->m44 * top[3])) * invDeterminant;
+    inverse.m14 = (-(a->m32 * top[5]) + (a->m33 * top[4]) - (a->m34 * top[3])) * invDeterminant;
+
+    inverse.m21 = (-(a->m21 * bottom[5]) + (a->m23 * bottom[2]) - (a->m24 * bottom[1])) * invDeterminant;
+    inverse.m22 = (+(a->m11 * bottom[5]) - (a->m13 * bottom[2]) + (a->m14 * bottom[1])) * invDeterminant;
+    inverse.m23 = (-(a->m41 * top[5]) + (a->m43 * top[2]) - (a->m44 * top[1])) * invDeterminant;
+    inverse.m24 = (+(a->m31 * top[5]) - (a->m33 * top[2]) + (a->m34 * top[1])) * invDeterminant;
+
+    inverse.m31 = (+(a->m21 * bottom[4]) - (a->m22 * bottom[2]) + (a->m24 * bottom[0])) * invDeterminant;
+    inverse.m32 = (-(a->m11 * bottom[4]) + (a->m12 * bottom[2]) - (a->m14 * bottom[0])) * invDeterminant;
+    inverse.m33 = (+(a->m41 * top[4]) - (a->m42 * top[2]) + (a->m44 * top[0])) * invDeterminant;
+    inverse.m34 = (-(a->m31 * top[4]) + (a->m32 * top[2]) - (a->m34 * top[0])) * invDeterminant;
+
+    inverse.m41 = (-(a->m21 * bottom[3]) + (a->m22 * bottom[1]) - (a->m23 * bottom[0])) * invDeterminant;
+    inverse.m42 = (+(a->m11 * bottom[3]) - (a->m12 * bottom[1]) + (a->m13 * bottom[0])) * invDeterminant;
+    inverse.m43 = (-(a->m41 * top[3]) + (a->m42 * top[1]) - (a->m43 * top[0])) * invDeterminant;
+    inverse.m44 = (+(a->m31 * top[3]) - (a->m32 * top[1]) + (a->m33 * top[0])) * invDeterminant;
+
+    *dest = inverse;
+
+    return dest;
+}
+
+TmMat4Kernels const tmMat4KernelsScalar = {
+    .add = mat4AddScalar,
+    .multiply = mat4MultiplyScalar,
+    .scalarMultiply = mat4ScalarMultiplyScalar,
+    .transpose = mat4TransposeScalar,
+    .inverse = mat4InverseScalar,
+    .multiplyBatch = mat4MultiplyBatchScalar,
+    .transformVec4Batch = mat4TransformVec4BatchScalar,
+    .transformPointsVec3Batch = mat4TransformPointsVec3BatchScalar
+};
+
+TmMat4 *
+tmMat4Add(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    return tmSimdMat4Kernels()->add(dest, a, b);
+}
+
+TmMat4 *
+tmMat4Multiply(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    return tmSimdMat4Kernels()->multiply(dest, a, b);
+}
+
+TmMat4 *
+tmMat4ScalarMultiply(TmMat4 *dest, TmMat4 const *a, TmScalar x)
+{
+    return tmSimdMat4Kernels()->scalarMultiply(dest, a, x);
+}
+
 TmMat4 *
 tmMat4Transpose(TmMat4 *dest, TmMat4 const *a)
 {
-    dest->m11 = a->m11;
-    dest->m21 = a->m12;
-    dest->m31 = a->m13;
-    dest->m41 = a->m14;
-    dest->m12 = a->m21;
-    dest->m22 = a->m22;
-    dest->m32 = a->m23;
-    dest->m42 = a->m24;
-    dest->m13 = a->m31;
-    dest->m23 = a->m32;
-    dest->m33 = a->m33;
-    dest->m43 = a->m34;
-    dest->m14 = a->m41;
-    dest->m24 = a->m42;
-    dest->m34 = a->m43;
-    dest->m44 = a->m44;
+    return tmSimdMat4Kernels()->transpose(dest, a);
+}
+
+TmMat4 *
+tmMat4MultiplyBatch(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b, size_t count)
+{
+    return tmSimdMat4Kernels()->multiplyBatch(dest, a, b, count);
+}
+
+TmVec4 *
+tmMat4TransformVec4Batch(TmVec4 *dest, TmMat4 const *m, TmVec4 const *vectors, size_t count)
+{
+    return tmSimdMat4Kernels()->transformVec4Batch(dest, m, vectors, count);
+}
+
+TmVec3 *
+tmMat4TransformPointsVec3Batch(TmVec3 *dest, TmMat4 const *m, TmVec3 const *points, size_t count)
+{
+    return tmSimdMat4Kernels()->transformPointsVec3Batch(dest, m, points, count);
+}
+
+TmMat4f *
+tmMat4ToFloat(TmMat4f *dest, TmMat4 const *a)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    float *pDest = (float *)dest;
+
+    for (int i = 0; i < 16; ++i) {
+        pDest[i] = (float)pA[i];
+    }
 
     return dest;
 }
 
-#define MAT3_DET(m11, m12, m13, m21, m22, m23, m31, m32, m33)   \
-    (((m11) * (m22) * (m33)) +                                  \
-     ((m12) * (m23) + (m31)) +                                  \
-     ((m13) * (m21) * (m32)) -                                  \
-     ((m31) * (m22) * (m13)) -                                  \
-     ((m32) * (m23) * (m11)) -                                  \
-     ((m33) * (m21) * (m12)))
+TmMat4f *
+tmMat4ToFloatCameraRelativeBatch(TmMat4f *dest, TmMat4 const *world, TmVec3 const *eye, size_t count)
+{
+    TmVec3 const e = *eye;
+
+    for (size_t i = 0; i < count; ++i) {
+        TmScalar const *pWorld = (TmScalar const *)&world[i];
+        float *pDest = (float *)&dest[i];
+
+        // Row r of translation(-eye) * world is row r of world minus
+        // eye[r] times its bottom row, which for affine matrices only
+        // changes the translation.
+        for (int column = 0; column < 4; ++column) {
+            TmScalar const *c = pWorld + 4 * column;
+
+            pDest[4 * column + 0] = (float)(c[0] - (e.x * c[3]));
+            pDest[4 * column + 1] = (float)(c[1] - (e.y * c[3]));
+            pDest[4 * column + 2] = (float)(c[2] - (e.z * c[3]));
+            pDest[4 * column + 3] = (float)c[3];
+        }
+    }
+
+    return dest;
+}
 
 TmScalar
 tmMat4Determinant(TmMat4 const *a)
 {
-    TmScalar result;
-    TmScalar minor_m11;
-    TmScalar minor_m12;
-    TmScalar minor_m13;
-    TmScalar minor_m14;
-    
-    minor_m11 = MAT3_DET(a->m22, a->m23, a->m24,
-                         a->m32, a->m33, a->m34,
-                         a->m42, a->m43, a->m44);
-    minor_m12 = MAT3_DET(a->m21, a->m23, a->m24,
-                         a->m31, a->m33, a->m34,
-                         a->m41, a->m43, a->m44);
-    minor_m13 = MAT3_DET(a->m21, a->m22, a->m24,
-                         a->m31, a->m32, a->m34,
-                         a->m41, a->m42, a->m44);
-    minor_m14 = MAT3_DET(a->m21, a->m22, a->m23,
-                         a->m31, a->m32, a->m33,
-                         a->m41, a->m42, a->m43);
-
-    result = ((a->m11 * minor_m11) -
-              (a->m12 * minor_m12) +
-              (a->m13 * minor_m13) -
-              (a->m14 * minor_m14));
-    
-    return result;
-}
+    TmScalar top[6];
+    TmScalar bottom[6];
 
-#undef MAT3_DET
+    mat4SubDeterminants(top, bottom, a);
+
+    return mat4DeterminantFromSubDeterminants(top, bottom);
+}
 
 TmMat4 *
 tmMat4Identity(TmMat4 *dest)
@@ -436,14 +620,73 @@ tmMat4Identity(TmMat4 *dest)
 TmMat4 *
 tmMat4Inverse(TmMat4 *dest, TmMat4 const *a)
 {
-    TmScalar determinant;
+    return tmSimdMat4Kernels()->inverse(dest, a);
+}
 
-    // TODO: This is not finished
-    assert(0);
+TmMat4 *
+tmMat4InverseAffine(TmMat4 *dest, TmMat4 const *a)
+{
+    TmMat4 inverse;
+    TmScalar determinant;
+    TmScalar invDeterminant;
 
-    determinant = tmMat4Determinant(a);
+    // Inverse of the upper 3x3 block from its cofactors
+    inverse.m11 = (a->m22 * a->m33) - (a->m32 * a->m23);
+    inverse.m12 = (a->m32 * a->m13) - (a->m12 * a->m33);
+    inverse.m13 = (a->m12 * a->m23) - (a->m22 * a->m13);
+    determinant = (a->m11 * inverse.m11) + (a->m21 * inverse.m12) + (a->m31 * inverse.m13);
     assert(determinant != 0.0f);
-    //*dest = inverse;
+    invDeterminant = 1.0f / determinant;
+
+    inverse.m11 *= invDeterminant;
+    inverse.m12 *= invDeterminant;
+    inverse.m13 *= invDeterminant;
+    inverse.m21 = ((a->m31 * a->m23) - (a->m21 * a->m33)) * invDeterminant;
+    inverse.m22 = ((a->m11 * a->m33) - (a->m31 * a->m13)) * invDeterminant;
+    inverse.m23 = ((a->m21 * a->m13) - (a->m11 * a->m23)) * invDeterminant;
+    inverse.m31 = ((a->m21 * a->m32) - (a->m31 * a->m22)) * invDeterminant;
+    inverse.m32 = ((a->m31 * a->m12) - (a->m11 * a->m32)) * invDeterminant;
+    inverse.m33 = ((a->m11 * a->m22) - (a->m21 * a->m12)) * invDeterminant;
+
+    // Translation is the inverted block applied to -t
+    inverse.m14 = -((inverse.m11 * a->m14) + (inverse.m12 * a->m24) + (inverse.m13 * a->m34));
+    inverse.m24 = -((inverse.m21 * a->m14) + (inverse.m22 * a->m24) + (inverse.m23 * a->m34));
+    inverse.m34 = -((inverse.m31 * a->m14) + (inverse.m32 * a->m24) + (inverse.m33 * a->m34));
+
+    inverse.m41 = 0.0f;
+    inverse.m42 = 0.0f;
+    inverse.m43 = 0.0f;
+    inverse.m44 = 1.0f;
+    *dest = inverse;
+
+    return dest;
+}
+
+TmMat4 *
+tmMat4InverseRigid(TmMat4 *dest, TmMat4 const *a)
+{
+    TmMat4 inverse;
+
+    // The inverse of a rotation is its transpose
+    inverse.m11 = a->m11;
+    inverse.m12 = a->m21;
+    inverse.m13 = a->m31;
+    inverse.m21 = a->m12;
+    inverse.m22 = a->m22;
+    inverse.m23 = a->m32;
+    inverse.m31 = a->m13;
+    inverse.m32 = a->m23;
+    inverse.m33 = a->m33;
+
+    inverse.m14 = -((inverse.m11 * a->m14) + (inverse.m12 * a->m24) + (inverse.m13 * a->m34));
+    inverse.m24 = -((inverse.m21 * a->m14) + (inverse.m22 * a->m24) + (inverse.m23 * a->m34));
+    inverse.m34 = -((inverse.m31 * a->m14) + (inverse.m32 * a->m24) + (inverse.m33 * a->m34));
+
+    inverse.m41 = 0.0f;
+    inverse.m42 = 0.0f;
+    inverse.m43 = 0.0f;
+    inverse.m44 = 1.0f;
+    *dest = inverse;
 
     return dest;
 }
@@ -0,0 +1,267 @@
+#include <assert.h>
+#include <immintrin.h>
+#include "matrix.h"
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// A 256-bit register holds two TmMat4 columns. Like the SSE2 backend,
+// every input is loaded before dest is written.
+
+static __m256
+broadcastColumnAvx2(TmScalar const *column)
+{
+    __m128 const half = _mm_loadu_ps(column);
+
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(half), half, 1);
+}
+
+static __m256
+combineHalvesAvx2(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+static TmMat4 *
+mat4AddAvx2(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar const *pB = (TmScalar const *)b;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m256 const sum12 = _mm256_add_ps(_mm256_loadu_ps(pA + 0), _mm256_loadu_ps(pB + 0));
+    __m256 const sum34 = _mm256_add_ps(_mm256_loadu_ps(pA + 8), _mm256_loadu_ps(pB + 8));
+
+    _mm256_storeu_ps(pDest + 0, sum12);
+    _mm256_storeu_ps(pDest + 8, sum34);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplyAvx2(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar const *pB = (TmScalar const *)b;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m256 const aColumn1 = broadcastColumnAvx2(pA + 0);
+    __m256 const aColumn2 = broadcastColumnAvx2(pA + 4);
+    __m256 const aColumn3 = broadcastColumnAvx2(pA + 8);
+    __m256 const aColumn4 = broadcastColumnAvx2(pA + 12);
+    __m256 products[2];
+
+    // Each half of bColumns holds one column of b. The in-lane permutes
+    // splat row k of each column across its half, so one pass computes
+    // two product columns, summed in the scalar backend's order.
+    for (int i = 0; i < 2; ++i) {
+        __m256 const bColumns = _mm256_loadu_ps(pB + 8 * i);
+        __m256 result;
+
+        result = _mm256_mul_ps(aColumn1, _mm256_permute_ps(bColumns, 0x00));
+        result = _mm256_add_ps(result, _mm256_mul_ps(aColumn2, _mm256_permute_ps(bColumns, 0x55)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(aColumn3, _mm256_permute_ps(bColumns, 0xAA)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(aColumn4, _mm256_permute_ps(bColumns, 0xFF)));
+        products[i] = result;
+    }
+    _mm256_storeu_ps(pDest + 0, products[0]);
+    _mm256_storeu_ps(pDest + 8, products[1]);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4ScalarMultiplyAvx2(TmMat4 *dest, TmMat4 const *a, TmScalar x)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m256 const scale = _mm256_set1_ps(x);
+    __m256 const product12 = _mm256_mul_ps(_mm256_loadu_ps(pA + 0), scale);
+    __m256 const product34 = _mm256_mul_ps(_mm256_loadu_ps(pA + 8), scale);
+
+    _mm256_storeu_ps(pDest + 0, product12);
+    _mm256_storeu_ps(pDest + 8, product34);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4TransposeAvx2(TmMat4 *dest, TmMat4 const *a)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m256i const gatherRows = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    __m256 const columns12 = _mm256_loadu_ps(pA + 0);
+    __m256 const columns34 = _mm256_loadu_ps(pA + 8);
+    // (m11 m12 m21 m22 m31 m32 m41 m42) and (m13 m14 m23 m24 ...)
+    __m256 const pairs12 = _mm256_permutevar8x32_ps(columns12, gatherRows);
+    __m256 const pairs34 = _mm256_permutevar8x32_ps(columns34, gatherRows);
+    // Interleave the pairs: low/high 64-bit halves of each lane give the
+    // rows of a, which are the columns of the transpose.
+    __m256d const rowsLow = _mm256_unpacklo_pd(_mm256_castps_pd(pairs12), _mm256_castps_pd(pairs34));
+    __m256d const rowsHigh = _mm256_unpackhi_pd(_mm256_castps_pd(pairs12), _mm256_castps_pd(pairs34));
+    // rowsLow = (row1 | row3), rowsHigh = (row2 | row4)
+    __m256 const transposed12 = _mm256_castpd_ps(_mm256_permute2f128_pd(rowsLow, rowsHigh, 0x20));
+    __m256 const transposed34 = _mm256_castpd_ps(_mm256_permute2f128_pd(rowsLow, rowsHigh, 0x31));
+
+    _mm256_storeu_ps(pDest + 0, transposed12);
+    _mm256_storeu_ps(pDest + 8, transposed34);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplyBatchAvx2(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b, size_t count)
+{
+    size_t i = 0;
+
+    // Two products per iteration, one in each 128-bit half: the low
+    // halves hold the columns of a[i] and b[i], the high halves those of
+    // a[i + 1] and b[i + 1].
+    for (; i + 2 <= count; i += 2) {
+        TmScalar const *pA = (TmScalar const *)&a[i];
+        TmScalar const *pB = (TmScalar const *)&b[i];
+        TmScalar *pDest = (TmScalar *)&dest[i];
+        __m256 aColumns[4];
+        __m256 products[4];
+
+        for (int k = 0; k < 4; ++k) {
+            aColumns[k] = combineHalvesAvx2(_mm_loadu_ps(pA + 4 * k), _mm_loadu_ps(pA + 16 + 4 * k));
+        }
+        for (int k = 0; k < 4; ++k) {
+            __m256 const bColumns = combineHalvesAvx2(_mm_loadu_ps(pB + 4 * k), _mm_loadu_ps(pB + 16 + 4 * k));
+            __m256 result;
+
+            result = _mm256_mul_ps(aColumns[0], _mm256_permute_ps(bColumns, 0x00));
+            result = _mm256_add_ps(result, _mm256_mul_ps(aColumns[1], _mm256_permute_ps(bColumns, 0x55)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(aColumns[2], _mm256_permute_ps(bColumns, 0xAA)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(aColumns[3], _mm256_permute_ps(bColumns, 0xFF)));
+            products[k] = result;
+        }
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps(pDest + 4 * k, _mm256_castps256_ps128(products[k]));
+            _mm_storeu_ps(pDest + 16 + 4 * k, _mm256_extractf128_ps(products[k], 1));
+        }
+    }
+    if (i < count) {
+        mat4MultiplyAvx2(&dest[i], &a[i], &b[i]);
+    }
+
+    return dest;
+}
+
+static TmVec4 *
+mat4TransformVec4BatchAvx2(TmVec4 *dest, TmMat4 const *m, TmVec4 const *vectors, size_t count)
+{
+    TmScalar const *pM = (TmScalar const *)m;
+    __m256 const column1 = broadcastColumnAvx2(pM + 0);
+    __m256 const column2 = broadcastColumnAvx2(pM + 4);
+    __m256 const column3 = broadcastColumnAvx2(pM + 8);
+    __m256 const column4 = broadcastColumnAvx2(pM + 12);
+    size_t i = 0;
+
+    // Two vectors per iteration, one in each 128-bit half.
+    for (; i + 2 <= count; i += 2) {
+        __m256 const v = _mm256_loadu_ps((TmScalar const *)&vectors[i]);
+        __m256 result;
+
+        result = _mm256_mul_ps(column1, _mm256_permute_ps(v, 0x00));
+        result = _mm256_add_ps(result, _mm256_mul_ps(column2, _mm256_permute_ps(v, 0x55)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(column3, _mm256_permute_ps(v, 0xAA)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(column4, _mm256_permute_ps(v, 0xFF)));
+        _mm256_storeu_ps((TmScalar *)&dest[i], result);
+    }
+    if (i < count) {
+        __m128 const v = _mm_loadu_ps((TmScalar const *)&vectors[i]);
+        __m128 result;
+
+        result = _mm_mul_ps(_mm256_castps256_ps128(column1), _mm_permute_ps(v, 0x00));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm256_castps256_ps128(column2), _mm_permute_ps(v, 0x55)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm256_castps256_ps128(column3), _mm_permute_ps(v, 0xAA)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm256_castps256_ps128(column4), _mm_permute_ps(v, 0xFF)));
+        _mm_storeu_ps((TmScalar *)&dest[i], result);
+    }
+
+    return dest;
+}
+
+static TmVec3 *
+mat4TransformPointsVec3BatchAvx2(TmVec3 *dest, TmMat4 const *m, TmVec3 const *points, size_t count)
+{
+    __m256 const m11 = _mm256_set1_ps(m->m11);
+    __m256 const m21 = _mm256_set1_ps(m->m21);
+    __m256 const m31 = _mm256_set1_ps(m->m31);
+    __m256 const m12 = _mm256_set1_ps(m->m12);
+    __m256 const m22 = _mm256_set1_ps(m->m22);
+    __m256 const m32 = _mm256_set1_ps(m->m32);
+    __m256 const m13 = _mm256_set1_ps(m->m13);
+    __m256 const m23 = _mm256_set1_ps(m->m23);
+    __m256 const m33 = _mm256_set1_ps(m->m33);
+    __m256 const m14 = _mm256_set1_ps(m->m14);
+    __m256 const m24 = _mm256_set1_ps(m->m24);
+    __m256 const m34 = _mm256_set1_ps(m->m34);
+    size_t i = 0;
+
+    // Eight points per iteration, transposed so that each lane holds
+    // one point.
+    for (; i + 8 <= count; i += 8) {
+        __m128 lowX;
+        __m128 lowY;
+        __m128 lowZ;
+        __m128 highX;
+        __m128 highY;
+        __m128 highZ;
+        __m256 x;
+        __m256 y;
+        __m256 z;
+        __m256 resultX;
+        __m256 resultY;
+        __m256 resultZ;
+
+        sseLoadVec3x4(&lowX, &lowY, &lowZ, &points[i]);
+        sseLoadVec3x4(&highX, &highY, &highZ, &points[i + 4]);
+        x = combineHalvesAvx2(lowX, highX);
+        y = combineHalvesAvx2(lowY, highY);
+        z = combineHalvesAvx2(lowZ, highZ);
+        resultX = _mm256_mul_ps(m11, x);
+        resultX = _mm256_add_ps(resultX, _mm256_mul_ps(m12, y));
+        resultX = _mm256_add_ps(resultX, _mm256_mul_ps(m13, z));
+        resultX = _mm256_add_ps(resultX, m14);
+        resultY = _mm256_mul_ps(m21, x);
+        resultY = _mm256_add_ps(resultY, _mm256_mul_ps(m22, y));
+        resultY = _mm256_add_ps(resultY, _mm256_mul_ps(m23, z));
+        resultY = _mm256_add_ps(resultY, m24);
+        resultZ = _mm256_mul_ps(m31, x);
+        resultZ = _mm256_add_ps(resultZ, _mm256_mul_ps(m32, y));
+        resultZ = _mm256_add_ps(resultZ, _mm256_mul_ps(m33, z));
+        resultZ = _mm256_add_ps(resultZ, m34);
+        sseStoreVec3x4(&dest[i],
+                       _mm256_castps256_ps128(resultX),
+                       _mm256_castps256_ps128(resultY),
+                       _mm256_castps256_ps128(resultZ));
+        sseStoreVec3x4(&dest[i + 4],
+                       _mm256_extractf128_ps(resultX, 1),
+                       _mm256_extractf128_ps(resultY, 1),
+                       _mm256_extractf128_ps(resultZ, 1));
+    }
+    tmMat4KernelsScalar.transformPointsVec3Batch(&dest[i], m, &points[i], count - i);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4InverseAvx2(TmMat4 *dest, TmMat4 const *a)
+{
+    return sseMat4Inverse(dest, a);
+}
+
+TmMat4Kernels const tmMat4KernelsAvx2 = {
+    .add = mat4AddAvx2,
+    .multiply = mat4MultiplyAvx2,
+    .scalarMultiply = mat4ScalarMultiplyAvx2,
+    .transpose = mat4TransposeAvx2,
+    .inverse = mat4InverseAvx2,
+    .multiplyBatch = mat4MultiplyBatchAvx2,
+    .transformVec4Batch = mat4TransformVec4BatchAvx2,
+    .transformPointsVec3Batch = mat4TransformPointsVec3BatchAvx2
+};
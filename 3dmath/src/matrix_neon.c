@@ -0,0 +1,313 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include "matrix.h"
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// Separate multiplies and adds are used instead of vmlaq/vfmaq so that
+// results match the scalar backend exactly. Every input is loaded
+// before dest is written.
+
+static float32x4_t
+linearCombinationNeon(float32x4_t const aColumns[4], TmScalar const *bColumn)
+{
+    float32x4_t result;
+
+    result = vmulq_n_f32(aColumns[0], bColumn[0]);
+    result = vaddq_f32(result, vmulq_n_f32(aColumns[1], bColumn[1]));
+    result = vaddq_f32(result, vmulq_n_f32(aColumns[2], bColumn[2]));
+    result = vaddq_f32(result, vmulq_n_f32(aColumns[3], bColumn[3]));
+
+    return result;
+}
+
+static TmMat4 *
+mat4AddNeon(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar const *pB = (TmScalar const *)b;
+    TmScalar *pDest = (TmScalar *)dest;
+    float32x4_t sums[4];
+
+    for (int i = 0; i < 4; ++i) {
+        sums[i] = vaddq_f32(vld1q_f32(pA + 4 * i), vld1q_f32(pB + 4 * i));
+    }
+    for (int i = 0; i < 4; ++i) {
+        vst1q_f32(pDest + 4 * i, sums[i]);
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplyNeon(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar const *pB = (TmScalar const *)b;
+    TmScalar *pDest = (TmScalar *)dest;
+    float32x4_t aColumns[4];
+    float32x4_t productColumns[4];
+
+    for (int i = 0; i < 4; ++i) {
+        aColumns[i] = vld1q_f32(pA + 4 * i);
+    }
+    for (int i = 0; i < 4; ++i) {
+        productColumns[i] = linearCombinationNeon(aColumns, pB + 4 * i);
+    }
+    for (int i = 0; i < 4; ++i) {
+        vst1q_f32(pDest + 4 * i, productColumns[i]);
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4ScalarMultiplyNeon(TmMat4 *dest, TmMat4 const *a, TmScalar x)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar *pDest = (TmScalar *)dest;
+
+    for (int i = 0; i < 4; ++i) {
+        vst1q_f32(pDest + 4 * i, vmulq_n_f32(vld1q_f32(pA + 4 * i), x));
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4TransposeNeon(TmMat4 *dest, TmMat4 const *a)
+{
+    // vld4q de-interleaves with a stride of four, so val[i] receives
+    // row i + 1 of a, which is column i + 1 of the transpose.
+    TmScalar *pDest = (TmScalar *)dest;
+    float32x4x4_t const rows = vld4q_f32((TmScalar const *)a);
+
+    for (int i = 0; i < 4; ++i) {
+        vst1q_f32(pDest + 4 * i, rows.val[i]);
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplyBatchNeon(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b, size_t count)
+{
+    size_t i = 0;
+
+    // As in the SSE2 backend, two products are interleaved per iteration
+    // so that their dependency chains overlap.
+    for (; i + 2 <= count; i += 2) {
+        TmScalar const *pA = (TmScalar const *)&a[i];
+        TmScalar const *pB = (TmScalar const *)&b[i];
+        TmScalar *pDest = (TmScalar *)&dest[i];
+        float32x4_t aColumns[2][4];
+        float32x4_t products[2][4];
+
+        for (int k = 0; k < 4; ++k) {
+            aColumns[0][k] = vld1q_f32(pA + 4 * k);
+            aColumns[1][k] = vld1q_f32(pA + 16 + 4 * k);
+        }
+        for (int k = 0; k < 4; ++k) {
+            products[0][k] = linearCombinationNeon(aColumns[0], pB + 4 * k);
+            products[1][k] = linearCombinationNeon(aColumns[1], pB + 16 + 4 * k);
+        }
+        for (int k = 0; k < 4; ++k) {
+            vst1q_f32(pDest + 4 * k, products[0][k]);
+            vst1q_f32(pDest + 16 + 4 * k, products[1][k]);
+        }
+    }
+    if (i < count) {
+        mat4MultiplyNeon(&dest[i], &a[i], &b[i]);
+    }
+
+    return dest;
+}
+
+static TmVec4 *
+mat4TransformVec4BatchNeon(TmVec4 *dest, TmMat4 const *m, TmVec4 const *vectors, size_t count)
+{
+    TmScalar const *pM = (TmScalar const *)m;
+    float32x4_t columns[4];
+    size_t i = 0;
+
+    for (int k = 0; k < 4; ++k) {
+        columns[k] = vld1q_f32(pM + 4 * k);
+    }
+    // Four vectors per iteration: vld4q de-interleaves them so that each
+    // lane holds one vector, and vst4q interleaves the results back.
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t const v = vld4q_f32((TmScalar const *)&vectors[i]);
+        float32x4x4_t results;
+
+        for (int r = 0; r < 4; ++r) {
+            float32x4_t result;
+
+            result = vmulq_n_f32(v.val[0], pM[r]);
+            result = vaddq_f32(result, vmulq_n_f32(v.val[1], pM[4 + r]));
+            result = vaddq_f32(result, vmulq_n_f32(v.val[2], pM[8 + r]));
+            result = vaddq_f32(result, vmulq_n_f32(v.val[3], pM[12 + r]));
+            results.val[r] = result;
+        }
+        vst4q_f32((TmScalar *)&dest[i], results);
+    }
+    for (; i < count; ++i) {
+        TmScalar const *pVector = (TmScalar const *)&vectors[i];
+
+        vst1q_f32((TmScalar *)&dest[i], linearCombinationNeon(columns, pVector));
+    }
+
+    return dest;
+}
+
+static TmVec3 *
+mat4TransformPointsVec3BatchNeon(TmVec3 *dest, TmMat4 const *m, TmVec3 const *points, size_t count)
+{
+    size_t i = 0;
+
+    // vld3q/vst3q transpose four points into x, y and z lanes and back.
+    for (; i + 4 <= count; i += 4) {
+        float32x4x3_t const p = vld3q_f32((TmScalar const *)&points[i]);
+        float32x4x3_t result;
+
+        result.val[0] = vmulq_n_f32(p.val[0], m->m11);
+        result.val[0] = vaddq_f32(result.val[0], vmulq_n_f32(p.val[1], m->m12));
+        result.val[0] = vaddq_f32(result.val[0], vmulq_n_f32(p.val[2], m->m13));
+        result.val[0] = vaddq_f32(result.val[0], vdupq_n_f32(m->m14));
+        result.val[1] = vmulq_n_f32(p.val[0], m->m21);
+        result.val[1] = vaddq_f32(result.val[1], vmulq_n_f32(p.val[1], m->m22));
+        result.val[1] = vaddq_f32(result.val[1], vmulq_n_f32(p.val[2], m->m23));
+        result.val[1] = vaddq_f32(result.val[1], vdupq_n_f32(m->m24));
+        result.val[2] = vmulq_n_f32(p.val[0], m->m31);
+        result.val[2] = vaddq_f32(result.val[2], vmulq_n_f32(p.val[1], m->m32));
+        result.val[2] = vaddq_f32(result.val[2], vmulq_n_f32(p.val[2], m->m33));
+        result.val[2] = vaddq_f32(result.val[2], vdupq_n_f32(m->m34));
+        vst3q_f32((TmScalar *)&dest[i], result);
+    }
+    tmMat4KernelsScalar.transformPointsVec3Batch(&dest[i], m, &points[i], count - i);
+
+    return dest;
+}
+
+// 2x2 blocks are held in one register as (b11 b12 b21 b22). NEON has
+// no general shuffle, so each lane selection is built from 64-bit
+// halves; the names list the selected lanes from lane 0 upwards.
+
+static float32x4_t
+swizzle0303Neon(float32x4_t v)
+{
+    float32x2_t const pair = vtrn1_f32(vget_low_f32(v), vrev64_f32(vget_high_f32(v)));
+
+    return vcombine_f32(pair, pair);
+}
+
+static float32x4_t
+swizzle2121Neon(float32x4_t v)
+{
+    float32x2_t const pair = vtrn1_f32(vget_high_f32(v), vrev64_f32(vget_low_f32(v)));
+
+    return vcombine_f32(pair, pair);
+}
+
+static float32x4_t
+swizzle3030Neon(float32x4_t v)
+{
+    float32x2_t const pair = vtrn1_f32(vrev64_f32(vget_high_f32(v)), vget_low_f32(v));
+
+    return vcombine_f32(pair, pair);
+}
+
+// a * b
+static float32x4_t
+mat2MultiplyNeon(float32x4_t a, float32x4_t b)
+{
+    return vaddq_f32(vmulq_f32(a, swizzle0303Neon(b)),
+                     vmulq_f32(vrev64q_f32(a), swizzle2121Neon(b)));
+}
+
+// adj(a) * b
+static float32x4_t
+mat2AdjointMultiplyNeon(float32x4_t a, float32x4_t b)
+{
+    float32x4_t const a3300 = vcombine_f32(vdup_laneq_f32(a, 3), vdup_laneq_f32(a, 0));
+    float32x4_t const a1122 = vcombine_f32(vdup_laneq_f32(a, 1), vdup_laneq_f32(a, 2));
+
+    return vsubq_f32(vmulq_f32(a3300, b), vmulq_f32(a1122, vextq_f32(b, b, 2)));
+}
+
+// a * adj(b)
+static float32x4_t
+mat2MultiplyAdjointNeon(float32x4_t a, float32x4_t b)
+{
+    return vsubq_f32(vmulq_f32(a, swizzle3030Neon(b)),
+                     vmulq_f32(vrev64q_f32(a), swizzle2121Neon(b)));
+}
+
+// Same blockwise inversion as the SSE backend; see sseMat4Inverse.
+static TmMat4 *
+mat4InverseNeon(TmMat4 *dest, TmMat4 const *m)
+{
+    TmScalar const *pM = (TmScalar const *)m;
+    TmScalar *pDest = (TmScalar *)dest;
+    float32x4_t const r0 = vld1q_f32(pM + 0);
+    float32x4_t const r1 = vld1q_f32(pM + 4);
+    float32x4_t const r2 = vld1q_f32(pM + 8);
+    float32x4_t const r3 = vld1q_f32(pM + 12);
+    float32x4_t const a = vcombine_f32(vget_low_f32(r0), vget_low_f32(r1));
+    float32x4_t const b = vcombine_f32(vget_high_f32(r0), vget_high_f32(r1));
+    float32x4_t const c = vcombine_f32(vget_low_f32(r2), vget_low_f32(r3));
+    float32x4_t const d = vcombine_f32(vget_high_f32(r2), vget_high_f32(r3));
+    // (|A| |B| |C| |D|)
+    float32x4_t const blockDeterminants = vsubq_f32(
+        vmulq_f32(vuzp1q_f32(r0, r2), vuzp2q_f32(r1, r3)),
+        vmulq_f32(vuzp2q_f32(r0, r2), vuzp1q_f32(r1, r3)));
+    float32x4_t const detA = vdupq_laneq_f32(blockDeterminants, 0);
+    float32x4_t const detB = vdupq_laneq_f32(blockDeterminants, 1);
+    float32x4_t const detC = vdupq_laneq_f32(blockDeterminants, 2);
+    float32x4_t const detD = vdupq_laneq_f32(blockDeterminants, 3);
+    float32x4_t const adjAB = mat2AdjointMultiplyNeon(a, b);
+    float32x4_t const adjDC = mat2AdjointMultiplyNeon(d, c);
+    float32x4_t const adjDC0213 = vcombine_f32(vzip1_f32(vget_low_f32(adjDC), vget_high_f32(adjDC)),
+                                               vzip2_f32(vget_low_f32(adjDC), vget_high_f32(adjDC)));
+    float32x4_t x = vsubq_f32(vmulq_f32(detD, a), mat2MultiplyNeon(b, adjDC));
+    float32x4_t y = vsubq_f32(vmulq_f32(detB, c), mat2MultiplyAdjointNeon(d, adjAB));
+    float32x4_t z = vsubq_f32(vmulq_f32(detC, b), mat2MultiplyAdjointNeon(a, adjDC));
+    float32x4_t w = vsubq_f32(vmulq_f32(detA, d), mat2MultiplyNeon(c, adjAB));
+    TmScalar const trace = vaddvq_f32(vmulq_f32(adjAB, adjDC0213));
+    TmScalar const determinant = ((vgetq_lane_f32(blockDeterminants, 0) * vgetq_lane_f32(blockDeterminants, 3)) +
+                                  (vgetq_lane_f32(blockDeterminants, 1) * vgetq_lane_f32(blockDeterminants, 2)) -
+                                  trace);
+    TmScalar const signs[4] = {1.0f, -1.0f, -1.0f, 1.0f};
+    float32x4_t scale;
+
+    assert(determinant != 0.0f);
+    scale = vdivq_f32(vld1q_f32(signs), vdupq_n_f32(determinant));
+    x = vmulq_f32(x, scale);
+    y = vmulq_f32(y, scale);
+    z = vmulq_f32(z, scale);
+    w = vmulq_f32(w, scale);
+
+    // Lanes (3 1) and (2 0) of each block, as in the SSE stores
+    vst1q_f32(pDest + 0, vcombine_f32(vtrn2_f32(vget_high_f32(x), vget_low_f32(x)),
+                                      vtrn2_f32(vget_high_f32(y), vget_low_f32(y))));
+    vst1q_f32(pDest + 4, vcombine_f32(vtrn1_f32(vget_high_f32(x), vget_low_f32(x)),
+                                      vtrn1_f32(vget_high_f32(y), vget_low_f32(y))));
+    vst1q_f32(pDest + 8, vcombine_f32(vtrn2_f32(vget_high_f32(z), vget_low_f32(z)),
+                                      vtrn2_f32(vget_high_f32(w), vget_low_f32(w))));
+    vst1q_f32(pDest + 12, vcombine_f32(vtrn1_f32(vget_high_f32(z), vget_low_f32(z)),
+                                       vtrn1_f32(vget_high_f32(w), vget_low_f32(w))));
+
+    return dest;
+}
+
+TmMat4Kernels const tmMat4KernelsNeon = {
+    .add = mat4AddNeon,
+    .multiply = mat4MultiplyNeon,
+    .scalarMultiply = mat4ScalarMultiplyNeon,
+    .transpose = mat4TransposeNeon,
+    .inverse = mat4InverseNeon,
+    .multiplyBatch = mat4MultiplyBatchNeon,
+    .transformVec4Batch = mat4TransformVec4BatchNeon,
+    .transformPointsVec3Batch = mat4TransformPointsVec3BatchNeon
+};
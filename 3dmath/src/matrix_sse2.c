@@ -0,0 +1,255 @@
+#include <assert.h>
+#include <emmintrin.h>
+#include "matrix.h"
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// TmMat4 is only guaranteed scalar alignment, so every column is
+// accessed with unaligned loads and stores. All inputs are loaded
+// before dest is written, which makes dest == a or dest == b safe.
+
+static __m128
+linearCombinationSse2(__m128 const aColumns[4], TmScalar const *bColumn)
+{
+    __m128 result;
+
+    // Same summation order as the scalar backend.
+    result = _mm_mul_ps(aColumns[0], _mm_set1_ps(bColumn[0]));
+    result = _mm_add_ps(result, _mm_mul_ps(aColumns[1], _mm_set1_ps(bColumn[1])));
+    result = _mm_add_ps(result, _mm_mul_ps(aColumns[2], _mm_set1_ps(bColumn[2])));
+    result = _mm_add_ps(result, _mm_mul_ps(aColumns[3], _mm_set1_ps(bColumn[3])));
+
+    return result;
+}
+
+static TmMat4 *
+mat4AddSse2(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar const *pB = (TmScalar const *)b;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m128 sums[4];
+
+    for (int i = 0; i < 4; ++i) {
+        sums[i] = _mm_add_ps(_mm_loadu_ps(pA + 4 * i), _mm_loadu_ps(pB + 4 * i));
+    }
+    for (int i = 0; i < 4; ++i) {
+        _mm_storeu_ps(pDest + 4 * i, sums[i]);
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplySse2(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar const *pB = (TmScalar const *)b;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m128 aColumns[4];
+    __m128 productColumns[4];
+
+    for (int i = 0; i < 4; ++i) {
+        aColumns[i] = _mm_loadu_ps(pA + 4 * i);
+    }
+    for (int i = 0; i < 4; ++i) {
+        productColumns[i] = linearCombinationSse2(aColumns, pB + 4 * i);
+    }
+    for (int i = 0; i < 4; ++i) {
+        _mm_storeu_ps(pDest + 4 * i, productColumns[i]);
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4ScalarMultiplySse2(TmMat4 *dest, TmMat4 const *a, TmScalar x)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m128 const scale = _mm_set1_ps(x);
+
+    for (int i = 0; i < 4; ++i) {
+        _mm_storeu_ps(pDest + 4 * i, _mm_mul_ps(_mm_loadu_ps(pA + 4 * i), scale));
+    }
+
+    return dest;
+}
+
+static TmMat4 *
+mat4TransposeSse2(TmMat4 *dest, TmMat4 const *a)
+{
+    TmScalar const *pA = (TmScalar const *)a;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m128 column1 = _mm_loadu_ps(pA + 0);
+    __m128 column2 = _mm_loadu_ps(pA + 4);
+    __m128 column3 = _mm_loadu_ps(pA + 8);
+    __m128 column4 = _mm_loadu_ps(pA + 12);
+
+    _MM_TRANSPOSE4_PS(column1, column2, column3, column4);
+    _mm_storeu_ps(pDest + 0, column1);
+    _mm_storeu_ps(pDest + 4, column2);
+    _mm_storeu_ps(pDest + 8, column3);
+    _mm_storeu_ps(pDest + 12, column4);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4MultiplyBatchSse2(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b, size_t count)
+{
+    size_t i = 0;
+
+    // A register holds a single column, so two products are interleaved
+    // per iteration instead, giving the adds of one something to overlap
+    // with while the other's wait.
+    for (; i + 2 <= count; i += 2) {
+        TmScalar const *pA = (TmScalar const *)&a[i];
+        TmScalar const *pB = (TmScalar const *)&b[i];
+        TmScalar *pDest = (TmScalar *)&dest[i];
+        __m128 aColumns[2][4];
+        __m128 products[2][4];
+
+        for (int k = 0; k < 4; ++k) {
+            aColumns[0][k] = _mm_loadu_ps(pA + 4 * k);
+            aColumns[1][k] = _mm_loadu_ps(pA + 16 + 4 * k);
+        }
+        for (int k = 0; k < 4; ++k) {
+            products[0][k] = linearCombinationSse2(aColumns[0], pB + 4 * k);
+            products[1][k] = linearCombinationSse2(aColumns[1], pB + 16 + 4 * k);
+        }
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps(pDest + 4 * k, products[0][k]);
+            _mm_storeu_ps(pDest + 16 + 4 * k, products[1][k]);
+        }
+    }
+    if (i < count) {
+        mat4MultiplySse2(&dest[i], &a[i], &b[i]);
+    }
+
+    return dest;
+}
+
+static TmVec4 *
+mat4TransformVec4BatchSse2(TmVec4 *dest, TmMat4 const *m, TmVec4 const *vectors, size_t count)
+{
+    TmScalar const *pM = (TmScalar const *)m;
+    __m128 const column1 = _mm_loadu_ps(pM + 0);
+    __m128 const column2 = _mm_loadu_ps(pM + 4);
+    __m128 const column3 = _mm_loadu_ps(pM + 8);
+    __m128 const column4 = _mm_loadu_ps(pM + 12);
+    __m128 rows[4][4];
+    size_t i = 0;
+
+    // rows[r][c] splats m(r + 1, c + 1) for the transposed loop.
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            rows[r][c] = _mm_set1_ps(pM[4 * c + r]);
+        }
+    }
+
+    // Four vectors per iteration, transposed so that each lane holds one
+    // vector; the sums keep the order of the column loop below.
+    for (; i + 4 <= count; i += 4) {
+        TmScalar const *pVectors = (TmScalar const *)&vectors[i];
+        __m128 v[4];
+        __m128 results[4];
+
+        for (int k = 0; k < 4; ++k) {
+            v[k] = _mm_loadu_ps(pVectors + 4 * k);
+        }
+        _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+        for (int r = 0; r < 4; ++r) {
+            __m128 result;
+
+            result = _mm_mul_ps(rows[r][0], v[0]);
+            result = _mm_add_ps(result, _mm_mul_ps(rows[r][1], v[1]));
+            result = _mm_add_ps(result, _mm_mul_ps(rows[r][2], v[2]));
+            result = _mm_add_ps(result, _mm_mul_ps(rows[r][3], v[3]));
+            results[r] = result;
+        }
+        _MM_TRANSPOSE4_PS(results[0], results[1], results[2], results[3]);
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps((TmScalar *)&dest[i + k], results[k]);
+        }
+    }
+    for (; i < count; ++i) {
+        __m128 const v = _mm_loadu_ps((TmScalar const *)&vectors[i]);
+        __m128 result;
+
+        result = _mm_mul_ps(column1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm_add_ps(result, _mm_mul_ps(column2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        result = _mm_add_ps(result, _mm_mul_ps(column3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        result = _mm_add_ps(result, _mm_mul_ps(column4, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps((TmScalar *)&dest[i], result);
+    }
+
+    return dest;
+}
+
+static TmVec3 *
+mat4TransformPointsVec3BatchSse2(TmVec3 *dest, TmMat4 const *m, TmVec3 const *points, size_t count)
+{
+    __m128 const m11 = _mm_set1_ps(m->m11);
+    __m128 const m21 = _mm_set1_ps(m->m21);
+    __m128 const m31 = _mm_set1_ps(m->m31);
+    __m128 const m12 = _mm_set1_ps(m->m12);
+    __m128 const m22 = _mm_set1_ps(m->m22);
+    __m128 const m32 = _mm_set1_ps(m->m32);
+    __m128 const m13 = _mm_set1_ps(m->m13);
+    __m128 const m23 = _mm_set1_ps(m->m23);
+    __m128 const m33 = _mm_set1_ps(m->m33);
+    __m128 const m14 = _mm_set1_ps(m->m14);
+    __m128 const m24 = _mm_set1_ps(m->m24);
+    __m128 const m34 = _mm_set1_ps(m->m34);
+    size_t i = 0;
+
+    // Four points per iteration, transposed so that each lane holds
+    // one point.
+    for (; i + 4 <= count; i += 4) {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        __m128 resultX;
+        __m128 resultY;
+        __m128 resultZ;
+
+        sseLoadVec3x4(&x, &y, &z, &points[i]);
+        resultX = _mm_mul_ps(m11, x);
+        resultX = _mm_add_ps(resultX, _mm_mul_ps(m12, y));
+        resultX = _mm_add_ps(resultX, _mm_mul_ps(m13, z));
+        resultX = _mm_add_ps(resultX, m14);
+        resultY = _mm_mul_ps(m21, x);
+        resultY = _mm_add_ps(resultY, _mm_mul_ps(m22, y));
+        resultY = _mm_add_ps(resultY, _mm_mul_ps(m23, z));
+        resultY = _mm_add_ps(resultY, m24);
+        resultZ = _mm_mul_ps(m31, x);
+        resultZ = _mm_add_ps(resultZ, _mm_mul_ps(m32, y));
+        resultZ = _mm_add_ps(resultZ, _mm_mul_ps(m33, z));
+        resultZ = _mm_add_ps(resultZ, m34);
+        sseStoreVec3x4(&dest[i], resultX, resultY, resultZ);
+    }
+    tmMat4KernelsScalar.transformPointsVec3Batch(&dest[i], m, &points[i], count - i);
+
+    return dest;
+}
+
+static TmMat4 *
+mat4InverseSse2(TmMat4 *dest, TmMat4 const *a)
+{
+    return sseMat4Inverse(dest, a);
+}
+
+TmMat4Kernels const tmMat4KernelsSse2 = {
+    .add = mat4AddSse2,
+    .multiply = mat4MultiplySse2,
+    .scalarMultiply = mat4ScalarMultiplySse2,
+    .transpose = mat4TransposeSse2,
+    .inverse = mat4InverseSse2,
+    .multiplyBatch = mat4MultiplyBatchSse2,
+    .transformVec4Batch = mat4TransformVec4BatchSse2,
+    .transformPointsVec3Batch = mat4TransformPointsVec3BatchSse2
+};
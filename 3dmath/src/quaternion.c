@@ -0,0 +1,360 @@
+#include <assert.h>
+#include <math.h>
+#include "quaternion.h"
+#include "simd_private.h"
+
+static_assert(sizeof(TmQuat) == sizeof(TmScalar[4]),
+              "TmQuat has unexpected padding");
+
+// sin(t theta) / sin(theta) = t (1 + b1 (1 + b2 (1 + ...))) with
+// bi = (t^2 - i^2) / (i (2i + 1)) (cos(theta) - 1), so no trig is
+// needed (Eberly, "A Fast and Accurate Algorithm for Computing SLERP").
+// bi = (u[i] t^2 - v[i]) (cos(theta) - 1). The series is truncated
+// after 12 terms and the last term is scaled by 1.894, which keeps the
+// error below 1e-6 over the whole shorter arc.
+#define SLERP_LAST_TERM_SCALE 1.894f
+
+TmScalar const tmSlerpU[TM_SLERP_TERMS] = {
+    1.0f / (1.0f * 3.0f),
+    1.0f / (2.0f * 5.0f),
+    1.0f / (3.0f * 7.0f),
+    1.0f / (4.0f * 9.0f),
+    1.0f / (5.0f * 11.0f),
+    1.0f / (6.0f * 13.0f),
+    1.0f / (7.0f * 15.0f),
+    1.0f / (8.0f * 17.0f),
+    1.0f / (9.0f * 19.0f),
+    1.0f / (10.0f * 21.0f),
+    1.0f / (11.0f * 23.0f),
+    SLERP_LAST_TERM_SCALE / (12.0f * 25.0f)
+};
+
+TmScalar const tmSlerpV[TM_SLERP_TERMS] = {
+    1.0f / 3.0f,
+    2.0f / 5.0f,
+    3.0f / 7.0f,
+    4.0f / 9.0f,
+    5.0f / 11.0f,
+    6.0f / 13.0f,
+    7.0f / 15.0f,
+    8.0f / 17.0f,
+    9.0f / 19.0f,
+    10.0f / 21.0f,
+    11.0f / 23.0f,
+    SLERP_LAST_TERM_SCALE * 12.0f / 25.0f
+};
+
+#undef SLERP_LAST_TERM_SCALE
+
+// The SIMD backends evaluate exactly these expressions, in this order,
+// for each lane.
+static TmQuat
+quatNlerpOne(TmQuat p, TmQuat q, TmScalar t)
+{
+    TmScalar const cosTheta = (p.x * q.x) + (p.y * q.y) + (p.z * q.z) + (p.w * q.w);
+    TmScalar const signedT = (cosTheta < 0.0f) ? -t : t;
+    TmScalar const d = 1.0f - t;
+    TmQuat r;
+    TmScalar length;
+
+    r.x = (d * p.x) + (signedT * q.x);
+    r.y = (d * p.y) + (signedT * q.y);
+    r.z = (d * p.z) + (signedT * q.z);
+    r.w = (d * p.w) + (signedT * q.w);
+    length = tmScalarSqrt((r.x * r.x) + (r.y * r.y) + (r.z * r.z) + (r.w * r.w));
+    r.x = r.x / length;
+    r.y = r.y / length;
+    r.z = r.z / length;
+    r.w = r.w / length;
+
+    return r;
+}
+
+static TmQuat
+quatSlerpOne(TmQuat p, TmQuat q, TmScalar t)
+{
+    TmScalar cosTheta = (p.x * q.x) + (p.y * q.y) + (p.z * q.z) + (p.w * q.w);
+    TmScalar const signedT = (cosTheta < 0.0f) ? -t : t;
+    TmScalar const d = 1.0f - t;
+    TmScalar const tSquared = t * t;
+    TmScalar const dSquared = d * d;
+    TmScalar cosThetaMinusOne;
+    TmScalar seriesT = 1.0f;
+    TmScalar seriesD = 1.0f;
+    TmScalar weightP;
+    TmScalar weightQ;
+    TmQuat r;
+
+    if (cosTheta < 0.0f) {
+        cosTheta = -cosTheta;
+    }
+    cosThetaMinusOne = cosTheta - 1.0f;
+    for (int i = TM_SLERP_TERMS - 1; i >= 0; --i) {
+        seriesT = 1.0f + (((tmSlerpU[i] * tSquared) - tmSlerpV[i]) * cosThetaMinusOne) * seriesT;
+        seriesD = 1.0f + (((tmSlerpU[i] * dSquared) - tmSlerpV[i]) * cosThetaMinusOne) * seriesD;
+    }
+    weightP = d * seriesD;
+    weightQ = signedT * seriesT;
+
+    r.x = (weightP * p.x) + (weightQ * q.x);
+    r.y = (weightP * p.y) + (weightQ * q.y);
+    r.z = (weightP * p.z) + (weightQ * q.z);
+    r.w = (weightP * p.w) + (weightQ * q.w);
+
+    return r;
+}
+
+static TmQuat *
+quatNlerpBatchScalar(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = quatNlerpOne(p[i], q[i], t[i]);
+    }
+
+    return dest;
+}
+
+static TmQuat *
+quatSlerpBatchScalar(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = quatSlerpOne(p[i], q[i], t[i]);
+    }
+
+    return dest;
+}
+
+TmQuatKernels const tmQuatKernelsScalar = {
+    .nlerpBatch = quatNlerpBatchScalar,
+    .slerpBatch = quatSlerpBatchScalar
+};
+
+TmQuat *
+tmQuatConjugate(TmQuat *dest, TmQuat const *q)
+{
+    dest->x = -q->x;
+    dest->y = -q->y;
+    dest->z = -q->z;
+    dest->w = q->w;
+
+    return dest;
+}
+
+TmScalar
+tmQuatDot(TmQuat const *p, TmQuat const *q)
+{
+    return (p->x * q->x) + (p->y * q->y) + (p->z * q->z) + (p->w * q->w);
+}
+
+TmQuat *
+tmQuatFromAxisAngle(TmQuat *dest, TmVec3 const *normal, TmScalar angle)
+{
+    TmScalar halfAngleSin;
+    TmScalar halfAngleCos;
+
+    tmScalarSinCos(0.5f * angle, &halfAngleSin, &halfAngleCos);
+    dest->x = normal->x * halfAngleSin;
+    dest->y = normal->y * halfAngleSin;
+    dest->z = normal->z * halfAngleSin;
+    dest->w = halfAngleCos;
+
+    return dest;
+}
+
+TmQuat *
+tmQuatFromMat4(TmQuat *dest, TmMat4 const *m)
+{
+    TmScalar const trace = m->m11 + m->m22 + m->m33;
+    TmQuat result;
+    TmScalar s;
+
+    // Shepperd's method: divide by the largest of the four possible
+    // denominators to stay accurate near 180 degree rotations.
+    if (trace > 0.0f) {
+        s = 2.0f * tmScalarSqrt(trace + 1.0f);
+        result.w = 0.25f * s;
+        result.x = (m->m32 - m->m23) / s;
+        result.y = (m->m13 - m->m31) / s;
+        result.z = (m->m21 - m->m12) / s;
+    } else if (m->m11 > m->m22 && m->m11 > m->m33) {
+        s = 2.0f * tmScalarSqrt(1.0f + m->m11 - m->m22 - m->m33);
+        result.w = (m->m32 - m->m23) / s;
+        result.x = 0.25f * s;
+        result.y = (m->m12 + m->m21) / s;
+        result.z = (m->m13 + m->m31) / s;
+    } else if (m->m22 > m->m33) {
+        s = 2.0f * tmScalarSqrt(1.0f + m->m22 - m->m11 - m->m33);
+        result.w = (m->m13 - m->m31) / s;
+        result.x = (m->m12 + m->m21) / s;
+        result.y = 0.25f * s;
+        result.z = (m->m23 + m->m32) / s;
+    } else {
+        s = 2.0f * tmScalarSqrt(1.0f + m->m33 - m->m11 - m->m22);
+        result.w = (m->m21 - m->m12) / s;
+        result.x = (m->m13 + m->m31) / s;
+        result.y = (m->m23 + m->m32) / s;
+        result.z = 0.25f * s;
+    }
+    *dest = result;
+
+    return dest;
+}
+
+TmQuat *
+tmQuatMultiply(TmQuat *dest, TmQuat const *a, TmQuat const *b)
+{
+    TmQuat product;
+
+    product.x = (a->w * b->x) + (a->x * b->w) + (a->y * b->z) - (a->z * b->y);
+    product.y = (a->w * b->y) - (a->x * b->z) + (a->y * b->w) + (a->z * b->x);
+    product.z = (a->w * b->z) + (a->x * b->y) - (a->y * b->x) + (a->z * b->w);
+    product.w = (a->w * b->w) - (a->x * b->x) - (a->y * b->y) - (a->z * b->z);
+    *dest = product;
+
+    return dest;
+}
+
+TmQuat *
+tmQuatNormalize(TmQuat *dest, TmQuat const *q)
+{
+    TmScalar length;
+
+    length = tmScalarSqrt(tmQuatDot(q, q));
+    assert(length != 0.0f);
+    dest->x = q->x / length;
+    dest->y = q->y / length;
+    dest->z = q->z / length;
+    dest->w = q->w / length;
+
+    return dest;
+}
+
+TmVec3 *
+tmQuatRotateVec3(TmVec3 *dest, TmQuat const *q, TmVec3 const *v)
+{
+    TmVec3 const axis = {q->x, q->y, q->z};
+    TmVec3 twiceCross;
+    TmVec3 crossOfCross;
+    TmVec3 result;
+
+    // v + w (2 axis x v) + axis x (2 axis x v)
+    tmVec3Cross(&twiceCross, &axis, v);
+    tmVec3Scale(&twiceCross, 2.0f, &twiceCross);
+    tmVec3Cross(&crossOfCross, &axis, &twiceCross);
+    result.x = v->x + (q->w * twiceCross.x) + crossOfCross.x;
+    result.y = v->y + (q->w * twiceCross.y) + crossOfCross.y;
+    result.z = v->z + (q->w * twiceCross.z) + crossOfCross.z;
+    *dest = result;
+
+    return dest;
+}
+
+TmMat4 *
+tmQuatToMat4(TmMat4 *dest, TmQuat const *q)
+{
+    TmScalar const xx = q->x * q->x;
+    TmScalar const yy = q->y * q->y;
+    TmScalar const zz = q->z * q->z;
+    TmScalar const xy = q->x * q->y;
+    TmScalar const xz = q->x * q->z;
+    TmScalar const yz = q->y * q->z;
+    TmScalar const wx = q->w * q->x;
+    TmScalar const wy = q->w * q->y;
+    TmScalar const wz = q->w * q->z;
+
+    dest->m11 = 1.0f - 2.0f * (yy + zz);
+    dest->m21 = 2.0f * (xy + wz);
+    dest->m31 = 2.0f * (xz - wy);
+    dest->m41 = 0.0f;
+
+    dest->m12 = 2.0f * (xy - wz);
+    dest->m22 = 1.0f - 2.0f * (xx + zz);
+    dest->m32 = 2.0f * (yz + wx);
+    dest->m42 = 0.0f;
+
+    dest->m13 = 2.0f * (xz + wy);
+    dest->m23 = 2.0f * (yz - wx);
+    dest->m33 = 1.0f - 2.0f * (xx + yy);
+    dest->m43 = 0.0f;
+
+    dest->m14 = 0.0f;
+    dest->m24 = 0.0f;
+    dest->m34 = 0.0f;
+    dest->m44 = 1.0f;
+
+    return dest;
+}
+
+TmQuat *
+tmQuatNlerp(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar t)
+{
+    *dest = quatNlerpOne(*p, *q, t);
+
+    return dest;
+}
+
+TmQuat *
+tmQuatSlerp(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar t)
+{
+    *dest = quatSlerpOne(*p, *q, t);
+
+    return dest;
+}
+
+TmQuat *
+tmQuatNlerpBatch(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    return tmSimdQuatKernels()->nlerpBatch(dest, p, q, t, count);
+}
+
+TmQuat *
+tmQuatSlerpBatch(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    return tmSimdQuatKernels()->slerpBatch(dest, p, q, t, count);
+}
+
+TmDualQuat *
+tmDualQuatFromMat4(TmDualQuat *dest, TmMat4 const *m)
+{
+    TmVec3 const translation = {m->m14, m->m24, m->m34};
+    TmQuat rotation;
+
+    tmQuatFromMat4(&rotation, m);
+
+    return tmDualQuatFromRotationTranslation(dest, &rotation, &translation);
+}
+
+TmDualQuat *
+tmDualQuatFromRotationTranslation(TmDualQuat *dest, TmQuat const *rotation, TmVec3 const *translation)
+{
+    TmQuat const pureTranslation = {translation->x, translation->y, translation->z, 0.0f};
+
+    dest->real = *rotation;
+    tmQuatMultiply(&dest->dual, &pureTranslation, rotation);
+    dest->dual.x *= 0.5f;
+    dest->dual.y *= 0.5f;
+    dest->dual.z *= 0.5f;
+    dest->dual.w *= 0.5f;
+
+    return dest;
+}
+
+TmVec3 *
+tmDualQuatTransformPoint(TmVec3 *dest, TmDualQuat const *dq, TmVec3 const *p)
+{
+    TmQuat const *real = &dq->real;
+    TmQuat const *dual = &dq->dual;
+    TmVec3 const axis = {real->x, real->y, real->z};
+    TmVec3 const dualAxis = {dual->x, dual->y, dual->z};
+    TmVec3 cross;
+    TmVec3 result;
+
+    // The translation is 2 dual * conjugate(real).
+    tmQuatRotateVec3(&result, real, p);
+    tmVec3Cross(&cross, &axis, &dualAxis);
+    dest->x = result.x + 2.0f * ((real->w * dual->x) - (dual->w * real->x) + cross.x);
+    dest->y = result.y + 2.0f * ((real->w * dual->y) - (dual->w * real->y) + cross.y);
+    dest->z = result.z + 2.0f * ((real->w * dual->z) - (dual->w * real->z) + cross.z);
+
+    return dest;
+}
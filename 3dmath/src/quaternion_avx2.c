@@ -0,0 +1,152 @@
+#include <assert.h>
+#include <immintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// Eight quaternions are transposed into x, y, z and w registers and
+// interpolated lane-wise with the same operations, in the same order, as
+// the scalar kernels in quaternion.c. Tails fall back to those kernels.
+
+static __m256
+combineHalvesAvx2(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+// Transposes eight quaternions into x, y, z and w registers.
+static void
+loadQuat8Avx2(__m256 *x, __m256 *y, __m256 *z, __m256 *w, TmQuat const *quats)
+{
+    __m128 x0, y0, z0, w0, x1, y1, z1, w1;
+
+    sseLoadVec4x4(&x0, &y0, &z0, &w0, (TmVec4 const *)&quats[0]);
+    sseLoadVec4x4(&x1, &y1, &z1, &w1, (TmVec4 const *)&quats[4]);
+    *x = combineHalvesAvx2(x0, x1);
+    *y = combineHalvesAvx2(y0, y1);
+    *z = combineHalvesAvx2(z0, z1);
+    *w = combineHalvesAvx2(w0, w1);
+}
+
+// Inverse of loadQuat8Avx2.
+static void
+storeQuat8Avx2(TmQuat *quats, __m256 x, __m256 y, __m256 z, __m256 w)
+{
+    sseStoreVec4x4((TmVec4 *)&quats[0],
+                   _mm256_castps256_ps128(x),
+                   _mm256_castps256_ps128(y),
+                   _mm256_castps256_ps128(z),
+                   _mm256_castps256_ps128(w));
+    sseStoreVec4x4((TmVec4 *)&quats[4],
+                   _mm256_extractf128_ps(x, 1),
+                   _mm256_extractf128_ps(y, 1),
+                   _mm256_extractf128_ps(z, 1),
+                   _mm256_extractf128_ps(w, 1));
+}
+
+// Flips t (and, for slerp, cos(theta)) where p . q < 0 by XOR-ing in
+// the sign bit, which is exactly what scalar negation does.
+static __m256
+shorterArcMaskAvx2(__m256 cosTheta)
+{
+    return _mm256_and_ps(_mm256_cmp_ps(cosTheta, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_set1_ps(-0.0f));
+}
+
+static __m256
+quatDotAvx2(__m256 px, __m256 py, __m256 pz, __m256 pw, __m256 qx, __m256 qy, __m256 qz, __m256 qw)
+{
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, qx), _mm256_mul_ps(py, qy)),
+                                 _mm256_mul_ps(pz, qz)),
+                      _mm256_mul_ps(pw, qw));
+}
+
+static __m256
+lerpAvx2(__m256 d, __m256 p, __m256 t, __m256 q)
+{
+    return _mm256_add_ps(_mm256_mul_ps(d, p), _mm256_mul_ps(t, q));
+}
+
+static TmQuat *
+quatNlerpBatchAvx2(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 px, py, pz, pw, qx, qy, qz, qw;
+        __m256 rx, ry, rz, rw, length;
+        __m256 const ti = _mm256_loadu_ps(t + i);
+        __m256 const d = _mm256_sub_ps(one, ti);
+        __m256 signedT;
+
+        loadQuat8Avx2(&px, &py, &pz, &pw, &p[i]);
+        loadQuat8Avx2(&qx, &qy, &qz, &qw, &q[i]);
+        signedT = _mm256_xor_ps(ti, shorterArcMaskAvx2(quatDotAvx2(px, py, pz, pw, qx, qy, qz, qw)));
+
+        rx = lerpAvx2(d, px, signedT, qx);
+        ry = lerpAvx2(d, py, signedT, qy);
+        rz = lerpAvx2(d, pz, signedT, qz);
+        rw = lerpAvx2(d, pw, signedT, qw);
+        length = _mm256_sqrt_ps(quatDotAvx2(rx, ry, rz, rw, rx, ry, rz, rw));
+        storeQuat8Avx2(&dest[i],
+                       _mm256_div_ps(rx, length),
+                       _mm256_div_ps(ry, length),
+                       _mm256_div_ps(rz, length),
+                       _mm256_div_ps(rw, length));
+    }
+    tmQuatKernelsScalar.nlerpBatch(&dest[i], &p[i], &q[i], t + i, count - i);
+
+    return dest;
+}
+
+static TmQuat *
+quatSlerpBatchAvx2(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 px, py, pz, pw, qx, qy, qz, qw;
+        __m256 const ti = _mm256_loadu_ps(t + i);
+        __m256 const d = _mm256_sub_ps(one, ti);
+        __m256 const tSquared = _mm256_mul_ps(ti, ti);
+        __m256 const dSquared = _mm256_mul_ps(d, d);
+        __m256 cosTheta, mask, cosThetaMinusOne, weightP, weightQ;
+        __m256 seriesT = one;
+        __m256 seriesD = one;
+
+        loadQuat8Avx2(&px, &py, &pz, &pw, &p[i]);
+        loadQuat8Avx2(&qx, &qy, &qz, &qw, &q[i]);
+        cosTheta = quatDotAvx2(px, py, pz, pw, qx, qy, qz, qw);
+        mask = shorterArcMaskAvx2(cosTheta);
+        cosThetaMinusOne = _mm256_sub_ps(_mm256_xor_ps(cosTheta, mask), one);
+
+        for (int j = TM_SLERP_TERMS - 1; j >= 0; --j) {
+            __m256 const u = _mm256_set1_ps(tmSlerpU[j]);
+            __m256 const v = _mm256_set1_ps(tmSlerpV[j]);
+            __m256 const termT = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(u, tSquared), v), cosThetaMinusOne);
+            __m256 const termD = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(u, dSquared), v), cosThetaMinusOne);
+
+            seriesT = _mm256_add_ps(one, _mm256_mul_ps(termT, seriesT));
+            seriesD = _mm256_add_ps(one, _mm256_mul_ps(termD, seriesD));
+        }
+        weightP = _mm256_mul_ps(d, seriesD);
+        weightQ = _mm256_mul_ps(_mm256_xor_ps(ti, mask), seriesT);
+
+        storeQuat8Avx2(&dest[i],
+                       lerpAvx2(weightP, px, weightQ, qx),
+                       lerpAvx2(weightP, py, weightQ, qy),
+                       lerpAvx2(weightP, pz, weightQ, qz),
+                       lerpAvx2(weightP, pw, weightQ, qw));
+    }
+    tmQuatKernelsScalar.slerpBatch(&dest[i], &p[i], &q[i], t + i, count - i);
+
+    return dest;
+}
+
+TmQuatKernels const tmQuatKernelsAvx2 = {
+    .nlerpBatch = quatNlerpBatchAvx2,
+    .slerpBatch = quatSlerpBatchAvx2
+};
@@ -0,0 +1,111 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// vld4q transposes four quaternions into x, y, z and w registers, which
+// are interpolated lane-wise with the same operations, in the same
+// order, as the scalar kernels in quaternion.c. Tails fall back to those
+// kernels.
+
+// Flips t (and, for slerp, cos(theta)) where p . q < 0 by XOR-ing in
+// the sign bit, which is exactly what scalar negation does.
+static uint32x4_t
+shorterArcMaskNeon(float32x4_t cosTheta)
+{
+    return vandq_u32(vcltq_f32(cosTheta, vdupq_n_f32(0.0f)), vdupq_n_u32(0x80000000u));
+}
+
+static float32x4_t
+flipSignNeon(float32x4_t v, uint32x4_t mask)
+{
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), mask));
+}
+
+static float32x4_t
+quatDotNeon(float32x4x4_t p, float32x4x4_t q)
+{
+    return vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(p.val[0], q.val[0]), vmulq_f32(p.val[1], q.val[1])),
+                               vmulq_f32(p.val[2], q.val[2])),
+                     vmulq_f32(p.val[3], q.val[3]));
+}
+
+static float32x4x4_t
+lerpNeon(float32x4_t d, float32x4x4_t p, float32x4_t t, float32x4x4_t q)
+{
+    float32x4x4_t r;
+
+    for (int k = 0; k < 4; ++k) {
+        r.val[k] = vaddq_f32(vmulq_f32(d, p.val[k]), vmulq_f32(t, q.val[k]));
+    }
+
+    return r;
+}
+
+static TmQuat *
+quatNlerpBatchNeon(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t const pi = vld4q_f32((TmScalar const *)&p[i]);
+        float32x4x4_t const qi = vld4q_f32((TmScalar const *)&q[i]);
+        float32x4_t const ti = vld1q_f32(t + i);
+        float32x4_t const d = vsubq_f32(one, ti);
+        float32x4_t const signedT = flipSignNeon(ti, shorterArcMaskNeon(quatDotNeon(pi, qi)));
+        float32x4x4_t r = lerpNeon(d, pi, signedT, qi);
+        float32x4_t const length = vsqrtq_f32(quatDotNeon(r, r));
+
+        for (int k = 0; k < 4; ++k) {
+            r.val[k] = vdivq_f32(r.val[k], length);
+        }
+        vst4q_f32((TmScalar *)&dest[i], r);
+    }
+    tmQuatKernelsScalar.nlerpBatch(&dest[i], &p[i], &q[i], t + i, count - i);
+
+    return dest;
+}
+
+static TmQuat *
+quatSlerpBatchNeon(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t const pi = vld4q_f32((TmScalar const *)&p[i]);
+        float32x4x4_t const qi = vld4q_f32((TmScalar const *)&q[i]);
+        float32x4_t const ti = vld1q_f32(t + i);
+        float32x4_t const d = vsubq_f32(one, ti);
+        float32x4_t const tSquared = vmulq_f32(ti, ti);
+        float32x4_t const dSquared = vmulq_f32(d, d);
+        float32x4_t const cosTheta = quatDotNeon(pi, qi);
+        uint32x4_t const mask = shorterArcMaskNeon(cosTheta);
+        float32x4_t const cosThetaMinusOne = vsubq_f32(flipSignNeon(cosTheta, mask), one);
+        float32x4_t seriesT = one;
+        float32x4_t seriesD = one;
+
+        for (int j = TM_SLERP_TERMS - 1; j >= 0; --j) {
+            float32x4_t const u = vdupq_n_f32(tmSlerpU[j]);
+            float32x4_t const v = vdupq_n_f32(tmSlerpV[j]);
+            float32x4_t const termT = vmulq_f32(vsubq_f32(vmulq_f32(u, tSquared), v), cosThetaMinusOne);
+            float32x4_t const termD = vmulq_f32(vsubq_f32(vmulq_f32(u, dSquared), v), cosThetaMinusOne);
+
+            seriesT = vaddq_f32(one, vmulq_f32(termT, seriesT));
+            seriesD = vaddq_f32(one, vmulq_f32(termD, seriesD));
+        }
+        vst4q_f32((TmScalar *)&dest[i],
+                  lerpNeon(vmulq_f32(d, seriesD), pi, vmulq_f32(flipSignNeon(ti, mask), seriesT), qi));
+    }
+    tmQuatKernelsScalar.slerpBatch(&dest[i], &p[i], &q[i], t + i, count - i);
+
+    return dest;
+}
+
+TmQuatKernels const tmQuatKernelsNeon = {
+    .nlerpBatch = quatNlerpBatchNeon,
+    .slerpBatch = quatSlerpBatchNeon
+};
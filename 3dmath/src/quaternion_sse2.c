@@ -0,0 +1,116 @@
+#include <assert.h>
+#include <emmintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// Four quaternions are transposed into x, y, z and w registers and
+// interpolated lane-wise with the same operations, in the same order, as
+// the scalar kernels in quaternion.c. Tails fall back to those kernels.
+
+// Flips t (and, for slerp, cos(theta)) where p . q < 0 by XOR-ing in
+// the sign bit, which is exactly what scalar negation does.
+static __m128
+shorterArcMaskSse2(__m128 cosTheta)
+{
+    return _mm_and_ps(_mm_cmplt_ps(cosTheta, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+}
+
+static __m128
+quatDotSse2(__m128 px, __m128 py, __m128 pz, __m128 pw, __m128 qx, __m128 qy, __m128 qz, __m128 qw)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, qx), _mm_mul_ps(py, qy)),
+                                 _mm_mul_ps(pz, qz)),
+                      _mm_mul_ps(pw, qw));
+}
+
+static __m128
+lerpSse2(__m128 d, __m128 p, __m128 t, __m128 q)
+{
+    return _mm_add_ps(_mm_mul_ps(d, p), _mm_mul_ps(t, q));
+}
+
+static TmQuat *
+quatNlerpBatchSse2(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    __m128 const one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 px, py, pz, pw, qx, qy, qz, qw;
+        __m128 rx, ry, rz, rw, length;
+        __m128 const ti = _mm_loadu_ps(t + i);
+        __m128 const d = _mm_sub_ps(one, ti);
+        __m128 signedT;
+
+        sseLoadVec4x4(&px, &py, &pz, &pw, (TmVec4 const *)&p[i]);
+        sseLoadVec4x4(&qx, &qy, &qz, &qw, (TmVec4 const *)&q[i]);
+        signedT = _mm_xor_ps(ti, shorterArcMaskSse2(quatDotSse2(px, py, pz, pw, qx, qy, qz, qw)));
+
+        rx = lerpSse2(d, px, signedT, qx);
+        ry = lerpSse2(d, py, signedT, qy);
+        rz = lerpSse2(d, pz, signedT, qz);
+        rw = lerpSse2(d, pw, signedT, qw);
+        length = _mm_sqrt_ps(quatDotSse2(rx, ry, rz, rw, rx, ry, rz, rw));
+        sseStoreVec4x4((TmVec4 *)&dest[i],
+                       _mm_div_ps(rx, length),
+                       _mm_div_ps(ry, length),
+                       _mm_div_ps(rz, length),
+                       _mm_div_ps(rw, length));
+    }
+    tmQuatKernelsScalar.nlerpBatch(&dest[i], &p[i], &q[i], t + i, count - i);
+
+    return dest;
+}
+
+static TmQuat *
+quatSlerpBatchSse2(TmQuat *dest, TmQuat const *p, TmQuat const *q, TmScalar const *t, size_t count)
+{
+    __m128 const one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 px, py, pz, pw, qx, qy, qz, qw;
+        __m128 const ti = _mm_loadu_ps(t + i);
+        __m128 const d = _mm_sub_ps(one, ti);
+        __m128 const tSquared = _mm_mul_ps(ti, ti);
+        __m128 const dSquared = _mm_mul_ps(d, d);
+        __m128 cosTheta, mask, cosThetaMinusOne, weightP, weightQ;
+        __m128 seriesT = one;
+        __m128 seriesD = one;
+
+        sseLoadVec4x4(&px, &py, &pz, &pw, (TmVec4 const *)&p[i]);
+        sseLoadVec4x4(&qx, &qy, &qz, &qw, (TmVec4 const *)&q[i]);
+        cosTheta = quatDotSse2(px, py, pz, pw, qx, qy, qz, qw);
+        mask = shorterArcMaskSse2(cosTheta);
+        cosThetaMinusOne = _mm_sub_ps(_mm_xor_ps(cosTheta, mask), one);
+
+        for (int j = TM_SLERP_TERMS - 1; j >= 0; --j) {
+            __m128 const u = _mm_set1_ps(tmSlerpU[j]);
+            __m128 const v = _mm_set1_ps(tmSlerpV[j]);
+            __m128 const termT = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, tSquared), v), cosThetaMinusOne);
+            __m128 const termD = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, dSquared), v), cosThetaMinusOne);
+
+            seriesT = _mm_add_ps(one, _mm_mul_ps(termT, seriesT));
+            seriesD = _mm_add_ps(one, _mm_mul_ps(termD, seriesD));
+        }
+        weightP = _mm_mul_ps(d, seriesD);
+        weightQ = _mm_mul_ps(_mm_xor_ps(ti, mask), seriesT);
+
+        sseStoreVec4x4((TmVec4 *)&dest[i],
+                       lerpSse2(weightP, px, weightQ, qx),
+                       lerpSse2(weightP, py, weightQ, qy),
+                       lerpSse2(weightP, pz, weightQ, qz),
+                       lerpSse2(weightP, pw, weightQ, qw));
+    }
+    tmQuatKernelsScalar.slerpBatch(&dest[i], &p[i], &q[i], t + i, count - i);
+
+    return dest;
+}
+
+TmQuatKernels const tmQuatKernelsSse2 = {
+    .nlerpBatch = quatNlerpBatchSse2,
+    .slerpBatch = quatSlerpBatchSse2
+};
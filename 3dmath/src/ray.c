@@ -0,0 +1,122 @@
+#include <assert.h>
+#include <math.h>
+#include "ray.h"
+#include "ray_private.h"
+#include "simd_private.h"
+
+static_assert(sizeof(TmTriangle) == sizeof(TmScalar[9]),
+              "TmTriangle has unexpected padding");
+
+static size_t
+intersectAabbBatchScalar(TmScalar *t, TmRay const *ray, TmScalar tMax, TmAabb const *boxes, size_t first, size_t count)
+{
+    TmVec3 const inverseDirection = rayInverseDirection(ray);
+    size_t hits = 0;
+
+    for (size_t i = first; i < count; ++i) {
+        if (raySlabTest(&ray->origin, &inverseDirection, &boxes[i], tMax, &t[i])) {
+            ++hits;
+        } else {
+            t[i] = INFINITY;
+        }
+    }
+
+    return hits;
+}
+
+static size_t
+intersectSphereBatchScalar(TmScalar *t, TmRay const *ray, TmScalar tMax, TmSphere const *spheres, size_t first, size_t count)
+{
+    TmScalar const directionSqLength = tmVec3Dot(&ray->direction, &ray->direction);
+    size_t hits = 0;
+
+    for (size_t i = first; i < count; ++i) {
+        if (raySphereTest(ray, directionSqLength, &spheres[i], tMax, &t[i])) {
+            ++hits;
+        } else {
+            t[i] = INFINITY;
+        }
+    }
+
+    return hits;
+}
+
+static size_t
+intersectTriangleBatchScalar(TmScalar *t, TmRay const *ray, TmScalar tMax, TmTriangle const *triangles, size_t first, size_t count)
+{
+    size_t hits = 0;
+
+    for (size_t i = first; i < count; ++i) {
+        if (rayTriangleTest(ray, &triangles[i], tMax, &t[i])) {
+            ++hits;
+        } else {
+            t[i] = INFINITY;
+        }
+    }
+
+    return hits;
+}
+
+TmRayKernels const tmRayKernelsScalar = {
+    .intersectAabbBatch = intersectAabbBatchScalar,
+    .intersectSphereBatch = intersectSphereBatchScalar,
+    .intersectTriangleBatch = intersectTriangleBatchScalar
+};
+
+bool
+tmRayIntersectAabb(TmRay const *ray, TmAabb const *box, TmScalar tMax, TmScalar *tNear)
+{
+    TmVec3 const inverseDirection = rayInverseDirection(ray);
+    TmScalar t;
+
+    if (!raySlabTest(&ray->origin, &inverseDirection, box, tMax, &t)) {
+        return false;
+    }
+    *tNear = t;
+
+    return true;
+}
+
+bool
+tmRayIntersectSphere(TmRay const *ray, TmSphere const *sphere, TmScalar tMax, TmScalar *tNear)
+{
+    TmScalar t;
+
+    if (!raySphereTest(ray, tmVec3Dot(&ray->direction, &ray->direction), sphere, tMax, &t)) {
+        return false;
+    }
+    *tNear = t;
+
+    return true;
+}
+
+bool
+tmRayIntersectTriangle(TmRay const *ray, TmTriangle const *triangle, TmScalar tMax, TmScalar *t)
+{
+    TmScalar hitT;
+
+    if (!rayTriangleTest(ray, triangle, tMax, &hitT)) {
+        return false;
+    }
+    *t = hitT;
+
+    return true;
+}
+
+size_t
+tmRayIntersectAabbBatch(TmScalar *t, TmRay const *ray, TmScalar tMax, TmAabb const *boxes, size_t count)
+{
+    return tmSimdRayKernels()->intersectAabbBatch(t, ray, tMax, boxes, 0, count);
+}
+
+size_t
+tmRayIntersectSphereBatch(TmScalar *t, TmRay const *ray, TmScalar tMax, TmSphere const *spheres, size_t count)
+{
+    return tmSimdRayKernels()->intersectSphereBatch(t, ray, tMax, spheres, 0, count);
+}
+
+size_t
+tmRayIntersectTriangleBatch(TmScalar *t, TmRay const *ray, TmScalar tMax, TmTriangle const *triangles, size_t count)
+{
+    return tmSimdRayKernels()->intersectTriangleBatch(t, ray, tMax, triangles, 0, count);
+}
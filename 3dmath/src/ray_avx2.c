@@ -0,0 +1,177 @@
+#include <assert.h>
+#include <math.h>
+#include <immintrin.h>
+#include "ray_private.h"
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// Eight primitives are transposed into component registers and tested
+// against the broadcast ray with the same operations, in the same
+// order, as the scalar tests in ray_private.h. Where those branch, both
+// sides are evaluated and the lanes selected. Tails fall back to the
+// scalar kernels.
+
+static __m256
+combineHalvesAvx2(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+static __m256
+dotAvx2(__m256 const p[3], __m256 const q[3])
+{
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p[0], q[0]), _mm256_mul_ps(p[1], q[1])),
+                         _mm256_mul_ps(p[2], q[2]));
+}
+
+static void
+crossAvx2(__m256 dest[3], __m256 const p[3], __m256 const q[3])
+{
+    dest[0] = _mm256_sub_ps(_mm256_mul_ps(p[1], q[2]), _mm256_mul_ps(p[2], q[1]));
+    dest[1] = _mm256_sub_ps(_mm256_mul_ps(p[2], q[0]), _mm256_mul_ps(p[0], q[2]));
+    dest[2] = _mm256_sub_ps(_mm256_mul_ps(p[0], q[1]), _mm256_mul_ps(p[1], q[0]));
+}
+
+static void
+broadcastVec3Avx2(__m256 dest[3], TmVec3 const *v)
+{
+    dest[0] = _mm256_set1_ps(v->x);
+    dest[1] = _mm256_set1_ps(v->y);
+    dest[2] = _mm256_set1_ps(v->z);
+}
+
+// Stores the entry t of hit lanes and INFINITY for the rest, and
+// returns the number of hits.
+static size_t
+storeHitsAvx2(TmScalar *t, __m256 hit, __m256 hitT)
+{
+    _mm256_storeu_ps(t, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), hitT, hit));
+
+    return (size_t)__builtin_popcount((unsigned)_mm256_movemask_ps(hit));
+}
+
+static size_t
+intersectAabbBatchAvx2(TmScalar *t, TmRay const *ray, TmScalar tMax, TmAabb const *boxes, size_t first, size_t count)
+{
+    TmVec3 const inverseDirection = rayInverseDirection(ray);
+    __m256 origin[3], inverse[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Avx2(origin, &ray->origin);
+    broadcastVec3Avx2(inverse, &inverseDirection);
+    for (; i + 8 <= count; i += 8) {
+        __m128 lowMin[3], lowMax[3], highMin[3], highMax[3];
+        __m256 tEnter = _mm256_setzero_ps();
+        __m256 tExit = _mm256_set1_ps(tMax);
+
+        sseLoadAabb4(lowMin, lowMax, &boxes[i]);
+        sseLoadAabb4(highMin, highMax, &boxes[i + 4]);
+        for (int k = 0; k < 3; ++k) {
+            __m256 const min = combineHalvesAvx2(lowMin[k], highMin[k]);
+            __m256 const max = combineHalvesAvx2(lowMax[k], highMax[k]);
+            __m256 const t0 = _mm256_mul_ps(_mm256_sub_ps(min, origin[k]), inverse[k]);
+            __m256 const t1 = _mm256_mul_ps(_mm256_sub_ps(max, origin[k]), inverse[k]);
+
+            // vminps and vmaxps return their second operand unless the
+            // comparison holds, which is how the scalar test treats NaN.
+            tEnter = _mm256_max_ps(_mm256_min_ps(t1, t0), tEnter);
+            tExit = _mm256_min_ps(_mm256_max_ps(t0, t1), tExit);
+        }
+        hits += storeHitsAvx2(&t[i], _mm256_cmp_ps(tEnter, tExit, _CMP_LE_OQ), tEnter);
+    }
+
+    return hits + tmRayKernelsScalar.intersectAabbBatch(t, ray, tMax, boxes, i, count);
+}
+
+static size_t
+intersectSphereBatchAvx2(TmScalar *t, TmRay const *ray, TmScalar tMax, TmSphere const *spheres, size_t first, size_t count)
+{
+    __m256 const directionSqLength = _mm256_set1_ps(tmVec3Dot(&ray->direction, &ray->direction));
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 origin[3], direction[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Avx2(origin, &ray->origin);
+    broadcastVec3Avx2(direction, &ray->direction);
+    for (; i + 8 <= count; i += 8) {
+        __m128 low[4], high[4];
+        __m256 offset[3], radius;
+        __m256 b, c, discriminant, outsideT, hitT, hit;
+
+        sseLoadVec4x4(&low[0], &low[1], &low[2], &low[3], (TmVec4 const *)&spheres[i]);
+        sseLoadVec4x4(&high[0], &high[1], &high[2], &high[3], (TmVec4 const *)&spheres[i + 4]);
+        for (int k = 0; k < 3; ++k) {
+            offset[k] = _mm256_sub_ps(origin[k], combineHalvesAvx2(low[k], high[k]));
+        }
+        radius = combineHalvesAvx2(low[3], high[3]);
+        b = dotAvx2(offset, direction);
+        c = _mm256_sub_ps(dotAvx2(offset, offset), _mm256_mul_ps(radius, radius));
+        discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(directionSqLength, c));
+        outsideT = _mm256_div_ps(_mm256_sub_ps(_mm256_xor_ps(b, _mm256_set1_ps(-0.0f)),
+                                               _mm256_sqrt_ps(discriminant)),
+                                 directionSqLength);
+        hitT = _mm256_blendv_ps(outsideT, zero, _mm256_cmp_ps(c, zero, _CMP_LE_OQ));
+        hit = _mm256_and_ps(_mm256_cmp_ps(discriminant, zero, _CMP_NLT_UQ),
+                            _mm256_and_ps(_mm256_cmp_ps(hitT, zero, _CMP_GE_OQ),
+                                          _mm256_cmp_ps(hitT, _mm256_set1_ps(tMax), _CMP_LE_OQ)));
+        hits += storeHitsAvx2(&t[i], hit, hitT);
+    }
+
+    return hits + tmRayKernelsScalar.intersectSphereBatch(t, ray, tMax, spheres, i, count);
+}
+
+static size_t
+intersectTriangleBatchAvx2(TmScalar *t, TmRay const *ray, TmScalar tMax, TmTriangle const *triangles, size_t first, size_t count)
+{
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 origin[3], direction[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Avx2(origin, &ray->origin);
+    broadcastVec3Avx2(direction, &ray->direction);
+    for (; i + 8 <= count; i += 8) {
+        __m128 lowA[3], lowB[3], lowC[3], highA[3], highB[3], highC[3];
+        __m256 edge1[3], edge2[3], p[3], s[3], q[3];
+        __m256 determinant, inverseDeterminant, u, v, hitT, hit;
+
+        sseLoadTriangleVertices4(lowA, lowB, lowC, &triangles[i].a);
+        sseLoadTriangleVertices4(highA, highB, highC, &triangles[i + 4].a);
+        for (int k = 0; k < 3; ++k) {
+            __m256 const a = combineHalvesAvx2(lowA[k], highA[k]);
+
+            edge1[k] = _mm256_sub_ps(combineHalvesAvx2(lowB[k], highB[k]), a);
+            edge2[k] = _mm256_sub_ps(combineHalvesAvx2(lowC[k], highC[k]), a);
+            s[k] = _mm256_sub_ps(origin[k], a);
+        }
+        crossAvx2(p, direction, edge2);
+        determinant = dotAvx2(edge1, p);
+        inverseDeterminant = _mm256_div_ps(one, determinant);
+        u = _mm256_mul_ps(dotAvx2(s, p), inverseDeterminant);
+        crossAvx2(q, s, edge1);
+        v = _mm256_mul_ps(dotAvx2(direction, q), inverseDeterminant);
+        hitT = _mm256_mul_ps(dotAvx2(edge2, q), inverseDeterminant);
+
+        hit = _mm256_and_ps(_mm256_cmp_ps(determinant, zero, _CMP_NEQ_UQ),
+                            _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ),
+                                               _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(hitT, zero, _CMP_GE_OQ),
+                                               _mm256_cmp_ps(hitT, _mm256_set1_ps(tMax), _CMP_LE_OQ)));
+        hits += storeHitsAvx2(&t[i], hit, hitT);
+    }
+
+    return hits + tmRayKernelsScalar.intersectTriangleBatch(t, ray, tMax, triangles, i, count);
+}
+
+TmRayKernels const tmRayKernelsAvx2 = {
+    .intersectAabbBatch = intersectAabbBatchAvx2,
+    .intersectSphereBatch = intersectSphereBatchAvx2,
+    .intersectTriangleBatch = intersectTriangleBatchAvx2
+};
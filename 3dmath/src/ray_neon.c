@@ -0,0 +1,177 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include <math.h>
+#include "ray_private.h"
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// Four primitives are loaded into component registers and tested
+// against the broadcast ray with the same operations, in the same
+// order, as the scalar tests in ray_private.h. Where those branch, both
+// sides are evaluated and the lanes selected. Unlike vminq and vmaxq,
+// the selects treat NaN as the scalar comparisons do. Tails fall back
+// to the scalar kernels.
+
+static float32x4_t
+dotNeon(float32x4_t const p[3], float32x4_t const q[3])
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(p[0], q[0]), vmulq_f32(p[1], q[1])),
+                     vmulq_f32(p[2], q[2]));
+}
+
+static void
+crossNeon(float32x4_t dest[3], float32x4_t const p[3], float32x4_t const q[3])
+{
+    dest[0] = vsubq_f32(vmulq_f32(p[1], q[2]), vmulq_f32(p[2], q[1]));
+    dest[1] = vsubq_f32(vmulq_f32(p[2], q[0]), vmulq_f32(p[0], q[2]));
+    dest[2] = vsubq_f32(vmulq_f32(p[0], q[1]), vmulq_f32(p[1], q[0]));
+}
+
+static void
+broadcastVec3Neon(float32x4_t dest[3], TmVec3 const *v)
+{
+    dest[0] = vdupq_n_f32(v->x);
+    dest[1] = vdupq_n_f32(v->y);
+    dest[2] = vdupq_n_f32(v->z);
+}
+
+// Loads component offset of four consecutive records of stride floats
+// each.
+static float32x4_t
+gatherNeon(float const *records, int stride, int offset)
+{
+    float32x4_t v = vdupq_n_f32(records[offset]);
+
+    v = vld1q_lane_f32(&records[stride + offset], v, 1);
+    v = vld1q_lane_f32(&records[2 * stride + offset], v, 2);
+    v = vld1q_lane_f32(&records[3 * stride + offset], v, 3);
+
+    return v;
+}
+
+// Stores the entry t of hit lanes and INFINITY for the rest, and
+// returns the number of hits.
+static size_t
+storeHitsNeon(TmScalar *t, uint32x4_t hit, float32x4_t hitT)
+{
+    vst1q_f32(t, vbslq_f32(hit, hitT, vdupq_n_f32(INFINITY)));
+
+    return vaddvq_u32(vshrq_n_u32(hit, 31));
+}
+
+static size_t
+intersectAabbBatchNeon(TmScalar *t, TmRay const *ray, TmScalar tMax, TmAabb const *boxes, size_t first, size_t count)
+{
+    TmVec3 const inverseDirection = rayInverseDirection(ray);
+    float32x4_t origin[3], inverse[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Neon(origin, &ray->origin);
+    broadcastVec3Neon(inverse, &inverseDirection);
+    for (; i + 4 <= count; i += 4) {
+        // Each load yields (min, max, min, max) of two boxes.
+        float32x4x3_t const first2 = vld3q_f32((float const *)&boxes[i]);
+        float32x4x3_t const second2 = vld3q_f32((float const *)&boxes[i + 2]);
+        float32x4_t tEnter = vdupq_n_f32(0.0f);
+        float32x4_t tExit = vdupq_n_f32(tMax);
+
+        for (int k = 0; k < 3; ++k) {
+            float32x4_t const min = vuzp1q_f32(first2.val[k], second2.val[k]);
+            float32x4_t const max = vuzp2q_f32(first2.val[k], second2.val[k]);
+            float32x4_t const t0 = vmulq_f32(vsubq_f32(min, origin[k]), inverse[k]);
+            float32x4_t const t1 = vmulq_f32(vsubq_f32(max, origin[k]), inverse[k]);
+            uint32x4_t const isSwapped = vcgtq_f32(t0, t1);
+            float32x4_t const axisEnter = vbslq_f32(isSwapped, t1, t0);
+            float32x4_t const axisExit = vbslq_f32(isSwapped, t0, t1);
+
+            tEnter = vbslq_f32(vcgtq_f32(axisEnter, tEnter), axisEnter, tEnter);
+            tExit = vbslq_f32(vcltq_f32(axisExit, tExit), axisExit, tExit);
+        }
+        hits += storeHitsNeon(&t[i], vcleq_f32(tEnter, tExit), tEnter);
+    }
+
+    return hits + tmRayKernelsScalar.intersectAabbBatch(t, ray, tMax, boxes, i, count);
+}
+
+static size_t
+intersectSphereBatchNeon(TmScalar *t, TmRay const *ray, TmScalar tMax, TmSphere const *spheres, size_t first, size_t count)
+{
+    float32x4_t const directionSqLength = vdupq_n_f32(tmVec3Dot(&ray->direction, &ray->direction));
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+    float32x4_t origin[3], direction[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Neon(origin, &ray->origin);
+    broadcastVec3Neon(direction, &ray->direction);
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t const sphere = vld4q_f32((float const *)&spheres[i]);
+        float32x4_t offset[3];
+        float32x4_t b, c, discriminant, outsideT, hitT;
+        uint32x4_t hit;
+
+        for (int k = 0; k < 3; ++k) {
+            offset[k] = vsubq_f32(origin[k], sphere.val[k]);
+        }
+        b = dotNeon(offset, direction);
+        c = vsubq_f32(dotNeon(offset, offset), vmulq_f32(sphere.val[3], sphere.val[3]));
+        discriminant = vsubq_f32(vmulq_f32(b, b), vmulq_f32(directionSqLength, c));
+        outsideT = vdivq_f32(vsubq_f32(vnegq_f32(b), vsqrtq_f32(discriminant)), directionSqLength);
+        hitT = vbslq_f32(vcleq_f32(c, zero), zero, outsideT);
+        hit = vandq_u32(vmvnq_u32(vcltq_f32(discriminant, zero)),
+                        vandq_u32(vcgeq_f32(hitT, zero), vcleq_f32(hitT, vdupq_n_f32(tMax))));
+        hits += storeHitsNeon(&t[i], hit, hitT);
+    }
+
+    return hits + tmRayKernelsScalar.intersectSphereBatch(t, ray, tMax, spheres, i, count);
+}
+
+static size_t
+intersectTriangleBatchNeon(TmScalar *t, TmRay const *ray, TmScalar tMax, TmTriangle const *triangles, size_t first, size_t count)
+{
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    float32x4_t origin[3], direction[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Neon(origin, &ray->origin);
+    broadcastVec3Neon(direction, &ray->direction);
+    for (; i + 4 <= count; i += 4) {
+        float const *records = (float const *)&triangles[i];
+        float32x4_t edge1[3], edge2[3], p[3], s[3], q[3];
+        float32x4_t determinant, inverseDeterminant, u, v, hitT;
+        uint32x4_t hit;
+
+        for (int k = 0; k < 3; ++k) {
+            float32x4_t const a = gatherNeon(records, 9, k);
+
+            edge1[k] = vsubq_f32(gatherNeon(records, 9, 3 + k), a);
+            edge2[k] = vsubq_f32(gatherNeon(records, 9, 6 + k), a);
+            s[k] = vsubq_f32(origin[k], a);
+        }
+        crossNeon(p, direction, edge2);
+        determinant = dotNeon(edge1, p);
+        inverseDeterminant = vdivq_f32(one, determinant);
+        u = vmulq_f32(dotNeon(s, p), inverseDeterminant);
+        crossNeon(q, s, edge1);
+        v = vmulq_f32(dotNeon(direction, q), inverseDeterminant);
+        hitT = vmulq_f32(dotNeon(edge2, q), inverseDeterminant);
+
+        hit = vandq_u32(vmvnq_u32(vceqq_f32(determinant, zero)), vcgeq_f32(u, zero));
+        hit = vandq_u32(hit, vandq_u32(vcgeq_f32(v, zero), vcleq_f32(vaddq_f32(u, v), one)));
+        hit = vandq_u32(hit, vandq_u32(vcgeq_f32(hitT, zero), vcleq_f32(hitT, vdupq_n_f32(tMax))));
+        hits += storeHitsNeon(&t[i], hit, hitT);
+    }
+
+    return hits + tmRayKernelsScalar.intersectTriangleBatch(t, ray, tMax, triangles, i, count);
+}
+
+TmRayKernels const tmRayKernelsNeon = {
+    .intersectAabbBatch = intersectAabbBatchNeon,
+    .intersectSphereBatch = intersectSphereBatchNeon,
+    .intersectTriangleBatch = intersectTriangleBatchNeon
+};
@@ -0,0 +1,101 @@
+#ifndef GRAPHICS_MATH_RAY_PRIVATE_H
+#define GRAPHICS_MATH_RAY_PRIVATE_H
+
+#include <stdbool.h>
+#include "bounds.h"
+#include "ray.h"
+#include "scalar.h"
+#include "vector.h"
+
+// Slab test against a precomputed 1 / direction, shared by every ray
+// query. Where a zero direction component meets an origin on that slab
+// plane the product is NaN, and the comparisons below ignore it.
+static inline bool
+raySlabTest(TmVec3 const *origin, TmVec3 const *inverseDirection, TmAabb const *box, TmScalar tMax, TmScalar *tNear)
+{
+    TmScalar const origins[3] = {origin->x, origin->y, origin->z};
+    TmScalar const inverses[3] = {inverseDirection->x, inverseDirection->y, inverseDirection->z};
+    TmScalar const mins[3] = {box->min.x, box->min.y, box->min.z};
+    TmScalar const maxs[3] = {box->max.x, box->max.y, box->max.z};
+    TmScalar tEnter = 0.0f;
+    TmScalar tExit = tMax;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        TmScalar t0 = (mins[axis] - origins[axis]) * inverses[axis];
+        TmScalar t1 = (maxs[axis] - origins[axis]) * inverses[axis];
+
+        if (t0 > t1) {
+            TmScalar const swap = t0;
+
+            t0 = t1;
+            t1 = swap;
+        }
+        tEnter = (t0 > tEnter) ? t0 : tEnter;
+        tExit = (t1 < tExit) ? t1 : tExit;
+    }
+    *tNear = tEnter;
+
+    return tEnter <= tExit;
+}
+
+// directionSqLength is the dot product of the direction with itself,
+// which batches compute once. The SIMD backends evaluate the same
+// expressions, in the same order, for each lane.
+static inline bool
+raySphereTest(TmRay const *ray, TmScalar directionSqLength, TmSphere const *sphere, TmScalar tMax, TmScalar *tNear)
+{
+    TmVec3 offset;
+    TmScalar b;
+    TmScalar c;
+    TmScalar discriminant;
+    TmScalar t;
+
+    tmVec3Sub(&offset, &ray->origin, &sphere->center);
+    b = tmVec3Dot(&offset, &ray->direction);
+    c = tmVec3Dot(&offset, &offset) - (sphere->radius * sphere->radius);
+    discriminant = (b * b) - (directionSqLength * c);
+    if (discriminant < 0.0f) {
+        return false;
+    }
+    t = (c <= 0.0f) ? 0.0f : (-b - tmScalarSqrt(discriminant)) / directionSqLength;
+    *tNear = t;
+
+    return t >= 0.0f && t <= tMax;
+}
+
+static inline bool
+rayTriangleTest(TmRay const *ray, TmTriangle const *triangle, TmScalar tMax, TmScalar *t)
+{
+    TmVec3 edge1;
+    TmVec3 edge2;
+    TmVec3 p;
+    TmVec3 s;
+    TmVec3 q;
+    TmScalar determinant;
+    TmScalar inverseDeterminant;
+    TmScalar u;
+    TmScalar v;
+
+    tmVec3Sub(&edge1, &triangle->b, &triangle->a);
+    tmVec3Sub(&edge2, &triangle->c, &triangle->a);
+    tmVec3Cross(&p, &ray->direction, &edge2);
+    determinant = tmVec3Dot(&edge1, &p);
+    inverseDeterminant = 1.0f / determinant;
+    tmVec3Sub(&s, &ray->origin, &triangle->a);
+    u = tmVec3Dot(&s, &p) * inverseDeterminant;
+    tmVec3Cross(&q, &s, &edge1);
+    v = tmVec3Dot(&ray->direction, &q) * inverseDeterminant;
+    *t = tmVec3Dot(&edge2, &q) * inverseDeterminant;
+
+    // Rays in the triangle's plane have a zero determinant.
+    return determinant != 0.0f && u >= 0.0f && v >= 0.0f && u + v <= 1.0f
+        && *t >= 0.0f && *t <= tMax;
+}
+
+static inline TmVec3
+rayInverseDirection(TmRay const *ray)
+{
+    return (TmVec3){1.0f / ray->direction.x, 1.0f / ray->direction.y, 1.0f / ray->direction.z};
+}
+
+#endif /* GRAPHICS_MATH_RAY_PRIVATE_H */
@@ -0,0 +1,163 @@
+#include <assert.h>
+#include <math.h>
+#include <emmintrin.h>
+#include "ray_private.h"
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// Four primitives are transposed into component registers and tested
+// against the broadcast ray with the same operations, in the same
+// order, as the scalar tests in ray_private.h. Where those branch, both
+// sides are evaluated and the lanes selected. Tails fall back to the
+// scalar kernels.
+
+// mask ? a : b
+static __m128
+selectSse2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128
+dotSse2(__m128 const p[3], __m128 const q[3])
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[0], q[0]), _mm_mul_ps(p[1], q[1])),
+                      _mm_mul_ps(p[2], q[2]));
+}
+
+static void
+crossSse2(__m128 dest[3], __m128 const p[3], __m128 const q[3])
+{
+    dest[0] = _mm_sub_ps(_mm_mul_ps(p[1], q[2]), _mm_mul_ps(p[2], q[1]));
+    dest[1] = _mm_sub_ps(_mm_mul_ps(p[2], q[0]), _mm_mul_ps(p[0], q[2]));
+    dest[2] = _mm_sub_ps(_mm_mul_ps(p[0], q[1]), _mm_mul_ps(p[1], q[0]));
+}
+
+static void
+broadcastVec3Sse2(__m128 dest[3], TmVec3 const *v)
+{
+    dest[0] = _mm_set1_ps(v->x);
+    dest[1] = _mm_set1_ps(v->y);
+    dest[2] = _mm_set1_ps(v->z);
+}
+
+// Stores the entry t of hit lanes and INFINITY for the rest, and
+// returns the number of hits.
+static size_t
+storeHitsSse2(TmScalar *t, __m128 hit, __m128 hitT)
+{
+    _mm_storeu_ps(t, selectSse2(hit, hitT, _mm_set1_ps(INFINITY)));
+
+    return (size_t)__builtin_popcount((unsigned)_mm_movemask_ps(hit));
+}
+
+static size_t
+intersectAabbBatchSse2(TmScalar *t, TmRay const *ray, TmScalar tMax, TmAabb const *boxes, size_t first, size_t count)
+{
+    TmVec3 const inverseDirection = rayInverseDirection(ray);
+    __m128 origin[3], inverse[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Sse2(origin, &ray->origin);
+    broadcastVec3Sse2(inverse, &inverseDirection);
+    for (; i + 4 <= count; i += 4) {
+        __m128 min[3], max[3];
+        __m128 tEnter = _mm_setzero_ps();
+        __m128 tExit = _mm_set1_ps(tMax);
+
+        sseLoadAabb4(min, max, &boxes[i]);
+        for (int k = 0; k < 3; ++k) {
+            __m128 const t0 = _mm_mul_ps(_mm_sub_ps(min[k], origin[k]), inverse[k]);
+            __m128 const t1 = _mm_mul_ps(_mm_sub_ps(max[k], origin[k]), inverse[k]);
+
+            // minps and maxps return their second operand unless the
+            // comparison holds, which is how the scalar test treats NaN.
+            tEnter = _mm_max_ps(_mm_min_ps(t1, t0), tEnter);
+            tExit = _mm_min_ps(_mm_max_ps(t0, t1), tExit);
+        }
+        hits += storeHitsSse2(&t[i], _mm_cmple_ps(tEnter, tExit), tEnter);
+    }
+
+    return hits + tmRayKernelsScalar.intersectAabbBatch(t, ray, tMax, boxes, i, count);
+}
+
+static size_t
+intersectSphereBatchSse2(TmScalar *t, TmRay const *ray, TmScalar tMax, TmSphere const *spheres, size_t first, size_t count)
+{
+    __m128 const directionSqLength = _mm_set1_ps(tmVec3Dot(&ray->direction, &ray->direction));
+    __m128 const zero = _mm_setzero_ps();
+    __m128 origin[3], direction[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Sse2(origin, &ray->origin);
+    broadcastVec3Sse2(direction, &ray->direction);
+    for (; i + 4 <= count; i += 4) {
+        __m128 center[3], radius, offset[3];
+        __m128 b, c, discriminant, outsideT, hitT, hit;
+
+        sseLoadVec4x4(&center[0], &center[1], &center[2], &radius, (TmVec4 const *)&spheres[i]);
+        for (int k = 0; k < 3; ++k) {
+            offset[k] = _mm_sub_ps(origin[k], center[k]);
+        }
+        b = dotSse2(offset, direction);
+        c = _mm_sub_ps(dotSse2(offset, offset), _mm_mul_ps(radius, radius));
+        discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(directionSqLength, c));
+        outsideT = _mm_div_ps(_mm_sub_ps(_mm_xor_ps(b, _mm_set1_ps(-0.0f)), _mm_sqrt_ps(discriminant)),
+                              directionSqLength);
+        hitT = selectSse2(_mm_cmple_ps(c, zero), zero, outsideT);
+        hit = _mm_and_ps(_mm_cmpnlt_ps(discriminant, zero),
+                         _mm_and_ps(_mm_cmpge_ps(hitT, zero), _mm_cmple_ps(hitT, _mm_set1_ps(tMax))));
+        hits += storeHitsSse2(&t[i], hit, hitT);
+    }
+
+    return hits + tmRayKernelsScalar.intersectSphereBatch(t, ray, tMax, spheres, i, count);
+}
+
+static size_t
+intersectTriangleBatchSse2(TmScalar *t, TmRay const *ray, TmScalar tMax, TmTriangle const *triangles, size_t first, size_t count)
+{
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 origin[3], direction[3];
+    size_t hits = 0;
+    size_t i = first;
+
+    broadcastVec3Sse2(origin, &ray->origin);
+    broadcastVec3Sse2(direction, &ray->direction);
+    for (; i + 4 <= count; i += 4) {
+        __m128 a[3], b[3], c[3], edge1[3], edge2[3], p[3], s[3], q[3];
+        __m128 determinant, inverseDeterminant, u, v, hitT, hit;
+
+        sseLoadTriangleVertices4(a, b, c, &triangles[i].a);
+        for (int k = 0; k < 3; ++k) {
+            edge1[k] = _mm_sub_ps(b[k], a[k]);
+            edge2[k] = _mm_sub_ps(c[k], a[k]);
+            s[k] = _mm_sub_ps(origin[k], a[k]);
+        }
+        crossSse2(p, direction, edge2);
+        determinant = dotSse2(edge1, p);
+        inverseDeterminant = _mm_div_ps(one, determinant);
+        u = _mm_mul_ps(dotSse2(s, p), inverseDeterminant);
+        crossSse2(q, s, edge1);
+        v = _mm_mul_ps(dotSse2(direction, q), inverseDeterminant);
+        hitT = _mm_mul_ps(dotSse2(edge2, q), inverseDeterminant);
+
+        hit = _mm_and_ps(_mm_cmpneq_ps(determinant, zero), _mm_cmpge_ps(u, zero));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(hitT, zero), _mm_cmple_ps(hitT, _mm_set1_ps(tMax))));
+        hits += storeHitsSse2(&t[i], hit, hitT);
+    }
+
+    return hits + tmRayKernelsScalar.intersectTriangleBatch(t, ray, tMax, triangles, i, count);
+}
+
+TmRayKernels const tmRayKernelsSse2 = {
+    .intersectAabbBatch = intersectAabbBatchSse2,
+    .intersectSphereBatch = intersectSphereBatchSse2,
+    .intersectTriangleBatch = intersectTriangleBatchSse2
+};
@@ -1,4 +1,8 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include "scalar.h"
+#include "simd_private.h"
 
 TmScalar
 tmScalarMix(TmScalar x, TmScalar y, TmScalar a)
@@ -6,3 +10,107 @@ tmScalarMix(TmScalar x, TmScalar y, TmScalar a)
     return x * (1.0f - a) + y * a;
 }
 
+// The SIMD backends evaluate exactly these expressions, in this order,
+// for each lane. quadrant is the angle's multiple of pi/2 modulo 4, r
+// the remainder and sinR/cosR its sine and cosine.
+static void
+fastTrigReduce(float x, uint32_t *quadrant, float *sinR, float *cosR)
+{
+    float const biased = (x * TM_FAST_TRIG_TWO_OVER_PI) + TM_FAST_TRIG_ROUNDING_BIAS;
+    float const k = biased - TM_FAST_TRIG_ROUNDING_BIAS;
+    float const r = ((x - (k * TM_FAST_TRIG_PI_OVER_2_HI)) -
+                        (k * TM_FAST_TRIG_PI_OVER_2_MID)) -
+                       (k * TM_FAST_TRIG_PI_OVER_2_LO);
+    float const r2 = r * r;
+    uint32_t biasedBits;
+
+    memcpy(&biasedBits, &biased, sizeof(biasedBits));
+    *quadrant = biasedBits & 3u;
+    *sinR = r + ((r * r2) * (TM_FAST_TRIG_SIN1 + (r2 * (TM_FAST_TRIG_SIN2 + (r2 * TM_FAST_TRIG_SIN3)))));
+    *cosR = (1.0f - (0.5f * r2)) +
+            ((r2 * r2) * (TM_FAST_TRIG_COS1 + (r2 * (TM_FAST_TRIG_COS2 + (r2 * TM_FAST_TRIG_COS3)))));
+}
+
+static void
+fastSinCosOne(float x, float *sine, float *cosine)
+{
+    uint32_t quadrant;
+    float sinR;
+    float cosR;
+
+    fastTrigReduce(x, &quadrant, &sinR, &cosR);
+    *sine = (quadrant & 1u) ? cosR : sinR;
+    *cosine = (quadrant & 1u) ? sinR : cosR;
+    if (quadrant & 2u) {
+        *sine = -*sine;
+    }
+    if ((quadrant + 1u) & 2u) {
+        *cosine = -*cosine;
+    }
+}
+
+static void
+sinCosBatchScalar(float *sines, float *cosines, float const *angles, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        fastSinCosOne(angles[i], &sines[i], &cosines[i]);
+    }
+}
+
+TmScalarKernels const tmScalarKernelsScalar = {
+    .sinCosBatch = sinCosBatchScalar
+};
+
+float
+tmScalarFastCos(float x)
+{
+    float sine;
+    float cosine;
+
+    fastSinCosOne(x, &sine, &cosine);
+
+    return cosine;
+}
+
+float
+tmScalarFastSin(float x)
+{
+    float sine;
+    float cosine;
+
+    fastSinCosOne(x, &sine, &cosine);
+
+    return sine;
+}
+
+void
+tmScalarFastSinCos(float x, float *sine, float *cosine)
+{
+    fastSinCosOne(x, sine, cosine);
+}
+
+float
+tmScalarFastTan(float x)
+{
+    uint32_t quadrant;
+    float sinR;
+    float cosR;
+
+    // tan(r + k pi/2) is tan(r) for even k and -1/tan(r) for odd k.
+    fastTrigReduce(x, &quadrant, &sinR, &cosR);
+
+    return (quadrant & 1u) ? -(cosR / sinR) : (sinR / cosR);
+}
+
+void
+tmScalarFastSinCosBatch(float *sines, float *cosines, float const *angles, size_t count)
+{
+    tmSimdScalarKernels()->sinCosBatch(sines, cosines, angles, count);
+}
+
+void
+tmScalarLibmSinCos(TmScalar x, TmScalar *sine, TmScalar *cosine)
+{
+    *sine = tmScalarLibmSin(x);
+    *cosine = tmScalarLibmCos(x);
+}
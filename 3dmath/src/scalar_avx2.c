@@ -0,0 +1,63 @@
+#include <assert.h>
+#include <immintrin.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// Evaluates the same expressions, in the same order, as fastTrigReduce
+// and fastSinCosOne in scalar.c. Tails fall back to the scalar kernel.
+
+static void
+sinCosAvx2(__m256 x, __m256 *sine, __m256 *cosine)
+{
+    __m256 const bias = _mm256_set1_ps(TM_FAST_TRIG_ROUNDING_BIAS);
+    __m256 const biased = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(TM_FAST_TRIG_TWO_OVER_PI)), bias);
+    __m256 const k = _mm256_sub_ps(biased, bias);
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256i const quadrant = _mm256_castps_si256(biased);
+    __m256i const bit0 = _mm256_set1_epi32(1);
+    __m256i const bit1 = _mm256_set1_epi32(2);
+    __m256 r, r2, r4, sinPoly, cosPoly, sinR, cosR, swap, sinSign, cosSign;
+
+    r = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TM_FAST_TRIG_PI_OVER_2_HI)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(TM_FAST_TRIG_PI_OVER_2_MID)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(TM_FAST_TRIG_PI_OVER_2_LO)));
+    r2 = _mm256_mul_ps(r, r);
+    r4 = _mm256_mul_ps(r2, r2);
+
+    sinPoly = _mm256_add_ps(_mm256_set1_ps(TM_FAST_TRIG_SIN2), _mm256_mul_ps(r2, _mm256_set1_ps(TM_FAST_TRIG_SIN3)));
+    sinPoly = _mm256_add_ps(_mm256_set1_ps(TM_FAST_TRIG_SIN1), _mm256_mul_ps(r2, sinPoly));
+    sinR = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), sinPoly));
+    cosPoly = _mm256_add_ps(_mm256_set1_ps(TM_FAST_TRIG_COS2), _mm256_mul_ps(r2, _mm256_set1_ps(TM_FAST_TRIG_COS3)));
+    cosPoly = _mm256_add_ps(_mm256_set1_ps(TM_FAST_TRIG_COS1), _mm256_mul_ps(r2, cosPoly));
+    cosR = _mm256_add_ps(_mm256_sub_ps(one, _mm256_mul_ps(_mm256_set1_ps(0.5f), r2)), _mm256_mul_ps(r4, cosPoly));
+
+    // Odd quadrants swap sine and cosine; bit 1 of the quadrant, moved
+    // into the sign bit, negates them.
+    swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, bit0), bit0));
+    sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, bit1), 30));
+    cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, bit0), bit1), 30));
+    *sine = _mm256_xor_ps(_mm256_or_ps(_mm256_and_ps(swap, cosR), _mm256_andnot_ps(swap, sinR)), sinSign);
+    *cosine = _mm256_xor_ps(_mm256_or_ps(_mm256_and_ps(swap, sinR), _mm256_andnot_ps(swap, cosR)), cosSign);
+}
+
+static void
+sinCosBatchAvx2(float *sines, float *cosines, float const *angles, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 sine;
+        __m256 cosine;
+
+        sinCosAvx2(_mm256_loadu_ps(angles + i), &sine, &cosine);
+        _mm256_storeu_ps(sines + i, sine);
+        _mm256_storeu_ps(cosines + i, cosine);
+    }
+    tmScalarKernelsScalar.sinCosBatch(sines + i, cosines + i, angles + i, count - i);
+}
+
+TmScalarKernels const tmScalarKernelsAvx2 = {
+    .sinCosBatch = sinCosBatchAvx2
+};
@@ -0,0 +1,65 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// Evaluates the same expressions, in the same order, as fastTrigReduce
+// and fastSinCosOne in scalar.c. Separate multiplies and adds keep the
+// results identical. Tails fall back to the scalar kernel.
+
+static void
+sinCosNeon(float32x4_t x, float32x4_t *sine, float32x4_t *cosine)
+{
+    float32x4_t const bias = vdupq_n_f32(TM_FAST_TRIG_ROUNDING_BIAS);
+    float32x4_t const biased = vaddq_f32(vmulq_f32(x, vdupq_n_f32(TM_FAST_TRIG_TWO_OVER_PI)), bias);
+    float32x4_t const k = vsubq_f32(biased, bias);
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    uint32x4_t const quadrant = vreinterpretq_u32_f32(biased);
+    uint32x4_t const bit0 = vdupq_n_u32(1u);
+    uint32x4_t const bit1 = vdupq_n_u32(2u);
+    float32x4_t r, r2, r4, sinPoly, cosPoly, sinR, cosR;
+    uint32x4_t swap, sinSign, cosSign;
+
+    r = vsubq_f32(x, vmulq_f32(k, vdupq_n_f32(TM_FAST_TRIG_PI_OVER_2_HI)));
+    r = vsubq_f32(r, vmulq_f32(k, vdupq_n_f32(TM_FAST_TRIG_PI_OVER_2_MID)));
+    r = vsubq_f32(r, vmulq_f32(k, vdupq_n_f32(TM_FAST_TRIG_PI_OVER_2_LO)));
+    r2 = vmulq_f32(r, r);
+    r4 = vmulq_f32(r2, r2);
+
+    sinPoly = vaddq_f32(vdupq_n_f32(TM_FAST_TRIG_SIN2), vmulq_f32(r2, vdupq_n_f32(TM_FAST_TRIG_SIN3)));
+    sinPoly = vaddq_f32(vdupq_n_f32(TM_FAST_TRIG_SIN1), vmulq_f32(r2, sinPoly));
+    sinR = vaddq_f32(r, vmulq_f32(vmulq_f32(r, r2), sinPoly));
+    cosPoly = vaddq_f32(vdupq_n_f32(TM_FAST_TRIG_COS2), vmulq_f32(r2, vdupq_n_f32(TM_FAST_TRIG_COS3)));
+    cosPoly = vaddq_f32(vdupq_n_f32(TM_FAST_TRIG_COS1), vmulq_f32(r2, cosPoly));
+    cosR = vaddq_f32(vsubq_f32(one, vmulq_f32(vdupq_n_f32(0.5f), r2)), vmulq_f32(r4, cosPoly));
+
+    // Odd quadrants swap sine and cosine; bit 1 of the quadrant, moved
+    // into the sign bit, negates them.
+    swap = vtstq_u32(quadrant, bit0);
+    sinSign = vshlq_n_u32(vandq_u32(quadrant, bit1), 30);
+    cosSign = vshlq_n_u32(vandq_u32(vaddq_u32(quadrant, bit0), bit1), 30);
+    *sine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cosR, sinR)), sinSign));
+    *cosine = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sinR, cosR)), cosSign));
+}
+
+static void
+sinCosBatchNeon(float *sines, float *cosines, float const *angles, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t sine;
+        float32x4_t cosine;
+
+        sinCosNeon(vld1q_f32(angles + i), &sine, &cosine);
+        vst1q_f32(sines + i, sine);
+        vst1q_f32(cosines + i, cosine);
+    }
+    tmScalarKernelsScalar.sinCosBatch(sines + i, cosines + i, angles + i, count - i);
+}
+
+TmScalarKernels const tmScalarKernelsNeon = {
+    .sinCosBatch = sinCosBatchNeon
+};
@@ -0,0 +1,63 @@
+#include <assert.h>
+#include <emmintrin.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// Evaluates the same expressions, in the same order, as fastTrigReduce
+// and fastSinCosOne in scalar.c. Tails fall back to the scalar kernel.
+
+static void
+sinCosSse2(__m128 x, __m128 *sine, __m128 *cosine)
+{
+    __m128 const bias = _mm_set1_ps(TM_FAST_TRIG_ROUNDING_BIAS);
+    __m128 const biased = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(TM_FAST_TRIG_TWO_OVER_PI)), bias);
+    __m128 const k = _mm_sub_ps(biased, bias);
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128i const quadrant = _mm_castps_si128(biased);
+    __m128i const bit0 = _mm_set1_epi32(1);
+    __m128i const bit1 = _mm_set1_epi32(2);
+    __m128 r, r2, r4, sinPoly, cosPoly, sinR, cosR, swap, sinSign, cosSign;
+
+    r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TM_FAST_TRIG_PI_OVER_2_HI)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(TM_FAST_TRIG_PI_OVER_2_MID)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(TM_FAST_TRIG_PI_OVER_2_LO)));
+    r2 = _mm_mul_ps(r, r);
+    r4 = _mm_mul_ps(r2, r2);
+
+    sinPoly = _mm_add_ps(_mm_set1_ps(TM_FAST_TRIG_SIN2), _mm_mul_ps(r2, _mm_set1_ps(TM_FAST_TRIG_SIN3)));
+    sinPoly = _mm_add_ps(_mm_set1_ps(TM_FAST_TRIG_SIN1), _mm_mul_ps(r2, sinPoly));
+    sinR = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sinPoly));
+    cosPoly = _mm_add_ps(_mm_set1_ps(TM_FAST_TRIG_COS2), _mm_mul_ps(r2, _mm_set1_ps(TM_FAST_TRIG_COS3)));
+    cosPoly = _mm_add_ps(_mm_set1_ps(TM_FAST_TRIG_COS1), _mm_mul_ps(r2, cosPoly));
+    cosR = _mm_add_ps(_mm_sub_ps(one, _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(r4, cosPoly));
+
+    // Odd quadrants swap sine and cosine; bit 1 of the quadrant, moved
+    // into the sign bit, negates them.
+    swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, bit0), bit0));
+    sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, bit1), 30));
+    cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, bit0), bit1), 30));
+    *sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosR), _mm_andnot_ps(swap, sinR)), sinSign);
+    *cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sinR), _mm_andnot_ps(swap, cosR)), cosSign);
+}
+
+static void
+sinCosBatchSse2(float *sines, float *cosines, float const *angles, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 sine;
+        __m128 cosine;
+
+        sinCosSse2(_mm_loadu_ps(angles + i), &sine, &cosine);
+        _mm_storeu_ps(sines + i, sine);
+        _mm_storeu_ps(cosines + i, cosine);
+    }
+    tmScalarKernelsScalar.sinCosBatch(sines + i, cosines + i, angles + i, count - i);
+}
+
+TmScalarKernels const tmScalarKernelsSse2 = {
+    .sinCosBatch = sinCosBatchSse2
+};
@@ -0,0 +1,243 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "simd.h"
+#include "simd_private.h"
+
+static TmMat4Kernels const *const sk_mat4Kernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmMat4KernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmMat4KernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmMat4KernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmMat4KernelsNeon,
+#endif
+};
+
+static TmSoAKernels const *const sk_soaKernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmSoAKernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmSoAKernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmSoAKernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmSoAKernelsNeon,
+#endif
+};
+
+static TmQuatKernels const *const sk_quatKernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmQuatKernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmQuatKernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmQuatKernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmQuatKernelsNeon,
+#endif
+};
+
+static TmScalarKernels const *const sk_scalarKernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmScalarKernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmScalarKernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmScalarKernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmScalarKernelsNeon,
+#endif
+};
+
+static TmFrustumKernels const *const sk_frustumKernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmFrustumKernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmFrustumKernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmFrustumKernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmFrustumKernelsNeon,
+#endif
+};
+
+static TmRayKernels const *const sk_rayKernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmRayKernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmRayKernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmRayKernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmRayKernelsNeon,
+#endif
+};
+
+static TmSkinKernels const *const sk_skinKernels[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = &tmSkinKernelsScalar,
+#ifdef TM_SIMD_SSE2
+    [TM_SIMD_BACKEND_SSE2] = &tmSkinKernelsSse2,
+#endif
+#ifdef TM_SIMD_AVX2
+    [TM_SIMD_BACKEND_AVX2] = &tmSkinKernelsAvx2,
+#endif
+#ifdef TM_SIMD_NEON
+    [TM_SIMD_BACKEND_NEON] = &tmSkinKernelsNeon,
+#endif
+};
+
+static char const *const sk_backendNames[TM_SIMD_BACKEND_COUNT] = {
+    [TM_SIMD_BACKEND_SCALAR] = "scalar",
+    [TM_SIMD_BACKEND_SSE2] = "sse2",
+    [TM_SIMD_BACKEND_AVX2] = "avx2",
+    [TM_SIMD_BACKEND_NEON] = "neon",
+};
+
+// Most preferred first. The scalar backend always terminates the search.
+static TmSimdBackend const sk_backendPreference[] = {
+    TM_SIMD_BACKEND_AVX2,
+    TM_SIMD_BACKEND_NEON,
+    TM_SIMD_BACKEND_SSE2,
+    TM_SIMD_BACKEND_SCALAR
+};
+
+// Read by the skinning and BVH worker threads. Relaxed accesses are
+// enough: the value indexes constant tables and guards nothing else.
+static _Atomic TmSimdBackend s_backend = TM_SIMD_BACKEND_COUNT;
+
+static bool
+cpuSupports(TmSimdBackend backend)
+{
+    switch (backend) {
+    case TM_SIMD_BACKEND_SCALAR:
+        return true;
+#if defined(TM_SIMD_SSE2) || defined(TM_SIMD_AVX2)
+    case TM_SIMD_BACKEND_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case TM_SIMD_BACKEND_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef TM_SIMD_NEON
+    case TM_SIMD_BACKEND_NEON:
+        // Advanced SIMD is mandatory on AArch64.
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+static TmSimdBackend
+selectBackend(void)
+{
+    TmSimdBackend backend = atomic_load_explicit(&s_backend, memory_order_relaxed);
+
+    if (backend == TM_SIMD_BACKEND_COUNT) {
+        TmSimdBackend expected = TM_SIMD_BACKEND_COUNT;
+
+        for (size_t i = 0; i < sizeof(sk_backendPreference)/sizeof(sk_backendPreference[0]); ++i) {
+            if (tmSimdBackendIsSupported(sk_backendPreference[i])) {
+                backend = sk_backendPreference[i];
+                break;
+            }
+        }
+        // Keeps a backend set by tmSimdSetBackend in the meantime.
+        if (!atomic_compare_exchange_strong_explicit(&s_backend, &expected, backend,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+            backend = expected;
+        }
+    }
+
+    return backend;
+}
+
+TmSimdBackend
+tmSimdBackend(void)
+{
+    return selectBackend();
+}
+
+char const *
+tmSimdBackendName(TmSimdBackend backend)
+{
+    if (backend >= TM_SIMD_BACKEND_COUNT) {
+        return "unknown";
+    }
+
+    return sk_backendNames[backend];
+}
+
+bool
+tmSimdBackendIsSupported(TmSimdBackend backend)
+{
+    if (backend >= TM_SIMD_BACKEND_COUNT || sk_mat4Kernels[backend] == NULL) {
+        return false;
+    }
+
+    return cpuSupports(backend);
+}
+
+bool
+tmSimdSetBackend(TmSimdBackend backend)
+{
+    bool const isSupported = tmSimdBackendIsSupported(backend);
+
+    if (isSupported) {
+        atomic_store_explicit(&s_backend, backend, memory_order_relaxed);
+    }
+
+    return isSupported;
+}
+
+TmMat4Kernels const *
+tmSimdMat4Kernels(void)
+{
+    return sk_mat4Kernels[selectBackend()];
+}
+
+TmSoAKernels const *
+tmSimdSoAKernels(void)
+{
+    return sk_soaKernels[selectBackend()];
+}
+
+TmQuatKernels const *
+tmSimdQuatKernels(void)
+{
+    return sk_quatKernels[selectBackend()];
+}
+
+TmScalarKernels const *
+tmSimdScalarKernels(void)
+{
+    return sk_scalarKernels[selectBackend()];
+}
+
+TmFrustumKernels const *
+tmSimdFrustumKernels(void)
+{
+    return sk_frustumKernels[selectBackend()];
+}
+
+TmRayKernels const *
+tmSimdRayKernels(void)
+{
+    return sk_rayKernels[selectBackend()];
+}
+
+TmSkinKernels const *
+tmSimdSkinKernels(void)
+{
+    return sk_skinKernels[selectBackend()];
+}
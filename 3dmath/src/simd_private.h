@@ -0,0 +1,214 @@
+#ifndef GRAPHICS_MATH_SIMD_PRIVATE_H
+#define GRAPHICS_MATH_SIMD_PRIVATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frustum.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "ray.h"
+#include "scalar.h"
+#include "simd.h"
+#include "skinning.h"
+#include "vector.h"
+
+// Each backend fills in one of these. The public tmMat4* functions
+// forward to the table of the selected backend.
+typedef struct TmMat4Kernels {
+    TmMat4  *(*add)(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b);
+    TmMat4  *(*multiply)(TmMat4 *dest, TmMat4 const *a, TmMat4 const *b);
+    TmMat4  *(*scalarMultiply)(TmMat4 *dest, TmMat4 const *a, TmScalar x);
+    TmMat4  *(*transpose)(TmMat4 *dest, TmMat4 const *a);
+    TmMat4  *(*inverse)(TmMat4 *dest, TmMat4 const *a);
+    TmMat4  *(*multiplyBatch)(TmMat4 *dest,
+                              TmMat4 const *a,
+                              TmMat4 const *b,
+                              size_t count);
+    TmVec4  *(*transformVec4Batch)(TmVec4 *dest,
+                                   TmMat4 const *m,
+                                   TmVec4 const *vectors,
+                                   size_t count);
+    TmVec3  *(*transformPointsVec3Batch)(TmVec3 *dest,
+                                         TmMat4 const *m,
+                                         TmVec3 const *points,
+                                         size_t count);
+} TmMat4Kernels;
+
+// Element-wise kernels over component arrays, used by the TmVec*SoA
+// streams. Component arrays are passed as arrays of pointers, one per
+// component. Outputs may alias inputs element for element.
+typedef struct TmSoAKernels {
+    void     (*add)(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count);
+    void     (*sub)(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count);
+    void     (*multiply)(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count);
+    void     (*divide)(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count);
+    void     (*scale)(TmScalar *dest, TmScalar scale, TmScalar const *p, size_t count);
+    void     (*squareRoot)(TmScalar *dest, TmScalar const *p, size_t count);
+    void     (*dot3)(TmScalar *dest,
+                     TmScalar const *const p[3],
+                     TmScalar const *const q[3],
+                     size_t count);
+    void     (*dot4)(TmScalar *dest,
+                     TmScalar const *const p[4],
+                     TmScalar const *const q[4],
+                     size_t count);
+    void     (*cross)(TmScalar *const dest[3],
+                      TmScalar const *const p[3],
+                      TmScalar const *const q[3],
+                      size_t count);
+    void     (*fromAoS3)(TmScalar *const dest[3], TmVec3 const *src, size_t count);
+    void     (*toAoS3)(TmVec3 *dest, TmScalar const *const src[3], size_t count);
+    void     (*fromAoS4)(TmScalar *const dest[4], TmVec4 const *src, size_t count);
+    void     (*toAoS4)(TmVec4 *dest, TmScalar const *const src[4], size_t count);
+} TmSoAKernels;
+
+// Batched quaternion interpolation. Every backend evaluates the same
+// expressions as the scalar one, so the results are identical.
+typedef struct TmQuatKernels {
+    TmQuat  *(*nlerpBatch)(TmQuat *dest,
+                           TmQuat const *p,
+                           TmQuat const *q,
+                           TmScalar const *t,
+                           size_t count);
+    TmQuat  *(*slerpBatch)(TmQuat *dest,
+                           TmQuat const *p,
+                           TmQuat const *q,
+                           TmScalar const *t,
+                           size_t count);
+} TmQuatKernels;
+
+// Coefficients of the SLERP weight polynomial, see quaternion.c.
+#define TM_SLERP_TERMS 12
+extern TmScalar const tmSlerpU[TM_SLERP_TERMS];
+extern TmScalar const tmSlerpV[TM_SLERP_TERMS];
+
+// Batched fast trigonometry, see tmScalarFastSinCos.
+typedef struct TmScalarKernels {
+    void     (*sinCosBatch)(float *sines,
+                            float *cosines,
+                            float const *angles,
+                            size_t count);
+} TmScalarKernels;
+
+// Constants of the fast trigonometric functions, shared by every
+// backend. Adding and then subtracting the rounding bias rounds
+// x * 2/pi to the nearest integer k, whose low bits are then the low
+// bits of the biased sum. Pi/2 is split into three parts so that k
+// times the first two is exact (Cody and Waite).
+#define TM_FAST_TRIG_TWO_OVER_PI    0.636619772367581343f
+#define TM_FAST_TRIG_ROUNDING_BIAS  12582912.0f
+#define TM_FAST_TRIG_PI_OVER_2_HI   1.5703125f
+#define TM_FAST_TRIG_PI_OVER_2_MID  4.837512969970703125e-4f
+#define TM_FAST_TRIG_PI_OVER_2_LO   7.54978995489188216e-8f
+// sin(r) ~ r + r^3 (S1 + r^2 (S2 + r^2 S3)) on [-pi/4, pi/4]
+#define TM_FAST_TRIG_SIN1           -1.6666654611e-1f
+#define TM_FAST_TRIG_SIN2           8.3321608736e-3f
+#define TM_FAST_TRIG_SIN3           -1.9515295891e-4f
+// cos(r) ~ 1 - r^2 / 2 + r^4 (C1 + r^2 (C2 + r^2 C3)) on [-pi/4, pi/4]
+#define TM_FAST_TRIG_COS1           4.166664568298827e-2f
+#define TM_FAST_TRIG_COS2           -1.388731625493765e-3f
+#define TM_FAST_TRIG_COS3           2.443315711809948e-5f
+
+// Batched frustum tests over elements [first, count). They OR the
+// visibility bits into visible, which the caller has cleared, so SIMD
+// backends can hand their tails to the scalar kernels.
+typedef struct TmFrustumKernels {
+    void     (*cullAabbBatch)(uint32_t *visible,
+                              TmFrustum const *frustum,
+                              TmAabb const *boxes,
+                              size_t first,
+                              size_t count);
+    void     (*cullSphereBatch)(uint32_t *visible,
+                                TmFrustum const *frustum,
+                                TmSphere const *spheres,
+                                size_t first,
+                                size_t count);
+} TmFrustumKernels;
+
+// Batched ray tests over primitives [first, count). Each writes t[i] as
+// tmRayIntersect*Batch documents and returns the number of hits in its
+// range, so SIMD backends can hand their tails to the scalar kernels.
+typedef struct TmRayKernels {
+    size_t   (*intersectAabbBatch)(TmScalar *t,
+                                   TmRay const *ray,
+                                   TmScalar tMax,
+                                   TmAabb const *boxes,
+                                   size_t first,
+                                   size_t count);
+    size_t   (*intersectSphereBatch)(TmScalar *t,
+                                     TmRay const *ray,
+                                     TmScalar tMax,
+                                     TmSphere const *spheres,
+                                     size_t first,
+                                     size_t count);
+    size_t   (*intersectTriangleBatch)(TmScalar *t,
+                                       TmRay const *ray,
+                                       TmScalar tMax,
+                                       TmTriangle const *triangles,
+                                       size_t first,
+                                       size_t count);
+} TmRayKernels;
+
+// Skinning of vertices [first, end) of a mesh, see skinning.h. The
+// public functions split meshes into ranges, one per thread.
+typedef struct TmSkinKernels {
+    void     (*linear)(TmVec3 *positions,
+                       TmVec3 *normals,
+                       TmSkinMesh const *mesh,
+                       TmMat4 const *palette,
+                       size_t first,
+                       size_t end);
+    void     (*dualQuat)(TmVec3 *positions,
+                         TmVec3 *normals,
+                         TmSkinMesh const *mesh,
+                         TmDualQuat const *palette,
+                         size_t first,
+                         size_t end);
+} TmSkinKernels;
+
+// TM_SIMD_<backend> is defined by the build for each backend source
+// file it compiles on the target architecture.
+extern TmMat4Kernels const tmMat4KernelsScalar;
+extern TmSoAKernels const tmSoAKernelsScalar;
+extern TmQuatKernels const tmQuatKernelsScalar;
+extern TmScalarKernels const tmScalarKernelsScalar;
+extern TmFrustumKernels const tmFrustumKernelsScalar;
+extern TmRayKernels const tmRayKernelsScalar;
+extern TmSkinKernels const tmSkinKernelsScalar;
+#ifdef TM_SIMD_SSE2
+extern TmMat4Kernels const tmMat4KernelsSse2;
+extern TmSoAKernels const tmSoAKernelsSse2;
+extern TmQuatKernels const tmQuatKernelsSse2;
+extern TmScalarKernels const tmScalarKernelsSse2;
+extern TmFrustumKernels const tmFrustumKernelsSse2;
+extern TmRayKernels const tmRayKernelsSse2;
+extern TmSkinKernels const tmSkinKernelsSse2;
+#endif
+#ifdef TM_SIMD_AVX2
+extern TmMat4Kernels const tmMat4KernelsAvx2;
+extern TmSoAKernels const tmSoAKernelsAvx2;
+extern TmQuatKernels const tmQuatKernelsAvx2;
+extern TmScalarKernels const tmScalarKernelsAvx2;
+extern TmFrustumKernels const tmFrustumKernelsAvx2;
+extern TmRayKernels const tmRayKernelsAvx2;
+extern TmSkinKernels const tmSkinKernelsAvx2;
+#endif
+#ifdef TM_SIMD_NEON
+extern TmMat4Kernels const tmMat4KernelsNeon;
+extern TmSoAKernels const tmSoAKernelsNeon;
+extern TmQuatKernels const tmQuatKernelsNeon;
+extern TmScalarKernels const tmScalarKernelsNeon;
+extern TmFrustumKernels const tmFrustumKernelsNeon;
+extern TmRayKernels const tmRayKernelsNeon;
+extern TmSkinKernels const tmSkinKernelsNeon;
+#endif
+
+TmMat4Kernels const *tmSimdMat4Kernels(void);
+TmSoAKernels const  *tmSimdSoAKernels(void);
+TmQuatKernels const *tmSimdQuatKernels(void);
+TmScalarKernels const *tmSimdScalarKernels(void);
+TmFrustumKernels const *tmSimdFrustumKernels(void);
+TmRayKernels const *tmSimdRayKernels(void);
+TmSkinKernels const *tmSimdSkinKernels(void);
+
+#endif /* GRAPHICS_MATH_SIMD_PRIVATE_H */
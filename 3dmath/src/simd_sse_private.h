@@ -0,0 +1,234 @@
+#ifndef GRAPHICS_MATH_SIMD_SSE_PRIVATE_H
+#define GRAPHICS_MATH_SIMD_SSE_PRIVATE_H
+
+#include <assert.h>
+#include <xmmintrin.h>
+#include "bounds.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "vector.h"
+
+// Helpers shared by the SSE2 and AVX2 backends. They are compiled into
+// each backend with that backend's instruction set.
+
+// Loads four consecutive TmVec3 and transposes them to x, y and z lanes.
+static inline void
+sseLoadVec3x4(__m128 *x, __m128 *y, __m128 *z, TmVec3 const *points)
+{
+    TmScalar const *p = (TmScalar const *)points;
+    // (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+    __m128 const v0 = _mm_loadu_ps(p + 0);
+    __m128 const v1 = _mm_loadu_ps(p + 4);
+    __m128 const v2 = _mm_loadu_ps(p + 8);
+    __m128 const x2y2x3y3 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 const y0z0y1z1 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 2, 1));
+
+    *x = _mm_shuffle_ps(v0, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+    *z = _mm_shuffle_ps(y0z0y1z1, v2, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// Inverse of sseLoadVec3x4.
+static inline void
+sseStoreVec3x4(TmVec3 *points, __m128 x, __m128 y, __m128 z)
+{
+    TmScalar *p = (TmScalar *)points;
+    __m128 const x0x2y0y2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 const y1y3z1z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    __m128 const z0z2x1x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+    _mm_storeu_ps(p + 0, _mm_shuffle_ps(x0x2y0y2, z0z2x1x3, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(y1y3z1z3, x0x2y0y2, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(z0z2x1x3, y1y3z1z3, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+// Loads four consecutive TmAabb and transposes them to min and max
+// lanes of each component.
+static inline void
+sseLoadAabb4(__m128 min[3], __m128 max[3], TmAabb const *boxes)
+{
+    __m128 first[3];
+    __m128 second[3];
+
+    // Each load yields (min, max, min, max) of two boxes.
+    sseLoadVec3x4(&first[0], &first[1], &first[2], &boxes[0].min);
+    sseLoadVec3x4(&second[0], &second[1], &second[2], &boxes[2].min);
+    for (int k = 0; k < 3; ++k) {
+        min[k] = _mm_shuffle_ps(first[k], second[k], _MM_SHUFFLE(2, 0, 2, 0));
+        max[k] = _mm_shuffle_ps(first[k], second[k], _MM_SHUFFLE(3, 1, 3, 1));
+    }
+}
+
+// Loads the vertices of four triangles stored as consecutive (a, b, c)
+// triples and transposes each vertex to x, y and z lanes.
+static inline void
+sseLoadTriangleVertices4(__m128 a[3], __m128 b[3], __m128 c[3], TmVec3 const *vertices)
+{
+    // Component k of (a0 b0 c0 a1) (b1 c1 a2 b2) (c2 a3 b3 c3)
+    __m128 v[3][3];
+
+    sseLoadVec3x4(&v[0][0], &v[0][1], &v[0][2], &vertices[0]);
+    sseLoadVec3x4(&v[1][0], &v[1][1], &v[1][2], &vertices[4]);
+    sseLoadVec3x4(&v[2][0], &v[2][1], &v[2][2], &vertices[8]);
+    for (int k = 0; k < 3; ++k) {
+        __m128 const a2a3 = _mm_shuffle_ps(v[1][k], v[2][k], _MM_SHUFFLE(1, 1, 2, 2));
+        __m128 const b0b1 = _mm_shuffle_ps(v[0][k], v[1][k], _MM_SHUFFLE(0, 0, 1, 1));
+        __m128 const b2b3 = _mm_shuffle_ps(v[1][k], v[2][k], _MM_SHUFFLE(2, 2, 3, 3));
+        __m128 const c0c1 = _mm_shuffle_ps(v[0][k], v[1][k], _MM_SHUFFLE(1, 1, 2, 2));
+
+        a[k] = _mm_shuffle_ps(v[0][k], a2a3, _MM_SHUFFLE(2, 0, 3, 0));
+        b[k] = _mm_shuffle_ps(b0b1, b2b3, _MM_SHUFFLE(2, 0, 2, 0));
+        c[k] = _mm_shuffle_ps(c0c1, v[2][k], _MM_SHUFFLE(3, 0, 2, 0));
+    }
+}
+
+// Loads four consecutive TmVec4 and transposes them to x, y, z and w lanes.
+static inline void
+sseLoadVec4x4(__m128 *x, __m128 *y, __m128 *z, __m128 *w, TmVec4 const *vectors)
+{
+    TmScalar const *p = (TmScalar const *)vectors;
+    __m128 r0 = _mm_loadu_ps(p + 0);
+    __m128 r1 = _mm_loadu_ps(p + 4);
+    __m128 r2 = _mm_loadu_ps(p + 8);
+    __m128 r3 = _mm_loadu_ps(p + 12);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    *x = r0;
+    *y = r1;
+    *z = r2;
+    *w = r3;
+}
+
+// Loads four dual quaternions from anywhere and transposes their real
+// and dual parts to x, y, z and w lanes.
+static inline void
+sseLoadDualQuat4(__m128 real[4], __m128 dual[4], TmDualQuat const *const dq[4])
+{
+    __m128 r0 = _mm_loadu_ps(&dq[0]->real.x);
+    __m128 r1 = _mm_loadu_ps(&dq[1]->real.x);
+    __m128 r2 = _mm_loadu_ps(&dq[2]->real.x);
+    __m128 r3 = _mm_loadu_ps(&dq[3]->real.x);
+    __m128 d0 = _mm_loadu_ps(&dq[0]->dual.x);
+    __m128 d1 = _mm_loadu_ps(&dq[1]->dual.x);
+    __m128 d2 = _mm_loadu_ps(&dq[2]->dual.x);
+    __m128 d3 = _mm_loadu_ps(&dq[3]->dual.x);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+    real[0] = r0;
+    real[1] = r1;
+    real[2] = r2;
+    real[3] = r3;
+    dual[0] = d0;
+    dual[1] = d1;
+    dual[2] = d2;
+    dual[3] = d3;
+}
+
+// Inverse of sseLoadVec4x4.
+static inline void
+sseStoreVec4x4(TmVec4 *vectors, __m128 x, __m128 y, __m128 z, __m128 w)
+{
+    TmScalar *p = (TmScalar *)vectors;
+
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(p + 0, x);
+    _mm_storeu_ps(p + 4, y);
+    _mm_storeu_ps(p + 8, z);
+    _mm_storeu_ps(p + 12, w);
+}
+
+// Lane selections for the inverse below, listed from lane 0 upwards.
+#define SSE_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE(w, z, y, x))
+#define SSE_SWIZZLE(v, x, y, z, w) SSE_SHUFFLE(v, v, x, y, z, w)
+
+// The 2x2 helpers hold a block in one register as (b11 b12 b21 b22).
+
+// a * b
+static inline __m128
+sseMat2Multiply(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, SSE_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(SSE_SWIZZLE(a, 1, 0, 3, 2), SSE_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(a) * b
+static inline __m128
+sseMat2AdjointMultiply(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(SSE_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(SSE_SWIZZLE(a, 1, 1, 2, 2), SSE_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adj(b)
+static inline __m128
+sseMat2MultiplyAdjoint(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, SSE_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(SSE_SWIZZLE(a, 1, 0, 3, 2), SSE_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// General inverse by blockwise inversion of M = [A B; C D]. The 2x2
+// products adj(A)B and adj(D)C are computed once and shared by every
+// block of the result, and |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C).
+//
+// The columns are treated as the rows of the transpose; inverting the
+// transpose and storing it row by row yields the column-major inverse.
+static inline TmMat4 *
+sseMat4Inverse(TmMat4 *dest, TmMat4 const *m)
+{
+    TmScalar const *pM = (TmScalar const *)m;
+    TmScalar *pDest = (TmScalar *)dest;
+    __m128 const r0 = _mm_loadu_ps(pM + 0);
+    __m128 const r1 = _mm_loadu_ps(pM + 4);
+    __m128 const r2 = _mm_loadu_ps(pM + 8);
+    __m128 const r3 = _mm_loadu_ps(pM + 12);
+    __m128 const a = _mm_movelh_ps(r0, r1);
+    __m128 const b = _mm_movehl_ps(r1, r0);
+    __m128 const c = _mm_movelh_ps(r2, r3);
+    __m128 const d = _mm_movehl_ps(r3, r2);
+    // (|A| |B| |C| |D|)
+    __m128 const blockDeterminants = _mm_sub_ps(
+        _mm_mul_ps(SSE_SHUFFLE(r0, r2, 0, 2, 0, 2), SSE_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+        _mm_mul_ps(SSE_SHUFFLE(r0, r2, 1, 3, 1, 3), SSE_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    __m128 const detA = SSE_SWIZZLE(blockDeterminants, 0, 0, 0, 0);
+    __m128 const detB = SSE_SWIZZLE(blockDeterminants, 1, 1, 1, 1);
+    __m128 const detC = SSE_SWIZZLE(blockDeterminants, 2, 2, 2, 2);
+    __m128 const detD = SSE_SWIZZLE(blockDeterminants, 3, 3, 3, 3);
+    __m128 const adjAB = sseMat2AdjointMultiply(a, b);
+    __m128 const adjDC = sseMat2AdjointMultiply(d, c);
+    // Adjoints of the four blocks of the inverse, before scaling
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), sseMat2Multiply(b, adjDC));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), sseMat2MultiplyAdjoint(d, adjAB));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), sseMat2MultiplyAdjoint(a, adjDC));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), sseMat2Multiply(c, adjAB));
+    __m128 trace = _mm_mul_ps(adjAB, SSE_SWIZZLE(adjDC, 0, 2, 1, 3));
+    __m128 determinant;
+    __m128 scale;
+
+    trace = _mm_add_ps(trace, SSE_SWIZZLE(trace, 1, 0, 3, 2));
+    trace = _mm_add_ps(trace, SSE_SWIZZLE(trace, 2, 3, 0, 1));
+    determinant = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+    determinant = _mm_sub_ps(determinant, trace);
+    assert(_mm_cvtss_f32(determinant) != 0.0f);
+
+    // Undoing each adjoint negates the off-diagonal and swaps the
+    // diagonal; the sign goes into the scale, the swap into the stores.
+    scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+    z = _mm_mul_ps(z, scale);
+    w = _mm_mul_ps(w, scale);
+
+    _mm_storeu_ps(pDest + 0, SSE_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(pDest + 4, SSE_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(pDest + 8, SSE_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(pDest + 12, SSE_SHUFFLE(z, w, 2, 0, 2, 0));
+
+    return dest;
+}
+
+#undef SSE_SWIZZLE
+#undef SSE_SHUFFLE
+
+#endif /* GRAPHICS_MATH_SIMD_SSE_PRIVATE_H */
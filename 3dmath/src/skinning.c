@@ -0,0 +1,263 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <threads.h>
+#include "simd_private.h"
+#include "skinning.h"
+
+// Meshes are split into one range per thread, but no thread gets fewer
+// vertices than this.
+#define SKIN_PARALLEL_MIN_COUNT 4096
+#define SKIN_MAX_THREADS 64
+// Ranges start at multiples of this, so only the last one has a SIMD
+// tail.
+#define SKIN_RANGE_ALIGNMENT 8
+
+typedef struct SkinTask {
+    TmSkinKernels const    *kernels;
+    TmVec3                 *positions;
+    TmVec3                 *normals;
+    TmSkinMesh const       *mesh;
+    // Exactly one palette is set.
+    TmMat4 const           *matrices;
+    TmDualQuat const       *dualQuats;
+    size_t                  first;
+    size_t                  end;
+} SkinTask;
+
+// The SIMD backends evaluate each expression below lane-wise, in the
+// same order, so keep them in sync.
+
+static void
+skinLinearScalar(TmVec3 *positions,
+                 TmVec3 *normals,
+                 TmSkinMesh const *mesh,
+                 TmMat4 const *palette,
+                 size_t first,
+                 size_t end)
+{
+    for (size_t i = first; i < end; ++i) {
+        uint16_t const *joints = &mesh->joints[TM_SKIN_INFLUENCES * i];
+        TmScalar const weights[TM_SKIN_INFLUENCES] = {
+            mesh->weights[i].x, mesh->weights[i].y, mesh->weights[i].z, mesh->weights[i].w
+        };
+        TmScalar const *m = (TmScalar const *)&palette[joints[0]];
+        TmVec3 const *p = &mesh->positions[i];
+        TmMat4 blend;
+        TmScalar *b = (TmScalar *)&blend;
+
+        // ((w0 M0 + w1 M1) + w2 M2) + w3 M3, element by element
+        for (int e = 0; e < 16; ++e) {
+            b[e] = weights[0] * m[e];
+        }
+        for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+            m = (TmScalar const *)&palette[joints[k]];
+            for (int e = 0; e < 16; ++e) {
+                b[e] = b[e] + weights[k] * m[e];
+            }
+        }
+
+        positions[i].x = (((blend.m11 * p->x) + (blend.m12 * p->y)) + (blend.m13 * p->z)) + blend.m14;
+        positions[i].y = (((blend.m21 * p->x) + (blend.m22 * p->y)) + (blend.m23 * p->z)) + blend.m24;
+        positions[i].z = (((blend.m31 * p->x) + (blend.m32 * p->y)) + (blend.m33 * p->z)) + blend.m34;
+        if (mesh->normals != NULL) {
+            TmVec3 const *n = &mesh->normals[i];
+            TmVec3 normal;
+            TmScalar length;
+
+            normal.x = ((blend.m11 * n->x) + (blend.m12 * n->y)) + (blend.m13 * n->z);
+            normal.y = ((blend.m21 * n->x) + (blend.m22 * n->y)) + (blend.m23 * n->z);
+            normal.z = ((blend.m31 * n->x) + (blend.m32 * n->y)) + (blend.m33 * n->z);
+            length = tmScalarSqrt(((normal.x * normal.x) + (normal.y * normal.y)) + (normal.z * normal.z));
+            if (length > 0.0f) {
+                normal.x = normal.x / length;
+                normal.y = normal.y / length;
+                normal.z = normal.z / length;
+            }
+            normals[i] = normal;
+        }
+    }
+}
+
+static void
+skinDualQuatScalar(TmVec3 *positions,
+                   TmVec3 *normals,
+                   TmSkinMesh const *mesh,
+                   TmDualQuat const *palette,
+                   size_t first,
+                   size_t end)
+{
+    for (size_t i = first; i < end; ++i) {
+        uint16_t const *joints = &mesh->joints[TM_SKIN_INFLUENCES * i];
+        TmScalar const weights[TM_SKIN_INFLUENCES] = {
+            mesh->weights[i].x, mesh->weights[i].y, mesh->weights[i].z, mesh->weights[i].w
+        };
+        TmQuat const *r0 = &palette[joints[0]].real;
+        TmQuat const *d0 = &palette[joints[0]].dual;
+        TmVec3 const *p = &mesh->positions[i];
+        TmQuat r = {weights[0] * r0->x, weights[0] * r0->y, weights[0] * r0->z, weights[0] * r0->w};
+        TmQuat d = {weights[0] * d0->x, weights[0] * d0->y, weights[0] * d0->z, weights[0] * d0->w};
+        TmScalar inverseLength;
+        TmVec3 t;
+
+        for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+            TmQuat const *rk = &palette[joints[k]].real;
+            TmQuat const *dk = &palette[joints[k]].dual;
+            TmScalar const cosine = (((rk->x * r0->x) + (rk->y * r0->y)) + (rk->z * r0->z)) + (rk->w * r0->w);
+            // Blend along the shorter arc from the first joint.
+            TmScalar const w = (cosine < 0.0f) ? -weights[k] : weights[k];
+
+            r.x = r.x + w * rk->x;
+            r.y = r.y + w * rk->y;
+            r.z = r.z + w * rk->z;
+            r.w = r.w + w * rk->w;
+            d.x = d.x + w * dk->x;
+            d.y = d.y + w * dk->y;
+            d.z = d.z + w * dk->z;
+            d.w = d.w + w * dk->w;
+        }
+        inverseLength = 1.0f / tmScalarSqrt((((r.x * r.x) + (r.y * r.y)) + (r.z * r.z)) + (r.w * r.w));
+        r.x = r.x * inverseLength;
+        r.y = r.y * inverseLength;
+        r.z = r.z * inverseLength;
+        r.w = r.w * inverseLength;
+        d.x = d.x * inverseLength;
+        d.y = d.y * inverseLength;
+        d.z = d.z * inverseLength;
+        d.w = d.w * inverseLength;
+
+        // p + 2 r x (r x p + w p), then the translation
+        // 2 (w d - d.w r + r x d).
+        t.x = ((r.y * p->z) - (r.z * p->y)) + (r.w * p->x);
+        t.y = ((r.z * p->x) - (r.x * p->z)) + (r.w * p->y);
+        t.z = ((r.x * p->y) - (r.y * p->x)) + (r.w * p->z);
+        positions[i].x = (p->x + 2.0f * ((r.y * t.z) - (r.z * t.y)))
+                       + 2.0f * (((r.w * d.x) - (d.w * r.x)) + ((r.y * d.z) - (r.z * d.y)));
+        positions[i].y = (p->y + 2.0f * ((r.z * t.x) - (r.x * t.z)))
+                       + 2.0f * (((r.w * d.y) - (d.w * r.y)) + ((r.z * d.x) - (r.x * d.z)));
+        positions[i].z = (p->z + 2.0f * ((r.x * t.y) - (r.y * t.x)))
+                       + 2.0f * (((r.w * d.z) - (d.w * r.z)) + ((r.x * d.y) - (r.y * d.x)));
+        if (mesh->normals != NULL) {
+            TmVec3 const *n = &mesh->normals[i];
+
+            t.x = ((r.y * n->z) - (r.z * n->y)) + (r.w * n->x);
+            t.y = ((r.z * n->x) - (r.x * n->z)) + (r.w * n->y);
+            t.z = ((r.x * n->y) - (r.y * n->x)) + (r.w * n->z);
+            normals[i].x = n->x + 2.0f * ((r.y * t.z) - (r.z * t.y));
+            normals[i].y = n->y + 2.0f * ((r.z * t.x) - (r.x * t.z));
+            normals[i].z = n->z + 2.0f * ((r.x * t.y) - (r.y * t.x));
+        }
+    }
+}
+
+TmSkinKernels const tmSkinKernelsScalar = {
+    .linear = skinLinearScalar,
+    .dualQuat = skinDualQuatScalar
+};
+
+static void
+runTask(SkinTask const *task)
+{
+    if (task->matrices != NULL) {
+        task->kernels->linear(task->positions, task->normals, task->mesh, task->matrices,
+                              task->first, task->end);
+    } else {
+        task->kernels->dualQuat(task->positions, task->normals, task->mesh, task->dualQuats,
+                                task->first, task->end);
+    }
+}
+
+static int
+runTaskThread(void *taskPtr)
+{
+    runTask(taskPtr);
+
+    return 0;
+}
+
+// Splits the whole mesh into ranges, runs the first on the calling
+// thread and the rest on threads of their own, where they can be
+// created.
+static void
+runTasks(SkinTask const *whole, unsigned threadCount)
+{
+    size_t const count = whole->end;
+    size_t taskCount = count / SKIN_PARALLEL_MIN_COUNT;
+    SkinTask tasks[SKIN_MAX_THREADS];
+    thrd_t threads[SKIN_MAX_THREADS];
+    bool isThreaded[SKIN_MAX_THREADS];
+    size_t rangeSize;
+
+    taskCount = (taskCount < threadCount) ? taskCount : threadCount;
+    taskCount = (taskCount < SKIN_MAX_THREADS) ? taskCount : SKIN_MAX_THREADS;
+    if (taskCount <= 1) {
+        runTask(whole);
+        return;
+    }
+
+    rangeSize = (count + taskCount - 1) / taskCount;
+    rangeSize = (rangeSize + SKIN_RANGE_ALIGNMENT - 1) / SKIN_RANGE_ALIGNMENT * SKIN_RANGE_ALIGNMENT;
+    for (size_t i = 0; i < taskCount; ++i) {
+        size_t const first = i * rangeSize;
+
+        tasks[i] = *whole;
+        tasks[i].first = (first < count) ? first : count;
+        tasks[i].end = (first + rangeSize < count) ? first + rangeSize : count;
+    }
+    for (size_t i = 1; i < taskCount; ++i) {
+        isThreaded[i] = (thrd_create(&threads[i], runTaskThread, &tasks[i]) == thrd_success);
+        if (!isThreaded[i]) {
+            runTask(&tasks[i]);
+        }
+    }
+    runTask(&tasks[0]);
+    for (size_t i = 1; i < taskCount; ++i) {
+        if (isThreaded[i]) {
+            thrd_join(threads[i], NULL);
+        }
+    }
+}
+
+void
+tmSkinLinear(TmVec3 *positions,
+             TmVec3 *normals,
+             TmSkinMesh const *mesh,
+             TmMat4 const *palette,
+             unsigned threadCount)
+{
+    SkinTask const whole = {
+        .kernels = tmSimdSkinKernels(),
+        .positions = positions,
+        .normals = normals,
+        .mesh = mesh,
+        .matrices = palette,
+        .dualQuats = NULL,
+        .first = 0,
+        .end = mesh->count
+    };
+
+    assert(palette != NULL);
+    runTasks(&whole, threadCount);
+}
+
+void
+tmSkinDualQuat(TmVec3 *positions,
+               TmVec3 *normals,
+               TmSkinMesh const *mesh,
+               TmDualQuat const *palette,
+               unsigned threadCount)
+{
+    SkinTask const whole = {
+        .kernels = tmSimdSkinKernels(),
+        .positions = positions,
+        .normals = normals,
+        .mesh = mesh,
+        .matrices = NULL,
+        .dualQuats = palette,
+        .first = 0,
+        .end = mesh->count
+    };
+
+    assert(palette != NULL);
+    runTasks(&whole, threadCount);
+}
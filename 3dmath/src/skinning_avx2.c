@@ -0,0 +1,245 @@
+#include <assert.h>
+#include <immintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// Eight vertices at a time, with the same operations, in the same order,
+// as the scalar kernels in skinning.c. Linear blending sums two matrix
+// columns per register for each vertex, then transposes the blended
+// matrices to transform the vertices lane-wise. Dual quaternions are
+// transposed as they are loaded. Tails fall back to the scalar kernels.
+
+static __m256
+combineHalvesAvx2(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+static void
+loadVec3x8Avx2(__m256 v[3], TmVec3 const *points)
+{
+    __m128 low[3], high[3];
+
+    sseLoadVec3x4(&low[0], &low[1], &low[2], &points[0]);
+    sseLoadVec3x4(&high[0], &high[1], &high[2], &points[4]);
+    for (int k = 0; k < 3; ++k) {
+        v[k] = combineHalvesAvx2(low[k], high[k]);
+    }
+}
+
+static void
+storeVec3x8Avx2(TmVec3 *points, __m256 x, __m256 y, __m256 z)
+{
+    sseStoreVec3x4(&points[0], _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+    sseStoreVec3x4(&points[4], _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+}
+
+// ((w0 M0 + w1 M1) + w2 M2) + w3 M3, as columns (0, 1) and (2, 3).
+static void
+blendMatricesAvx2(__m256 columns[2], TmMat4 const *palette, uint16_t const *joints, TmVec4 const *weights)
+{
+    TmScalar const *w = &weights->x;
+    TmScalar const *m = (TmScalar const *)&palette[joints[0]];
+    __m256 weight = _mm256_set1_ps(w[0]);
+
+    columns[0] = _mm256_mul_ps(weight, _mm256_loadu_ps(m));
+    columns[1] = _mm256_mul_ps(weight, _mm256_loadu_ps(m + 8));
+    for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+        m = (TmScalar const *)&palette[joints[k]];
+        weight = _mm256_set1_ps(w[k]);
+        columns[0] = _mm256_add_ps(columns[0], _mm256_mul_ps(weight, _mm256_loadu_ps(m)));
+        columns[1] = _mm256_add_ps(columns[1], _mm256_mul_ps(weight, _mm256_loadu_ps(m + 8)));
+    }
+}
+
+// Column c of four blended matrices, transposed to rows.
+static void
+transposeColumnAvx2(__m128 rows[3], __m256 (*blend)[2], int c)
+{
+    __m128 r[4];
+
+    for (int v = 0; v < 4; ++v) {
+        __m256 const pair = blend[v][c / 2];
+
+        r[v] = (c % 2 == 0) ? _mm256_castps256_ps128(pair) : _mm256_extractf128_ps(pair, 1);
+    }
+    _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+    rows[0] = r[0];
+    rows[1] = r[1];
+    rows[2] = r[2];
+}
+
+static void
+skinLinearAvx2(TmVec3 *positions,
+               TmVec3 *normals,
+               TmSkinMesh const *mesh,
+               TmMat4 const *palette,
+               size_t first,
+               size_t end)
+{
+    __m256 const zero = _mm256_setzero_ps();
+    size_t i = first;
+
+    for (; i + 8 <= end; i += 8) {
+        // m[r][c] holds element (r, c) of the eight blended matrices.
+        __m256 blend[8][2];
+        __m256 m[3][4];
+        __m256 p[3];
+
+        for (int v = 0; v < 8; ++v) {
+            blendMatricesAvx2(blend[v], palette, &mesh->joints[TM_SKIN_INFLUENCES * (i + v)], &mesh->weights[i + v]);
+        }
+        for (int c = 0; c < 4; ++c) {
+            __m128 low[3], high[3];
+
+            transposeColumnAvx2(low, &blend[0], c);
+            transposeColumnAvx2(high, &blend[4], c);
+            for (int r = 0; r < 3; ++r) {
+                m[r][c] = combineHalvesAvx2(low[r], high[r]);
+            }
+        }
+
+        loadVec3x8Avx2(p, &mesh->positions[i]);
+        storeVec3x8Avx2(&positions[i],
+                        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0][0], p[0]), _mm256_mul_ps(m[0][1], p[1])),
+                                                    _mm256_mul_ps(m[0][2], p[2])), m[0][3]),
+                        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[1][0], p[0]), _mm256_mul_ps(m[1][1], p[1])),
+                                                    _mm256_mul_ps(m[1][2], p[2])), m[1][3]),
+                        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[2][0], p[0]), _mm256_mul_ps(m[2][1], p[1])),
+                                                    _mm256_mul_ps(m[2][2], p[2])), m[2][3]));
+        if (mesh->normals != NULL) {
+            __m256 n[3], length, isNonZero;
+
+            loadVec3x8Avx2(p, &mesh->normals[i]);
+            for (int r = 0; r < 3; ++r) {
+                n[r] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[r][0], p[0]), _mm256_mul_ps(m[r][1], p[1])),
+                                     _mm256_mul_ps(m[r][2], p[2]));
+            }
+            length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(n[0], n[0]), _mm256_mul_ps(n[1], n[1])),
+                                                  _mm256_mul_ps(n[2], n[2])));
+            isNonZero = _mm256_cmp_ps(length, zero, _CMP_GT_OQ);
+            storeVec3x8Avx2(&normals[i],
+                            _mm256_blendv_ps(n[0], _mm256_div_ps(n[0], length), isNonZero),
+                            _mm256_blendv_ps(n[1], _mm256_div_ps(n[1], length), isNonZero),
+                            _mm256_blendv_ps(n[2], _mm256_div_ps(n[2], length), isNonZero));
+        }
+    }
+    tmSkinKernelsScalar.linear(positions, normals, mesh, palette, i, end);
+}
+
+// Influence k of vertices [i, i + 8).
+static void
+loadInfluenceAvx2(__m256 real[4], __m256 dual[4], TmSkinMesh const *mesh, TmDualQuat const *palette, size_t i, int k)
+{
+    uint16_t const *joints = &mesh->joints[TM_SKIN_INFLUENCES * i + (size_t)k];
+    __m128 lowReal[4], lowDual[4], highReal[4], highDual[4];
+    TmDualQuat const *dq[8];
+
+    for (int v = 0; v < 8; ++v) {
+        dq[v] = &palette[joints[TM_SKIN_INFLUENCES * v]];
+    }
+    sseLoadDualQuat4(lowReal, lowDual, &dq[0]);
+    sseLoadDualQuat4(highReal, highDual, &dq[4]);
+    for (int c = 0; c < 4; ++c) {
+        real[c] = combineHalvesAvx2(lowReal[c], highReal[c]);
+        dual[c] = combineHalvesAvx2(lowDual[c], highDual[c]);
+    }
+}
+
+// 2 (r x (r x v + w v)), the rotation's change to v.
+static void
+rotationOffsetAvx2(__m256 dest[3], __m256 const r[4], __m256 const v[3])
+{
+    __m256 const two = _mm256_set1_ps(2.0f);
+    __m256 t[3];
+
+    t[0] = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(r[1], v[2]), _mm256_mul_ps(r[2], v[1])), _mm256_mul_ps(r[3], v[0]));
+    t[1] = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(r[2], v[0]), _mm256_mul_ps(r[0], v[2])), _mm256_mul_ps(r[3], v[1]));
+    t[2] = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(r[0], v[1]), _mm256_mul_ps(r[1], v[0])), _mm256_mul_ps(r[3], v[2]));
+    dest[0] = _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(r[1], t[2]), _mm256_mul_ps(r[2], t[1])));
+    dest[1] = _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(r[2], t[0]), _mm256_mul_ps(r[0], t[2])));
+    dest[2] = _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(r[0], t[1]), _mm256_mul_ps(r[1], t[0])));
+}
+
+static void
+skinDualQuatAvx2(TmVec3 *positions,
+                 TmVec3 *normals,
+                 TmSkinMesh const *mesh,
+                 TmDualQuat const *palette,
+                 size_t first,
+                 size_t end)
+{
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const two = _mm256_set1_ps(2.0f);
+    __m256 const signBit = _mm256_set1_ps(-0.0f);
+    size_t i = first;
+
+    for (; i + 8 <= end; i += 8) {
+        __m128 lowWeights[4], highWeights[4];
+        __m256 w[4], r0[4], d0[4], r[4], d[4];
+        __m256 p[3], offset[3], translation[3], inverseLength;
+
+        sseLoadVec4x4(&lowWeights[0], &lowWeights[1], &lowWeights[2], &lowWeights[3], &mesh->weights[i]);
+        sseLoadVec4x4(&highWeights[0], &highWeights[1], &highWeights[2], &highWeights[3], &mesh->weights[i + 4]);
+        for (int k = 0; k < 4; ++k) {
+            w[k] = combineHalvesAvx2(lowWeights[k], highWeights[k]);
+        }
+        loadInfluenceAvx2(r0, d0, mesh, palette, i, 0);
+        for (int c = 0; c < 4; ++c) {
+            r[c] = _mm256_mul_ps(w[0], r0[c]);
+            d[c] = _mm256_mul_ps(w[0], d0[c]);
+        }
+        for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+            __m256 rk[4], dk[4], cosine, weight;
+
+            loadInfluenceAvx2(rk, dk, mesh, palette, i, k);
+            cosine = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rk[0], r0[0]), _mm256_mul_ps(rk[1], r0[1])),
+                                                 _mm256_mul_ps(rk[2], r0[2])),
+                                   _mm256_mul_ps(rk[3], r0[3]));
+            weight = _mm256_xor_ps(w[k], _mm256_and_ps(_mm256_cmp_ps(cosine, zero, _CMP_LT_OQ), signBit));
+            for (int c = 0; c < 4; ++c) {
+                r[c] = _mm256_add_ps(r[c], _mm256_mul_ps(weight, rk[c]));
+                d[c] = _mm256_add_ps(d[c], _mm256_mul_ps(weight, dk[c]));
+            }
+        }
+        inverseLength = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                      _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], r[0]),
+                                                                                               _mm256_mul_ps(r[1], r[1])),
+                                                                                 _mm256_mul_ps(r[2], r[2])),
+                                                                   _mm256_mul_ps(r[3], r[3]))));
+        for (int c = 0; c < 4; ++c) {
+            r[c] = _mm256_mul_ps(r[c], inverseLength);
+            d[c] = _mm256_mul_ps(d[c], inverseLength);
+        }
+
+        translation[0] = _mm256_mul_ps(two, _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(r[3], d[0]), _mm256_mul_ps(d[3], r[0])),
+                                                          _mm256_sub_ps(_mm256_mul_ps(r[1], d[2]), _mm256_mul_ps(r[2], d[1]))));
+        translation[1] = _mm256_mul_ps(two, _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(r[3], d[1]), _mm256_mul_ps(d[3], r[1])),
+                                                          _mm256_sub_ps(_mm256_mul_ps(r[2], d[0]), _mm256_mul_ps(r[0], d[2]))));
+        translation[2] = _mm256_mul_ps(two, _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(r[3], d[2]), _mm256_mul_ps(d[3], r[2])),
+                                                          _mm256_sub_ps(_mm256_mul_ps(r[0], d[1]), _mm256_mul_ps(r[1], d[0]))));
+        loadVec3x8Avx2(p, &mesh->positions[i]);
+        rotationOffsetAvx2(offset, r, p);
+        storeVec3x8Avx2(&positions[i],
+                        _mm256_add_ps(_mm256_add_ps(p[0], offset[0]), translation[0]),
+                        _mm256_add_ps(_mm256_add_ps(p[1], offset[1]), translation[1]),
+                        _mm256_add_ps(_mm256_add_ps(p[2], offset[2]), translation[2]));
+        if (mesh->normals != NULL) {
+            loadVec3x8Avx2(p, &mesh->normals[i]);
+            rotationOffsetAvx2(offset, r, p);
+            storeVec3x8Avx2(&normals[i],
+                            _mm256_add_ps(p[0], offset[0]),
+                            _mm256_add_ps(p[1], offset[1]),
+                            _mm256_add_ps(p[2], offset[2]));
+        }
+    }
+    tmSkinKernelsScalar.dualQuat(positions, normals, mesh, palette, i, end);
+}
+
+TmSkinKernels const tmSkinKernelsAvx2 = {
+    .linear = skinLinearAvx2,
+    .dualQuat = skinDualQuatAvx2
+};
@@ -0,0 +1,210 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// Four vertices at a time, with the same operations, in the same order,
+// as the scalar kernels in skinning.c. Linear blending sums whole matrix
+// columns per vertex, then transposes the blended matrices of the four
+// vertices to transform them lane-wise. Dual quaternions are transposed
+// as they are loaded. Tails fall back to the scalar kernels.
+
+static void
+transpose4Neon(float32x4_t dest[4], float32x4_t a, float32x4_t b, float32x4_t c, float32x4_t d)
+{
+    float32x4_t const ab0 = vtrn1q_f32(a, b);
+    float32x4_t const ab1 = vtrn2q_f32(a, b);
+    float32x4_t const cd0 = vtrn1q_f32(c, d);
+    float32x4_t const cd1 = vtrn2q_f32(c, d);
+
+    dest[0] = vcombine_f32(vget_low_f32(ab0), vget_low_f32(cd0));
+    dest[1] = vcombine_f32(vget_low_f32(ab1), vget_low_f32(cd1));
+    dest[2] = vcombine_f32(vget_high_f32(ab0), vget_high_f32(cd0));
+    dest[3] = vcombine_f32(vget_high_f32(ab1), vget_high_f32(cd1));
+}
+
+// Columns of ((w0 M0 + w1 M1) + w2 M2) + w3 M3.
+static void
+blendMatricesNeon(float32x4_t columns[4], TmMat4 const *palette, uint16_t const *joints, TmVec4 const *weights)
+{
+    float const *w = &weights->x;
+    float const *m = (float const *)&palette[joints[0]];
+    float32x4_t weight = vdupq_n_f32(w[0]);
+
+    for (int c = 0; c < 4; ++c) {
+        columns[c] = vmulq_f32(weight, vld1q_f32(m + 4 * c));
+    }
+    for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+        m = (float const *)&palette[joints[k]];
+        weight = vdupq_n_f32(w[k]);
+        for (int c = 0; c < 4; ++c) {
+            columns[c] = vaddq_f32(columns[c], vmulq_f32(weight, vld1q_f32(m + 4 * c)));
+        }
+    }
+}
+
+static void
+skinLinearNeon(TmVec3 *positions,
+               TmVec3 *normals,
+               TmSkinMesh const *mesh,
+               TmMat4 const *palette,
+               size_t first,
+               size_t end)
+{
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        // blend[v][c] is column c of vertex v; m[r][c] holds element
+        // (r, c) of the four vertices.
+        float32x4_t blend[4][4];
+        float32x4_t m[3][4];
+        float32x4x3_t p, result;
+
+        for (int v = 0; v < 4; ++v) {
+            blendMatricesNeon(blend[v], palette, &mesh->joints[TM_SKIN_INFLUENCES * (i + v)], &mesh->weights[i + v]);
+        }
+        for (int c = 0; c < 4; ++c) {
+            float32x4_t rows[4];
+
+            transpose4Neon(rows, blend[0][c], blend[1][c], blend[2][c], blend[3][c]);
+            m[0][c] = rows[0];
+            m[1][c] = rows[1];
+            m[2][c] = rows[2];
+        }
+
+        p = vld3q_f32((float const *)&mesh->positions[i]);
+        for (int r = 0; r < 3; ++r) {
+            result.val[r] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(m[r][0], p.val[0]), vmulq_f32(m[r][1], p.val[1])),
+                                                vmulq_f32(m[r][2], p.val[2])), m[r][3]);
+        }
+        vst3q_f32((float *)&positions[i], result);
+        if (mesh->normals != NULL) {
+            float32x4_t length;
+            uint32x4_t isNonZero;
+
+            p = vld3q_f32((float const *)&mesh->normals[i]);
+            for (int r = 0; r < 3; ++r) {
+                result.val[r] = vaddq_f32(vaddq_f32(vmulq_f32(m[r][0], p.val[0]), vmulq_f32(m[r][1], p.val[1])),
+                                          vmulq_f32(m[r][2], p.val[2]));
+            }
+            length = vsqrtq_f32(vaddq_f32(vaddq_f32(vmulq_f32(result.val[0], result.val[0]),
+                                                    vmulq_f32(result.val[1], result.val[1])),
+                                          vmulq_f32(result.val[2], result.val[2])));
+            isNonZero = vcgtq_f32(length, zero);
+            for (int r = 0; r < 3; ++r) {
+                result.val[r] = vbslq_f32(isNonZero, vdivq_f32(result.val[r], length), result.val[r]);
+            }
+            vst3q_f32((float *)&normals[i], result);
+        }
+    }
+    tmSkinKernelsScalar.linear(positions, normals, mesh, palette, i, end);
+}
+
+// Influence k of vertices [i, i + 4).
+static void
+loadInfluenceNeon(float32x4_t real[4], float32x4_t dual[4], TmSkinMesh const *mesh, TmDualQuat const *palette, size_t i, int k)
+{
+    uint16_t const *joints = &mesh->joints[TM_SKIN_INFLUENCES * i + (size_t)k];
+    float32x4_t r[4], d[4];
+
+    for (int v = 0; v < 4; ++v) {
+        TmDualQuat const *dq = &palette[joints[TM_SKIN_INFLUENCES * v]];
+
+        r[v] = vld1q_f32(&dq->real.x);
+        d[v] = vld1q_f32(&dq->dual.x);
+    }
+    transpose4Neon(real, r[0], r[1], r[2], r[3]);
+    transpose4Neon(dual, d[0], d[1], d[2], d[3]);
+}
+
+// 2 (r x (r x v + w v)), the rotation's change to v.
+static void
+rotationOffsetNeon(float32x4_t dest[3], float32x4_t const r[4], float32x4x3_t const *v)
+{
+    float32x4_t const two = vdupq_n_f32(2.0f);
+    float32x4_t t[3];
+
+    t[0] = vaddq_f32(vsubq_f32(vmulq_f32(r[1], v->val[2]), vmulq_f32(r[2], v->val[1])), vmulq_f32(r[3], v->val[0]));
+    t[1] = vaddq_f32(vsubq_f32(vmulq_f32(r[2], v->val[0]), vmulq_f32(r[0], v->val[2])), vmulq_f32(r[3], v->val[1]));
+    t[2] = vaddq_f32(vsubq_f32(vmulq_f32(r[0], v->val[1]), vmulq_f32(r[1], v->val[0])), vmulq_f32(r[3], v->val[2]));
+    dest[0] = vmulq_f32(two, vsubq_f32(vmulq_f32(r[1], t[2]), vmulq_f32(r[2], t[1])));
+    dest[1] = vmulq_f32(two, vsubq_f32(vmulq_f32(r[2], t[0]), vmulq_f32(r[0], t[2])));
+    dest[2] = vmulq_f32(two, vsubq_f32(vmulq_f32(r[0], t[1]), vmulq_f32(r[1], t[0])));
+}
+
+static void
+skinDualQuatNeon(TmVec3 *positions,
+                 TmVec3 *normals,
+                 TmSkinMesh const *mesh,
+                 TmDualQuat const *palette,
+                 size_t first,
+                 size_t end)
+{
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+    float32x4_t const two = vdupq_n_f32(2.0f);
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        float32x4x4_t const w = vld4q_f32((float const *)&mesh->weights[i]);
+        float32x4_t r0[4], d0[4], r[4], d[4];
+        float32x4_t offset[3], translation[3], inverseLength;
+        float32x4x3_t p, result;
+
+        loadInfluenceNeon(r0, d0, mesh, palette, i, 0);
+        for (int c = 0; c < 4; ++c) {
+            r[c] = vmulq_f32(w.val[0], r0[c]);
+            d[c] = vmulq_f32(w.val[0], d0[c]);
+        }
+        for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+            float32x4_t rk[4], dk[4], cosine, weight;
+
+            loadInfluenceNeon(rk, dk, mesh, palette, i, k);
+            cosine = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(rk[0], r0[0]), vmulq_f32(rk[1], r0[1])),
+                                         vmulq_f32(rk[2], r0[2])),
+                               vmulq_f32(rk[3], r0[3]));
+            weight = vbslq_f32(vcltq_f32(cosine, zero), vnegq_f32(w.val[k]), w.val[k]);
+            for (int c = 0; c < 4; ++c) {
+                r[c] = vaddq_f32(r[c], vmulq_f32(weight, rk[c]));
+                d[c] = vaddq_f32(d[c], vmulq_f32(weight, dk[c]));
+            }
+        }
+        inverseLength = vdivq_f32(vdupq_n_f32(1.0f),
+                                  vsqrtq_f32(vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(r[0], r[0]), vmulq_f32(r[1], r[1])),
+                                                                 vmulq_f32(r[2], r[2])),
+                                                       vmulq_f32(r[3], r[3]))));
+        for (int c = 0; c < 4; ++c) {
+            r[c] = vmulq_f32(r[c], inverseLength);
+            d[c] = vmulq_f32(d[c], inverseLength);
+        }
+
+        translation[0] = vmulq_f32(two, vaddq_f32(vsubq_f32(vmulq_f32(r[3], d[0]), vmulq_f32(d[3], r[0])),
+                                                  vsubq_f32(vmulq_f32(r[1], d[2]), vmulq_f32(r[2], d[1]))));
+        translation[1] = vmulq_f32(two, vaddq_f32(vsubq_f32(vmulq_f32(r[3], d[1]), vmulq_f32(d[3], r[1])),
+                                                  vsubq_f32(vmulq_f32(r[2], d[0]), vmulq_f32(r[0], d[2]))));
+        translation[2] = vmulq_f32(two, vaddq_f32(vsubq_f32(vmulq_f32(r[3], d[2]), vmulq_f32(d[3], r[2])),
+                                                  vsubq_f32(vmulq_f32(r[0], d[1]), vmulq_f32(r[1], d[0]))));
+        p = vld3q_f32((float const *)&mesh->positions[i]);
+        rotationOffsetNeon(offset, r, &p);
+        for (int k = 0; k < 3; ++k) {
+            result.val[k] = vaddq_f32(vaddq_f32(p.val[k], offset[k]), translation[k]);
+        }
+        vst3q_f32((float *)&positions[i], result);
+        if (mesh->normals != NULL) {
+            p = vld3q_f32((float const *)&mesh->normals[i]);
+            rotationOffsetNeon(offset, r, &p);
+            for (int k = 0; k < 3; ++k) {
+                result.val[k] = vaddq_f32(p.val[k], offset[k]);
+            }
+            vst3q_f32((float *)&normals[i], result);
+        }
+    }
+    tmSkinKernelsScalar.dualQuat(positions, normals, mesh, palette, i, end);
+}
+
+TmSkinKernels const tmSkinKernelsNeon = {
+    .linear = skinLinearNeon,
+    .dualQuat = skinDualQuatNeon
+};
@@ -0,0 +1,206 @@
+#include <assert.h>
+#include <emmintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// Four vertices at a time, with the same operations, in the same order,
+// as the scalar kernels in skinning.c. Linear blending sums whole matrix
+// columns per vertex, then transposes the blended matrices of the four
+// vertices to transform them lane-wise. Dual quaternions are transposed
+// as they are loaded. Tails fall back to the scalar kernels.
+
+// mask ? a : b
+static __m128
+selectSse2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Columns of ((w0 M0 + w1 M1) + w2 M2) + w3 M3.
+static void
+blendMatricesSse2(__m128 columns[4], TmMat4 const *palette, uint16_t const *joints, TmVec4 const *weights)
+{
+    TmScalar const *w = &weights->x;
+    TmScalar const *m = (TmScalar const *)&palette[joints[0]];
+    __m128 weight = _mm_set1_ps(w[0]);
+
+    for (int c = 0; c < 4; ++c) {
+        columns[c] = _mm_mul_ps(weight, _mm_loadu_ps(m + 4 * c));
+    }
+    for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+        m = (TmScalar const *)&palette[joints[k]];
+        weight = _mm_set1_ps(w[k]);
+        for (int c = 0; c < 4; ++c) {
+            columns[c] = _mm_add_ps(columns[c], _mm_mul_ps(weight, _mm_loadu_ps(m + 4 * c)));
+        }
+    }
+}
+
+static void
+skinLinearSse2(TmVec3 *positions,
+               TmVec3 *normals,
+               TmSkinMesh const *mesh,
+               TmMat4 const *palette,
+               size_t first,
+               size_t end)
+{
+    __m128 const zero = _mm_setzero_ps();
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        // blend[v][c] is column c of vertex v; m[r][c] holds element
+        // (r, c) of the four vertices.
+        __m128 blend[4][4];
+        __m128 m[3][4];
+        __m128 x, y, z;
+
+        for (int v = 0; v < 4; ++v) {
+            blendMatricesSse2(blend[v], palette, &mesh->joints[TM_SKIN_INFLUENCES * (i + v)], &mesh->weights[i + v]);
+        }
+        for (int c = 0; c < 4; ++c) {
+            __m128 r0 = blend[0][c];
+            __m128 r1 = blend[1][c];
+            __m128 r2 = blend[2][c];
+            __m128 r3 = blend[3][c];
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            m[0][c] = r0;
+            m[1][c] = r1;
+            m[2][c] = r2;
+        }
+
+        sseLoadVec3x4(&x, &y, &z, &mesh->positions[i]);
+        sseStoreVec3x4(&positions[i],
+                       _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], x), _mm_mul_ps(m[0][1], y)),
+                                             _mm_mul_ps(m[0][2], z)), m[0][3]),
+                       _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1][0], x), _mm_mul_ps(m[1][1], y)),
+                                             _mm_mul_ps(m[1][2], z)), m[1][3]),
+                       _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2][0], x), _mm_mul_ps(m[2][1], y)),
+                                             _mm_mul_ps(m[2][2], z)), m[2][3]));
+        if (mesh->normals != NULL) {
+            __m128 n[3], length, isNonZero;
+
+            sseLoadVec3x4(&x, &y, &z, &mesh->normals[i]);
+            for (int r = 0; r < 3; ++r) {
+                n[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[r][0], x), _mm_mul_ps(m[r][1], y)),
+                                  _mm_mul_ps(m[r][2], z));
+            }
+            length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0], n[0]), _mm_mul_ps(n[1], n[1])),
+                                            _mm_mul_ps(n[2], n[2])));
+            isNonZero = _mm_cmpgt_ps(length, zero);
+            sseStoreVec3x4(&normals[i],
+                           selectSse2(isNonZero, _mm_div_ps(n[0], length), n[0]),
+                           selectSse2(isNonZero, _mm_div_ps(n[1], length), n[1]),
+                           selectSse2(isNonZero, _mm_div_ps(n[2], length), n[2]));
+        }
+    }
+    tmSkinKernelsScalar.linear(positions, normals, mesh, palette, i, end);
+}
+
+// Influence k of vertices [i, i + 4).
+static void
+loadInfluenceSse2(__m128 real[4], __m128 dual[4], TmSkinMesh const *mesh, TmDualQuat const *palette, size_t i, int k)
+{
+    uint16_t const *joints = &mesh->joints[TM_SKIN_INFLUENCES * i + (size_t)k];
+    TmDualQuat const *const dq[4] = {
+        &palette[joints[0]],
+        &palette[joints[TM_SKIN_INFLUENCES]],
+        &palette[joints[2 * TM_SKIN_INFLUENCES]],
+        &palette[joints[3 * TM_SKIN_INFLUENCES]]
+    };
+
+    sseLoadDualQuat4(real, dual, dq);
+}
+
+// 2 (r x (r x v + w v)), the rotation's change to v.
+static void
+rotationOffsetSse2(__m128 dest[3], __m128 const r[4], __m128 const v[3])
+{
+    __m128 const two = _mm_set1_ps(2.0f);
+    __m128 t[3];
+
+    t[0] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(r[1], v[2]), _mm_mul_ps(r[2], v[1])), _mm_mul_ps(r[3], v[0]));
+    t[1] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(r[2], v[0]), _mm_mul_ps(r[0], v[2])), _mm_mul_ps(r[3], v[1]));
+    t[2] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(r[0], v[1]), _mm_mul_ps(r[1], v[0])), _mm_mul_ps(r[3], v[2]));
+    dest[0] = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(r[1], t[2]), _mm_mul_ps(r[2], t[1])));
+    dest[1] = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(r[2], t[0]), _mm_mul_ps(r[0], t[2])));
+    dest[2] = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(r[0], t[1]), _mm_mul_ps(r[1], t[0])));
+}
+
+static void
+skinDualQuatSse2(TmVec3 *positions,
+                 TmVec3 *normals,
+                 TmSkinMesh const *mesh,
+                 TmDualQuat const *palette,
+                 size_t first,
+                 size_t end)
+{
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const two = _mm_set1_ps(2.0f);
+    __m128 const signBit = _mm_set1_ps(-0.0f);
+    size_t i = first;
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 w[4], r0[4], d0[4], r[4], d[4];
+        __m128 p[3], offset[3], translation[3], inverseLength;
+
+        sseLoadVec4x4(&w[0], &w[1], &w[2], &w[3], &mesh->weights[i]);
+        loadInfluenceSse2(r0, d0, mesh, palette, i, 0);
+        for (int c = 0; c < 4; ++c) {
+            r[c] = _mm_mul_ps(w[0], r0[c]);
+            d[c] = _mm_mul_ps(w[0], d0[c]);
+        }
+        for (int k = 1; k < TM_SKIN_INFLUENCES; ++k) {
+            __m128 rk[4], dk[4], cosine, weight;
+
+            loadInfluenceSse2(rk, dk, mesh, palette, i, k);
+            cosine = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rk[0], r0[0]), _mm_mul_ps(rk[1], r0[1])),
+                                           _mm_mul_ps(rk[2], r0[2])),
+                                _mm_mul_ps(rk[3], r0[3]));
+            weight = _mm_xor_ps(w[k], _mm_and_ps(_mm_cmplt_ps(cosine, zero), signBit));
+            for (int c = 0; c < 4; ++c) {
+                r[c] = _mm_add_ps(r[c], _mm_mul_ps(weight, rk[c]));
+                d[c] = _mm_add_ps(d[c], _mm_mul_ps(weight, dk[c]));
+            }
+        }
+        inverseLength = _mm_div_ps(_mm_set1_ps(1.0f),
+                                   _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]),
+                                                                                _mm_mul_ps(r[1], r[1])),
+                                                                     _mm_mul_ps(r[2], r[2])),
+                                                          _mm_mul_ps(r[3], r[3]))));
+        for (int c = 0; c < 4; ++c) {
+            r[c] = _mm_mul_ps(r[c], inverseLength);
+            d[c] = _mm_mul_ps(d[c], inverseLength);
+        }
+
+        translation[0] = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(r[3], d[0]), _mm_mul_ps(d[3], r[0])),
+                                                    _mm_sub_ps(_mm_mul_ps(r[1], d[2]), _mm_mul_ps(r[2], d[1]))));
+        translation[1] = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(r[3], d[1]), _mm_mul_ps(d[3], r[1])),
+                                                    _mm_sub_ps(_mm_mul_ps(r[2], d[0]), _mm_mul_ps(r[0], d[2]))));
+        translation[2] = _mm_mul_ps(two, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(r[3], d[2]), _mm_mul_ps(d[3], r[2])),
+                                                    _mm_sub_ps(_mm_mul_ps(r[0], d[1]), _mm_mul_ps(r[1], d[0]))));
+        sseLoadVec3x4(&p[0], &p[1], &p[2], &mesh->positions[i]);
+        rotationOffsetSse2(offset, r, p);
+        sseStoreVec3x4(&positions[i],
+                       _mm_add_ps(_mm_add_ps(p[0], offset[0]), translation[0]),
+                       _mm_add_ps(_mm_add_ps(p[1], offset[1]), translation[1]),
+                       _mm_add_ps(_mm_add_ps(p[2], offset[2]), translation[2]));
+        if (mesh->normals != NULL) {
+            sseLoadVec3x4(&p[0], &p[1], &p[2], &mesh->normals[i]);
+            rotationOffsetSse2(offset, r, p);
+            sseStoreVec3x4(&normals[i],
+                           _mm_add_ps(p[0], offset[0]),
+                           _mm_add_ps(p[1], offset[1]),
+                           _mm_add_ps(p[2], offset[2]));
+        }
+    }
+    tmSkinKernelsScalar.dualQuat(positions, normals, mesh, palette, i, end);
+}
+
+TmSkinKernels const tmSkinKernelsSse2 = {
+    .linear = skinLinearSse2,
+    .dualQuat = skinDualQuatSse2
+};
@@ -0,0 +1,222 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "transform.h"
+
+// Per-node flags. UPDATED is only meaningful from firstDirty on, for the
+// update that wrote it.
+#define TRANSFORM_FLAG_DIRTY   0x1
+#define TRANSFORM_FLAG_UPDATED 0x2
+
+static bool
+growArray(void **array, size_t capacity, size_t elementSize)
+{
+    void *grown = realloc(*array, capacity * elementSize);
+
+    if (grown == NULL) {
+        return false;
+    }
+    *array = grown;
+
+    return true;
+}
+
+static bool
+reserve(TmTransformHierarchy *hierarchy, size_t capacity)
+{
+    // A failed realloc leaves the array as it was, so the hierarchy stays
+    // usable at its old capacity.
+    if (!growArray((void **)&hierarchy->translations, capacity, sizeof(*hierarchy->translations)) ||
+        !growArray((void **)&hierarchy->rotations, capacity, sizeof(*hierarchy->rotations)) ||
+        !growArray((void **)&hierarchy->scales, capacity, sizeof(*hierarchy->scales)) ||
+        !growArray((void **)&hierarchy->parents, capacity, sizeof(*hierarchy->parents)) ||
+        !growArray((void **)&hierarchy->locals, capacity, sizeof(*hierarchy->locals)) ||
+        !growArray((void **)&hierarchy->worlds, capacity, sizeof(*hierarchy->worlds)) ||
+        !growArray((void **)&hierarchy->flags, capacity, sizeof(*hierarchy->flags))) {
+        return false;
+    }
+    hierarchy->capacity = capacity;
+
+    return true;
+}
+
+static void
+markDirty(TmTransformHierarchy *hierarchy, uint32_t node)
+{
+    assert(node < hierarchy->count);
+    hierarchy->flags[node] |= TRANSFORM_FLAG_DIRTY;
+    if (node < hierarchy->firstDirty) {
+        hierarchy->firstDirty = node;
+    }
+}
+
+bool
+tmTransformHierarchyInit(TmTransformHierarchy *hierarchy, size_t capacity)
+{
+    memset(hierarchy, 0, sizeof(*hierarchy));
+    if (capacity > 0 && !reserve(hierarchy, capacity)) {
+        tmTransformHierarchyFree(hierarchy);
+        return false;
+    }
+
+    return true;
+}
+
+void
+tmTransformHierarchyFree(TmTransformHierarchy *hierarchy)
+{
+    free(hierarchy->translations);
+    free(hierarchy->rotations);
+    free(hierarchy->scales);
+    free(hierarchy->parents);
+    free(hierarchy->locals);
+    free(hierarchy->worlds);
+    free(hierarchy->flags);
+    memset(hierarchy, 0, sizeof(*hierarchy));
+}
+
+uint32_t
+tmTransformHierarchyAdd(TmTransformHierarchy *hierarchy, uint32_t parent)
+{
+    size_t const node = hierarchy->count;
+
+    assert(parent == TM_TRANSFORM_NO_PARENT || parent < node);
+    if (node >= TM_TRANSFORM_NO_PARENT) {
+        return TM_TRANSFORM_NO_PARENT;
+    }
+    if (node == hierarchy->capacity &&
+        !reserve(hierarchy, (hierarchy->capacity > 0) ? 2 * hierarchy->capacity : 16)) {
+        return TM_TRANSFORM_NO_PARENT;
+    }
+
+    hierarchy->translations[node] = (TmVec3){0.0f, 0.0f, 0.0f};
+    hierarchy->rotations[node] = TM_QUAT_IDENTITY;
+    hierarchy->scales[node] = (TmVec3){1.0f, 1.0f, 1.0f};
+    hierarchy->parents[node] = parent;
+    hierarchy->flags[node] = 0;
+    hierarchy->count = node + 1;
+    markDirty(hierarchy, (uint32_t)node);
+
+    return (uint32_t)node;
+}
+
+void
+tmTransformHierarchyMarkDirty(TmTransformHierarchy *hierarchy, size_t first, size_t count)
+{
+    assert(first + count <= hierarchy->count);
+    for (size_t i = first; i < first + count; ++i) {
+        hierarchy->flags[i] |= TRANSFORM_FLAG_DIRTY;
+    }
+    if (count > 0 && first < hierarchy->firstDirty) {
+        hierarchy->firstDirty = first;
+    }
+}
+
+void
+tmTransformHierarchySetTranslation(TmTransformHierarchy *hierarchy,
+                                   uint32_t node,
+                                   TmVec3 const *translation)
+{
+    markDirty(hierarchy, node);
+    hierarchy->translations[node] = *translation;
+}
+
+void
+tmTransformHierarchySetRotation(TmTransformHierarchy *hierarchy,
+                                uint32_t node,
+                                TmQuat const *rotation)
+{
+    markDirty(hierarchy, node);
+    hierarchy->rotations[node] = *rotation;
+}
+
+void
+tmTransformHierarchySetScale(TmTransformHierarchy *hierarchy,
+                             uint32_t node,
+                             TmVec3 const *scale)
+{
+    markDirty(hierarchy, node);
+    hierarchy->scales[node] = *scale;
+}
+
+size_t
+tmTransformHierarchyUpdate(TmTransformHierarchy *hierarchy)
+{
+    size_t const first = hierarchy->firstDirty;
+    size_t updated = 0;
+
+    // Locals first, in a pass of independent nodes, then worlds, which
+    // depend on their parents'.
+    for (size_t i = first; i < hierarchy->count; ++i) {
+        if (hierarchy->flags[i] & TRANSFORM_FLAG_DIRTY) {
+            tmTransformCompose(&hierarchy->locals[i],
+                               &hierarchy->translations[i],
+                               &hierarchy->rotations[i],
+                               &hierarchy->scales[i]);
+        }
+    }
+    // Nothing before first changed, so a parent there was not updated
+    // whatever its stale flags say.
+    for (size_t i = first; i < hierarchy->count; ++i) {
+        uint32_t const parent = hierarchy->parents[i];
+        bool const isRoot = (parent == TM_TRANSFORM_NO_PARENT);
+        bool const isUpdated = (hierarchy->flags[i] & TRANSFORM_FLAG_DIRTY) ||
+                               (!isRoot && parent >= first &&
+                                (hierarchy->flags[parent] & TRANSFORM_FLAG_UPDATED));
+
+        if (!isUpdated) {
+            hierarchy->flags[i] = 0;
+            continue;
+        }
+        if (isRoot) {
+            hierarchy->worlds[i] = hierarchy->locals[i];
+        } else {
+            tmMat4Multiply(&hierarchy->worlds[i], &hierarchy->worlds[parent], &hierarchy->locals[i]);
+        }
+        hierarchy->flags[i] = TRANSFORM_FLAG_UPDATED;
+        ++updated;
+    }
+    hierarchy->firstDirty = hierarchy->count;
+
+    return updated;
+}
+
+TmMat4 *
+tmTransformCompose(TmMat4 *dest,
+                   TmVec3 const *translation,
+                   TmQuat const *rotation,
+                   TmVec3 const *scale)
+{
+    // tmQuatToMat4 with each column scaled, written once.
+    TmScalar const xx = rotation->x * rotation->x;
+    TmScalar const yy = rotation->y * rotation->y;
+    TmScalar const zz = rotation->z * rotation->z;
+    TmScalar const xy = rotation->x * rotation->y;
+    TmScalar const xz = rotation->x * rotation->z;
+    TmScalar const yz = rotation->y * rotation->z;
+    TmScalar const wx = rotation->w * rotation->x;
+    TmScalar const wy = rotation->w * rotation->y;
+    TmScalar const wz = rotation->w * rotation->z;
+
+    dest->m11 = (1.0f - 2.0f * (yy + zz)) * scale->x;
+    dest->m21 = 2.0f * (xy + wz) * scale->x;
+    dest->m31 = 2.0f * (xz - wy) * scale->x;
+    dest->m41 = 0.0f;
+
+    dest->m12 = 2.0f * (xy - wz) * scale->y;
+    dest->m22 = (1.0f - 2.0f * (xx + zz)) * scale->y;
+    dest->m32 = 2.0f * (yz + wx) * scale->y;
+    dest->m42 = 0.0f;
+
+    dest->m13 = 2.0f * (xz + wy) * scale->z;
+    dest->m23 = 2.0f * (yz - wx) * scale->z;
+    dest->m33 = (1.0f - 2.0f * (xx + yy)) * scale->z;
+    dest->m43 = 0.0f;
+
+    dest->m14 = translation->x;
+    dest->m24 = translation->y;
+    dest->m34 = translation->z;
+    dest->m44 = 1.0f;
+
+    return dest;
+}
@@ -0,0 +1,516 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include "simd_private.h"
+#include "vector_soa.h"
+
+// Composite operations run in blocks so that their intermediate
+// results stay on the stack and in L1.
+#define SOA_BLOCK_COUNT 256
+
+// Rounds counts up so every component array starts on an aligned
+// boundary and can be processed in whole 8-wide vectors.
+#define SOA_COUNT_GRANULARITY (TM_SOA_ALIGNMENT / sizeof(TmScalar))
+
+static TmScalar *
+allocComponents(size_t componentCount, size_t *pStride, size_t count)
+{
+    size_t const stride = ((count + SOA_COUNT_GRANULARITY - 1) / SOA_COUNT_GRANULARITY) * SOA_COUNT_GRANULARITY;
+    size_t const size = componentCount * (stride > 0 ? stride : SOA_COUNT_GRANULARITY) * sizeof(TmScalar);
+
+    *pStride = stride;
+#ifdef _WIN32
+    return (TmScalar *)_aligned_malloc(size, TM_SOA_ALIGNMENT);
+#else
+    return (TmScalar *)aligned_alloc(TM_SOA_ALIGNMENT, size);
+#endif
+}
+
+static void
+freeComponents(TmScalar *block)
+{
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+static size_t
+blockCount(size_t start, size_t count)
+{
+    return (count - start < SOA_BLOCK_COUNT) ? count - start : SOA_BLOCK_COUNT;
+}
+
+static void
+soaAddScalar(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = p[i] + q[i];
+    }
+}
+
+static void
+soaSubScalar(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = p[i] - q[i];
+    }
+}
+
+static void
+soaMultiplyScalar(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = p[i] * q[i];
+    }
+}
+
+static void
+soaDivideScalar(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = p[i] / q[i];
+    }
+}
+
+static void
+soaScaleScalar(TmScalar *dest, TmScalar scale, TmScalar const *p, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = scale * p[i];
+    }
+}
+
+static void
+soaSquareRootScalar(TmScalar *dest, TmScalar const *p, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = tmScalarSqrt(p[i]);
+    }
+}
+
+static void
+soaDot3Scalar(TmScalar *dest, TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = ((p[0][i] * q[0][i]) +
+                   (p[1][i] * q[1][i]) +
+                   (p[2][i] * q[2][i]));
+    }
+}
+
+static void
+soaDot4Scalar(TmScalar *dest, TmScalar const *const p[4], TmScalar const *const q[4], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = ((p[0][i] * q[0][i]) +
+                   (p[1][i] * q[1][i]) +
+                   (p[2][i] * q[2][i]) +
+                   (p[3][i] * q[3][i]));
+    }
+}
+
+static void
+soaCrossScalar(TmScalar *const dest[3], TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        TmScalar const x = (p[1][i] * q[2][i]) - (p[2][i] * q[1][i]);
+        TmScalar const y = (p[2][i] * q[0][i]) - (p[0][i] * q[2][i]);
+        TmScalar const z = (p[0][i] * q[1][i]) - (p[1][i] * q[0][i]);
+
+        dest[0][i] = x;
+        dest[1][i] = y;
+        dest[2][i] = z;
+    }
+}
+
+static void
+soaFromAoS3Scalar(TmScalar *const dest[3], TmVec3 const *src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[0][i] = src[i].x;
+        dest[1][i] = src[i].y;
+        dest[2][i] = src[i].z;
+    }
+}
+
+static void
+soaToAoS3Scalar(TmVec3 *dest, TmScalar const *const src[3], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i].x = src[0][i];
+        dest[i].y = src[1][i];
+        dest[i].z = src[2][i];
+    }
+}
+
+static void
+soaFromAoS4Scalar(TmScalar *const dest[4], TmVec4 const *src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[0][i] = src[i].x;
+        dest[1][i] = src[i].y;
+        dest[2][i] = src[i].z;
+        dest[3][i] = src[i].w;
+    }
+}
+
+static void
+soaToAoS4Scalar(TmVec4 *dest, TmScalar const *const src[4], size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        dest[i].x = src[0][i];
+        dest[i].y = src[1][i];
+        dest[i].z = src[2][i];
+        dest[i].w = src[3][i];
+    }
+}
+
+TmSoAKernels const tmSoAKernelsScalar = {
+    .add = soaAddScalar,
+    .sub = soaSubScalar,
+    .multiply = soaMultiplyScalar,
+    .divide = soaDivideScalar,
+    .scale = soaScaleScalar,
+    .squareRoot = soaSquareRootScalar,
+    .dot3 = soaDot3Scalar,
+    .dot4 = soaDot4Scalar,
+    .cross = soaCrossScalar,
+    .fromAoS3 = soaFromAoS3Scalar,
+    .toAoS3 = soaToAoS3Scalar,
+    .fromAoS4 = soaFromAoS4Scalar,
+    .toAoS4 = soaToAoS4Scalar
+};
+
+bool
+tmVec3SoAAlloc(TmVec3SoA *soa, size_t count)
+{
+    size_t stride;
+    TmScalar * const block = allocComponents(3, &stride, count);
+
+    if (block == NULL) {
+        return false;
+    }
+    soa->x = block;
+    soa->y = block + stride;
+    soa->z = block + 2 * stride;
+    soa->count = count;
+
+    return true;
+}
+
+void
+tmVec3SoAFree(TmVec3SoA *soa)
+{
+    freeComponents(soa->x);
+    soa->x = NULL;
+    soa->y = NULL;
+    soa->z = NULL;
+    soa->count = 0;
+}
+
+TmVec3SoA *
+tmVec3SoAFromAoS(TmVec3SoA *dest, TmVec3 const *src)
+{
+    TmScalar *const destComponents[3] = {dest->x, dest->y, dest->z};
+
+    tmSimdSoAKernels()->fromAoS3(destComponents, src, dest->count);
+
+    return dest;
+}
+
+TmVec3 *
+tmVec3SoAToAoS(TmVec3 *dest, TmVec3SoA const *src)
+{
+    TmScalar const *const srcComponents[3] = {src->x, src->y, src->z};
+
+    tmSimdSoAKernels()->toAoS3(dest, srcComponents, src->count);
+
+    return dest;
+}
+
+TmVec3SoA *
+tmVec3SoAAdd(TmVec3SoA *dest, TmVec3SoA const *p, TmVec3SoA const *q)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count && p->count == q->count);
+    kernels->add(dest->x, p->x, q->x, p->count);
+    kernels->add(dest->y, p->y, q->y, p->count);
+    kernels->add(dest->z, p->z, q->z, p->count);
+
+    return dest;
+}
+
+TmVec3SoA *
+tmVec3SoACross(TmVec3SoA *dest, TmVec3SoA const *p, TmVec3SoA const *q)
+{
+    TmScalar *const destComponents[3] = {dest->x, dest->y, dest->z};
+    TmScalar const *const pComponents[3] = {p->x, p->y, p->z};
+    TmScalar const *const qComponents[3] = {q->x, q->y, q->z};
+
+    assert(dest->count == p->count && p->count == q->count);
+    tmSimdSoAKernels()->cross(destComponents, pComponents, qComponents, p->count);
+
+    return dest;
+}
+
+TmScalar *
+tmVec3SoADot(TmScalar *dest, TmVec3SoA const *p, TmVec3SoA const *q)
+{
+    TmScalar const *const pComponents[3] = {p->x, p->y, p->z};
+    TmScalar const *const qComponents[3] = {q->x, q->y, q->z};
+
+    assert(p->count == q->count);
+    tmSimdSoAKernels()->dot3(dest, pComponents, qComponents, p->count);
+
+    return dest;
+}
+
+TmScalar *
+tmVec3SoALength(TmScalar *dest, TmVec3SoA const *p)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+    TmScalar const *const pComponents[3] = {p->x, p->y, p->z};
+
+    kernels->dot3(dest, pComponents, pComponents, p->count);
+    kernels->squareRoot(dest, dest, p->count);
+
+    return dest;
+}
+
+TmVec3SoA *
+tmVec3SoANormalize(TmVec3SoA *dest, TmVec3SoA const *p)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    // Unlike tmVec3Normalize, zero-length vectors are not asserted on;
+    // they produce non-finite components.
+    assert(dest->count == p->count);
+    for (size_t start = 0; start < p->count; start += SOA_BLOCK_COUNT) {
+        size_t const count = blockCount(start, p->count);
+        TmScalar const *const pComponents[3] = {p->x + start, p->y + start, p->z + start};
+        TmScalar length[SOA_BLOCK_COUNT];
+
+        kernels->dot3(length, pComponents, pComponents, count);
+        kernels->squareRoot(length, length, count);
+        kernels->divide(dest->x + start, p->x + start, length, count);
+        kernels->divide(dest->y + start, p->y + start, length, count);
+        kernels->divide(dest->z + start, p->z + start, length, count);
+    }
+
+    return dest;
+}
+
+TmVec3SoA *
+tmVec3SoAProjection(TmVec3SoA *pOntoQ, TmVec3SoA const *p, TmVec3SoA const *q)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(pOntoQ->count == p->count && p->count == q->count);
+    for (size_t start = 0; start < p->count; start += SOA_BLOCK_COUNT) {
+        size_t const count = blockCount(start, p->count);
+        TmScalar const *const pComponents[3] = {p->x + start, p->y + start, p->z + start};
+        TmScalar const *const qComponents[3] = {q->x + start, q->y + start, q->z + start};
+        TmScalar pDotQ[SOA_BLOCK_COUNT];
+        TmScalar qLenSquared[SOA_BLOCK_COUNT];
+
+        kernels->dot3(pDotQ, pComponents, qComponents, count);
+        kernels->dot3(qLenSquared, qComponents, qComponents, count);
+        kernels->divide(pDotQ, pDotQ, qLenSquared, count);
+        kernels->multiply(pOntoQ->x + start, pDotQ, q->x + start, count);
+        kernels->multiply(pOntoQ->y + start, pDotQ, q->y + start, count);
+        kernels->multiply(pOntoQ->z + start, pDotQ, q->z + start, count);
+    }
+
+    return pOntoQ;
+}
+
+TmVec3SoA *
+tmVec3SoAScale(TmVec3SoA *dest, TmScalar scale, TmVec3SoA const *p)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count);
+    kernels->scale(dest->x, scale, p->x, p->count);
+    kernels->scale(dest->y, scale, p->y, p->count);
+    kernels->scale(dest->z, scale, p->z, p->count);
+
+    return dest;
+}
+
+TmVec3SoA *
+tmVec3SoASub(TmVec3SoA *dest, TmVec3SoA const *p, TmVec3SoA const *q)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count && p->count == q->count);
+    kernels->sub(dest->x, p->x, q->x, p->count);
+    kernels->sub(dest->y, p->y, q->y, p->count);
+    kernels->sub(dest->z, p->z, q->z, p->count);
+
+    return dest;
+}
+
+bool
+tmVec4SoAAlloc(TmVec4SoA *soa, size_t count)
+{
+    size_t stride;
+    TmScalar * const block = allocComponents(4, &stride, count);
+
+    if (block == NULL) {
+        return false;
+    }
+    soa->x = block;
+    soa->y = block + stride;
+    soa->z = block + 2 * stride;
+    soa->w = block + 3 * stride;
+    soa->count = count;
+
+    return true;
+}
+
+void
+tmVec4SoAFree(TmVec4SoA *soa)
+{
+    freeComponents(soa->x);
+    soa->x = NULL;
+    soa->y = NULL;
+    soa->z = NULL;
+    soa->w = NULL;
+    soa->count = 0;
+}
+
+TmVec4SoA *
+tmVec4SoAFromAoS(TmVec4SoA *dest, TmVec4 const *src)
+{
+    TmScalar *const destComponents[4] = {dest->x, dest->y, dest->z, dest->w};
+
+    tmSimdSoAKernels()->fromAoS4(destComponents, src, dest->count);
+
+    return dest;
+}
+
+TmVec4 *
+tmVec4SoAToAoS(TmVec4 *dest, TmVec4SoA const *src)
+{
+    TmScalar const *const srcComponents[4] = {src->x, src->y, src->z, src->w};
+
+    tmSimdSoAKernels()->toAoS4(dest, srcComponents, src->count);
+
+    return dest;
+}
+
+TmVec4SoA *
+tmVec4SoAAdd(TmVec4SoA *dest, TmVec4SoA const *p, TmVec4SoA const *q)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count && p->count == q->count);
+    kernels->add(dest->x, p->x, q->x, p->count);
+    kernels->add(dest->y, p->y, q->y, p->count);
+    kernels->add(dest->z, p->z, q->z, p->count);
+    kernels->add(dest->w, p->w, q->w, p->count);
+
+    return dest;
+}
+
+TmScalar *
+tmVec4SoADot(TmScalar *dest, TmVec4SoA const *p, TmVec4SoA const *q)
+{
+    TmScalar const *const pComponents[4] = {p->x, p->y, p->z, p->w};
+    TmScalar const *const qComponents[4] = {q->x, q->y, q->z, q->w};
+
+    assert(p->count == q->count);
+    tmSimdSoAKernels()->dot4(dest, pComponents, qComponents, p->count);
+
+    return dest;
+}
+
+TmScalar *
+tmVec4SoALength(TmScalar *dest, TmVec4SoA const *p)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+    TmScalar const *const pComponents[4] = {p->x, p->y, p->z, p->w};
+
+    kernels->dot4(dest, pComponents, pComponents, p->count);
+    kernels->squareRoot(dest, dest, p->count);
+
+    return dest;
+}
+
+TmVec4SoA *
+tmVec4SoANormalize(TmVec4SoA *dest, TmVec4SoA const *p)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count);
+    for (size_t start = 0; start < p->count; start += SOA_BLOCK_COUNT) {
+        size_t const count = blockCount(start, p->count);
+        TmScalar const *const pComponents[4] = {p->x + start, p->y + start, p->z + start, p->w + start};
+        TmScalar length[SOA_BLOCK_COUNT];
+
+        kernels->dot4(length, pComponents, pComponents, count);
+        kernels->squareRoot(length, length, count);
+        kernels->divide(dest->x + start, p->x + start, length, count);
+        kernels->divide(dest->y + start, p->y + start, length, count);
+        kernels->divide(dest->z + start, p->z + start, length, count);
+        kernels->divide(dest->w + start, p->w + start, length, count);
+    }
+
+    return dest;
+}
+
+TmVec4SoA *
+tmVec4SoAProjection(TmVec4SoA *pOntoQ, TmVec4SoA const *p, TmVec4SoA const *q)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(pOntoQ->count == p->count && p->count == q->count);
+    for (size_t start = 0; start < p->count; start += SOA_BLOCK_COUNT) {
+        size_t const count = blockCount(start, p->count);
+        TmScalar const *const pComponents[4] = {p->x + start, p->y + start, p->z + start, p->w + start};
+        TmScalar const *const qComponents[4] = {q->x + start, q->y + start, q->z + start, q->w + start};
+        TmScalar pDotQ[SOA_BLOCK_COUNT];
+        TmScalar qLenSquared[SOA_BLOCK_COUNT];
+
+        kernels->dot4(pDotQ, pComponents, qComponents, count);
+        kernels->dot4(qLenSquared, qComponents, qComponents, count);
+        kernels->divide(pDotQ, pDotQ, qLenSquared, count);
+        kernels->multiply(pOntoQ->x + start, pDotQ, q->x + start, count);
+        kernels->multiply(pOntoQ->y + start, pDotQ, q->y + start, count);
+        kernels->multiply(pOntoQ->z + start, pDotQ, q->z + start, count);
+        kernels->multiply(pOntoQ->w + start, pDotQ, q->w + start, count);
+    }
+
+    return pOntoQ;
+}
+
+TmVec4SoA *
+tmVec4SoAScale(TmVec4SoA *dest, TmScalar scale, TmVec4SoA const *p)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count);
+    kernels->scale(dest->x, scale, p->x, p->count);
+    kernels->scale(dest->y, scale, p->y, p->count);
+    kernels->scale(dest->z, scale, p->z, p->count);
+    kernels->scale(dest->w, scale, p->w, p->count);
+
+    return dest;
+}
+
+TmVec4SoA *
+tmVec4SoASub(TmVec4SoA *dest, TmVec4SoA const *p, TmVec4SoA const *q)
+{
+    TmSoAKernels const *kernels = tmSimdSoAKernels();
+
+    assert(dest->count == p->count && p->count == q->count);
+    kernels->sub(dest->x, p->x, q->x, p->count);
+    kernels->sub(dest->y, p->y, q->y, p->count);
+    kernels->sub(dest->z, p->z, q->z, p->count);
+    kernels->sub(dest->w, p->w, q->w, p->count);
+
+    return dest;
+}
@@ -0,0 +1,268 @@
+#include <assert.h>
+#include <immintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The AVX2 backend only supports float scalars");
+
+// Streams made by tmVec*SoAAlloc are aligned, but callers may pass
+// offset streams, so every access is unaligned. Tails shorter than a
+// vector fall back to the scalar kernels, which round identically.
+
+static void
+soaAddAvx2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(p + i), _mm256_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.add(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaSubAvx2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_sub_ps(_mm256_loadu_ps(p + i), _mm256_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.sub(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaMultiplyAvx2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(p + i), _mm256_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.multiply(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaDivideAvx2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_div_ps(_mm256_loadu_ps(p + i), _mm256_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.divide(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaScaleAvx2(TmScalar *dest, TmScalar scale, TmScalar const *p, size_t count)
+{
+    __m256 const s = _mm256_set1_ps(scale);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_mul_ps(s, _mm256_loadu_ps(p + i)));
+    }
+    tmSoAKernelsScalar.scale(dest + i, scale, p + i, count - i);
+}
+
+static void
+soaSquareRootAvx2(TmScalar *dest, TmScalar const *p, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_sqrt_ps(_mm256_loadu_ps(p + i)));
+    }
+    tmSoAKernelsScalar.squareRoot(dest + i, p + i, count - i);
+}
+
+static void
+soaDot3Avx2(TmScalar *dest, TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 dot = _mm256_mul_ps(_mm256_loadu_ps(p[0] + i), _mm256_loadu_ps(q[0] + i));
+
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_loadu_ps(p[1] + i), _mm256_loadu_ps(q[1] + i)));
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_loadu_ps(p[2] + i), _mm256_loadu_ps(q[2] + i)));
+        _mm256_storeu_ps(dest + i, dot);
+    }
+    if (i < count) {
+        TmScalar const *const pTail[3] = {p[0] + i, p[1] + i, p[2] + i};
+        TmScalar const *const qTail[3] = {q[0] + i, q[1] + i, q[2] + i};
+
+        tmSoAKernelsScalar.dot3(dest + i, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaDot4Avx2(TmScalar *dest, TmScalar const *const p[4], TmScalar const *const q[4], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 dot = _mm256_mul_ps(_mm256_loadu_ps(p[0] + i), _mm256_loadu_ps(q[0] + i));
+
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_loadu_ps(p[1] + i), _mm256_loadu_ps(q[1] + i)));
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_loadu_ps(p[2] + i), _mm256_loadu_ps(q[2] + i)));
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_loadu_ps(p[3] + i), _mm256_loadu_ps(q[3] + i)));
+        _mm256_storeu_ps(dest + i, dot);
+    }
+    if (i < count) {
+        TmScalar const *const pTail[4] = {p[0] + i, p[1] + i, p[2] + i, p[3] + i};
+        TmScalar const *const qTail[4] = {q[0] + i, q[1] + i, q[2] + i, q[3] + i};
+
+        tmSoAKernelsScalar.dot4(dest + i, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaCrossAvx2(TmScalar *const dest[3], TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 const px = _mm256_loadu_ps(p[0] + i);
+        __m256 const py = _mm256_loadu_ps(p[1] + i);
+        __m256 const pz = _mm256_loadu_ps(p[2] + i);
+        __m256 const qx = _mm256_loadu_ps(q[0] + i);
+        __m256 const qy = _mm256_loadu_ps(q[1] + i);
+        __m256 const qz = _mm256_loadu_ps(q[2] + i);
+
+        _mm256_storeu_ps(dest[0] + i, _mm256_sub_ps(_mm256_mul_ps(py, qz), _mm256_mul_ps(pz, qy)));
+        _mm256_storeu_ps(dest[1] + i, _mm256_sub_ps(_mm256_mul_ps(pz, qx), _mm256_mul_ps(px, qz)));
+        _mm256_storeu_ps(dest[2] + i, _mm256_sub_ps(_mm256_mul_ps(px, qy), _mm256_mul_ps(py, qx)));
+    }
+    if (i < count) {
+        TmScalar *const destTail[3] = {dest[0] + i, dest[1] + i, dest[2] + i};
+        TmScalar const *const pTail[3] = {p[0] + i, p[1] + i, p[2] + i};
+        TmScalar const *const qTail[3] = {q[0] + i, q[1] + i, q[2] + i};
+
+        tmSoAKernelsScalar.cross(destTail, pTail, qTail, count - i);
+    }
+}
+
+// The AoS conversions are shuffle bound, so they transpose two groups
+// of four with the SSE helpers and join the halves.
+
+static __m256
+combineHalvesAvx2(__m128 low, __m128 high)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+static void
+soaFromAoS3Avx2(TmScalar *const dest[3], TmVec3 const *src, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128 x0, y0, z0, x1, y1, z1;
+
+        sseLoadVec3x4(&x0, &y0, &z0, &src[i]);
+        sseLoadVec3x4(&x1, &y1, &z1, &src[i + 4]);
+        _mm256_storeu_ps(dest[0] + i, combineHalvesAvx2(x0, x1));
+        _mm256_storeu_ps(dest[1] + i, combineHalvesAvx2(y0, y1));
+        _mm256_storeu_ps(dest[2] + i, combineHalvesAvx2(z0, z1));
+    }
+    if (i < count) {
+        TmScalar *const destTail[3] = {dest[0] + i, dest[1] + i, dest[2] + i};
+
+        tmSoAKernelsScalar.fromAoS3(destTail, &src[i], count - i);
+    }
+}
+
+static void
+soaToAoS3Avx2(TmVec3 *dest, TmScalar const *const src[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 const x = _mm256_loadu_ps(src[0] + i);
+        __m256 const y = _mm256_loadu_ps(src[1] + i);
+        __m256 const z = _mm256_loadu_ps(src[2] + i);
+
+        sseStoreVec3x4(&dest[i],
+                       _mm256_castps256_ps128(x),
+                       _mm256_castps256_ps128(y),
+                       _mm256_castps256_ps128(z));
+        sseStoreVec3x4(&dest[i + 4],
+                       _mm256_extractf128_ps(x, 1),
+                       _mm256_extractf128_ps(y, 1),
+                       _mm256_extractf128_ps(z, 1));
+    }
+    if (i < count) {
+        TmScalar const *const srcTail[3] = {src[0] + i, src[1] + i, src[2] + i};
+
+        tmSoAKernelsScalar.toAoS3(&dest[i], srcTail, count - i);
+    }
+}
+
+static void
+soaFromAoS4Avx2(TmScalar *const dest[4], TmVec4 const *src, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128 x0, y0, z0, w0, x1, y1, z1, w1;
+
+        sseLoadVec4x4(&x0, &y0, &z0, &w0, &src[i]);
+        sseLoadVec4x4(&x1, &y1, &z1, &w1, &src[i + 4]);
+        _mm256_storeu_ps(dest[0] + i, combineHalvesAvx2(x0, x1));
+        _mm256_storeu_ps(dest[1] + i, combineHalvesAvx2(y0, y1));
+        _mm256_storeu_ps(dest[2] + i, combineHalvesAvx2(z0, z1));
+        _mm256_storeu_ps(dest[3] + i, combineHalvesAvx2(w0, w1));
+    }
+    if (i < count) {
+        TmScalar *const destTail[4] = {dest[0] + i, dest[1] + i, dest[2] + i, dest[3] + i};
+
+        tmSoAKernelsScalar.fromAoS4(destTail, &src[i], count - i);
+    }
+}
+
+static void
+soaToAoS4Avx2(TmVec4 *dest, TmScalar const *const src[4], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 const x = _mm256_loadu_ps(src[0] + i);
+        __m256 const y = _mm256_loadu_ps(src[1] + i);
+        __m256 const z = _mm256_loadu_ps(src[2] + i);
+        __m256 const w = _mm256_loadu_ps(src[3] + i);
+
+        sseStoreVec4x4(&dest[i],
+                       _mm256_castps256_ps128(x),
+                       _mm256_castps256_ps128(y),
+                       _mm256_castps256_ps128(z),
+                       _mm256_castps256_ps128(w));
+        sseStoreVec4x4(&dest[i + 4],
+                       _mm256_extractf128_ps(x, 1),
+                       _mm256_extractf128_ps(y, 1),
+                       _mm256_extractf128_ps(z, 1),
+                       _mm256_extractf128_ps(w, 1));
+    }
+    if (i < count) {
+        TmScalar const *const srcTail[4] = {src[0] + i, src[1] + i, src[2] + i, src[3] + i};
+
+        tmSoAKernelsScalar.toAoS4(&dest[i], srcTail, count - i);
+    }
+}
+
+TmSoAKernels const tmSoAKernelsAvx2 = {
+    .add = soaAddAvx2,
+    .sub = soaSubAvx2,
+    .multiply = soaMultiplyAvx2,
+    .divide = soaDivideAvx2,
+    .scale = soaScaleAvx2,
+    .squareRoot = soaSquareRootAvx2,
+    .dot3 = soaDot3Avx2,
+    .dot4 = soaDot4Avx2,
+    .cross = soaCrossAvx2,
+    .fromAoS3 = soaFromAoS3Avx2,
+    .toAoS3 = soaToAoS3Avx2,
+    .fromAoS4 = soaFromAoS4Avx2,
+    .toAoS4 = soaToAoS4Avx2
+};
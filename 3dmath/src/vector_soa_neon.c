@@ -0,0 +1,239 @@
+#include <arm_neon.h>
+#include <assert.h>
+#include "simd_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The NEON backend only supports float scalars");
+
+// Separate multiplies and adds keep the results identical to the scalar
+// backend. Tails shorter than a vector fall back to the scalar kernels.
+
+static void
+soaAddNeon(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dest + i, vaddq_f32(vld1q_f32(p + i), vld1q_f32(q + i)));
+    }
+    tmSoAKernelsScalar.add(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaSubNeon(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dest + i, vsubq_f32(vld1q_f32(p + i), vld1q_f32(q + i)));
+    }
+    tmSoAKernelsScalar.sub(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaMultiplyNeon(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dest + i, vmulq_f32(vld1q_f32(p + i), vld1q_f32(q + i)));
+    }
+    tmSoAKernelsScalar.multiply(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaDivideNeon(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dest + i, vdivq_f32(vld1q_f32(p + i), vld1q_f32(q + i)));
+    }
+    tmSoAKernelsScalar.divide(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaScaleNeon(TmScalar *dest, TmScalar scale, TmScalar const *p, size_t count)
+{
+    float32x4_t const s = vdupq_n_f32(scale);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dest + i, vmulq_f32(s, vld1q_f32(p + i)));
+    }
+    tmSoAKernelsScalar.scale(dest + i, scale, p + i, count - i);
+}
+
+static void
+soaSquareRootNeon(TmScalar *dest, TmScalar const *p, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dest + i, vsqrtq_f32(vld1q_f32(p + i)));
+    }
+    tmSoAKernelsScalar.squareRoot(dest + i, p + i, count - i);
+}
+
+static void
+soaDot3Neon(TmScalar *dest, TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t dot = vmulq_f32(vld1q_f32(p[0] + i), vld1q_f32(q[0] + i));
+
+        dot = vaddq_f32(dot, vmulq_f32(vld1q_f32(p[1] + i), vld1q_f32(q[1] + i)));
+        dot = vaddq_f32(dot, vmulq_f32(vld1q_f32(p[2] + i), vld1q_f32(q[2] + i)));
+        vst1q_f32(dest + i, dot);
+    }
+    if (i < count) {
+        TmScalar const *const pTail[3] = {p[0] + i, p[1] + i, p[2] + i};
+        TmScalar const *const qTail[3] = {q[0] + i, q[1] + i, q[2] + i};
+
+        tmSoAKernelsScalar.dot3(dest + i, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaDot4Neon(TmScalar *dest, TmScalar const *const p[4], TmScalar const *const q[4], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t dot = vmulq_f32(vld1q_f32(p[0] + i), vld1q_f32(q[0] + i));
+
+        dot = vaddq_f32(dot, vmulq_f32(vld1q_f32(p[1] + i), vld1q_f32(q[1] + i)));
+        dot = vaddq_f32(dot, vmulq_f32(vld1q_f32(p[2] + i), vld1q_f32(q[2] + i)));
+        dot = vaddq_f32(dot, vmulq_f32(vld1q_f32(p[3] + i), vld1q_f32(q[3] + i)));
+        vst1q_f32(dest + i, dot);
+    }
+    if (i < count) {
+        TmScalar const *const pTail[4] = {p[0] + i, p[1] + i, p[2] + i, p[3] + i};
+        TmScalar const *const qTail[4] = {q[0] + i, q[1] + i, q[2] + i, q[3] + i};
+
+        tmSoAKernelsScalar.dot4(dest + i, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaCrossNeon(TmScalar *const dest[3], TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t const px = vld1q_f32(p[0] + i);
+        float32x4_t const py = vld1q_f32(p[1] + i);
+        float32x4_t const pz = vld1q_f32(p[2] + i);
+        float32x4_t const qx = vld1q_f32(q[0] + i);
+        float32x4_t const qy = vld1q_f32(q[1] + i);
+        float32x4_t const qz = vld1q_f32(q[2] + i);
+
+        vst1q_f32(dest[0] + i, vsubq_f32(vmulq_f32(py, qz), vmulq_f32(pz, qy)));
+        vst1q_f32(dest[1] + i, vsubq_f32(vmulq_f32(pz, qx), vmulq_f32(px, qz)));
+        vst1q_f32(dest[2] + i, vsubq_f32(vmulq_f32(px, qy), vmulq_f32(py, qx)));
+    }
+    if (i < count) {
+        TmScalar *const destTail[3] = {dest[0] + i, dest[1] + i, dest[2] + i};
+        TmScalar const *const pTail[3] = {p[0] + i, p[1] + i, p[2] + i};
+        TmScalar const *const qTail[3] = {q[0] + i, q[1] + i, q[2] + i};
+
+        tmSoAKernelsScalar.cross(destTail, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaFromAoS3Neon(TmScalar *const dest[3], TmVec3 const *src, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x3_t const v = vld3q_f32((TmScalar const *)&src[i]);
+
+        vst1q_f32(dest[0] + i, v.val[0]);
+        vst1q_f32(dest[1] + i, v.val[1]);
+        vst1q_f32(dest[2] + i, v.val[2]);
+    }
+    if (i < count) {
+        TmScalar *const destTail[3] = {dest[0] + i, dest[1] + i, dest[2] + i};
+
+        tmSoAKernelsScalar.fromAoS3(destTail, &src[i], count - i);
+    }
+}
+
+static void
+soaToAoS3Neon(TmVec3 *dest, TmScalar const *const src[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x3_t v;
+
+        v.val[0] = vld1q_f32(src[0] + i);
+        v.val[1] = vld1q_f32(src[1] + i);
+        v.val[2] = vld1q_f32(src[2] + i);
+        vst3q_f32((TmScalar *)&dest[i], v);
+    }
+    if (i < count) {
+        TmScalar const *const srcTail[3] = {src[0] + i, src[1] + i, src[2] + i};
+
+        tmSoAKernelsScalar.toAoS3(&dest[i], srcTail, count - i);
+    }
+}
+
+static void
+soaFromAoS4Neon(TmScalar *const dest[4], TmVec4 const *src, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t const v = vld4q_f32((TmScalar const *)&src[i]);
+
+        vst1q_f32(dest[0] + i, v.val[0]);
+        vst1q_f32(dest[1] + i, v.val[1]);
+        vst1q_f32(dest[2] + i, v.val[2]);
+        vst1q_f32(dest[3] + i, v.val[3]);
+    }
+    if (i < count) {
+        TmScalar *const destTail[4] = {dest[0] + i, dest[1] + i, dest[2] + i, dest[3] + i};
+
+        tmSoAKernelsScalar.fromAoS4(destTail, &src[i], count - i);
+    }
+}
+
+static void
+soaToAoS4Neon(TmVec4 *dest, TmScalar const *const src[4], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        float32x4x4_t v;
+
+        v.val[0] = vld1q_f32(src[0] + i);
+        v.val[1] = vld1q_f32(src[1] + i);
+        v.val[2] = vld1q_f32(src[2] + i);
+        v.val[3] = vld1q_f32(src[3] + i);
+        vst4q_f32((TmScalar *)&dest[i], v);
+    }
+    if (i < count) {
+        TmScalar const *const srcTail[4] = {src[0] + i, src[1] + i, src[2] + i, src[3] + i};
+
+        tmSoAKernelsScalar.toAoS4(&dest[i], srcTail, count - i);
+    }
+}
+
+TmSoAKernels const tmSoAKernelsNeon = {
+    .add = soaAddNeon,
+    .sub = soaSubNeon,
+    .multiply = soaMultiplyNeon,
+    .divide = soaDivideNeon,
+    .scale = soaScaleNeon,
+    .squareRoot = soaSquareRootNeon,
+    .dot3 = soaDot3Neon,
+    .dot4 = soaDot4Neon,
+    .cross = soaCrossNeon,
+    .fromAoS3 = soaFromAoS3Neon,
+    .toAoS3 = soaToAoS3Neon,
+    .fromAoS4 = soaFromAoS4Neon,
+    .toAoS4 = soaToAoS4Neon
+};
@@ -0,0 +1,239 @@
+#include <assert.h>
+#include <emmintrin.h>
+#include "simd_private.h"
+#include "simd_sse_private.h"
+
+static_assert(sizeof(TmScalar) == sizeof(float),
+              "The SSE2 backend only supports float scalars");
+
+// Streams made by tmVec*SoAAlloc are aligned, but callers may pass
+// offset streams, so every access is unaligned. Tails shorter than a
+// vector fall back to the scalar kernels, which round identically.
+
+static void
+soaAddSse2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(p + i), _mm_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.add(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaSubSse2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_sub_ps(_mm_loadu_ps(p + i), _mm_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.sub(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaMultiplySse2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(p + i), _mm_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.multiply(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaDivideSse2(TmScalar *dest, TmScalar const *p, TmScalar const *q, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_div_ps(_mm_loadu_ps(p + i), _mm_loadu_ps(q + i)));
+    }
+    tmSoAKernelsScalar.divide(dest + i, p + i, q + i, count - i);
+}
+
+static void
+soaScaleSse2(TmScalar *dest, TmScalar scale, TmScalar const *p, size_t count)
+{
+    __m128 const s = _mm_set1_ps(scale);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_mul_ps(s, _mm_loadu_ps(p + i)));
+    }
+    tmSoAKernelsScalar.scale(dest + i, scale, p + i, count - i);
+}
+
+static void
+soaSquareRootSse2(TmScalar *dest, TmScalar const *p, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_sqrt_ps(_mm_loadu_ps(p + i)));
+    }
+    tmSoAKernelsScalar.squareRoot(dest + i, p + i, count - i);
+}
+
+static void
+soaDot3Sse2(TmScalar *dest, TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 dot = _mm_mul_ps(_mm_loadu_ps(p[0] + i), _mm_loadu_ps(q[0] + i));
+
+        dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(p[1] + i), _mm_loadu_ps(q[1] + i)));
+        dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(p[2] + i), _mm_loadu_ps(q[2] + i)));
+        _mm_storeu_ps(dest + i, dot);
+    }
+    if (i < count) {
+        TmScalar const *const pTail[3] = {p[0] + i, p[1] + i, p[2] + i};
+        TmScalar const *const qTail[3] = {q[0] + i, q[1] + i, q[2] + i};
+
+        tmSoAKernelsScalar.dot3(dest + i, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaDot4Sse2(TmScalar *dest, TmScalar const *const p[4], TmScalar const *const q[4], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 dot = _mm_mul_ps(_mm_loadu_ps(p[0] + i), _mm_loadu_ps(q[0] + i));
+
+        dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(p[1] + i), _mm_loadu_ps(q[1] + i)));
+        dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(p[2] + i), _mm_loadu_ps(q[2] + i)));
+        dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(p[3] + i), _mm_loadu_ps(q[3] + i)));
+        _mm_storeu_ps(dest + i, dot);
+    }
+    if (i < count) {
+        TmScalar const *const pTail[4] = {p[0] + i, p[1] + i, p[2] + i, p[3] + i};
+        TmScalar const *const qTail[4] = {q[0] + i, q[1] + i, q[2] + i, q[3] + i};
+
+        tmSoAKernelsScalar.dot4(dest + i, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaCrossSse2(TmScalar *const dest[3], TmScalar const *const p[3], TmScalar const *const q[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 const px = _mm_loadu_ps(p[0] + i);
+        __m128 const py = _mm_loadu_ps(p[1] + i);
+        __m128 const pz = _mm_loadu_ps(p[2] + i);
+        __m128 const qx = _mm_loadu_ps(q[0] + i);
+        __m128 const qy = _mm_loadu_ps(q[1] + i);
+        __m128 const qz = _mm_loadu_ps(q[2] + i);
+
+        _mm_storeu_ps(dest[0] + i, _mm_sub_ps(_mm_mul_ps(py, qz), _mm_mul_ps(pz, qy)));
+        _mm_storeu_ps(dest[1] + i, _mm_sub_ps(_mm_mul_ps(pz, qx), _mm_mul_ps(px, qz)));
+        _mm_storeu_ps(dest[2] + i, _mm_sub_ps(_mm_mul_ps(px, qy), _mm_mul_ps(py, qx)));
+    }
+    if (i < count) {
+        TmScalar *const destTail[3] = {dest[0] + i, dest[1] + i, dest[2] + i};
+        TmScalar const *const pTail[3] = {p[0] + i, p[1] + i, p[2] + i};
+        TmScalar const *const qTail[3] = {q[0] + i, q[1] + i, q[2] + i};
+
+        tmSoAKernelsScalar.cross(destTail, pTail, qTail, count - i);
+    }
+}
+
+static void
+soaFromAoS3Sse2(TmScalar *const dest[3], TmVec3 const *src, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+
+        sseLoadVec3x4(&x, &y, &z, &src[i]);
+        _mm_storeu_ps(dest[0] + i, x);
+        _mm_storeu_ps(dest[1] + i, y);
+        _mm_storeu_ps(dest[2] + i, z);
+    }
+    if (i < count) {
+        TmScalar *const destTail[3] = {dest[0] + i, dest[1] + i, dest[2] + i};
+
+        tmSoAKernelsScalar.fromAoS3(destTail, &src[i], count - i);
+    }
+}
+
+static void
+soaToAoS3Sse2(TmVec3 *dest, TmScalar const *const src[3], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        sseStoreVec3x4(&dest[i],
+                       _mm_loadu_ps(src[0] + i),
+                       _mm_loadu_ps(src[1] + i),
+                       _mm_loadu_ps(src[2] + i));
+    }
+    if (i < count) {
+        TmScalar const *const srcTail[3] = {src[0] + i, src[1] + i, src[2] + i};
+
+        tmSoAKernelsScalar.toAoS3(&dest[i], srcTail, count - i);
+    }
+}
+
+static void
+soaFromAoS4Sse2(TmScalar *const dest[4], TmVec4 const *src, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z, w;
+
+        sseLoadVec4x4(&x, &y, &z, &w, &src[i]);
+        _mm_storeu_ps(dest[0] + i, x);
+        _mm_storeu_ps(dest[1] + i, y);
+        _mm_storeu_ps(dest[2] + i, z);
+        _mm_storeu_ps(dest[3] + i, w);
+    }
+    if (i < count) {
+        TmScalar *const destTail[4] = {dest[0] + i, dest[1] + i, dest[2] + i, dest[3] + i};
+
+        tmSoAKernelsScalar.fromAoS4(destTail, &src[i], count - i);
+    }
+}
+
+static void
+soaToAoS4Sse2(TmVec4 *dest, TmScalar const *const src[4], size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        sseStoreVec4x4(&dest[i],
+                       _mm_loadu_ps(src[0] + i),
+                       _mm_loadu_ps(src[1] + i),
+                       _mm_loadu_ps(src[2] + i),
+                       _mm_loadu_ps(src[3] + i));
+    }
+    if (i < count) {
+        TmScalar const *const srcTail[4] = {src[0] + i, src[1] + i, src[2] + i, src[3] + i};
+
+        tmSoAKernelsScalar.toAoS4(&dest[i], srcTail, count - i);
+    }
+}
+
+TmSoAKernels const tmSoAKernelsSse2 = {
+    .add = soaAddSse2,
+    .sub = soaSubSse2,
+    .multiply = soaMultiplySse2,
+    .divide = soaDivideSse2,
+    .scale = soaScaleSse2,
+    .squareRoot = soaSquareRootSse2,
+    .dot3 = soaDot3Sse2,
+    .dot4 = soaDot4Sse2,
+    .cross = soaCrossSse2,
+    .fromAoS3 = soaFromAoS3Sse2,
+    .toAoS3 = soaToAoS3Sse2,
+    .fromAoS4 = soaFromAoS4Sse2,
+    .toAoS4 = soaToAoS4Sse2
+};
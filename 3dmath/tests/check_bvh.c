@@ -0,0 +1,403 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bvh.h"
+#include "frustum.h"
+#include "greatest.h"
+#include "ray.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+
+// Below the parallel threshold, so only the serial builder runs.
+#define TEST_BOX_COUNT 1000
+// Above it.
+#define TEST_LARGE_BOX_COUNT 20000
+#define TEST_RAY_COUNT 64
+
+// The same 90 degree frustum as check_frustum.c.
+static TmMat4 const sk_cameraToClip = {
+    .m11 = 1.0f,  .m21 = 0.0f,  .m31 = 0.0f,               .m41 = 0.0f,
+    .m12 = 0.0f,  .m22 = 1.0f,  .m32 = 0.0f,               .m42 = 0.0f,
+    .m13 = 0.0f,  .m23 = 0.0f,  .m33 = 46.0f / -44.0f,     .m43 = -1.0f,
+    .m14 = 0.0f,  .m24 = 0.0f,  .m34 = 90.0f / -44.0f,     .m44 = 0.0f
+};
+
+static TmAabb s_boxes[TEST_LARGE_BOX_COUNT];
+
+static TmScalar
+nextRandom(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+
+    return (TmScalar)(*state >> 8) / (TmScalar)(1u << 24);
+}
+
+// Small boxes scattered through a cube around the frustum.
+static void
+fillBoxes(TmAabb *boxes, size_t count, uint32_t seed)
+{
+    uint32_t state = seed;
+
+    for (size_t i = 0; i < count; ++i) {
+        TmScalar const size = 0.1f + 2.0f * nextRandom(&state);
+
+        boxes[i].min.x = 100.0f * nextRandom(&state) - 50.0f;
+        boxes[i].min.y = 100.0f * nextRandom(&state) - 50.0f;
+        boxes[i].min.z = 100.0f * nextRandom(&state) - 70.0f;
+        boxes[i].max.x = boxes[i].min.x + size;
+        boxes[i].max.y = boxes[i].min.y + size * nextRandom(&state);
+        boxes[i].max.z = boxes[i].min.z + size;
+    }
+}
+
+static TmRay
+randomRay(uint32_t *state)
+{
+    TmRay ray;
+
+    ray.origin.x = 120.0f * nextRandom(state) - 60.0f;
+    ray.origin.y = 120.0f * nextRandom(state) - 60.0f;
+    ray.origin.z = 120.0f * nextRandom(state) - 80.0f;
+    ray.direction.x = nextRandom(state) - 0.5f;
+    ray.direction.y = nextRandom(state) - 0.5f;
+    ray.direction.z = nextRandom(state) - 0.5f;
+
+    return ray;
+}
+
+static bool
+aabbContains(TmAabb const *outer, TmAabb const *inner)
+{
+    return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y && outer->min.z <= inner->min.z
+        && outer->max.x >= inner->max.x && outer->max.y >= inner->max.y && outer->max.z >= inner->max.z;
+}
+
+// Every node bounds its children, every primitive is in exactly one leaf
+// and no path is deeper than the traversal stacks allow.
+TEST
+assertBvhValid(TmBvh const *bvh, TmAabb const *boxes)
+{
+    uint32_t stack[TM_BVH_MAX_DEPTH][2];
+    size_t stackSize = 0;
+    size_t leafPrimitives = 0;
+    bool *isSeen = calloc(bvh->count, sizeof(*isSeen));
+
+    ASSERT(isSeen != NULL);
+    stack[stackSize][0] = 0;
+    stack[stackSize++][1] = 1;
+    while (stackSize > 0) {
+        uint32_t const index = stack[--stackSize][0];
+        uint32_t const depth = stack[stackSize][1];
+        TmBvhNode const *node = &bvh->nodes[index];
+
+        ASSERT(index < bvh->nodeCount);
+        ASSERT(depth <= TM_BVH_MAX_DEPTH);
+        if (node->count == 0) {
+            ASSERT(aabbContains(&node->bounds, &bvh->nodes[index + 1].bounds));
+            ASSERT(aabbContains(&node->bounds, &bvh->nodes[node->offset].bounds));
+            stack[stackSize][0] = index + 1;
+            stack[stackSize++][1] = depth + 1;
+            stack[stackSize][0] = node->offset;
+            stack[stackSize++][1] = depth + 1;
+            continue;
+        }
+        ASSERT(node->count <= TM_BVH_MAX_LEAF_SIZE);
+        for (uint32_t i = node->offset; i < node->offset + node->count; ++i) {
+            uint32_t const primitive = bvh->primitives[i];
+
+            ASSERT(primitive < bvh->count);
+            ASSERT_FALSE(isSeen[primitive]);
+            isSeen[primitive] = true;
+            ASSERT(aabbContains(&node->bounds, &boxes[primitive]));
+            ASSERT_EQ(boxes[primitive].min.x, bvh->boxes[i].min.x);
+            ASSERT_EQ(boxes[primitive].max.z, bvh->boxes[i].max.z);
+            ++leafPrimitives;
+        }
+    }
+    ASSERT_EQ(bvh->count, leafPrimitives);
+    free(isSeen);
+    PASS();
+}
+
+typedef struct RayHits {
+    uint32_t   *isHit;
+    uint32_t    closest;
+    TmScalar    closestT;
+} RayHits;
+
+static bool
+collectRayHit(void *context, uint32_t primitive, TmScalar tNear, TmScalar *tMax)
+{
+    RayHits *hits = context;
+
+    (void)tMax;
+    (void)tNear;
+    hits->isHit[primitive / 32] |= UINT32_C(1) << (primitive % 32);
+
+    return true;
+}
+
+static bool
+closestRayHit(void *context, uint32_t primitive, TmScalar tNear, TmScalar *tMax)
+{
+    RayHits *hits = context;
+
+    if (tNear < hits->closestT) {
+        hits->closest = primitive;
+        hits->closestT = tNear;
+        *tMax = tNear;
+    }
+
+    return true;
+}
+
+static bool
+collectOverlap(void *context, uint32_t primitive)
+{
+    uint32_t *isHit = context;
+
+    isHit[primitive / 32] |= UINT32_C(1) << (primitive % 32);
+
+    return true;
+}
+
+static bool
+stopAtFirst(void *context, uint32_t primitive)
+{
+    (void)context;
+    (void)primitive;
+
+    return false;
+}
+
+TEST
+rayIntersectAabb01(void)
+{
+    TmAabb const box = {{2.0f, -1.0f, -1.0f}, {3.0f, 1.0f, 1.0f}};
+    TmScalar tNear = -1.0f;
+
+    ASSERT(tmRayIntersectAabb(&(TmRay){{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, &box, 10.0f, &tNear));
+    ASSERT_IN_RANGE(2.0f, tNear, TEST_FLOAT_EPSILON);
+    // t scales with the direction
+    ASSERT(tmRayIntersectAabb(&(TmRay){{0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}}, &box, 10.0f, &tNear));
+    ASSERT_IN_RANGE(1.0f, tNear, TEST_FLOAT_EPSILON);
+    // Beyond tMax, pointing away and passing beside it
+    ASSERT_FALSE(tmRayIntersectAabb(&(TmRay){{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, &box, 1.5f, &tNear));
+    ASSERT_FALSE(tmRayIntersectAabb(&(TmRay){{0.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}}, &box, 10.0f, &tNear));
+    ASSERT_FALSE(tmRayIntersectAabb(&(TmRay){{0.0f, 2.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, &box, 10.0f, &tNear));
+    // Starting inside
+    ASSERT(tmRayIntersectAabb(&(TmRay){{2.5f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}}, &box, 10.0f, &tNear));
+    ASSERT_EQ(0.0f, tNear);
+    // Diagonal
+    ASSERT(tmRayIntersectAabb(&(TmRay){{0.0f, -3.0f, 0.0f}, {1.0f, 1.0f, 0.0f}}, &box, 10.0f, &tNear));
+    ASSERT_IN_RANGE(2.0f, tNear, TEST_FLOAT_EPSILON);
+    PASS();
+}
+
+TEST
+bvhBuild01(void)
+{
+    TmAabb const box = {{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}};
+    TmBvh bvh;
+
+    ASSERT(tmBvhBuild(&bvh, &box, 1, 1));
+    ASSERT_EQ(1, bvh.nodeCount);
+    ASSERT_EQ(1, bvh.nodes[0].count);
+    CHECK_CALL(assertBvhValid(&bvh, &box));
+    ASSERT_EQ(1, tmBvhQueryAabb(&bvh, &box, stopAtFirst, NULL));
+
+    // Identical boxes cannot be separated, but still build a tree.
+    for (size_t i = 0; i < TEST_BOX_COUNT; ++i) {
+        s_boxes[i] = box;
+    }
+    tmBvhFree(&bvh);
+    ASSERT(tmBvhBuild(&bvh, s_boxes, TEST_BOX_COUNT, 1));
+    CHECK_CALL(assertBvhValid(&bvh, s_boxes));
+    tmBvhFree(&bvh);
+    PASS();
+}
+
+TEST
+bvhQueryRay01(void)
+{
+    uint32_t expected[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    uint32_t actual[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    uint32_t state = 777u;
+    TmBvh bvh;
+
+    fillBoxes(s_boxes, TEST_BOX_COUNT, 42u);
+    ASSERT(tmBvhBuild(&bvh, s_boxes, TEST_BOX_COUNT, 1));
+    CHECK_CALL(assertBvhValid(&bvh, s_boxes));
+
+    for (int r = 0; r < TEST_RAY_COUNT; ++r) {
+        TmRay const ray = randomRay(&state);
+        RayHits hits = {.isHit = actual, .closest = UINT32_MAX, .closestT = INFINITY};
+        uint32_t expectedClosest = UINT32_MAX;
+        TmScalar expectedClosestT = INFINITY;
+        size_t expectedCount = 0;
+        size_t count;
+
+        memset(expected, 0, sizeof(expected));
+        for (uint32_t i = 0; i < TEST_BOX_COUNT; ++i) {
+            TmScalar tNear;
+
+            if (tmRayIntersectAabb(&ray, &s_boxes[i], 1000.0f, &tNear)) {
+                expected[i / 32] |= UINT32_C(1) << (i % 32);
+                ++expectedCount;
+                if (tNear < expectedClosestT) {
+                    expectedClosest = i;
+                    expectedClosestT = tNear;
+                }
+            }
+        }
+
+        memset(actual, 0, sizeof(actual));
+        count = tmBvhQueryRay(&bvh, &ray, 1000.0f, collectRayHit, &hits);
+        ASSERT_EQ(expectedCount, count);
+        ASSERT_MEM_EQ(expected, actual, sizeof(expected));
+
+        tmBvhQueryRay(&bvh, &ray, 1000.0f, closestRayHit, &hits);
+        ASSERT_EQ(expectedClosest, hits.closest);
+        ASSERT_EQ(expectedClosestT, hits.closestT);
+    }
+    tmBvhFree(&bvh);
+    PASS();
+}
+
+TEST
+bvhQueryAabb01(void)
+{
+    uint32_t expected[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    uint32_t actual[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    uint32_t state = 99u;
+    TmBvh bvh;
+
+    fillBoxes(s_boxes, TEST_BOX_COUNT, 43u);
+    ASSERT(tmBvhBuild(&bvh, s_boxes, TEST_BOX_COUNT, 1));
+
+    for (int q = 0; q < TEST_RAY_COUNT; ++q) {
+        TmAabb query;
+        size_t expectedCount = 0;
+
+        fillBoxes(&query, 1, state++);
+        query.max.x += 10.0f;
+        query.max.y += 10.0f;
+        query.max.z += 10.0f;
+        memset(expected, 0, sizeof(expected));
+        for (uint32_t i = 0; i < TEST_BOX_COUNT; ++i) {
+            TmAabb const *box = &s_boxes[i];
+
+            if (box->min.x <= query.max.x && query.min.x <= box->max.x &&
+                box->min.y <= query.max.y && query.min.y <= box->max.y &&
+                box->min.z <= query.max.z && query.min.z <= box->max.z) {
+                expected[i / 32] |= UINT32_C(1) << (i % 32);
+                ++expectedCount;
+            }
+        }
+        memset(actual, 0, sizeof(actual));
+        ASSERT_EQ(expectedCount, tmBvhQueryAabb(&bvh, &query, collectOverlap, actual));
+        ASSERT_MEM_EQ(expected, actual, sizeof(expected));
+        ASSERT_EQ(expectedCount > 0 ? 1 : 0, tmBvhQueryAabb(&bvh, &query, stopAtFirst, NULL));
+    }
+    tmBvhFree(&bvh);
+    PASS();
+}
+
+TEST
+bvhCullFrustum01(void)
+{
+    uint32_t expected[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    uint32_t actual[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    TmFrustum frustum;
+    size_t expectedCount;
+    TmBvh bvh;
+
+    fillBoxes(s_boxes, TEST_BOX_COUNT, 44u);
+    ASSERT(tmBvhBuild(&bvh, s_boxes, TEST_BOX_COUNT, 1));
+    tmFrustumFromMat4(&frustum, &sk_cameraToClip);
+
+    expectedCount = tmFrustumCullAabbBatch(expected, &frustum, s_boxes, TEST_BOX_COUNT);
+    memset(actual, 0xff, sizeof(actual));
+    ASSERT_EQ(expectedCount, tmBvhCullFrustum(actual, &bvh, &frustum));
+    ASSERT_MEM_EQ(expected, actual, sizeof(expected));
+    ASSERT(expectedCount > 0 && expectedCount < TEST_BOX_COUNT);
+    tmBvhFree(&bvh);
+    PASS();
+}
+
+TEST
+bvhRefit01(void)
+{
+    uint32_t expected[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    uint32_t actual[TM_FRUSTUM_MASK_WORDS(TEST_BOX_COUNT)];
+    TmFrustum frustum;
+    size_t expectedCount;
+    TmBvh bvh;
+
+    fillBoxes(s_boxes, TEST_BOX_COUNT, 45u);
+    ASSERT(tmBvhBuild(&bvh, s_boxes, TEST_BOX_COUNT, 1));
+
+    // Move everything, some of it far.
+    for (size_t i = 0; i < TEST_BOX_COUNT; ++i) {
+        TmScalar const offset = (i % 7 == 0) ? 40.0f : 1.5f;
+
+        s_boxes[i].min.x += offset;
+        s_boxes[i].max.x += offset;
+        s_boxes[i].min.z -= offset;
+        s_boxes[i].max.z -= offset;
+    }
+    ASSERT_EQ(&bvh, tmBvhRefit(&bvh, s_boxes));
+    CHECK_CALL(assertBvhValid(&bvh, s_boxes));
+
+    tmFrustumFromMat4(&frustum, &sk_cameraToClip);
+    expectedCount = tmFrustumCullAabbBatch(expected, &frustum, s_boxes, TEST_BOX_COUNT);
+    ASSERT_EQ(expectedCount, tmBvhCullFrustum(actual, &bvh, &frustum));
+    ASSERT_MEM_EQ(expected, actual, sizeof(expected));
+    tmBvhFree(&bvh);
+    PASS();
+}
+
+TEST
+bvhBuildThreaded01(void)
+{
+    TmBvh serial;
+    TmBvh threaded;
+
+    fillBoxes(s_boxes, TEST_LARGE_BOX_COUNT, 46u);
+    ASSERT(tmBvhBuild(&serial, s_boxes, TEST_LARGE_BOX_COUNT, 1));
+    ASSERT(tmBvhBuild(&threaded, s_boxes, TEST_LARGE_BOX_COUNT, 4));
+    CHECK_CALL(assertBvhValid(&threaded, s_boxes));
+
+    ASSERT_EQ(serial.nodeCount, threaded.nodeCount);
+    ASSERT_MEM_EQ(serial.primitives, threaded.primitives, TEST_LARGE_BOX_COUNT * sizeof(*serial.primitives));
+    for (size_t i = 0; i < serial.nodeCount; ++i) {
+        ASSERT_EQ(serial.nodes[i].offset, threaded.nodes[i].offset);
+        ASSERT_EQ(serial.nodes[i].count, threaded.nodes[i].count);
+        ASSERT_EQ(serial.nodes[i].bounds.min.x, threaded.nodes[i].bounds.min.x);
+        ASSERT_EQ(serial.nodes[i].bounds.max.y, threaded.nodes[i].bounds.max.y);
+    }
+    tmBvhFree(&serial);
+    tmBvhFree(&threaded);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(rayIntersectAabb01);
+    RUN_TEST(bvhBuild01);
+    RUN_TEST(bvhQueryRay01);
+    RUN_TEST(bvhQueryAabb01);
+    RUN_TEST(bvhCullFrustum01);
+    RUN_TEST(bvhRefit01);
+    RUN_TEST(bvhBuildThreaded01);
+
+    GREATEST_MAIN_END();
+}
@@ -0,0 +1,221 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frustum.h"
+#include "greatest.h"
+#include "matrix.h"
+#include "simd.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+
+// More than two mask words, and not a multiple of any vector width, so
+// every backend runs its tail in the middle of a word.
+#define TEST_VOLUME_COUNT 75
+
+// Looks down -z with a 90 degree field of view, near 1 and far 45, like
+// the gltut samples.
+static TmMat4 const sk_cameraToClip = {
+    .m11 = 1.0f,  .m21 = 0.0f,  .m31 = 0.0f,               .m41 = 0.0f,
+    .m12 = 0.0f,  .m22 = 1.0f,  .m32 = 0.0f,               .m42 = 0.0f,
+    .m13 = 0.0f,  .m23 = 0.0f,  .m33 = 46.0f / -44.0f,     .m43 = -1.0f,
+    .m14 = 0.0f,  .m24 = 0.0f,  .m34 = 90.0f / -44.0f,     .m44 = 0.0f
+};
+
+TEST
+assertPlaneNear(TmVec4 const *expected, TmVec4 const *actual, TmScalar tolerance)
+{
+    ASSERT_IN_RANGE(expected->x, actual->x, tolerance);
+    ASSERT_IN_RANGE(expected->y, actual->y, tolerance);
+    ASSERT_IN_RANGE(expected->z, actual->z, tolerance);
+    ASSERT_IN_RANGE(expected->w, actual->w, tolerance);
+    PASS();
+}
+
+TEST
+frustumFromMat401(void)
+{
+    TmScalar const halfSqrt2 = 0.70710678118654752f;
+    TmVec4 const expected[TM_FRUSTUM_PLANE_COUNT] = {
+        [TM_FRUSTUM_PLANE_LEFT] = {halfSqrt2, 0.0f, -halfSqrt2, 0.0f},
+        [TM_FRUSTUM_PLANE_RIGHT] = {-halfSqrt2, 0.0f, -halfSqrt2, 0.0f},
+        [TM_FRUSTUM_PLANE_BOTTOM] = {0.0f, halfSqrt2, -halfSqrt2, 0.0f},
+        [TM_FRUSTUM_PLANE_TOP] = {0.0f, -halfSqrt2, -halfSqrt2, 0.0f},
+        [TM_FRUSTUM_PLANE_NEAR] = {0.0f, 0.0f, -1.0f, -1.0f},
+        [TM_FRUSTUM_PLANE_FAR] = {0.0f, 0.0f, 1.0f, 45.0f}
+    };
+    TmVec4 const expectedIdentity[TM_FRUSTUM_PLANE_COUNT] = {
+        [TM_FRUSTUM_PLANE_LEFT] = {1.0f, 0.0f, 0.0f, 1.0f},
+        [TM_FRUSTUM_PLANE_RIGHT] = {-1.0f, 0.0f, 0.0f, 1.0f},
+        [TM_FRUSTUM_PLANE_BOTTOM] = {0.0f, 1.0f, 0.0f, 1.0f},
+        [TM_FRUSTUM_PLANE_TOP] = {0.0f, -1.0f, 0.0f, 1.0f},
+        [TM_FRUSTUM_PLANE_NEAR] = {0.0f, 0.0f, 1.0f, 1.0f},
+        [TM_FRUSTUM_PLANE_FAR] = {0.0f, 0.0f, -1.0f, 1.0f}
+    };
+    TmFrustum frustum;
+
+    tmFrustumFromMat4(&frustum, &sk_cameraToClip);
+    for (int i = 0; i < TM_FRUSTUM_PLANE_COUNT; ++i) {
+        // The far plane normal is the difference of two nearly equal
+        // rows, so its distance is only good to a few digits.
+        TmScalar const tolerance = (i == TM_FRUSTUM_PLANE_FAR) ? 0.001f : TEST_FLOAT_EPSILON;
+
+        CHECK_CALL(assertPlaneNear(&expected[i], &frustum.planes[i], tolerance));
+    }
+
+    tmFrustumFromMat4(&frustum, &TM_MAT4_IDENTITY);
+    for (int i = 0; i < TM_FRUSTUM_PLANE_COUNT; ++i) {
+        CHECK_CALL(assertPlaneNear(&expectedIdentity[i], &frustum.planes[i], TEST_FLOAT_EPSILON));
+    }
+    PASS();
+}
+
+TEST
+frustumTestSphere01(void)
+{
+    TmFrustum frustum;
+
+    tmFrustumFromMat4(&frustum, &sk_cameraToClip);
+
+    ASSERT(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 0.0f, -10.0f}, 1.0f}));
+    // Behind the camera, and past the far plane
+    ASSERT_FALSE(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 0.0f, 5.0f}, 1.0f}));
+    ASSERT_FALSE(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 0.0f, -50.0f}, 4.0f}));
+    ASSERT(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 0.0f, -50.0f}, 6.0f}));
+    // Straddling the left plane, then just outside it
+    ASSERT(tmFrustumTestSphere(&frustum, &(TmSphere){{-11.0f, 0.0f, -10.0f}, 1.0f}));
+    ASSERT_FALSE(tmFrustumTestSphere(&frustum, &(TmSphere){{-12.0f, 0.0f, -10.0f}, 1.0f}));
+    ASSERT_FALSE(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 12.0f, -10.0f}, 1.0f}));
+    PASS();
+}
+
+TEST
+frustumTestSphere02(void)
+{
+    // An infinite far plane never culls.
+    TmMat4 infiniteFar = sk_cameraToClip;
+    TmFrustum frustum;
+
+    infiniteFar.m33 = -1.0f;
+    infiniteFar.m34 = -2.0f;
+    tmFrustumFromMat4(&frustum, &infiniteFar);
+
+    ASSERT(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 0.0f, -100000.0f}, 1.0f}));
+    ASSERT_FALSE(tmFrustumTestSphere(&frustum, &(TmSphere){{0.0f, 0.0f, 0.0f}, 0.5f}));
+    PASS();
+}
+
+TEST
+frustumTestAabb01(void)
+{
+    TmFrustum frustum;
+
+    tmFrustumFromMat4(&frustum, &sk_cameraToClip);
+
+    ASSERT(tmFrustumTestAabb(&frustum, &(TmAabb){{-1.0f, -1.0f, -11.0f}, {1.0f, 1.0f, -9.0f}}));
+    ASSERT_FALSE(tmFrustumTestAabb(&frustum, &(TmAabb){{-1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 3.0f}}));
+    // Straddling the near plane, and wider than the whole frustum
+    ASSERT(tmFrustumTestAabb(&frustum, &(TmAabb){{-0.5f, -0.5f, -1.5f}, {0.5f, 0.5f, 0.5f}}));
+    ASSERT(tmFrustumTestAabb(&frustum, &(TmAabb){{-100.0f, -1.0f, -20.0f}, {100.0f, 1.0f, -19.0f}}));
+    // Just outside the left plane
+    ASSERT_FALSE(tmFrustumTestAabb(&frustum, &(TmAabb){{-13.5f, -1.0f, -11.0f}, {-11.5f, 1.0f, -9.0f}}));
+    ASSERT(tmFrustumTestAabb(&frustum, &(TmAabb){{-12.5f, -1.0f, -11.0f}, {-10.5f, 1.0f, -9.0f}}));
+    PASS();
+}
+
+// Deterministic volumes scattered in and around the frustum.
+static void
+fillVolumes(TmSphere *spheres, TmAabb *boxes)
+{
+    uint32_t state = 12345u;
+
+    for (int i = 0; i < TEST_VOLUME_COUNT; ++i) {
+        TmScalar values[5];
+
+        for (int k = 0; k < 5; ++k) {
+            state = state * 1664525u + 1013904223u;
+            values[k] = (TmScalar)(state >> 8) / (TmScalar)(1u << 24);
+        }
+        spheres[i].center.x = 120.0f * values[0] - 60.0f;
+        spheres[i].center.y = 120.0f * values[1] - 60.0f;
+        spheres[i].center.z = 70.0f * values[2] - 60.0f;
+        spheres[i].radius = 8.0f * values[3];
+
+        boxes[i].min = spheres[i].center;
+        boxes[i].max.x = boxes[i].min.x + 10.0f * values[4];
+        boxes[i].max.y = boxes[i].min.y + spheres[i].radius;
+        boxes[i].max.z = boxes[i].min.z + 5.0f * values[4];
+    }
+}
+
+TEST
+frustumBatchMatchesSingle(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmSphere spheres[TEST_VOLUME_COUNT];
+    TmAabb boxes[TEST_VOLUME_COUNT];
+    uint32_t visible[TM_FRUSTUM_MASK_WORDS(TEST_VOLUME_COUNT)];
+    TmFrustum frustum;
+    size_t expectedCount;
+    size_t count;
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    fillVolumes(spheres, boxes);
+    tmFrustumFromMat4(&frustum, &sk_cameraToClip);
+    tmSimdSetBackend(backend);
+
+    memset(visible, 0xff, sizeof(visible));
+    count = tmFrustumCullSphereBatch(visible, &frustum, spheres, TEST_VOLUME_COUNT);
+    expectedCount = 0;
+    for (int i = 0; i < TEST_VOLUME_COUNT; ++i) {
+        bool const isVisible = tmFrustumTestSphere(&frustum, &spheres[i]);
+
+        ASSERT_EQ(isVisible, (visible[i / 32] >> (i % 32)) & 1u);
+        expectedCount += isVisible;
+    }
+    ASSERT_EQ(expectedCount, count);
+    ASSERT_EQ(0u, visible[TEST_VOLUME_COUNT / 32] >> (TEST_VOLUME_COUNT % 32));
+    // The scattered volumes should exercise both outcomes.
+    ASSERT(count > 0 && count < TEST_VOLUME_COUNT);
+
+    memset(visible, 0xff, sizeof(visible));
+    count = tmFrustumCullAabbBatch(visible, &frustum, boxes, TEST_VOLUME_COUNT);
+    expectedCount = 0;
+    for (int i = 0; i < TEST_VOLUME_COUNT; ++i) {
+        bool const isVisible = tmFrustumTestAabb(&frustum, &boxes[i]);
+
+        ASSERT_EQ(isVisible, (visible[i / 32] >> (i % 32)) & 1u);
+        expectedCount += isVisible;
+    }
+    ASSERT_EQ(expectedCount, count);
+    ASSERT_EQ(0u, visible[TEST_VOLUME_COUNT / 32] >> (TEST_VOLUME_COUNT % 32));
+    ASSERT(count > 0 && count < TEST_VOLUME_COUNT);
+
+    tmSimdSetBackend(originalBackend);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(frustumFromMat401);
+    RUN_TEST(frustumTestSphere01);
+    RUN_TEST(frustumTestSphere02);
+    RUN_TEST(frustumTestAabb01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(frustumBatchMatchesSingle, &backendArg);
+    }
+
+    GREATEST_MAIN_END();
+}
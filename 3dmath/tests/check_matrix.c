@@ -5,8 +5,46 @@
 
 #include "greatest.h"
 #include "matrix.h"
+#include "simd.h"
 
 #define TEST_FLOAT_EPSILON (0.000001f)
+#define TEST_INVERSE_EPSILON (0.00001f)
+
+static TmMat4 const sk_mat4A = {1.0f, 2.0f, 3.0f, 4.0f,
+                                5.0f, 6.0f, 7.0f, 8.0f,
+                                9.0f, 10.0f, 11.0f, 12.0f,
+                                13.0f, 14.0f, 15.0f, 16.0f};
+static TmMat4 const sk_mat4B = {2.0f, 0.0f, 1.0f, 0.0f,
+                                0.0f, 1.0f, 0.0f, 3.0f,
+                                -1.0f, 0.0f, 2.0f, 0.0f,
+                                0.5f, 0.0f, 0.0f, 1.0f};
+
+TEST
+assertMat4Equal(TmMat4 const *expected, TmMat4 const *actual)
+{
+    TmScalar const *pExpected = (TmScalar const *)expected;
+    TmScalar const *pActual = (TmScalar const *)actual;
+
+    for (int i = 0; i < 16; ++i) {
+        // Relative for large elements, since backends may round differently.
+        TmScalar const tolerance = TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(pExpected[i]));
+
+        ASSERT_IN_RANGE(pExpected[i], pActual[i], tolerance);
+    }
+    PASS();
+}
+
+TEST
+assertMat4Near(TmMat4 const *expected, TmMat4 const *actual, TmScalar tolerance)
+{
+    TmScalar const *pExpected = (TmScalar const *)expected;
+    TmScalar const *pActual = (TmScalar const *)actual;
+
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_IN_RANGE(pExpected[i], pActual[i], tolerance);
+    }
+    PASS();
+}
 
 TEST
 matrixSizes(void)
@@ -129,6 +167,372 @@ mat4Identity01(void)
 	PASS();
 }
 
+TEST
+mat4Add01(void)
+{
+    TmMat4 const expected = {3.0f, 2.0f, 4.0f, 4.0f,
+                             5.0f, 7.0f, 7.0f, 11.0f,
+                             8.0f, 10.0f, 13.0f, 12.0f,
+                             13.5f, 14.0f, 15.0f, 17.0f};
+    TmMat4 dest;
+
+    tmMat4Add(&dest, &sk_mat4A, &sk_mat4B);
+
+    CHECK_CALL(assertMat4Equal(&expected, &dest));
+    PASS();
+}
+
+TEST
+mat4Multiply01(void)
+{
+    TmMat4 const expected = {11.0f, 14.0f, 17.0f, 20.0f,
+                             44.0f, 48.0f, 52.0f, 56.0f,
+                             17.0f, 18.0f, 19.0f, 20.0f,
+                             13.5f, 15.0f, 16.5f, 18.0f};
+    TmMat4 dest;
+
+    tmMat4Multiply(&dest, &sk_mat4A, &sk_mat4B);
+
+    CHECK_CALL(assertMat4Equal(&expected, &dest));
+    PASS();
+}
+
+TEST
+mat4MultiplyAliased01(void)
+{
+    TmMat4 const expected = {11.0f, 14.0f, 17.0f, 20.0f,
+                             44.0f, 48.0f, 52.0f, 56.0f,
+                             17.0f, 18.0f, 19.0f, 20.0f,
+                             13.5f, 15.0f, 16.5f, 18.0f};
+    TmMat4 a = sk_mat4A;
+    TmMat4 b = sk_mat4B;
+
+    tmMat4Multiply(&a, &a, &sk_mat4B);
+    CHECK_CALL(assertMat4Equal(&expected, &a));
+
+    tmMat4Multiply(&b, &sk_mat4A, &b);
+    CHECK_CALL(assertMat4Equal(&expected, &b));
+    PASS();
+}
+
+TEST
+mat4Transpose01(void)
+{
+    TmMat4 const expected = {1.0f, 5.0f, 9.0f, 13.0f,
+                             2.0f, 6.0f, 10.0f, 14.0f,
+                             3.0f, 7.0f, 11.0f, 15.0f,
+                             4.0f, 8.0f, 12.0f, 16.0f};
+    TmMat4 dest = sk_mat4A;
+
+    tmMat4Transpose(&dest, &dest);
+
+    CHECK_CALL(assertMat4Equal(&expected, &dest));
+    PASS();
+}
+
+TEST
+mat3Inverse01(void)
+{
+    TmMat3 const a = {1.0f, 0.0f, 0.0f,
+                      2.0f, 1.0f, 0.0f,
+                      3.0f, 4.0f, 1.0f};
+    TmMat3 inverse;
+
+    tmMat3Inverse(&inverse, &a);
+
+    ASSERT_IN_RANGE(inverse.m11, 1.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m21, 0.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m31, 0.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m12, -2.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m22, 1.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m32, 0.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m13, 5.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m23, -4.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(inverse.m33, 1.0f, TEST_FLOAT_EPSILON);
+    PASS();
+}
+
+TEST
+mat4Determinant01(void)
+{
+    ASSERT_IN_RANGE(tmMat4Determinant(&sk_mat4A), 0.0f, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(tmMat4Determinant(&sk_mat4B), 5.0f, TEST_FLOAT_EPSILON);
+    PASS();
+}
+
+TEST
+mat4Inverse01(void)
+{
+    TmMat4 const identity = TM_MAT4_IDENTITY_INITIALIZER;
+    TmMat4 inverse;
+    TmMat4 product;
+
+    tmMat4Inverse(&inverse, &sk_mat4B);
+
+    tmMat4Multiply(&product, &sk_mat4B, &inverse);
+    CHECK_CALL(assertMat4Near(&identity, &product, TEST_INVERSE_EPSILON));
+    tmMat4Multiply(&product, &inverse, &sk_mat4B);
+    CHECK_CALL(assertMat4Near(&identity, &product, TEST_INVERSE_EPSILON));
+    PASS();
+}
+
+TEST
+mat4InverseAliased01(void)
+{
+    TmMat4 expected;
+    TmMat4 actual = sk_mat4B;
+
+    tmMat4Inverse(&expected, &sk_mat4B);
+    tmMat4Inverse(&actual, &actual);
+
+    CHECK_CALL(assertMat4Equal(&expected, &actual));
+    PASS();
+}
+
+static TmMat4 *
+makeAffine(TmMat4 *dest, TmScalar scaleX)
+{
+    TmVec3 const axis = {0.0f, 0.6f, 0.8f};
+
+    tmMat4Rotation(dest, &axis, 0.7f);
+    dest->m11 *= scaleX;
+    dest->m21 *= scaleX;
+    dest->m31 *= scaleX;
+    dest->m14 = 3.0f;
+    dest->m24 = -2.0f;
+    dest->m34 = 5.0f;
+
+    return dest;
+}
+
+TEST
+mat4InverseAffine01(void)
+{
+    TmMat4 a;
+    TmMat4 expected;
+    TmMat4 actual;
+
+    makeAffine(&a, 2.5f);
+    tmMat4Inverse(&expected, &a);
+    tmMat4InverseAffine(&actual, &a);
+
+    CHECK_CALL(assertMat4Near(&expected, &actual, TEST_INVERSE_EPSILON));
+    PASS();
+}
+
+TEST
+mat4InverseRigid01(void)
+{
+    TmMat4 a;
+    TmMat4 expected;
+    TmMat4 actual;
+
+    makeAffine(&a, 1.0f);
+    tmMat4Inverse(&expected, &a);
+    tmMat4InverseRigid(&actual, &a);
+
+    CHECK_CALL(assertMat4Near(&expected, &actual, TEST_INVERSE_EPSILON));
+    PASS();
+}
+
+#define TEST_BATCH_COUNT 11
+
+static void
+fillBatchInputs(TmMat4 matrices[TEST_BATCH_COUNT], TmVec4 vectors[TEST_BATCH_COUNT], TmVec3 points[TEST_BATCH_COUNT])
+{
+    for (int i = 0; i < TEST_BATCH_COUNT; ++i) {
+        TmScalar *pMatrix = (TmScalar *)&matrices[i];
+
+        for (int j = 0; j < 16; ++j) {
+            pMatrix[j] = (TmScalar)((i * 7 + j * 3) % 11) - 5.0f;
+        }
+        vectors[i] = (TmVec4){(TmScalar)i, -0.5f * i, 2.0f, 1.0f - i};
+        points[i] = (TmVec3){0.25f * i, (TmScalar)(i % 3), -1.0f * i};
+    }
+}
+
+TEST
+mat4TransformPointsVec3Batch01(void)
+{
+    TmMat4 transform = TM_MAT4_IDENTITY;
+    TmVec3 points[TEST_BATCH_COUNT];
+
+    transform.m11 = 2.0f;
+    transform.m22 = 3.0f;
+    transform.m33 = 4.0f;
+    transform.m14 = 1.0f;
+    transform.m24 = -1.0f;
+    transform.m34 = 0.5f;
+    for (int i = 0; i < TEST_BATCH_COUNT; ++i) {
+        points[i] = (TmVec3){(TmScalar)i, (TmScalar)-i, 0.5f * i};
+    }
+
+    tmMat4TransformPointsVec3Batch(points, &transform, points, TEST_BATCH_COUNT);
+
+    for (int i = 0; i < TEST_BATCH_COUNT; ++i) {
+        ASSERT_IN_RANGE(points[i].x, 2.0f * i + 1.0f, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(points[i].y, -3.0f * i - 1.0f, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(points[i].z, 2.0f * i + 0.5f, TEST_FLOAT_EPSILON);
+    }
+    PASS();
+}
+
+TEST
+mat4TransformVec4Batch01(void)
+{
+    TmVec4 vectors[TEST_BATCH_COUNT];
+
+    for (int i = 0; i < TEST_BATCH_COUNT; ++i) {
+        vectors[i] = (TmVec4){(TmScalar)i, 1.0f, 2.0f, 1.0f};
+    }
+
+    tmMat4TransformVec4Batch(vectors, &sk_mat4B, vectors, TEST_BATCH_COUNT);
+
+    for (int i = 0; i < TEST_BATCH_COUNT; ++i) {
+        ASSERT_IN_RANGE(vectors[i].x, 2.0f * i - 2.0f + 0.5f, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(vectors[i].y, 1.0f, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(vectors[i].z, 1.0f * i + 4.0f, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(vectors[i].w, 4.0f, TEST_FLOAT_EPSILON);
+    }
+    PASS();
+}
+
+TEST
+mat4BatchBackendMatchesScalar(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmMat4 matrices[TEST_BATCH_COUNT];
+    TmVec4 vectors[TEST_BATCH_COUNT];
+    TmVec3 points[TEST_BATCH_COUNT];
+    TmMat4 expectedMatrices[TEST_BATCH_COUNT];
+    TmMat4 actualMatrices[TEST_BATCH_COUNT];
+    TmVec4 expectedVectors[TEST_BATCH_COUNT];
+    TmVec4 actualVectors[TEST_BATCH_COUNT];
+    TmVec3 expectedPoints[TEST_BATCH_COUNT];
+    TmVec3 actualPoints[TEST_BATCH_COUNT];
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    fillBatchInputs(matrices, vectors, points);
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmMat4MultiplyBatch(expectedMatrices, matrices, matrices, TEST_BATCH_COUNT);
+    tmMat4TransformVec4Batch(expectedVectors, &matrices[3], vectors, TEST_BATCH_COUNT);
+    tmMat4TransformPointsVec3Batch(expectedPoints, &matrices[5], points, TEST_BATCH_COUNT);
+    tmSimdSetBackend(backend);
+    tmMat4MultiplyBatch(actualMatrices, matrices, matrices, TEST_BATCH_COUNT);
+    tmMat4TransformVec4Batch(actualVectors, &matrices[3], vectors, TEST_BATCH_COUNT);
+    tmMat4TransformPointsVec3Batch(actualPoints, &matrices[5], points, TEST_BATCH_COUNT);
+    tmSimdSetBackend(originalBackend);
+
+    for (int i = 0; i < TEST_BATCH_COUNT; ++i) {
+        CHECK_CALL(assertMat4Equal(&expectedMatrices[i], &actualMatrices[i]));
+        ASSERT_IN_RANGE(expectedVectors[i].x, actualVectors[i].x, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(expectedVectors[i].y, actualVectors[i].y, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(expectedVectors[i].z, actualVectors[i].z, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(expectedVectors[i].w, actualVectors[i].w, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(expectedPoints[i].x, actualPoints[i].x, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(expectedPoints[i].y, actualPoints[i].y, TEST_FLOAT_EPSILON);
+        ASSERT_IN_RANGE(expectedPoints[i].z, actualPoints[i].z, TEST_FLOAT_EPSILON);
+    }
+    PASS();
+}
+
+TEST
+mat4ToFloatCameraRelativeBatch01(void)
+{
+    TmVec3 const eye = {4096.0f, -8192.0f, 1024.0f};
+    TmMat4 world[2];
+    TmMat4 translation = TM_MAT4_IDENTITY;
+    TmMat4 relative;
+    TmMat4f actual[2];
+
+    // An affine model matrix only has its translation changed, and one
+    // with a projective bottom row follows translation(-eye) * world.
+    world[0] = sk_mat4B;
+    world[0].m14 = 4096.5f;
+    world[0].m24 = -8192.25f;
+    world[0].m34 = 1024.125f;
+    world[1] = sk_mat4A;
+    tmMat4ToFloatCameraRelativeBatch(actual, world, &eye, 2);
+
+    ASSERT_EQ(0.5f, actual[0].m14);
+    ASSERT_EQ(-0.25f, actual[0].m24);
+    ASSERT_EQ(0.125f, actual[0].m34);
+    ASSERT_EQ((float)sk_mat4B.m11, actual[0].m11);
+    ASSERT_EQ((float)sk_mat4B.m23, actual[0].m23);
+    ASSERT_EQ((float)sk_mat4B.m44, actual[0].m44);
+
+    translation.m14 = -eye.x;
+    translation.m24 = -eye.y;
+    translation.m34 = -eye.z;
+    tmMat4Multiply(&relative, &translation, &world[1]);
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_EQ((float)((TmScalar const *)&relative)[i], ((float const *)&actual[1])[i]);
+    }
+
+    // Far from the origin only wider scalars keep the fraction.
+    if (sizeof(TmScalar) > sizeof(float)) {
+        TmVec3 const farEye = {10000000.0, 0.0f, 0.0f};
+
+        world[0].m14 = 10000000.3;
+        tmMat4ToFloatCameraRelativeBatch(actual, world, &farEye, 1);
+        ASSERT_IN_RANGE(0.3f, actual[0].m14, TEST_FLOAT_EPSILON);
+    }
+    PASS();
+}
+
+TEST
+mat4BackendMatchesScalar(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmMat4 expected;
+    TmMat4 actual;
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmMat4Multiply(&expected, &sk_mat4A, &sk_mat4B);
+    tmSimdSetBackend(backend);
+    tmMat4Multiply(&actual, &sk_mat4A, &sk_mat4B);
+    tmSimdSetBackend(originalBackend);
+    CHECK_CALL(assertMat4Equal(&expected, &actual));
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmMat4Add(&expected, &sk_mat4A, &sk_mat4B);
+    tmSimdSetBackend(backend);
+    tmMat4Add(&actual, &sk_mat4A, &sk_mat4B);
+    tmSimdSetBackend(originalBackend);
+    CHECK_CALL(assertMat4Equal(&expected, &actual));
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmMat4ScalarMultiply(&expected, &sk_mat4A, -0.25f);
+    tmSimdSetBackend(backend);
+    tmMat4ScalarMultiply(&actual, &sk_mat4A, -0.25f);
+    tmSimdSetBackend(originalBackend);
+    CHECK_CALL(assertMat4Equal(&expected, &actual));
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmMat4Transpose(&expected, &sk_mat4A);
+    tmSimdSetBackend(backend);
+    tmMat4Transpose(&actual, &sk_mat4A);
+    tmSimdSetBackend(originalBackend);
+    CHECK_CALL(assertMat4Equal(&expected, &actual));
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmMat4Inverse(&expected, &sk_mat4B);
+    tmSimdSetBackend(backend);
+    tmMat4Inverse(&actual, &sk_mat4B);
+    tmSimdSetBackend(originalBackend);
+    CHECK_CALL(assertMat4Near(&expected, &actual, TEST_INVERSE_EPSILON));
+    PASS();
+}
+
 GREATEST_MAIN_DEFS();
 
 int
@@ -142,6 +546,25 @@ main(int argc, char *argv[])
     RUN_TEST(mat2Inverse02);
     RUN_TEST(mat4Rotation01);
     RUN_TEST(mat4Identity01);
+    RUN_TEST(mat4Add01);
+    RUN_TEST(mat4Multiply01);
+    RUN_TEST(mat4MultiplyAliased01);
+    RUN_TEST(mat4Transpose01);
+    RUN_TEST(mat3Inverse01);
+    RUN_TEST(mat4Determinant01);
+    RUN_TEST(mat4Inverse01);
+    RUN_TEST(mat4InverseAliased01);
+    RUN_TEST(mat4InverseAffine01);
+    RUN_TEST(mat4InverseRigid01);
+    RUN_TEST(mat4TransformPointsVec3Batch01);
+    RUN_TEST(mat4TransformVec4Batch01);
+    RUN_TEST(mat4ToFloatCameraRelativeBatch01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(mat4BackendMatchesScalar, &backendArg);
+        RUN_TEST1(mat4BatchBackendMatchesScalar, &backendArg);
+    }
 
     GREATEST_MAIN_END();
 }
@@ -0,0 +1,317 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "greatest.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "simd.h"
+#include "vector.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+#define TEST_SLERP_EPSILON (0.000002f)
+
+// Not a multiple of any vector width, so every backend runs its tail.
+#define TEST_QUAT_COUNT 19
+
+// Compares values rather than bytes, since long double scalars carry
+// padding on some targets.
+#define ASSERT_SCALARS_EQ(expected, actual, size)                            \
+    CHECK_CALL(assertScalarsEqual((TmScalar const *)(expected),              \
+                                  (TmScalar const *)(actual),                \
+                                  (size) / (sizeof(TmScalar))))
+
+TEST
+assertScalarsEqual(TmScalar const *expected, TmScalar const *actual, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(expected[i], actual[i]);
+    }
+    PASS();
+}
+
+static TmVec3 const sk_axis = {0.48f, -0.6f, 0.64f};
+
+TEST
+assertQuatNear(TmQuat const *expected, TmQuat const *actual, TmScalar tolerance)
+{
+    ASSERT_IN_RANGE(expected->x, actual->x, tolerance);
+    ASSERT_IN_RANGE(expected->y, actual->y, tolerance);
+    ASSERT_IN_RANGE(expected->z, actual->z, tolerance);
+    ASSERT_IN_RANGE(expected->w, actual->w, tolerance);
+    PASS();
+}
+
+TEST
+assertMat4Near(TmMat4 const *expected, TmMat4 const *actual, TmScalar tolerance)
+{
+    TmScalar const *pExpected = (TmScalar const *)expected;
+    TmScalar const *pActual = (TmScalar const *)actual;
+
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_IN_RANGE(pExpected[i], pActual[i], tolerance);
+    }
+    PASS();
+}
+
+// Exact slerp along the shorter arc, in double precision.
+static TmQuat
+referenceSlerp(TmQuat const *p, TmQuat const *q, TmScalar t)
+{
+    double cosTheta = (double)p->x * q->x + (double)p->y * q->y + (double)p->z * q->z + (double)p->w * q->w;
+    double const sign = (cosTheta < 0.0) ? -1.0 : 1.0;
+    double theta;
+    double weightP;
+    double weightQ;
+
+    cosTheta = fmin(fabs(cosTheta), 1.0);
+    theta = acos(cosTheta);
+    if (theta < 1e-6) {
+        weightP = 1.0 - t;
+        weightQ = t;
+    } else {
+        weightP = sin((1.0 - t) * theta) / sin(theta);
+        weightQ = sin(t * theta) / sin(theta);
+    }
+    weightQ *= sign;
+
+    return (TmQuat){(TmScalar)(weightP * p->x + weightQ * q->x),
+                    (TmScalar)(weightP * p->y + weightQ * q->y),
+                    (TmScalar)(weightP * p->z + weightQ * q->z),
+                    (TmScalar)(weightP * p->w + weightQ * q->w)};
+}
+
+static void
+fillInterpolationInputs(TmQuat p[TEST_QUAT_COUNT], TmQuat q[TEST_QUAT_COUNT], TmScalar t[TEST_QUAT_COUNT])
+{
+    for (int i = 0; i < TEST_QUAT_COUNT; ++i) {
+        TmVec3 const axisP = {0.6f, 0.0f, 0.8f};
+        TmVec3 const axisQ = {0.0f, 1.0f, 0.0f};
+
+        // Covers angles past 180 degrees so both arcs get exercised.
+        tmQuatFromAxisAngle(&p[i], &axisP, 0.3f * (TmScalar)i);
+        tmQuatFromAxisAngle(&q[i], &axisQ, 5.5f - 0.45f * (TmScalar)i);
+        t[i] = (TmScalar)(i % 6) / 5.0f;
+    }
+}
+
+TEST
+quatToMat401(void)
+{
+    TmMat4 expected;
+    TmMat4 actual;
+    TmQuat q;
+
+    for (int i = -6; i <= 6; ++i) {
+        TmScalar const angle = 0.55f * (TmScalar)i;
+
+        tmMat4Rotation(&expected, &sk_axis, angle);
+        tmQuatToMat4(&actual, tmQuatFromAxisAngle(&q, &sk_axis, angle));
+        CHECK_CALL(assertMat4Near(&expected, &actual, TEST_FLOAT_EPSILON * 4.0f));
+    }
+    PASS();
+}
+
+TEST
+quatFromMat401(void)
+{
+    TmMat4 rotation;
+    TmQuat expected;
+    TmQuat actual;
+
+    // Includes angles near 180 degrees, where the trace is negative.
+    for (int i = -6; i <= 6; ++i) {
+        TmScalar const angle = 0.52f * (TmScalar)i;
+
+        tmQuatFromAxisAngle(&expected, &sk_axis, angle);
+        tmQuatFromMat4(&actual, tmMat4Rotation(&rotation, &sk_axis, angle));
+        if (tmQuatDot(&expected, &actual) < 0.0f) {
+            expected = (TmQuat){-expected.x, -expected.y, -expected.z, -expected.w};
+        }
+        CHECK_CALL(assertQuatNear(&expected, &actual, TEST_FLOAT_EPSILON * 4.0f));
+    }
+    PASS();
+}
+
+TEST
+quatMultiply01(void)
+{
+    TmVec3 const otherAxis = {0.0f, 0.6f, 0.8f};
+    TmQuat a;
+    TmQuat b;
+    TmQuat product;
+    TmMat4 matrixA;
+    TmMat4 matrixB;
+    TmMat4 expected;
+    TmMat4 actual;
+
+    tmQuatFromAxisAngle(&a, &sk_axis, 0.7f);
+    tmQuatFromAxisAngle(&b, &otherAxis, -1.9f);
+    tmMat4Multiply(&expected, tmQuatToMat4(&matrixA, &a), tmQuatToMat4(&matrixB, &b));
+    tmQuatToMat4(&actual, tmQuatMultiply(&product, &a, &b));
+    CHECK_CALL(assertMat4Near(&expected, &actual, TEST_FLOAT_EPSILON * 4.0f));
+
+    // Aliased with an operand.
+    tmQuatMultiply(&a, &a, &b);
+    ASSERT_SCALARS_EQ(&product, &a, sizeof(product));
+    PASS();
+}
+
+TEST
+quatRotateVec301(void)
+{
+    TmVec3 const v = {1.5f, -0.5f, 2.0f};
+    TmVec4 const v4 = {v.x, v.y, v.z, 0.0f};
+    TmMat4 rotation;
+    TmVec4 expected;
+    TmVec3 actual;
+    TmQuat q;
+
+    tmMat4Rotation(&rotation, &sk_axis, 2.3f);
+    tmMat4TransformVec4Batch(&expected, &rotation, &v4, 1);
+    tmQuatRotateVec3(&actual, tmQuatFromAxisAngle(&q, &sk_axis, 2.3f), &v);
+    ASSERT_IN_RANGE(expected.x, actual.x, TEST_FLOAT_EPSILON * 8.0f);
+    ASSERT_IN_RANGE(expected.y, actual.y, TEST_FLOAT_EPSILON * 8.0f);
+    ASSERT_IN_RANGE(expected.z, actual.z, TEST_FLOAT_EPSILON * 8.0f);
+    PASS();
+}
+
+TEST
+dualQuatTransformPoint01(void)
+{
+    TmVec3 const translation = {3.0f, -1.0f, 0.5f};
+    TmVec3 const p = {1.5f, -0.5f, 2.0f};
+    TmVec4 const p4 = {p.x, p.y, p.z, 1.0f};
+    TmMat4 rigid;
+    TmVec4 expected;
+    TmVec3 actual;
+    TmDualQuat dq, fromMatrix;
+    TmQuat q;
+
+    tmMat4Rotation(&rigid, &sk_axis, 2.3f);
+    rigid.m14 = translation.x;
+    rigid.m24 = translation.y;
+    rigid.m34 = translation.z;
+    tmMat4TransformVec4Batch(&expected, &rigid, &p4, 1);
+    tmDualQuatFromRotationTranslation(&dq, tmQuatFromAxisAngle(&q, &sk_axis, 2.3f), &translation);
+    tmDualQuatTransformPoint(&actual, &dq, &p);
+    ASSERT_IN_RANGE(expected.x, actual.x, TEST_FLOAT_EPSILON * 16.0f);
+    ASSERT_IN_RANGE(expected.y, actual.y, TEST_FLOAT_EPSILON * 16.0f);
+    ASSERT_IN_RANGE(expected.z, actual.z, TEST_FLOAT_EPSILON * 16.0f);
+
+    // The matrix may yield -q, which is the same rotation.
+    tmDualQuatFromMat4(&fromMatrix, &rigid);
+    if (tmQuatDot(&fromMatrix.real, &dq.real) < 0.0f) {
+        fromMatrix.real = (TmQuat){-fromMatrix.real.x, -fromMatrix.real.y, -fromMatrix.real.z, -fromMatrix.real.w};
+        fromMatrix.dual = (TmQuat){-fromMatrix.dual.x, -fromMatrix.dual.y, -fromMatrix.dual.z, -fromMatrix.dual.w};
+    }
+    CHECK_CALL(assertQuatNear(&dq.real, &fromMatrix.real, TEST_FLOAT_EPSILON * 8.0f));
+    CHECK_CALL(assertQuatNear(&dq.dual, &fromMatrix.dual, TEST_FLOAT_EPSILON * 16.0f));
+    PASS();
+}
+
+TEST
+quatSlerp01(void)
+{
+    TmQuat const p = TM_QUAT_IDENTITY;
+    TmQuat q;
+    TmQuat expected;
+    TmQuat actual;
+
+    // Sweeps the whole range of cos(theta) on both arcs.
+    for (int angle = -359; angle <= 359; angle += 7) {
+        tmQuatFromAxisAngle(&q, &sk_axis, (TmScalar)angle * TM_SCALAR_PI / 180.0f);
+        for (int step = 0; step <= 16; ++step) {
+            TmScalar const t = (TmScalar)step / 16.0f;
+
+            expected = referenceSlerp(&p, &q, t);
+            tmQuatSlerp(&actual, &p, &q, t);
+            CHECK_CALL(assertQuatNear(&expected, &actual, TEST_SLERP_EPSILON));
+        }
+    }
+
+    // The end points are exact up to the sign of q.
+    tmQuatSlerp(&actual, &p, &q, 0.0f);
+    ASSERT_SCALARS_EQ(&p, &actual, sizeof(p));
+    PASS();
+}
+
+TEST
+quatNlerp01(void)
+{
+    TmQuat p[TEST_QUAT_COUNT];
+    TmQuat q[TEST_QUAT_COUNT];
+    TmScalar t[TEST_QUAT_COUNT];
+    TmQuat actual;
+
+    fillInterpolationInputs(p, q, t);
+    for (int i = 0; i < TEST_QUAT_COUNT; ++i) {
+        TmQuat const expected = referenceSlerp(&p[i], &q[i], t[i]);
+
+        tmQuatNlerp(&actual, &p[i], &q[i], t[i]);
+        ASSERT_IN_RANGE(1.0f, tmQuatDot(&actual, &actual), TEST_FLOAT_EPSILON * 4.0f);
+        // Nlerp and slerp agree on the end points and on which arc to take.
+        ASSERT(tmQuatDot(&expected, &actual) > 0.9f);
+    }
+    PASS();
+}
+
+TEST
+quatBatchMatchesScalar(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmQuat p[TEST_QUAT_COUNT];
+    TmQuat q[TEST_QUAT_COUNT];
+    TmScalar t[TEST_QUAT_COUNT];
+    TmQuat expected[TEST_QUAT_COUNT];
+    TmQuat actual[TEST_QUAT_COUNT];
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    fillInterpolationInputs(p, q, t);
+    tmSimdSetBackend(backend);
+
+    for (int i = 0; i < TEST_QUAT_COUNT; ++i) {
+        tmQuatSlerp(&expected[i], &p[i], &q[i], t[i]);
+    }
+    tmQuatSlerpBatch(actual, p, q, t, TEST_QUAT_COUNT);
+    ASSERT_SCALARS_EQ(expected, actual, sizeof(expected));
+
+    for (int i = 0; i < TEST_QUAT_COUNT; ++i) {
+        tmQuatNlerp(&expected[i], &p[i], &q[i], t[i]);
+    }
+    tmQuatNlerpBatch(actual, p, q, t, TEST_QUAT_COUNT);
+    ASSERT_SCALARS_EQ(expected, actual, sizeof(expected));
+
+    // In place.
+    tmQuatNlerpBatch(p, p, q, t, TEST_QUAT_COUNT);
+    ASSERT_SCALARS_EQ(expected, p, sizeof(expected));
+
+    tmSimdSetBackend(originalBackend);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(quatToMat401);
+    RUN_TEST(quatFromMat401);
+    RUN_TEST(quatMultiply01);
+    RUN_TEST(quatRotateVec301);
+    RUN_TEST(dualQuatTransformPoint01);
+    RUN_TEST(quatSlerp01);
+    RUN_TEST(quatNlerp01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(quatBatchMatchesScalar, &backendArg);
+    }
+
+    GREATEST_MAIN_END();
+}
@@ -0,0 +1,182 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "greatest.h"
+#include "ray.h"
+#include "simd.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+
+// Not a multiple of any vector width, so every backend runs its tail.
+#define TEST_PRIMITIVE_COUNT 75
+
+static TmScalar
+nextRandom(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+
+    return (TmScalar)(*state >> 8) / (TmScalar)(1u << 24);
+}
+
+// Primitives scattered around the ray's path, so that some are hit.
+static void
+fillPrimitives(TmAabb *boxes, TmSphere *spheres, TmTriangle *triangles, TmRay const *ray)
+{
+    uint32_t state = 12345u;
+
+    for (int i = 0; i < TEST_PRIMITIVE_COUNT; ++i) {
+        TmScalar const along = 20.0f * nextRandom(&state) - 2.0f;
+        TmVec3 center;
+        TmVec3 offset;
+
+        tmVec3Scale(&center, along, &ray->direction);
+        tmVec3Add(&center, &center, &ray->origin);
+        center.x += 6.0f * nextRandom(&state) - 3.0f;
+        center.y += 6.0f * nextRandom(&state) - 3.0f;
+        center.z += 6.0f * nextRandom(&state) - 3.0f;
+
+        spheres[i].center = center;
+        spheres[i].radius = 2.0f * nextRandom(&state);
+        boxes[i].min = center;
+        boxes[i].max.x = center.x + 3.0f * nextRandom(&state);
+        boxes[i].max.y = center.y + 3.0f * nextRandom(&state);
+        boxes[i].max.z = center.z + 3.0f * nextRandom(&state);
+        triangles[i].a = center;
+        offset = (TmVec3){4.0f * nextRandom(&state) - 2.0f, 4.0f * nextRandom(&state) - 2.0f, nextRandom(&state)};
+        tmVec3Add(&triangles[i].b, &center, &offset);
+        offset = (TmVec3){4.0f * nextRandom(&state) - 2.0f, nextRandom(&state), 4.0f * nextRandom(&state) - 2.0f};
+        tmVec3Add(&triangles[i].c, &center, &offset);
+    }
+    // Degenerate and boundary cases: the origin inside a box and a
+    // sphere, a triangle collapsed to a point, a box flat along the ray
+    // and one whose slab plane holds the origin.
+    boxes[2].min = (TmVec3){ray->origin.x - 1.0f, ray->origin.y - 1.0f, ray->origin.z - 1.0f};
+    boxes[2].max = (TmVec3){ray->origin.x + 1.0f, ray->origin.y + 1.0f, ray->origin.z + 1.0f};
+    spheres[3].center = ray->origin;
+    triangles[4].b = triangles[4].a;
+    triangles[4].c = triangles[4].a;
+    boxes[5].max.y = boxes[5].min.y;
+    boxes[6].min.y = ray->origin.y;
+}
+
+TEST
+rayIntersectSphere01(void)
+{
+    TmSphere const sphere = {{5.0f, 0.0f, 0.0f}, 1.0f};
+    TmScalar t = -1.0f;
+
+    ASSERT(tmRayIntersectSphere(&(TmRay){{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, &sphere, 10.0f, &t));
+    ASSERT_IN_RANGE(4.0f, t, TEST_FLOAT_EPSILON);
+    // t scales with the direction
+    ASSERT(tmRayIntersectSphere(&(TmRay){{0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}}, &sphere, 10.0f, &t));
+    ASSERT_IN_RANGE(2.0f, t, TEST_FLOAT_EPSILON);
+    // Beyond tMax, behind the origin and passing beside it
+    ASSERT_FALSE(tmRayIntersectSphere(&(TmRay){{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}, &sphere, 3.0f, &t));
+    ASSERT_FALSE(tmRayIntersectSphere(&(TmRay){{0.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}}, &sphere, 10.0f, &t));
+    ASSERT_FALSE(tmRayIntersectSphere(&(TmRay){{0.0f, 1.5f, 0.0f}, {1.0f, 0.0f, 0.0f}}, &sphere, 10.0f, &t));
+    // Starting inside
+    ASSERT(tmRayIntersectSphere(&(TmRay){{5.5f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}}, &sphere, 10.0f, &t));
+    ASSERT_EQ(0.0f, t);
+    PASS();
+}
+
+TEST
+rayIntersectTriangle01(void)
+{
+    TmTriangle const triangle = {{-1.0f, -1.0f, -5.0f}, {1.0f, -1.0f, -5.0f}, {0.0f, 1.0f, -5.0f}};
+    TmTriangle const flipped = {triangle.a, triangle.c, triangle.b};
+    TmRay const ray = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}};
+    TmScalar t = -1.0f;
+
+    ASSERT(tmRayIntersectTriangle(&ray, &triangle, 10.0f, &t));
+    ASSERT_IN_RANGE(5.0f, t, TEST_FLOAT_EPSILON);
+    // Both faces are hit
+    ASSERT(tmRayIntersectTriangle(&ray, &flipped, 10.0f, &t));
+    ASSERT_IN_RANGE(5.0f, t, TEST_FLOAT_EPSILON);
+    ASSERT(tmRayIntersectTriangle(&(TmRay){{0.0f, 0.0f, 0.0f}, {0.02f, 0.02f, -0.5f}}, &triangle, 20.0f, &t));
+    ASSERT_IN_RANGE(10.0f, t, TEST_FLOAT_EPSILON);
+    // Beyond tMax, behind the origin, beside it and in its plane
+    ASSERT_FALSE(tmRayIntersectTriangle(&ray, &triangle, 4.0f, &t));
+    ASSERT_FALSE(tmRayIntersectTriangle(&(TmRay){{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, &triangle, 10.0f, &t));
+    ASSERT_FALSE(tmRayIntersectTriangle(&(TmRay){{0.9f, 0.9f, 0.0f}, {0.0f, 0.0f, -1.0f}}, &triangle, 10.0f, &t));
+    ASSERT_FALSE(tmRayIntersectTriangle(&(TmRay){{-5.0f, 0.0f, -5.0f}, {1.0f, 0.0f, 0.0f}}, &triangle, 10.0f, &t));
+    PASS();
+}
+
+// Each batch must store exactly what the single tests give, INFINITY
+// for misses, over a buffer that starts out as NaN.
+#define ASSERT_BATCH_MATCHES_SINGLE(batchFn, singleFn, ray, tMax, primitives) \
+    do {                                                                        \
+        size_t expectedHits = 0;                                                \
+                                                                                \
+        for (int i = 0; i < TEST_PRIMITIVE_COUNT; ++i) {                        \
+            expectedHits += singleFn((ray), &(primitives)[i], (tMax), &t[i]);   \
+        }                                                                       \
+        ASSERT(expectedHits > 0 && expectedHits < TEST_PRIMITIVE_COUNT);        \
+        memset(t, 0xff, sizeof(t));                                             \
+        ASSERT_EQ(expectedHits, batchFn(t, (ray), (tMax), (primitives), TEST_PRIMITIVE_COUNT)); \
+        for (int i = 0; i < TEST_PRIMITIVE_COUNT; ++i) {                        \
+            TmScalar expected = INFINITY;                                       \
+                                                                                \
+            singleFn((ray), &(primitives)[i], (tMax), &expected);               \
+            ASSERT_EQ(expected, t[i]);                                          \
+        }                                                                       \
+    } while (0)
+
+TEST
+assertBatchMatchesSingle(TmRay const *ray)
+{
+    TmAabb boxes[TEST_PRIMITIVE_COUNT];
+    TmSphere spheres[TEST_PRIMITIVE_COUNT];
+    TmTriangle triangles[TEST_PRIMITIVE_COUNT];
+    TmScalar t[TEST_PRIMITIVE_COUNT];
+    TmScalar const tMax = 15.0f;
+
+    fillPrimitives(boxes, spheres, triangles, ray);
+    // The scattered primitives exercise both outcomes.
+    ASSERT_BATCH_MATCHES_SINGLE(tmRayIntersectAabbBatch, tmRayIntersectAabb, ray, tMax, boxes);
+    ASSERT_BATCH_MATCHES_SINGLE(tmRayIntersectSphereBatch, tmRayIntersectSphere, ray, tMax, spheres);
+    ASSERT_BATCH_MATCHES_SINGLE(tmRayIntersectTriangleBatch, tmRayIntersectTriangle, ray, tMax, triangles);
+    ASSERT_EQ(0, tmRayIntersectTriangleBatch(t, ray, tMax, triangles, 0));
+    PASS();
+}
+
+TEST
+rayBatchMatchesSingle(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmRay const diagonal = {{1.0f, -2.0f, 3.0f}, {0.6f, 0.3f, -0.7f}};
+    // A zero direction component makes the slab test divide by zero.
+    TmRay const flat = {{-4.0f, 0.5f, 2.0f}, {1.0f, 0.0f, -0.25f}};
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    tmSimdSetBackend(backend);
+    CHECK_CALL(assertBatchMatchesSingle(&diagonal));
+    CHECK_CALL(assertBatchMatchesSingle(&flat));
+    tmSimdSetBackend(originalBackend);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(rayIntersectSphere01);
+    RUN_TEST(rayIntersectTriangle01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(rayBatchMatchesSingle, &backendArg);
+    }
+
+    GREATEST_MAIN_END();
+}
@@ -0,0 +1,109 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "greatest.h"
+#include "scalar.h"
+#include "simd.h"
+
+// The documented accuracy of the fast trigonometric functions, which
+// are single precision whatever TmScalar is.
+#define TEST_FAST_TRIG_EPSILON (0.0000002f)
+#define TEST_FAST_TRIG_RANGE 8192.0f
+#define TEST_SWEEP_STEPS 2000000
+
+// Not a multiple of any vector width, so every backend runs its tail.
+#define TEST_ANGLE_COUNT 19
+
+TEST
+scalarMix01(void)
+{
+    ASSERT_EQ(2.0f, tmScalarMix(2.0f, 6.0f, 0.0f));
+    ASSERT_EQ(6.0f, tmScalarMix(2.0f, 6.0f, 1.0f));
+    ASSERT_EQ(3.0f, tmScalarMix(2.0f, 6.0f, 0.25f));
+    PASS();
+}
+
+TEST
+scalarFastSinCos01(void)
+{
+    // Every step lands on a different reduced argument, and the ends
+    // of the range have the largest reduction error.
+    for (int i = -TEST_SWEEP_STEPS; i <= TEST_SWEEP_STEPS; ++i) {
+        float const x = TEST_FAST_TRIG_RANGE * (float)i / (float)TEST_SWEEP_STEPS;
+        float sine;
+        float cosine;
+
+        tmScalarFastSinCos(x, &sine, &cosine);
+        ASSERT_IN_RANGE(sinf(x), sine, TEST_FAST_TRIG_EPSILON);
+        ASSERT_IN_RANGE(cosf(x), cosine, TEST_FAST_TRIG_EPSILON);
+        ASSERT_EQ(sine, tmScalarFastSin(x));
+        ASSERT_EQ(cosine, tmScalarFastCos(x));
+    }
+    PASS();
+}
+
+TEST
+scalarFastTan01(void)
+{
+    for (int i = -TEST_SWEEP_STEPS; i <= TEST_SWEEP_STEPS; ++i) {
+        float const x = TEST_FAST_TRIG_RANGE * (float)i / (float)TEST_SWEEP_STEPS;
+        double const expected = tan((double)x);
+
+        // The error grows with the derivative of tan, 1 + tan^2.
+        ASSERT_IN_RANGE(expected,
+                        (double)tmScalarFastTan(x),
+                        TEST_FAST_TRIG_EPSILON * (1.0 + expected * expected));
+    }
+    PASS();
+}
+
+TEST
+scalarFastSinCosBatch(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    float angles[TEST_ANGLE_COUNT];
+    float expectedSines[TEST_ANGLE_COUNT];
+    float expectedCosines[TEST_ANGLE_COUNT];
+    float sines[TEST_ANGLE_COUNT];
+    float cosines[TEST_ANGLE_COUNT];
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    // Covers every quadrant on both sides of zero, and the signed zeros.
+    for (int i = 0; i < TEST_ANGLE_COUNT; ++i) {
+        angles[i] = 0.9f * (float)(i - TEST_ANGLE_COUNT / 2) + 0.05f * (float)(i % 3);
+        tmScalarFastSinCos(angles[i], &expectedSines[i], &expectedCosines[i]);
+    }
+    angles[0] = -0.0f;
+    tmScalarFastSinCos(angles[0], &expectedSines[0], &expectedCosines[0]);
+
+    tmSimdSetBackend(backend);
+    tmScalarFastSinCosBatch(sines, cosines, angles, TEST_ANGLE_COUNT);
+    ASSERT_MEM_EQ(expectedSines, sines, sizeof(sines));
+    ASSERT_MEM_EQ(expectedCosines, cosines, sizeof(cosines));
+
+    tmSimdSetBackend(originalBackend);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(scalarMix01);
+    RUN_TEST(scalarFastSinCos01);
+    RUN_TEST(scalarFastTan01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(scalarFastSinCosBatch, &backendArg);
+    }
+
+    GREATEST_MAIN_END();
+}
@@ -0,0 +1,292 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "greatest.h"
+#include "quaternion.h"
+#include "simd.h"
+#include "skinning.h"
+#include "transform.h"
+#include "vector.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+
+#define TEST_JOINT_COUNT 12
+// Not a multiple of any vector width, so every backend runs its tail.
+#define TEST_VERTEX_COUNT 75
+// Enough for several threads.
+#define TEST_THREADED_VERTEX_COUNT 20000
+
+typedef struct TestMesh {
+    TmVec3     *positions;
+    TmVec3     *normals;
+    uint16_t   *joints;
+    TmVec4     *weights;
+    TmSkinMesh  mesh;
+} TestMesh;
+
+static TmScalar
+nextRandom(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+
+    return (TmScalar)(*state >> 8) / (TmScalar)(1u << 24);
+}
+
+// Compares values rather than bytes, since long double scalars carry
+// padding on some targets.
+TEST
+assertVec3sEqual(TmVec3 const *expected, TmVec3 const *actual, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(expected[i].x, actual[i].x);
+        ASSERT_EQ(expected[i].y, actual[i].y);
+        ASSERT_EQ(expected[i].z, actual[i].z);
+    }
+    PASS();
+}
+
+TEST
+assertVec3Near(TmVec3 const *expected, TmVec3 const *actual, TmScalar tolerance)
+{
+    ASSERT_IN_RANGE(expected->x, actual->x, tolerance);
+    ASSERT_IN_RANGE(expected->y, actual->y, tolerance);
+    ASSERT_IN_RANGE(expected->z, actual->z, tolerance);
+    PASS();
+}
+
+// Random rigid joints as matrices and dual quaternions, and their
+// rotations and translations.
+static void
+fillPalettes(TmMat4 *matrices, TmDualQuat *dualQuats, TmQuat *rotations, TmVec3 *translations, uint32_t seed)
+{
+    TmVec3 const unitScale = {1.0f, 1.0f, 1.0f};
+    uint32_t state = seed;
+
+    for (int j = 0; j < TEST_JOINT_COUNT; ++j) {
+        TmVec3 axis = {2.0f * nextRandom(&state) - 1.0f, 2.0f * nextRandom(&state) - 1.0f, 1.0f};
+
+        tmVec3Normalize(&axis, &axis);
+        tmQuatFromAxisAngle(&rotations[j], &axis, 6.0f * nextRandom(&state) - 3.0f);
+        translations[j] = (TmVec3){4.0f * nextRandom(&state) - 2.0f,
+                                   4.0f * nextRandom(&state) - 2.0f,
+                                   4.0f * nextRandom(&state) - 2.0f};
+        tmTransformCompose(&matrices[j], &translations[j], &rotations[j], &unitScale);
+        tmDualQuatFromRotationTranslation(&dualQuats[j], &rotations[j], &translations[j]);
+    }
+}
+
+// Random vertices with four random influences each, the last padded
+// with weight zero on some.
+static void
+initMesh(TestMesh *test, size_t count, uint32_t seed)
+{
+    uint32_t state = seed;
+
+    test->positions = malloc(count * sizeof(*test->positions));
+    test->normals = malloc(count * sizeof(*test->normals));
+    test->joints = malloc(count * TM_SKIN_INFLUENCES * sizeof(*test->joints));
+    test->weights = malloc(count * sizeof(*test->weights));
+    for (size_t i = 0; i < count; ++i) {
+        TmScalar w[TM_SKIN_INFLUENCES];
+        TmScalar sum = 0.0f;
+
+        test->positions[i] = (TmVec3){4.0f * nextRandom(&state) - 2.0f,
+                                      4.0f * nextRandom(&state) - 2.0f,
+                                      4.0f * nextRandom(&state) - 2.0f};
+        test->normals[i] = (TmVec3){2.0f * nextRandom(&state) - 1.0f, 2.0f * nextRandom(&state) - 1.0f, 0.5f};
+        tmVec3Normalize(&test->normals[i], &test->normals[i]);
+        for (int k = 0; k < TM_SKIN_INFLUENCES; ++k) {
+            test->joints[TM_SKIN_INFLUENCES * i + (size_t)k] = (uint16_t)(nextRandom(&state) * TEST_JOINT_COUNT);
+            w[k] = (k == TM_SKIN_INFLUENCES - 1 && i % 3 == 0) ? 0.0f : nextRandom(&state);
+            sum += w[k];
+        }
+        test->weights[i] = (TmVec4){w[0] / sum, w[1] / sum, w[2] / sum, w[3] / sum};
+    }
+    test->mesh = (TmSkinMesh){test->positions, test->normals, test->joints, test->weights, count};
+}
+
+static void
+freeMesh(TestMesh *test)
+{
+    free(test->positions);
+    free(test->normals);
+    free(test->joints);
+    free(test->weights);
+}
+
+TEST
+skinSingleJoint01(void)
+{
+    TmMat4 matrices[TEST_JOINT_COUNT];
+    TmDualQuat dualQuats[TEST_JOINT_COUNT];
+    TmQuat rotations[TEST_JOINT_COUNT];
+    TmVec3 translations[TEST_JOINT_COUNT];
+    TmVec3 positions[TEST_VERTEX_COUNT];
+    TmVec3 normals[TEST_VERTEX_COUNT];
+    TestMesh test;
+
+    // With all weight on one joint, both methods are that joint's rigid
+    // transform.
+    fillPalettes(matrices, dualQuats, rotations, translations, 5u);
+    initMesh(&test, TEST_VERTEX_COUNT, 17u);
+    for (size_t i = 0; i < TEST_VERTEX_COUNT; ++i) {
+        test.weights[i] = (TmVec4){0.0f, 1.0f, 0.0f, 0.0f};
+    }
+
+    tmSkinLinear(positions, normals, &test.mesh, matrices, 1);
+    for (size_t i = 0; i < TEST_VERTEX_COUNT; ++i) {
+        TmQuat const *rotation = &rotations[test.joints[TM_SKIN_INFLUENCES * i + 1]];
+        TmVec3 expected;
+
+        tmQuatRotateVec3(&expected, rotation, &test.positions[i]);
+        tmVec3Add(&expected, &expected, &translations[test.joints[TM_SKIN_INFLUENCES * i + 1]]);
+        CHECK_CALL(assertVec3Near(&expected, &positions[i], TEST_FLOAT_EPSILON * 16.0f));
+        tmQuatRotateVec3(&expected, rotation, &test.normals[i]);
+        CHECK_CALL(assertVec3Near(&expected, &normals[i], TEST_FLOAT_EPSILON * 8.0f));
+    }
+
+    tmSkinDualQuat(positions, normals, &test.mesh, dualQuats, 1);
+    for (size_t i = 0; i < TEST_VERTEX_COUNT; ++i) {
+        TmDualQuat const *dq = &dualQuats[test.joints[TM_SKIN_INFLUENCES * i + 1]];
+        TmVec3 expected;
+
+        tmDualQuatTransformPoint(&expected, dq, &test.positions[i]);
+        CHECK_CALL(assertVec3Near(&expected, &positions[i], TEST_FLOAT_EPSILON * 16.0f));
+        tmQuatRotateVec3(&expected, &dq->real, &test.normals[i]);
+        CHECK_CALL(assertVec3Near(&expected, &normals[i], TEST_FLOAT_EPSILON * 8.0f));
+    }
+    freeMesh(&test);
+    PASS();
+}
+
+TEST
+skinDualQuatBlend01(void)
+{
+    TmVec3 const zero = {0.0f, 0.0f, 0.0f};
+    TmVec3 const unitScale = {1.0f, 1.0f, 1.0f};
+    TmVec3 const bindPosition = {1.0f, 0.0f, 0.0f};
+    uint16_t const joints[TM_SKIN_INFLUENCES] = {0, 1, 0, 0};
+    TmVec4 const weights = {0.5f, 0.5f, 0.0f, 0.0f};
+    TmSkinMesh const mesh = {&bindPosition, NULL, joints, &weights, 1};
+    TmVec3 const zAxis = {0.0f, 0.0f, 1.0f};
+    TmMat4 matrices[2];
+    TmDualQuat dualQuats[2];
+    TmQuat rotations[2];
+    TmVec3 linear, dualQuat;
+
+    // Halfway between +-80 degrees about z, linear blending collapses
+    // the point towards the axis while dual quaternions keep its
+    // distance.
+    tmQuatFromAxisAngle(&rotations[0], &zAxis, 1.4f);
+    tmQuatFromAxisAngle(&rotations[1], &zAxis, -1.4f);
+    for (int j = 0; j < 2; ++j) {
+        tmTransformCompose(&matrices[j], &zero, &rotations[j], &unitScale);
+        tmDualQuatFromRotationTranslation(&dualQuats[j], &rotations[j], &zero);
+    }
+    tmSkinLinear(&linear, NULL, &mesh, matrices, 1);
+    tmSkinDualQuat(&dualQuat, NULL, &mesh, dualQuats, 1);
+    ASSERT_IN_RANGE(tmScalarCos(1.4f), linear.x, TEST_FLOAT_EPSILON * 8.0f);
+    CHECK_CALL(assertVec3Near(&bindPosition, &dualQuat, TEST_FLOAT_EPSILON * 8.0f));
+
+    // -q is the same rotation, and blends along the shorter arc.
+    dualQuats[1].real = (TmQuat){-dualQuats[1].real.x, -dualQuats[1].real.y, -dualQuats[1].real.z, -dualQuats[1].real.w};
+    dualQuats[1].dual = (TmQuat){-dualQuats[1].dual.x, -dualQuats[1].dual.y, -dualQuats[1].dual.z, -dualQuats[1].dual.w};
+    tmSkinDualQuat(&dualQuat, NULL, &mesh, dualQuats, 1);
+    CHECK_CALL(assertVec3Near(&bindPosition, &dualQuat, TEST_FLOAT_EPSILON * 8.0f));
+    PASS();
+}
+
+TEST
+skinBackendMatchesScalar(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmMat4 matrices[TEST_JOINT_COUNT];
+    TmDualQuat dualQuats[TEST_JOINT_COUNT];
+    TmQuat rotations[TEST_JOINT_COUNT];
+    TmVec3 translations[TEST_JOINT_COUNT];
+    TmVec3 expectedPositions[TEST_VERTEX_COUNT], expectedNormals[TEST_VERTEX_COUNT];
+    TmVec3 positions[TEST_VERTEX_COUNT], normals[TEST_VERTEX_COUNT];
+    TestMesh test;
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    fillPalettes(matrices, dualQuats, rotations, translations, 23u);
+    initMesh(&test, TEST_VERTEX_COUNT, 29u);
+    // A normal that skins to zero is left as it is.
+    test.normals[5] = (TmVec3){0.0f, 0.0f, 0.0f};
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmSkinLinear(expectedPositions, expectedNormals, &test.mesh, matrices, 1);
+    tmSimdSetBackend(backend);
+    tmSkinLinear(positions, normals, &test.mesh, matrices, 1);
+    CHECK_CALL(assertVec3sEqual(expectedPositions, positions, TEST_VERTEX_COUNT));
+    CHECK_CALL(assertVec3sEqual(expectedNormals, normals, TEST_VERTEX_COUNT));
+
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmSkinDualQuat(expectedPositions, expectedNormals, &test.mesh, dualQuats, 1);
+    tmSimdSetBackend(backend);
+    tmSkinDualQuat(positions, normals, &test.mesh, dualQuats, 1);
+    CHECK_CALL(assertVec3sEqual(expectedPositions, positions, TEST_VERTEX_COUNT));
+    CHECK_CALL(assertVec3sEqual(expectedNormals, normals, TEST_VERTEX_COUNT));
+
+    // Without normals, only positions are written.
+    test.mesh.normals = NULL;
+    tmSkinLinear(positions, normals, &test.mesh, matrices, 1);
+    CHECK_CALL(assertVec3sEqual(expectedNormals, normals, TEST_VERTEX_COUNT));
+    tmSimdSetBackend(TM_SIMD_BACKEND_SCALAR);
+    tmSkinLinear(expectedPositions, NULL, &test.mesh, matrices, 1);
+    CHECK_CALL(assertVec3sEqual(expectedPositions, positions, TEST_VERTEX_COUNT));
+    tmSimdSetBackend(originalBackend);
+    freeMesh(&test);
+    PASS();
+}
+
+TEST
+skinThreads01(void)
+{
+    TmMat4 matrices[TEST_JOINT_COUNT];
+    TmDualQuat dualQuats[TEST_JOINT_COUNT];
+    TmQuat rotations[TEST_JOINT_COUNT];
+    TmVec3 translations[TEST_JOINT_COUNT];
+    TmVec3 *expected = malloc(2 * TEST_THREADED_VERTEX_COUNT * sizeof(*expected));
+    TmVec3 *actual = malloc(2 * TEST_THREADED_VERTEX_COUNT * sizeof(*actual));
+    TestMesh test;
+
+    ASSERT(expected != NULL && actual != NULL);
+    fillPalettes(matrices, dualQuats, rotations, translations, 31u);
+    initMesh(&test, TEST_THREADED_VERTEX_COUNT, 37u);
+
+    tmSkinLinear(expected, &expected[TEST_THREADED_VERTEX_COUNT], &test.mesh, matrices, 1);
+    tmSkinLinear(actual, &actual[TEST_THREADED_VERTEX_COUNT], &test.mesh, matrices, 4);
+    CHECK_CALL(assertVec3sEqual(expected, actual, 2 * TEST_THREADED_VERTEX_COUNT));
+    tmSkinDualQuat(expected, &expected[TEST_THREADED_VERTEX_COUNT], &test.mesh, dualQuats, 1);
+    tmSkinDualQuat(actual, &actual[TEST_THREADED_VERTEX_COUNT], &test.mesh, dualQuats, 4);
+    CHECK_CALL(assertVec3sEqual(expected, actual, 2 * TEST_THREADED_VERTEX_COUNT));
+    freeMesh(&test);
+    free(expected);
+    free(actual);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(skinSingleJoint01);
+    RUN_TEST(skinDualQuatBlend01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(skinBackendMatchesScalar, &backendArg);
+    }
+    RUN_TEST(skinThreads01);
+
+    GREATEST_MAIN_END();
+}
@@ -0,0 +1,238 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "greatest.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "transform.h"
+#include "vector.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+// Products of several matrices accumulate rounding.
+#define TEST_PRODUCT_EPSILON (0.0001f)
+
+#define TEST_NODE_COUNT 40
+
+static TmVec3 const sk_axis = {0.48f, -0.6f, 0.64f};
+
+static TmScalar
+nextRandom(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+
+    return (TmScalar)(*state >> 8) / (TmScalar)(1u << 24);
+}
+
+TEST
+assertMat4Near(TmMat4 const *expected, TmMat4 const *actual, TmScalar tolerance)
+{
+    TmScalar const *pExpected = (TmScalar const *)expected;
+    TmScalar const *pActual = (TmScalar const *)actual;
+
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_IN_RANGE(pExpected[i], pActual[i], tolerance);
+    }
+    PASS();
+}
+
+// T * R * S from the individual matrices.
+static TmMat4
+referenceLocal(TmVec3 const *translation, TmVec3 const *axis, TmScalar angle, TmVec3 const *scale)
+{
+    TmMat4 t = TM_MAT4_IDENTITY;
+    TmMat4 s = TM_MAT4_IDENTITY;
+    TmMat4 r;
+    TmMat4 result;
+
+    t.m14 = translation->x;
+    t.m24 = translation->y;
+    t.m34 = translation->z;
+    s.m11 = scale->x;
+    s.m22 = scale->y;
+    s.m33 = scale->z;
+    tmMat4Rotation(&r, axis, angle);
+    tmMat4Multiply(&result, &r, &s);
+
+    return *tmMat4Multiply(&result, &t, &result);
+}
+
+// Gives every node a random local transform and returns the matching
+// world matrices.
+static void
+randomizeNodes(TmTransformHierarchy *hierarchy, TmMat4 *expectedWorlds, uint32_t seed)
+{
+    uint32_t state = seed;
+
+    for (uint32_t i = 0; i < hierarchy->count; ++i) {
+        TmVec3 const translation = {4.0f * nextRandom(&state) - 2.0f,
+                                    4.0f * nextRandom(&state) - 2.0f,
+                                    4.0f * nextRandom(&state) - 2.0f};
+        TmVec3 const scale = {0.5f + nextRandom(&state), 0.5f + nextRandom(&state), 0.5f + nextRandom(&state)};
+        TmScalar const angle = 6.0f * nextRandom(&state) - 3.0f;
+        uint32_t const parent = hierarchy->parents[i];
+        TmMat4 const local = referenceLocal(&translation, &sk_axis, angle, &scale);
+        TmQuat rotation;
+
+        tmTransformHierarchySetTranslation(hierarchy, i, &translation);
+        tmTransformHierarchySetRotation(hierarchy, i, tmQuatFromAxisAngle(&rotation, &sk_axis, angle));
+        tmTransformHierarchySetScale(hierarchy, i, &scale);
+        if (parent == TM_TRANSFORM_NO_PARENT) {
+            expectedWorlds[i] = local;
+        } else {
+            tmMat4Multiply(&expectedWorlds[i], &expectedWorlds[parent], &local);
+        }
+    }
+}
+
+// A forest whose nodes pick a random earlier parent, or none.
+static void
+addRandomNodes(TmTransformHierarchy *hierarchy, size_t count, uint32_t seed)
+{
+    uint32_t state = seed;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t const parent = (i == 0 || nextRandom(&state) < 0.2f) ?
+                                TM_TRANSFORM_NO_PARENT :
+                                (uint32_t)(nextRandom(&state) * (TmScalar)i);
+
+        tmTransformHierarchyAdd(hierarchy, parent);
+    }
+}
+
+TEST
+transformCompose01(void)
+{
+    TmVec3 const translation = {1.5f, -2.0f, 3.25f};
+    TmVec3 const scale = {0.5f, 2.0f, 1.5f};
+    TmMat4 const expected = referenceLocal(&translation, &sk_axis, 0.7f, &scale);
+    TmMat4 actual;
+    TmQuat rotation;
+
+    tmTransformCompose(&actual, &translation, tmQuatFromAxisAngle(&rotation, &sk_axis, 0.7f), &scale);
+    CHECK_CALL(assertMat4Near(&expected, &actual, TEST_FLOAT_EPSILON * 8.0f));
+    PASS();
+}
+
+TEST
+transformHierarchyUpdate01(void)
+{
+    TmTransformHierarchy hierarchy;
+    TmMat4 expected[TEST_NODE_COUNT];
+
+    ASSERT(tmTransformHierarchyInit(&hierarchy, TEST_NODE_COUNT));
+    addRandomNodes(&hierarchy, TEST_NODE_COUNT, 7u);
+    ASSERT_EQ(TEST_NODE_COUNT, hierarchy.count);
+
+    // New nodes are identities.
+    ASSERT_EQ(TEST_NODE_COUNT, tmTransformHierarchyUpdate(&hierarchy));
+    for (int i = 0; i < TEST_NODE_COUNT; ++i) {
+        CHECK_CALL(assertMat4Near(&TM_MAT4_IDENTITY, &hierarchy.worlds[i], TEST_FLOAT_EPSILON));
+    }
+
+    randomizeNodes(&hierarchy, expected, 99u);
+    ASSERT_EQ(TEST_NODE_COUNT, tmTransformHierarchyUpdate(&hierarchy));
+    for (int i = 0; i < TEST_NODE_COUNT; ++i) {
+        CHECK_CALL(assertMat4Near(&expected[i], &hierarchy.worlds[i], TEST_PRODUCT_EPSILON));
+    }
+    // Nothing changed since.
+    ASSERT_EQ(0, tmTransformHierarchyUpdate(&hierarchy));
+    tmTransformHierarchyFree(&hierarchy);
+    PASS();
+}
+
+TEST
+transformHierarchyDirtySubtree01(void)
+{
+    TmTransformHierarchy hierarchy;
+    TmVec3 const offset = {1.0f, 2.0f, 3.0f};
+    TmMat4 expected[6];
+    TmMat4 before[6];
+    uint32_t root, child, grandchild, sibling, otherRoot, otherChild;
+
+    // root -> child -> grandchild, root -> sibling, otherRoot -> otherChild
+    ASSERT(tmTransformHierarchyInit(&hierarchy, 0));
+    root = tmTransformHierarchyAdd(&hierarchy, TM_TRANSFORM_NO_PARENT);
+    child = tmTransformHierarchyAdd(&hierarchy, root);
+    otherRoot = tmTransformHierarchyAdd(&hierarchy, TM_TRANSFORM_NO_PARENT);
+    grandchild = tmTransformHierarchyAdd(&hierarchy, child);
+    sibling = tmTransformHierarchyAdd(&hierarchy, root);
+    otherChild = tmTransformHierarchyAdd(&hierarchy, otherRoot);
+    randomizeNodes(&hierarchy, expected, 3u);
+    ASSERT_EQ(6, tmTransformHierarchyUpdate(&hierarchy));
+
+    // Only the moved node and its descendants are recomputed.
+    for (int i = 0; i < 6; ++i) {
+        before[i] = hierarchy.worlds[i];
+    }
+    tmTransformHierarchySetTranslation(&hierarchy, child, &offset);
+    ASSERT_EQ(2, tmTransformHierarchyUpdate(&hierarchy));
+    ASSERT_EQ(offset.x, hierarchy.locals[child].m14);
+    ASSERT_EQ(before[root].m14, hierarchy.worlds[root].m14);
+    ASSERT_EQ(before[sibling].m14, hierarchy.worlds[sibling].m14);
+    ASSERT_EQ(before[otherChild].m14, hierarchy.worlds[otherChild].m14);
+    ASSERT(before[grandchild].m14 != hierarchy.worlds[grandchild].m14);
+
+    tmTransformHierarchySetTranslation(&hierarchy, root, &offset);
+    ASSERT_EQ(4, tmTransformHierarchyUpdate(&hierarchy));
+    // The root was recomputed by the last update but not this one, so it
+    // must not pull its children along again.
+    tmTransformHierarchySetScale(&hierarchy, sibling, &offset);
+    ASSERT_EQ(1, tmTransformHierarchyUpdate(&hierarchy));
+
+    // Direct writes to the arrays, then a dirty range.
+    randomizeNodes(&hierarchy, expected, 11u);
+    tmTransformHierarchyUpdate(&hierarchy);
+    hierarchy.translations[otherRoot] = offset;
+    hierarchy.scales[grandchild] = offset;
+    tmTransformHierarchyMarkDirty(&hierarchy, otherRoot, grandchild - otherRoot + 1);
+    ASSERT_EQ(3, tmTransformHierarchyUpdate(&hierarchy));
+    ASSERT_EQ(offset.x, hierarchy.worlds[otherRoot].m14);
+    ASSERT_EQ(offset.y, hierarchy.worlds[otherRoot].m24);
+    ASSERT_EQ(offset.z, hierarchy.worlds[otherRoot].m34);
+    tmTransformHierarchyFree(&hierarchy);
+    PASS();
+}
+
+TEST
+transformHierarchyGrow01(void)
+{
+    TmTransformHierarchy hierarchy;
+    TmVec3 const step = {0.5f, 0.0f, -1.0f};
+    uint32_t node = TM_TRANSFORM_NO_PARENT;
+
+    // A chain much longer than the initial capacity.
+    ASSERT(tmTransformHierarchyInit(&hierarchy, 0));
+    for (int i = 0; i < 100; ++i) {
+        node = tmTransformHierarchyAdd(&hierarchy, node);
+        ASSERT_EQ((uint32_t)i, node);
+        tmTransformHierarchySetTranslation(&hierarchy, node, &step);
+    }
+    ASSERT_EQ(100, tmTransformHierarchyUpdate(&hierarchy));
+    ASSERT_IN_RANGE(50.0f, hierarchy.worlds[node].m14, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(0.0f, hierarchy.worlds[node].m24, TEST_FLOAT_EPSILON);
+    ASSERT_IN_RANGE(-100.0f, hierarchy.worlds[node].m34, TEST_FLOAT_EPSILON);
+
+    // Nodes added after an update start dirty.
+    node = tmTransformHierarchyAdd(&hierarchy, 10);
+    ASSERT_EQ(1, tmTransformHierarchyUpdate(&hierarchy));
+    ASSERT_IN_RANGE(5.5f, hierarchy.worlds[node].m14, TEST_FLOAT_EPSILON);
+    tmTransformHierarchyFree(&hierarchy);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(transformCompose01);
+    RUN_TEST(transformHierarchyUpdate01);
+    RUN_TEST(transformHierarchyDirtySubtree01);
+    RUN_TEST(transformHierarchyGrow01);
+
+    GREATEST_MAIN_END();
+}
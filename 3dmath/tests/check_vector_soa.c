@@ -0,0 +1,267 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "greatest.h"
+#include "simd.h"
+#include "vector.h"
+#include "vector_soa.h"
+
+#define TEST_FLOAT_EPSILON (0.000001f)
+
+// Not a multiple of any vector width, so every backend runs its tail.
+#define TEST_STREAM_COUNT 19
+
+// Compares values rather than bytes, since long double scalars carry
+// padding on some targets.
+#define ASSERT_SCALARS_EQ(expected, actual, size)                            \
+    CHECK_CALL(assertScalarsEqual((TmScalar const *)(expected),              \
+                                  (TmScalar const *)(actual),                \
+                                  (size) / (sizeof(TmScalar))))
+
+TEST
+assertScalarsEqual(TmScalar const *expected, TmScalar const *actual, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(expected[i], actual[i]);
+    }
+    PASS();
+}
+
+static void
+fillVec3Inputs(TmVec3 p[TEST_STREAM_COUNT], TmVec3 q[TEST_STREAM_COUNT])
+{
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        p[i].x = 0.5f * (TmScalar)i - 3.0f;
+        p[i].y = 1.0f + 0.25f * (TmScalar)(i % 5);
+        p[i].z = -2.0f + 0.125f * (TmScalar)(i * 3);
+        q[i].x = 1.5f - 0.75f * (TmScalar)(i % 4);
+        q[i].y = 0.25f * (TmScalar)i + 0.5f;
+        q[i].z = 2.0f - 0.5f * (TmScalar)(i % 7);
+    }
+}
+
+static void
+fillVec4Inputs(TmVec4 p[TEST_STREAM_COUNT], TmVec4 q[TEST_STREAM_COUNT])
+{
+    TmVec3 p3[TEST_STREAM_COUNT];
+    TmVec3 q3[TEST_STREAM_COUNT];
+
+    fillVec3Inputs(p3, q3);
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        p[i] = (TmVec4){p3[i].x, p3[i].y, p3[i].z, 0.5f + 0.125f * (TmScalar)i};
+        q[i] = (TmVec4){q3[i].x, q3[i].y, q3[i].z, 1.0f - 0.25f * (TmScalar)(i % 3)};
+    }
+}
+
+TEST
+assertVec3Equal(TmVec3 const *expected, TmVec3 const *actual)
+{
+    ASSERT_IN_RANGE(expected->x, actual->x, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->x)));
+    ASSERT_IN_RANGE(expected->y, actual->y, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->y)));
+    ASSERT_IN_RANGE(expected->z, actual->z, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->z)));
+    PASS();
+}
+
+TEST
+assertVec4Equal(TmVec4 const *expected, TmVec4 const *actual)
+{
+    ASSERT_IN_RANGE(expected->x, actual->x, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->x)));
+    ASSERT_IN_RANGE(expected->y, actual->y, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->y)));
+    ASSERT_IN_RANGE(expected->z, actual->z, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->z)));
+    ASSERT_IN_RANGE(expected->w, actual->w, TEST_FLOAT_EPSILON * fmaxf(1.0f, tmScalarFabs(expected->w)));
+    PASS();
+}
+
+TEST
+vec3SoAAlloc01(void)
+{
+    TmVec3SoA soa;
+
+    ASSERT(tmVec3SoAAlloc(&soa, TEST_STREAM_COUNT));
+    ASSERT_EQ(soa.count, (size_t)TEST_STREAM_COUNT);
+    ASSERT_EQ((uintptr_t)soa.x % TM_SOA_ALIGNMENT, 0u);
+    ASSERT_EQ((uintptr_t)soa.y % TM_SOA_ALIGNMENT, 0u);
+    ASSERT_EQ((uintptr_t)soa.z % TM_SOA_ALIGNMENT, 0u);
+    ASSERT(soa.y >= soa.x + TEST_STREAM_COUNT);
+    ASSERT(soa.z >= soa.y + TEST_STREAM_COUNT);
+    tmVec3SoAFree(&soa);
+    ASSERT_EQ(soa.x, NULL);
+    PASS();
+}
+
+TEST
+vec3SoARoundTrip01(void)
+{
+    TmVec3 p[TEST_STREAM_COUNT];
+    TmVec3 q[TEST_STREAM_COUNT];
+    TmVec3 actual[TEST_STREAM_COUNT];
+    TmVec3SoA soa;
+
+    fillVec3Inputs(p, q);
+    ASSERT(tmVec3SoAAlloc(&soa, TEST_STREAM_COUNT));
+    tmVec3SoAFromAoS(&soa, p);
+    ASSERT_IN_RANGE(soa.y[7], p[7].y, TEST_FLOAT_EPSILON);
+    tmVec3SoAToAoS(actual, &soa);
+    tmVec3SoAFree(&soa);
+
+    ASSERT_SCALARS_EQ(p, actual, sizeof(p));
+    PASS();
+}
+
+TEST
+vec4SoARoundTrip01(void)
+{
+    TmVec4 p[TEST_STREAM_COUNT];
+    TmVec4 q[TEST_STREAM_COUNT];
+    TmVec4 actual[TEST_STREAM_COUNT];
+    TmVec4SoA soa;
+
+    fillVec4Inputs(p, q);
+    ASSERT(tmVec4SoAAlloc(&soa, TEST_STREAM_COUNT));
+    tmVec4SoAFromAoS(&soa, p);
+    ASSERT_IN_RANGE(soa.w[11], p[11].w, TEST_FLOAT_EPSILON);
+    tmVec4SoAToAoS(actual, &soa);
+    tmVec4SoAFree(&soa);
+
+    ASSERT_SCALARS_EQ(p, actual, sizeof(p));
+    PASS();
+}
+
+TEST
+vec3SoAMatchesAoS(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmVec3 p[TEST_STREAM_COUNT];
+    TmVec3 q[TEST_STREAM_COUNT];
+    TmVec3 actual[TEST_STREAM_COUNT];
+    TmScalar scalars[TEST_STREAM_COUNT];
+    TmVec3SoA pSoA;
+    TmVec3SoA qSoA;
+    TmVec3SoA destSoA;
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    fillVec3Inputs(p, q);
+    ASSERT(tmVec3SoAAlloc(&pSoA, TEST_STREAM_COUNT));
+    ASSERT(tmVec3SoAAlloc(&qSoA, TEST_STREAM_COUNT));
+    ASSERT(tmVec3SoAAlloc(&destSoA, TEST_STREAM_COUNT));
+    tmSimdSetBackend(backend);
+    tmVec3SoAFromAoS(&pSoA, p);
+    tmVec3SoAFromAoS(&qSoA, q);
+
+    tmVec3SoAToAoS(actual, tmVec3SoAAdd(&destSoA, &pSoA, &qSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec3 expected;
+        CHECK_CALL(assertVec3Equal(tmVec3Add(&expected, &p[i], &q[i]), &actual[i]));
+    }
+    tmVec3SoAToAoS(actual, tmVec3SoASub(&destSoA, &pSoA, &qSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec3 expected;
+        CHECK_CALL(assertVec3Equal(tmVec3Sub(&expected, &p[i], &q[i]), &actual[i]));
+    }
+    tmVec3SoAToAoS(actual, tmVec3SoACross(&destSoA, &pSoA, &qSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec3 expected;
+        CHECK_CALL(assertVec3Equal(tmVec3Cross(&expected, &p[i], &q[i]), &actual[i]));
+    }
+    tmVec3SoAToAoS(actual, tmVec3SoAScale(&destSoA, -1.5f, &pSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec3 expected;
+        CHECK_CALL(assertVec3Equal(tmVec3Scale(&expected, -1.5f, &p[i]), &actual[i]));
+    }
+    tmVec3SoAToAoS(actual, tmVec3SoANormalize(&destSoA, &pSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec3 expected;
+        CHECK_CALL(assertVec3Equal(tmVec3Normalize(&expected, &p[i]), &actual[i]));
+    }
+    tmVec3SoAToAoS(actual, tmVec3SoAProjection(&destSoA, &pSoA, &qSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec3 expected;
+        CHECK_CALL(assertVec3Equal(tmVec3Projection(&expected, &p[i], &q[i]), &actual[i]));
+    }
+    tmVec3SoADot(scalars, &pSoA, &qSoA);
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        ASSERT_IN_RANGE(tmVec3Dot(&p[i], &q[i]), scalars[i], TEST_FLOAT_EPSILON);
+    }
+    tmVec3SoALength(scalars, &pSoA);
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        ASSERT_IN_RANGE(tmVec3Length(&p[i]), scalars[i], TEST_FLOAT_EPSILON);
+    }
+
+    tmSimdSetBackend(originalBackend);
+    tmVec3SoAFree(&pSoA);
+    tmVec3SoAFree(&qSoA);
+    tmVec3SoAFree(&destSoA);
+    PASS();
+}
+
+TEST
+vec4SoAMatchesAoS(void *backendPtr)
+{
+    TmSimdBackend const backend = *(TmSimdBackend *)backendPtr;
+    TmSimdBackend const originalBackend = tmSimdBackend();
+    TmVec4 p[TEST_STREAM_COUNT];
+    TmVec4 q[TEST_STREAM_COUNT];
+    TmVec4 actual[TEST_STREAM_COUNT];
+    TmScalar scalars[TEST_STREAM_COUNT];
+    TmVec4SoA pSoA;
+    TmVec4SoA qSoA;
+
+    if (!tmSimdBackendIsSupported(backend)) {
+        SKIPm(tmSimdBackendName(backend));
+    }
+    fillVec4Inputs(p, q);
+    ASSERT(tmVec4SoAAlloc(&pSoA, TEST_STREAM_COUNT));
+    ASSERT(tmVec4SoAAlloc(&qSoA, TEST_STREAM_COUNT));
+    tmSimdSetBackend(backend);
+    tmVec4SoAFromAoS(&pSoA, p);
+    tmVec4SoAFromAoS(&qSoA, q);
+
+    tmVec4SoADot(scalars, &pSoA, &qSoA);
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        ASSERT_IN_RANGE(tmVec4Dot(&p[i], &q[i]), scalars[i], TEST_FLOAT_EPSILON);
+    }
+    tmVec4SoALength(scalars, &pSoA);
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        ASSERT_IN_RANGE(tmVec4Length(&p[i]), scalars[i], TEST_FLOAT_EPSILON);
+    }
+    tmVec4SoAToAoS(actual, tmVec4SoAProjection(&pSoA, &pSoA, &qSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec4 expected;
+        CHECK_CALL(assertVec4Equal(tmVec4Projection(&expected, &p[i], &q[i]), &actual[i]));
+    }
+    tmVec4SoAToAoS(actual, tmVec4SoANormalize(&qSoA, &qSoA));
+    for (int i = 0; i < TEST_STREAM_COUNT; ++i) {
+        TmVec4 expected;
+        CHECK_CALL(assertVec4Equal(tmVec4Normalize(&expected, &q[i]), &actual[i]));
+    }
+
+    tmSimdSetBackend(originalBackend);
+    tmVec4SoAFree(&pSoA);
+    tmVec4SoAFree(&qSoA);
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    RUN_TEST(vec3SoAAlloc01);
+    RUN_TEST(vec3SoARoundTrip01);
+    RUN_TEST(vec4SoARoundTrip01);
+    for (int backend = 0; backend < TM_SIMD_BACKEND_COUNT; ++backend) {
+        TmSimdBackend backendArg = (TmSimdBackend)backend;
+
+        RUN_TEST1(vec3SoAMatchesAoS, &backendArg);
+        RUN_TEST1(vec4SoAMatchesAoS, &backendArg);
+    }
+
+    GREATEST_MAIN_END();
+}
@@ -1,6 +1,9 @@
 #ifndef GL_SYS_H
 #define GL_SYS_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #ifdef GL_ES
 
 #include <GLES2/gl2.h>
@@ -13,40 +16,110 @@
 #define glDepthRangef glDepthRange
 #define glClearDepthf glClearDepth
 
+// GL 1.1 entry points, loaded like the others so that the call stats
+// can count them.
+typedef void (APIENTRYP GlsysDrawArraysProc)(GLenum mode, GLint first, GLsizei count);
+typedef void (APIENTRYP GlsysDrawElementsProc)(GLenum mode, GLsizei count, GLenum type, const void *indices);
+extern GlsysDrawArraysProc               glsysDrawArrays;
+extern GlsysDrawElementsProc             glsysDrawElements;
+#define glDrawArrays glsysDrawArrays
+#define glDrawElements glsysDrawElements
+
 extern PFNGLATTACHSHADERPROC             glAttachShader;
+extern PFNGLBEGINQUERYPROC               glBeginQuery;
 extern PFNGLBINDATTRIBLOCATIONPROC       glBindAttribLocation;
 extern PFNGLBINDBUFFERPROC               glBindBuffer;
+extern PFNGLBINDBUFFERRANGEPROC          glBindBufferRange;
+extern PFNGLBINDFRAMEBUFFERPROC          glBindFramebuffer;
+extern PFNGLBINDRENDERBUFFERPROC         glBindRenderbuffer;
 extern PFNGLBINDVERTEXARRAYPROC          glBindVertexArray;
 extern PFNGLBUFFERDATAPROC               glBufferData;
+extern PFNGLBUFFERSTORAGEPROC            glBufferStorage;
 extern PFNGLBUFFERSUBDATAPROC            glBufferSubData;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC   glCheckFramebufferStatus;
+extern PFNGLCLIENTWAITSYNCPROC           glClientWaitSync;
 extern PFNGLCOMPILESHADERPROC            glCompileShader;
 extern PFNGLCREATEPROGRAMPROC            glCreateProgram;
 extern PFNGLCREATESHADERPROC             glCreateShader;
+extern PFNGLDELETEBUFFERSPROC            glDeleteBuffers;
+extern PFNGLDELETEFRAMEBUFFERSPROC       glDeleteFramebuffers;
 extern PFNGLDELETEPROGRAMPROC            glDeleteProgram;
+extern PFNGLDELETEQUERIESPROC            glDeleteQueries;
+extern PFNGLDELETERENDERBUFFERSPROC      glDeleteRenderbuffers;
 extern PFNGLDELETESHADERPROC             glDeleteShader;
+extern PFNGLDELETESYNCPROC               glDeleteSync;
+extern PFNGLDELETEVERTEXARRAYSPROC       glDeleteVertexArrays;
 extern PFNGLDETACHSHADERPROC             glDetachShader;
 extern PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
 extern PFNGLENABLEVERTEXATTRIBARRAYPROC  glEnableVertexAttribArray;
+extern PFNGLENDQUERYPROC                 glEndQuery;
+extern PFNGLFENCESYNCPROC                glFenceSync;
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC  glFramebufferRenderbuffer;
 extern PFNGLGENBUFFERSPROC               glGenBuffers;
+extern PFNGLGENFRAMEBUFFERSPROC          glGenFramebuffers;
+extern PFNGLGENQUERIESPROC               glGenQueries;
+extern PFNGLGENRENDERBUFFERSPROC         glGenRenderbuffers;
 extern PFNGLGENVERTEXARRAYSPROC          glGenVertexArrays;
 extern PFNGLGETACTIVEATTRIBPROC          glGetActiveAttrib;
 extern PFNGLGETATTRIBLOCATIONPROC        glGetAttribLocation;
+extern PFNGLGETINTEGER64VPROC            glGetInteger64v;
+extern PFNGLGETPROGRAMBINARYPROC         glGetProgramBinary;
 extern PFNGLGETPROGRAMINFOLOGPROC        glGetProgramInfoLog;
 extern PFNGLGETPROGRAMIVPROC             glGetProgramiv;
+extern PFNGLGETQUERYOBJECTIVPROC         glGetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC      glGetQueryObjectui64v;
 extern PFNGLGETSHADERINFOLOGPROC         glGetShaderInfoLog;
 extern PFNGLGETSHADERIVPROC              glGetShaderiv;
+extern PFNGLGETSHADERSOURCEPROC          glGetShaderSource;
+extern PFNGLGETUNIFORMBLOCKINDEXPROC     glGetUniformBlockIndex;
 extern PFNGLGETUNIFORMLOCATIONPROC       glGetUniformLocation;
 extern PFNGLLINKPROGRAMPROC              glLinkProgram;
+extern PFNGLMAPBUFFERRANGEPROC           glMapBufferRange;
+extern PFNGLPROGRAMBINARYPROC            glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC        glProgramParameteri;
+extern PFNGLQUERYCOUNTERPROC             glQueryCounter;
+extern PFNGLRENDERBUFFERSTORAGEPROC      glRenderbufferStorage;
 extern PFNGLSHADERSOURCEPROC             glShaderSource;
 extern PFNGLUNIFORM1FPROC                glUniform1f;
 extern PFNGLUNIFORM2FPROC                glUniform2f;
 extern PFNGLUNIFORM3FPROC                glUniform3f;
+extern PFNGLUNIFORMBLOCKBINDINGPROC      glUniformBlockBinding;
 extern PFNGLUNIFORMMATRIX4FVPROC         glUniformMatrix4fv;
 extern PFNGLUSEPROGRAMPROC               glUseProgram;
 extern PFNGLVERTEXATTRIBPOINTERPROC      glVertexAttribPointer;
 
 #endif
 
+typedef struct GlsysStateCacheStats {
+    unsigned long   issuedCalls;
+    unsigned long   skippedCalls;
+} GlsysStateCacheStats;
+
+typedef struct GlsysCallStats {
+    unsigned long   drawCalls;
+    size_t          uploadedBytes;
+} GlsysCallStats;
+
 void	glsysInit(void);
 
+// Routes glUseProgram, glBindBuffer, glBindVertexArray,
+// gl{Enable,Disable}VertexAttribArray and glVertexAttribPointer through
+// a shadow copy of the state they set, skipping the calls that would not
+// change it. glDeleteBuffers, glDeleteVertexArrays and glDeleteProgram
+// forget the state naming what they delete, as the name may be reused.
+// May be called before or after glsysInit, with the context current on
+// the calling thread. State changed through other entry points or
+// another context is not seen. Not available with GL_ES, whose entry
+// points are not loaded by glsys.
+void	glsysEnableStateCache(bool isEnabled);
+void	glsysGetStateCacheStats(GlsysStateCacheStats *pStats);
+void	glsysResetStateCacheStats(void);
+
+// Counts glDrawArrays and glDrawElements calls, and the bytes passed to
+// glBufferData and glBufferSubData, as they reach the driver. Set up
+// like the state cache, and also not available with GL_ES.
+void	glsysEnableCallStats(bool isEnabled);
+void	glsysGetCallStats(GlsysCallStats *pStats);
+void	glsysResetCallStats(void);
+
 #endif // GL_SYS_H
@@ -0,0 +1,28 @@
+#ifndef GL_SYS_FILE_H
+#define GL_SYS_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A whole file in memory, mapped read-only where the platform and the
+// file allow it, and read into a buffer otherwise. The contents are not
+// NUL-terminated: pass size along, e.g. as glShaderSource's length.
+typedef struct GlsysFile {
+    const char  *data;
+    size_t       size;
+    bool         isMapped;
+} GlsysFile;
+
+// Returns false, with errno set, if the file cannot be read.
+bool	glsysFileOpen(const char *path, GlsysFile *pFile);
+void	glsysFileClose(GlsysFile *pFile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GL_SYS_FILE_H
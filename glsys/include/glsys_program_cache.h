@@ -0,0 +1,52 @@
+#ifndef GL_SYS_PROGRAM_CACHE_H
+#define GL_SYS_PROGRAM_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glsys_file.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// On-disk store of linked program binaries, one file per key in a cache
+// directory. The key should hash everything the binary depends on: the
+// shader sources, attribute bindings and the GL_VENDOR, GL_RENDERER and
+// GL_VERSION strings. The GL calls are left to the caller, so that any
+// loader can use it.
+
+// FNV-1a, chained by passing the previous hash, starting from
+// GLSYS_HASH_SEED.
+#define GLSYS_HASH_SEED UINT64_C(14695981039346656037)
+
+uint64_t	glsysHash(uint64_t hash, const void *data, size_t size);
+// Hashes the terminator too, so that "ab" then "c" differs from "a" then
+// "bc". NULL hashes like "".
+uint64_t	glsysHashString(uint64_t hash, const char *string);
+
+typedef struct GlsysProgramBinary {
+    uint32_t     format;
+    const void  *data;
+    size_t       size;
+    GlsysFile    file;
+} GlsysProgramBinary;
+
+// Returns false if there is no entry for key, or if it is corrupt or
+// stored for another key.
+bool	glsysProgramCacheLoad(const char *directory, uint64_t key, GlsysProgramBinary *pBinary);
+void	glsysProgramCacheRelease(GlsysProgramBinary *pBinary);
+// Replaces the entry for key as a whole, so that readers never see half
+// of one.
+bool	glsysProgramCacheStore(const char *directory,
+                               uint64_t key,
+                               uint32_t format,
+                               const void *data,
+                               size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GL_SYS_PROGRAM_CACHE_H
@@ -1,94 +1,555 @@
-#ifdef GL_ES
-
-void
-glsysInit(void)
-{
-}
-
-#else
-
-#include "SDL_video.h"
-#include "glsys.h"
-
-PFNGLATTACHSHADERPROC             glAttachShader;
-PFNGLBINDATTRIBLOCATIONPROC       glBindAttribLocation;
-PFNGLBINDBUFFERPROC               glBindBuffer;
-PFNGLBINDVERTEXARRAYPROC          glBindVertexArray;
-PFNGLBUFFERDATAPROC               glBufferData;
-PFNGLBUFFERSUBDATAPROC            glBufferSubData;
-PFNGLCOMPILESHADERPROC            glCompileShader;
-PFNGLCREATEPROGRAMPROC            glCreateProgram;
-PFNGLCREATESHADERPROC             glCreateShader;
-PFNGLDELETEPROGRAMPROC            glDeleteProgram;
-PFNGLDELETESHADERPROC             glDeleteShader;
-PFNGLDETACHSHADERPROC             glDetachShader;
-PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
-PFNGLENABLEVERTEXATTRIBARRAYPROC  glEnableVertexAttribArray;
-PFNGLGENBUFFERSPROC               glGenBuffers;
-PFNGLGENVERTEXARRAYSPROC          glGenVertexArrays;
-PFNGLGETACTIVEATTRIBPROC          glGetActiveAttrib;
-PFNGLGETATTRIBLOCATIONPROC        glGetAttribLocation;
-PFNGLGETPROGRAMINFOLOGPROC        glGetProgramInfoLog;
-PFNGLGETPROGRAMIVPROC             glGetProgramiv;
-PFNGLGETSHADERINFOLOGPROC         glGetShaderInfoLog;
-PFNGLGETSHADERIVPROC              glGetShaderiv;
-PFNGLGETUNIFORMLOCATIONPROC       glGetUniformLocation;
-PFNGLLINKPROGRAMPROC              glLinkProgram;
-PFNGLSHADERSOURCEPROC             glShaderSource;
-PFNGLUNIFORM1FPROC                glUniform1f;
-PFNGLUNIFORM2FPROC                glUniform2f;
-PFNGLUNIFORM3FPROC                glUniform3f;
-PFNGLUNIFORMMATRIX4FVPROC         glUniformMatrix4fv;
-PFNGLUSEPROGRAMPROC               glUseProgram;
-PFNGLVERTEXATTRIBPOINTERPROC      glVertexAttribPointer;
-
-#if defined(__GNUC__) && !defined(__clang__) // GCC only
-#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wpedantic"
-#else
-#pragma GCC diagnostic ignored "-pedantic"
-#endif
-#endif // GCC only
-void
-glsysInit(void)
-{
-    glAttachShader             = (PFNGLATTACHSHADERPROC)SDL_GL_GetProcAddress("glAttachShader");
-    glBindAttribLocation       = (PFNGLBINDATTRIBLOCATIONPROC)SDL_GL_GetProcAddress("glBindAttribLocation");
-    glBindBuffer               = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
-    glBindVertexArray          = (PFNGLBINDVERTEXARRAYPROC)SDL_GL_GetProcAddress("glBindVertexArray");
-    glBufferData               = (PFNGLBUFFERDATAPROC)SDL_GL_GetProcAddress("glBufferData");
-    glBufferSubData            = (PFNGLBUFFERSUBDATAPROC)SDL_GL_GetProcAddress("glBufferSubData");
-    glCompileShader            = (PFNGLCOMPILESHADERPROC)SDL_GL_GetProcAddress("glCompileShader");
-    glCreateProgram            = (PFNGLCREATEPROGRAMPROC)SDL_GL_GetProcAddress("glCreateProgram");
-    glCreateShader             = (PFNGLCREATESHADERPROC)SDL_GL_GetProcAddress("glCreateShader");
-    glDeleteProgram            = (PFNGLDELETEPROGRAMPROC)SDL_GL_GetProcAddress("glDeleteProgram");
-    glDeleteShader             = (PFNGLDELETESHADERPROC)SDL_GL_GetProcAddress("glDeleteShader");
-    glDetachShader             = (PFNGLDETACHSHADERPROC)SDL_GL_GetProcAddress("glDetachShader");
-    glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)SDL_GL_GetProcAddress("glEnableVertexAttribArray");
-    glEnableVertexAttribArray  = (PFNGLENABLEVERTEXATTRIBARRAYPROC)SDL_GL_GetProcAddress("glEnableVertexAttribArray");
-    glGenBuffers               = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
-    glGenVertexArrays          = (PFNGLGENVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glGenVertexArrays");
-    glGetActiveAttrib          = (PFNGLGETACTIVEATTRIBPROC)SDL_GL_GetProcAddress("glGetActiveAttrib");
-    glGetAttribLocation        = (PFNGLGETATTRIBLOCATIONPROC)SDL_GL_GetProcAddress("glGetAttribLocation");
-    glGetProgramInfoLog        = (PFNGLGETPROGRAMINFOLOGPROC)SDL_GL_GetProcAddress("glGetProgramInfoLog");
-    glGetProgramiv             = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
-    glGetShaderInfoLog         = (PFNGLGETSHADERINFOLOGPROC)SDL_GL_GetProcAddress("glGetShaderInfoLog");
-    glGetShaderiv              = (PFNGLGETSHADERIVPROC)SDL_GL_GetProcAddress("glGetShaderiv");
-    glGetUniformLocation       = (PFNGLGETUNIFORMLOCATIONPROC)SDL_GL_GetProcAddress("glGetUniformLocation");
-    glLinkProgram              = (PFNGLLINKPROGRAMPROC)SDL_GL_GetProcAddress("glLinkProgram");
-    glShaderSource             = (PFNGLSHADERSOURCEPROC)SDL_GL_GetProcAddress("glShaderSource");
-    glUniform1f                = (PFNGLUNIFORM1FPROC)SDL_GL_GetProcAddress("glUniform1f");
-    glUniform2f                = (PFNGLUNIFORM2FPROC)SDL_GL_GetProcAddress("glUniform2f");
-    glUniform3f                = (PFNGLUNIFORM3FPROC)SDL_GL_GetProcAddress("glUniform3f");
-    glUniformMatrix4fv         = (PFNGLUNIFORMMATRIX4FVPROC)SDL_GL_GetProcAddress("glUniformMatrix4fv");
-    glUseProgram               = (PFNGLUSEPROGRAMPROC)SDL_GL_GetProcAddress("glUseProgram");
-    glVertexAttribPointer      = (PFNGLVERTEXATTRIBPOINTERPROC)SDL_GL_GetProcAddress("glVertexAttribPointer");
-}
-#if defined(__GNUC__) && !defined(__clang__) // GCC only
-#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)
-#pragma GCC diagnostic pop
-#endif
-#endif // GCC only
-
-#endif
+#ifdef GL_ES
+
+#include "glsys.h"
+
+void
+glsysInit(void)
+{
+}
+
+void
+glsysEnableStateCache(bool isEnabled)
+{
+    (void)isEnabled;
+}
+
+void
+glsysGetStateCacheStats(GlsysStateCacheStats *pStats)
+{
+    pStats->issuedCalls = 0;
+    pStats->skippedCalls = 0;
+}
+
+void
+glsysResetStateCacheStats(void)
+{
+}
+
+void
+glsysEnableCallStats(bool isEnabled)
+{
+    (void)isEnabled;
+}
+
+void
+glsysGetCallStats(GlsysCallStats *pStats)
+{
+    pStats->drawCalls = 0;
+    pStats->uploadedBytes = 0;
+}
+
+void
+glsysResetCallStats(void)
+{
+}
+
+#else
+
+#include <stdint.h>
+#include "SDL_video.h"
+#include "glsys.h"
+
+GlsysDrawArraysProc               glsysDrawArrays;
+GlsysDrawElementsProc             glsysDrawElements;
+PFNGLATTACHSHADERPROC             glAttachShader;
+PFNGLBEGINQUERYPROC               glBeginQuery;
+PFNGLBINDATTRIBLOCATIONPROC       glBindAttribLocation;
+PFNGLBINDBUFFERPROC               glBindBuffer;
+PFNGLBINDBUFFERRANGEPROC          glBindBufferRange;
+PFNGLBINDFRAMEBUFFERPROC          glBindFramebuffer;
+PFNGLBINDRENDERBUFFERPROC         glBindRenderbuffer;
+PFNGLBINDVERTEXARRAYPROC          glBindVertexArray;
+PFNGLBUFFERDATAPROC               glBufferData;
+PFNGLBUFFERSTORAGEPROC            glBufferStorage;
+PFNGLBUFFERSUBDATAPROC            glBufferSubData;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC   glCheckFramebufferStatus;
+PFNGLCLIENTWAITSYNCPROC           glClientWaitSync;
+PFNGLCOMPILESHADERPROC            glCompileShader;
+PFNGLCREATEPROGRAMPROC            glCreateProgram;
+PFNGLCREATESHADERPROC             glCreateShader;
+PFNGLDELETEBUFFERSPROC            glDeleteBuffers;
+PFNGLDELETEFRAMEBUFFERSPROC       glDeleteFramebuffers;
+PFNGLDELETEPROGRAMPROC            glDeleteProgram;
+PFNGLDELETEQUERIESPROC            glDeleteQueries;
+PFNGLDELETERENDERBUFFERSPROC      glDeleteRenderbuffers;
+PFNGLDELETESHADERPROC             glDeleteShader;
+PFNGLDELETESYNCPROC               glDeleteSync;
+PFNGLDELETEVERTEXARRAYSPROC       glDeleteVertexArrays;
+PFNGLDETACHSHADERPROC             glDetachShader;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
+PFNGLENABLEVERTEXATTRIBARRAYPROC  glEnableVertexAttribArray;
+PFNGLENDQUERYPROC                 glEndQuery;
+PFNGLFENCESYNCPROC                glFenceSync;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC  glFramebufferRenderbuffer;
+PFNGLGENBUFFERSPROC               glGenBuffers;
+PFNGLGENFRAMEBUFFERSPROC          glGenFramebuffers;
+PFNGLGENQUERIESPROC               glGenQueries;
+PFNGLGENRENDERBUFFERSPROC         glGenRenderbuffers;
+PFNGLGENVERTEXARRAYSPROC          glGenVertexArrays;
+PFNGLGETACTIVEATTRIBPROC          glGetActiveAttrib;
+PFNGLGETATTRIBLOCATIONPROC        glGetAttribLocation;
+PFNGLGETINTEGER64VPROC            glGetInteger64v;
+PFNGLGETPROGRAMBINARYPROC         glGetProgramBinary;
+PFNGLGETPROGRAMINFOLOGPROC        glGetProgramInfoLog;
+PFNGLGETPROGRAMIVPROC             glGetProgramiv;
+PFNGLGETQUERYOBJECTIVPROC         glGetQueryObjectiv;
+PFNGLGETQUERYOBJECTUI64VPROC      glGetQueryObjectui64v;
+PFNGLGETSHADERINFOLOGPROC         glGetShaderInfoLog;
+PFNGLGETSHADERIVPROC              glGetShaderiv;
+PFNGLGETSHADERSOURCEPROC          glGetShaderSource;
+PFNGLGETUNIFORMBLOCKINDEXPROC     glGetUniformBlockIndex;
+PFNGLGETUNIFORMLOCATIONPROC       glGetUniformLocation;
+PFNGLLINKPROGRAMPROC              glLinkProgram;
+PFNGLMAPBUFFERRANGEPROC           glMapBufferRange;
+PFNGLPROGRAMBINARYPROC            glProgramBinary;
+PFNGLPROGRAMPARAMETERIPROC        glProgramParameteri;
+PFNGLQUERYCOUNTERPROC             glQueryCounter;
+PFNGLRENDERBUFFERSTORAGEPROC      glRenderbufferStorage;
+PFNGLSHADERSOURCEPROC             glShaderSource;
+PFNGLUNIFORM1FPROC                glUniform1f;
+PFNGLUNIFORM2FPROC                glUniform2f;
+PFNGLUNIFORM3FPROC                glUniform3f;
+PFNGLUNIFORMBLOCKBINDINGPROC      glUniformBlockBinding;
+PFNGLUNIFORMMATRIX4FVPROC         glUniformMatrix4fv;
+PFNGLUSEPROGRAMPROC               glUseProgram;
+PFNGLVERTEXATTRIBPOINTERPROC      glVertexAttribPointer;
+
+// Attributes past this one are passed through.
+#define STATE_CACHE_ATTRIBS 16
+
+typedef struct VertexAttribState {
+    bool            isKnown;
+    GLint           size;
+    GLenum          type;
+    GLboolean       normalized;
+    GLsizei         stride;
+    const void     *pointer;
+    GLuint          buffer;
+} VertexAttribState;
+
+// The last state set through the cached entry points, where known.
+typedef struct StateCache {
+    bool                    isEnabled;
+    bool                    isProgramKnown;
+    bool                    isArrayBufferKnown;
+    bool                    isVertexArrayKnown;
+    GLuint                  program;
+    GLuint                  arrayBuffer;
+    GLuint                  vertexArray;
+    // Vertex array object state, forgotten when its binding changes.
+    bool                    isElementArrayBufferKnown;
+    GLuint                  elementArrayBuffer;
+    uint32_t                knownAttribArrays;
+    uint32_t                enabledAttribArrays;
+    VertexAttribState       attribs[STATE_CACHE_ATTRIBS];
+    GlsysStateCacheStats    stats;
+} StateCache;
+
+static StateCache                         s_cache;
+static bool                               s_isLoaded;
+static PFNGLBINDBUFFERPROC                s_bindBuffer;
+static PFNGLBINDVERTEXARRAYPROC           s_bindVertexArray;
+static PFNGLDELETEBUFFERSPROC             s_deleteBuffers;
+static PFNGLDELETEPROGRAMPROC             s_deleteProgram;
+static PFNGLDELETEVERTEXARRAYSPROC        s_deleteVertexArrays;
+static PFNGLDISABLEVERTEXATTRIBARRAYPROC  s_disableVertexAttribArray;
+static PFNGLENABLEVERTEXATTRIBARRAYPROC   s_enableVertexAttribArray;
+static PFNGLUSEPROGRAMPROC                s_useProgram;
+static PFNGLVERTEXATTRIBPOINTERPROC       s_vertexAttribPointer;
+
+static bool                               s_areCallStatsEnabled;
+static GlsysCallStats                     s_callStats;
+static PFNGLBUFFERDATAPROC                s_bufferData;
+static PFNGLBUFFERSUBDATAPROC             s_bufferSubData;
+static GlsysDrawArraysProc                s_drawArrays;
+static GlsysDrawElementsProc              s_drawElements;
+
+static void
+forgetVertexArrayState(void)
+{
+    s_cache.isElementArrayBufferKnown = false;
+    s_cache.knownAttribArrays = 0;
+    for (int i = 0; i < STATE_CACHE_ATTRIBS; ++i) {
+        s_cache.attribs[i].isKnown = false;
+    }
+}
+
+static void
+forgetState(void)
+{
+    s_cache.isProgramKnown = false;
+    s_cache.isArrayBufferKnown = false;
+    s_cache.isVertexArrayKnown = false;
+    forgetVertexArrayState();
+}
+
+// Counts a call, and returns whether it is to be skipped.
+static bool
+skipCall(bool isRedundant)
+{
+    if (isRedundant) {
+        ++s_cache.stats.skippedCalls;
+    } else {
+        ++s_cache.stats.issuedCalls;
+    }
+
+    return isRedundant;
+}
+
+static void APIENTRY
+cachedBindBuffer(GLenum target, GLuint buffer)
+{
+    if (target == GL_ARRAY_BUFFER) {
+        if (skipCall(s_cache.isArrayBufferKnown && s_cache.arrayBuffer == buffer)) {
+            return;
+        }
+        s_cache.isArrayBufferKnown = true;
+        s_cache.arrayBuffer = buffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        if (skipCall(s_cache.isElementArrayBufferKnown && s_cache.elementArrayBuffer == buffer)) {
+            return;
+        }
+        s_cache.isElementArrayBufferKnown = true;
+        s_cache.elementArrayBuffer = buffer;
+    } else {
+        skipCall(false);
+    }
+    s_bindBuffer(target, buffer);
+}
+
+static void APIENTRY
+cachedBindVertexArray(GLuint array)
+{
+    if (skipCall(s_cache.isVertexArrayKnown && s_cache.vertexArray == array)) {
+        return;
+    }
+    s_cache.isVertexArrayKnown = true;
+    s_cache.vertexArray = array;
+    forgetVertexArrayState();
+    s_bindVertexArray(array);
+}
+
+// Deleting a bound buffer unbinds it, from the vertex array object's
+// attributes too, so a new buffer given its name must still be bound.
+static void APIENTRY
+cachedDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    for (GLsizei i = 0; i < n; ++i) {
+        if (buffers[i] == 0) {
+            continue;
+        }
+        if (s_cache.isArrayBufferKnown && s_cache.arrayBuffer == buffers[i]) {
+            s_cache.isArrayBufferKnown = false;
+        }
+        if (s_cache.isElementArrayBufferKnown && s_cache.elementArrayBuffer == buffers[i]) {
+            s_cache.isElementArrayBufferKnown = false;
+        }
+        for (int j = 0; j < STATE_CACHE_ATTRIBS; ++j) {
+            if (s_cache.attribs[j].buffer == buffers[i]) {
+                s_cache.attribs[j].isKnown = false;
+            }
+        }
+    }
+    s_deleteBuffers(n, buffers);
+}
+
+static void APIENTRY
+cachedDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    for (GLsizei i = 0; i < n; ++i) {
+        if (arrays[i] != 0 && s_cache.isVertexArrayKnown && s_cache.vertexArray == arrays[i]) {
+            s_cache.isVertexArrayKnown = false;
+            forgetVertexArrayState();
+        }
+    }
+    s_deleteVertexArrays(n, arrays);
+}
+
+static void
+setAttribArray(GLuint index, bool isEnabled)
+{
+    uint32_t const bit = (index < STATE_CACHE_ATTRIBS) ? UINT32_C(1) << index : 0;
+    uint32_t const state = isEnabled ? bit : 0;
+
+    if (skipCall(bit != 0 && (s_cache.knownAttribArrays & bit) != 0 &&
+                 (s_cache.enabledAttribArrays & bit) == state)) {
+        return;
+    }
+    s_cache.knownAttribArrays |= bit;
+    s_cache.enabledAttribArrays = (s_cache.enabledAttribArrays & ~bit) | state;
+    if (isEnabled) {
+        s_enableVertexAttribArray(index);
+    } else {
+        s_disableVertexAttribArray(index);
+    }
+}
+
+static void APIENTRY
+cachedDisableVertexAttribArray(GLuint index)
+{
+    setAttribArray(index, false);
+}
+
+static void APIENTRY
+cachedEnableVertexAttribArray(GLuint index)
+{
+    setAttribArray(index, true);
+}
+
+static void APIENTRY
+cachedUseProgram(GLuint program)
+{
+    if (skipCall(s_cache.isProgramKnown && s_cache.program == program)) {
+        return;
+    }
+    s_cache.isProgramKnown = true;
+    s_cache.program = program;
+    s_useProgram(program);
+}
+
+static void APIENTRY
+cachedDeleteProgram(GLuint program)
+{
+    if (program != 0 && s_cache.isProgramKnown && s_cache.program == program) {
+        s_cache.isProgramKnown = false;
+    }
+    s_deleteProgram(program);
+}
+
+// The pointer is only known along with the array buffer it refers to.
+static void APIENTRY
+cachedVertexAttribPointer(GLuint index,
+                          GLint size,
+                          GLenum type,
+                          GLboolean normalized,
+                          GLsizei stride,
+                          const void *pointer)
+{
+    if (index < STATE_CACHE_ATTRIBS) {
+        VertexAttribState *attrib = &s_cache.attribs[index];
+
+        if (skipCall(attrib->isKnown && s_cache.isArrayBufferKnown &&
+                     attrib->buffer == s_cache.arrayBuffer &&
+                     attrib->size == size && attrib->type == type &&
+                     attrib->normalized == normalized &&
+                     attrib->stride == stride && attrib->pointer == pointer)) {
+            return;
+        }
+        attrib->isKnown = s_cache.isArrayBufferKnown;
+        attrib->size = size;
+        attrib->type = type;
+        attrib->normalized = normalized;
+        attrib->stride = stride;
+        attrib->pointer = pointer;
+        attrib->buffer = s_cache.arrayBuffer;
+    } else {
+        skipCall(false);
+    }
+    s_vertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+static void
+installStateCache(void)
+{
+    bool const isEnabled = s_cache.isEnabled;
+
+    if (!s_isLoaded) {
+        return;
+    }
+    glBindBuffer               = isEnabled ? cachedBindBuffer : s_bindBuffer;
+    glBindVertexArray          = isEnabled ? cachedBindVertexArray : s_bindVertexArray;
+    glDeleteBuffers            = isEnabled ? cachedDeleteBuffers : s_deleteBuffers;
+    glDeleteProgram            = isEnabled ? cachedDeleteProgram : s_deleteProgram;
+    glDeleteVertexArrays       = isEnabled ? cachedDeleteVertexArrays : s_deleteVertexArrays;
+    glDisableVertexAttribArray = isEnabled ? cachedDisableVertexAttribArray : s_disableVertexAttribArray;
+    glEnableVertexAttribArray  = isEnabled ? cachedEnableVertexAttribArray : s_enableVertexAttribArray;
+    glUseProgram               = isEnabled ? cachedUseProgram : s_useProgram;
+    glVertexAttribPointer      = isEnabled ? cachedVertexAttribPointer : s_vertexAttribPointer;
+}
+
+static void APIENTRY
+countedBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    if (data != NULL) {
+        s_callStats.uploadedBytes += (size_t)size;
+    }
+    s_bufferData(target, size, data, usage);
+}
+
+static void APIENTRY
+countedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    s_callStats.uploadedBytes += (size_t)size;
+    s_bufferSubData(target, offset, size, data);
+}
+
+static void APIENTRY
+countedDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    ++s_callStats.drawCalls;
+    s_drawArrays(mode, first, count);
+}
+
+static void APIENTRY
+countedDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    ++s_callStats.drawCalls;
+    s_drawElements(mode, count, type, indices);
+}
+
+static void
+installCallStats(void)
+{
+    bool const isEnabled = s_areCallStatsEnabled;
+
+    if (!s_isLoaded) {
+        return;
+    }
+    glBufferData               = isEnabled ? countedBufferData : s_bufferData;
+    glBufferSubData            = isEnabled ? countedBufferSubData : s_bufferSubData;
+    glsysDrawArrays            = isEnabled ? countedDrawArrays : s_drawArrays;
+    glsysDrawElements          = isEnabled ? countedDrawElements : s_drawElements;
+}
+
+void
+glsysEnableStateCache(bool isEnabled)
+{
+    s_cache.isEnabled = isEnabled;
+    forgetState();
+    installStateCache();
+}
+
+void
+glsysGetStateCacheStats(GlsysStateCacheStats *pStats)
+{
+    *pStats = s_cache.stats;
+}
+
+void
+glsysResetStateCacheStats(void)
+{
+    s_cache.stats.issuedCalls = 0;
+    s_cache.stats.skippedCalls = 0;
+}
+
+void
+glsysEnableCallStats(bool isEnabled)
+{
+    s_areCallStatsEnabled = isEnabled;
+    installCallStats();
+}
+
+void
+glsysGetCallStats(GlsysCallStats *pStats)
+{
+    *pStats = s_callStats;
+}
+
+void
+glsysResetCallStats(void)
+{
+    s_callStats.drawCalls = 0;
+    s_callStats.uploadedBytes = 0;
+}
+
+#if defined(__GNUC__) && !defined(__clang__) // GCC only
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#else
+#pragma GCC diagnostic ignored "-pedantic"
+#endif
+#endif // GCC only
+void
+glsysInit(void)
+{
+    glsysDrawArrays            = (GlsysDrawArraysProc)SDL_GL_GetProcAddress("glDrawArrays");
+    glsysDrawElements          = (GlsysDrawElementsProc)SDL_GL_GetProcAddress("glDrawElements");
+    glAttachShader             = (PFNGLATTACHSHADERPROC)SDL_GL_GetProcAddress("glAttachShader");
+    glBeginQuery               = (PFNGLBEGINQUERYPROC)SDL_GL_GetProcAddress("glBeginQuery");
+    glBindAttribLocation       = (PFNGLBINDATTRIBLOCATIONPROC)SDL_GL_GetProcAddress("glBindAttribLocation");
+    glBindBuffer               = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
+    glBindBufferRange          = (PFNGLBINDBUFFERRANGEPROC)SDL_GL_GetProcAddress("glBindBufferRange");
+    glBindFramebuffer          = (PFNGLBINDFRAMEBUFFERPROC)SDL_GL_GetProcAddress("glBindFramebuffer");
+    glBindRenderbuffer         = (PFNGLBINDRENDERBUFFERPROC)SDL_GL_GetProcAddress("glBindRenderbuffer");
+    glBindVertexArray          = (PFNGLBINDVERTEXARRAYPROC)SDL_GL_GetProcAddress("glBindVertexArray");
+    glBufferData               = (PFNGLBUFFERDATAPROC)SDL_GL_GetProcAddress("glBufferData");
+    glBufferStorage            = (PFNGLBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glBufferStorage");
+    glBufferSubData            = (PFNGLBUFFERSUBDATAPROC)SDL_GL_GetProcAddress("glBufferSubData");
+    glCheckFramebufferStatus   = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)SDL_GL_GetProcAddress("glCheckFramebufferStatus");
+    glClientWaitSync           = (PFNGLCLIENTWAITSYNCPROC)SDL_GL_GetProcAddress("glClientWaitSync");
+    glCompileShader            = (PFNGLCOMPILESHADERPROC)SDL_GL_GetProcAddress("glCompileShader");
+    glCreateProgram            = (PFNGLCREATEPROGRAMPROC)SDL_GL_GetProcAddress("glCreateProgram");
+    glCreateShader             = (PFNGLCREATESHADERPROC)SDL_GL_GetProcAddress("glCreateShader");
+    glDeleteBuffers            = (PFNGLDELETEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteBuffers");
+    glDeleteFramebuffers       = (PFNGLDELETEFRAMEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteFramebuffers");
+    glDeleteProgram            = (PFNGLDELETEPROGRAMPROC)SDL_GL_GetProcAddress("glDeleteProgram");
+    glDeleteQueries            = (PFNGLDELETEQUERIESPROC)SDL_GL_GetProcAddress("glDeleteQueries");
+    glDeleteRenderbuffers      = (PFNGLDELETERENDERBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteRenderbuffers");
+    glDeleteShader             = (PFNGLDELETESHADERPROC)SDL_GL_GetProcAddress("glDeleteShader");
+    glDeleteSync               = (PFNGLDELETESYNCPROC)SDL_GL_GetProcAddress("glDeleteSync");
+    glDeleteVertexArrays       = (PFNGLDELETEVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glDeleteVertexArrays");
+    glDetachShader             = (PFNGLDETACHSHADERPROC)SDL_GL_GetProcAddress("glDetachShader");
+    glDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)SDL_GL_GetProcAddress("glDisableVertexAttribArray");
+    glEnableVertexAttribArray  = (PFNGLENABLEVERTEXATTRIBARRAYPROC)SDL_GL_GetProcAddress("glEnableVertexAttribArray");
+    glEndQuery                 = (PFNGLENDQUERYPROC)SDL_GL_GetProcAddress("glEndQuery");
+    glFenceSync                = (PFNGLFENCESYNCPROC)SDL_GL_GetProcAddress("glFenceSync");
+    glFramebufferRenderbuffer  = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)SDL_GL_GetProcAddress("glFramebufferRenderbuffer");
+    glGenBuffers               = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
+    glGenFramebuffers          = (PFNGLGENFRAMEBUFFERSPROC)SDL_GL_GetProcAddress("glGenFramebuffers");
+    glGenQueries               = (PFNGLGENQUERIESPROC)SDL_GL_GetProcAddress("glGenQueries");
+    glGenRenderbuffers         = (PFNGLGENRENDERBUFFERSPROC)SDL_GL_GetProcAddress("glGenRenderbuffers");
+    glGenVertexArrays          = (PFNGLGENVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glGenVertexArrays");
+    glGetActiveAttrib          = (PFNGLGETACTIVEATTRIBPROC)SDL_GL_GetProcAddress("glGetActiveAttrib");
+    glGetAttribLocation        = (PFNGLGETATTRIBLOCATIONPROC)SDL_GL_GetProcAddress("glGetAttribLocation");
+    glGetInteger64v            = (PFNGLGETINTEGER64VPROC)SDL_GL_GetProcAddress("glGetInteger64v");
+    glGetProgramBinary         = (PFNGLGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinary");
+    glGetProgramInfoLog        = (PFNGLGETPROGRAMINFOLOGPROC)SDL_GL_GetProcAddress("glGetProgramInfoLog");
+    glGetProgramiv             = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
+    glGetQueryObjectiv         = (PFNGLGETQUERYOBJECTIVPROC)SDL_GL_GetProcAddress("glGetQueryObjectiv");
+    glGetQueryObjectui64v      = (PFNGLGETQUERYOBJECTUI64VPROC)SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+    glGetShaderInfoLog         = (PFNGLGETSHADERINFOLOGPROC)SDL_GL_GetProcAddress("glGetShaderInfoLog");
+    glGetShaderiv              = (PFNGLGETSHADERIVPROC)SDL_GL_GetProcAddress("glGetShaderiv");
+    glGetShaderSource          = (PFNGLGETSHADERSOURCEPROC)SDL_GL_GetProcAddress("glGetShaderSource");
+    glGetUniformBlockIndex     = (PFNGLGETUNIFORMBLOCKINDEXPROC)SDL_GL_GetProcAddress("glGetUniformBlockIndex");
+    glGetUniformLocation       = (PFNGLGETUNIFORMLOCATIONPROC)SDL_GL_GetProcAddress("glGetUniformLocation");
+    glLinkProgram              = (PFNGLLINKPROGRAMPROC)SDL_GL_GetProcAddress("glLinkProgram");
+    glMapBufferRange           = (PFNGLMAPBUFFERRANGEPROC)SDL_GL_GetProcAddress("glMapBufferRange");
+    glProgramBinary            = (PFNGLPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinary");
+    glProgramParameteri        = (PFNGLPROGRAMPARAMETERIPROC)SDL_GL_GetProcAddress("glProgramParameteri");
+    glQueryCounter             = (PFNGLQUERYCOUNTERPROC)SDL_GL_GetProcAddress("glQueryCounter");
+    glRenderbufferStorage      = (PFNGLRENDERBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glRenderbufferStorage");
+    glShaderSource             = (PFNGLSHADERSOURCEPROC)SDL_GL_GetProcAddress("glShaderSource");
+    glUniform1f                = (PFNGLUNIFORM1FPROC)SDL_GL_GetProcAddress("glUniform1f");
+    glUniform2f                = (PFNGLUNIFORM2FPROC)SDL_GL_GetProcAddress("glUniform2f");
+    glUniform3f                = (PFNGLUNIFORM3FPROC)SDL_GL_GetProcAddress("glUniform3f");
+    glUniformBlockBinding      = (PFNGLUNIFORMBLOCKBINDINGPROC)SDL_GL_GetProcAddress("glUniformBlockBinding");
+    glUniformMatrix4fv         = (PFNGLUNIFORMMATRIX4FVPROC)SDL_GL_GetProcAddress("glUniformMatrix4fv");
+    glUseProgram               = (PFNGLUSEPROGRAMPROC)SDL_GL_GetProcAddress("glUseProgram");
+    glVertexAttribPointer      = (PFNGLVERTEXATTRIBPOINTERPROC)SDL_GL_GetProcAddress("glVertexAttribPointer");
+
+    s_bindBuffer               = glBindBuffer;
+    s_bindVertexArray          = glBindVertexArray;
+    s_deleteBuffers            = glDeleteBuffers;
+    s_deleteProgram            = glDeleteProgram;
+    s_deleteVertexArrays       = glDeleteVertexArrays;
+    s_disableVertexAttribArray = glDisableVertexAttribArray;
+    s_enableVertexAttribArray  = glEnableVertexAttribArray;
+    s_useProgram               = glUseProgram;
+    s_vertexAttribPointer      = glVertexAttribPointer;
+    s_bufferData               = glBufferData;
+    s_bufferSubData            = glBufferSubData;
+    s_drawArrays               = glsysDrawArrays;
+    s_drawElements             = glsysDrawElements;
+    s_isLoaded = true;
+    forgetState();
+    installStateCache();
+    installCallStats();
+}
+#if defined(__GNUC__) && !defined(__clang__) // GCC only
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)
+#pragma GCC diagnostic pop
+#endif
+#endif // GCC only
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "glsys_file.h"
+
+#define FILE_READ_CHUNK_SIZE 65536
+
+// Maps regular, non-empty files; false leaves the rest to readFile.
+static bool
+mapFile(const char *path, GlsysFile *pFile)
+{
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+    LARGE_INTEGER size;
+    void *data = NULL;
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= SIZE_MAX) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            // The view keeps the file open.
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    struct stat status;
+    void *data = NULL;
+    int const file = open(path, O_RDONLY);
+
+    if (file < 0) {
+        return false;
+    }
+    if (fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0 &&
+        (uintmax_t)status.st_size <= SIZE_MAX) {
+        data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        data = (data != MAP_FAILED) ? data : NULL;
+    }
+    // The mapping keeps the file open.
+    close(file);
+#endif
+    if (data == NULL) {
+        return false;
+    }
+    pFile->data = data;
+#ifdef _WIN32
+    pFile->size = (size_t)size.QuadPart;
+#else
+    pFile->size = (size_t)status.st_size;
+#endif
+    pFile->isMapped = true;
+
+    return true;
+}
+
+// Reads in chunks, so that files whose size is not known up front, such
+// as pipes, work too.
+static bool
+readFile(const char *path, GlsysFile *pFile)
+{
+    FILE *file = fopen(path, "rb");
+    char *data = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+    bool isRead;
+
+    if (file == NULL) {
+        return false;
+    }
+    for (;;) {
+        size_t bytesRead;
+
+        if (capacity - size < FILE_READ_CHUNK_SIZE) {
+            char *grown = realloc(data, capacity + FILE_READ_CHUNK_SIZE);
+
+            if (grown == NULL) {
+                break;
+            }
+            data = grown;
+            capacity += FILE_READ_CHUNK_SIZE;
+        }
+        bytesRead = fread(data + size, 1, capacity - size, file);
+        size += bytesRead;
+        if (bytesRead == 0) {
+            break;
+        }
+    }
+    isRead = feof(file) && !ferror(file);
+    fclose(file);
+    if (!isRead) {
+        free(data);
+        errno = (errno != 0) ? errno : EIO;
+        return false;
+    }
+
+    pFile->data = data;
+    pFile->size = size;
+    pFile->isMapped = false;
+
+    return true;
+}
+
+bool
+glsysFileOpen(const char *path, GlsysFile *pFile)
+{
+    return mapFile(path, pFile) || readFile(path, pFile);
+}
+
+void
+glsysFileClose(GlsysFile *pFile)
+{
+    if (pFile->isMapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(pFile->data);
+#else
+        munmap((void *)(uintptr_t)pFile->data, pFile->size);
+#endif
+    } else {
+        free((void *)(uintptr_t)pFile->data);
+    }
+    pFile->data = NULL;
+    pFile->size = 0;
+    pFile->isMapped = false;
+}
@@ -0,0 +1,135 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glsys_program_cache.h"
+
+#define CACHE_MAGIC 0x42504c47u // "GLPB"
+#define CACHE_VERSION 1u
+#define CACHE_PATH_SIZE 4096
+
+// Stored in native byte order: entries are only valid for the machine's
+// own driver anyway.
+typedef struct CacheHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    key;
+    uint32_t    format;
+    uint32_t    reserved;
+    uint64_t    size;
+    uint64_t    checksum;
+} CacheHeader;
+
+uint64_t
+glsysHash(uint64_t hash, const void *data, size_t size)
+{
+    unsigned char const *bytes = data;
+
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+uint64_t
+glsysHashString(uint64_t hash, const char *string)
+{
+    string = (string != NULL) ? string : "";
+
+    return glsysHash(hash, string, strlen(string) + 1);
+}
+
+static bool
+entryPath(char *path, const char *directory, uint64_t key, const char *suffix)
+{
+    int const length = snprintf(path, CACHE_PATH_SIZE, "%s/%016" PRIx64 ".glpb%s", directory, key, suffix);
+
+    return length > 0 && length < CACHE_PATH_SIZE;
+}
+
+bool
+glsysProgramCacheLoad(const char *directory, uint64_t key, GlsysProgramBinary *pBinary)
+{
+    char path[CACHE_PATH_SIZE];
+    CacheHeader header;
+    unsigned char const *data;
+
+    if (!entryPath(path, directory, key, "") || !glsysFileOpen(path, &pBinary->file)) {
+        return false;
+    }
+    if (pBinary->file.size < sizeof(header)) {
+        glsysFileClose(&pBinary->file);
+        return false;
+    }
+    memcpy(&header, pBinary->file.data, sizeof(header));
+    data = (unsigned char const *)pBinary->file.data + sizeof(header);
+    if (header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION ||
+        header.key != key ||
+        header.size != pBinary->file.size - sizeof(header) ||
+        header.checksum != glsysHash(GLSYS_HASH_SEED, data, (size_t)header.size)) {
+        glsysFileClose(&pBinary->file);
+        return false;
+    }
+
+    pBinary->format = header.format;
+    pBinary->data = data;
+    pBinary->size = (size_t)header.size;
+
+    return true;
+}
+
+void
+glsysProgramCacheRelease(GlsysProgramBinary *pBinary)
+{
+    glsysFileClose(&pBinary->file);
+    pBinary->data = NULL;
+    pBinary->size = 0;
+}
+
+bool
+glsysProgramCacheStore(const char *directory,
+                       uint64_t key,
+                       uint32_t format,
+                       const void *data,
+                       size_t size)
+{
+    char path[CACHE_PATH_SIZE];
+    char temporaryPath[CACHE_PATH_SIZE];
+    CacheHeader header;
+    FILE *file;
+    bool isWritten;
+
+    if (!entryPath(path, directory, key, "") || !entryPath(temporaryPath, directory, key, ".tmp")) {
+        return false;
+    }
+    memset(&header, 0, sizeof(header));
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.format = format;
+    header.size = size;
+    header.checksum = glsysHash(GLSYS_HASH_SEED, data, size);
+
+    file = fopen(temporaryPath, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    isWritten = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(data, 1, size, file) == size;
+    isWritten = (fclose(file) == 0) && isWritten;
+    if (isWritten) {
+#ifdef _WIN32
+        // rename does not replace files here.
+        remove(path);
+#endif
+        isWritten = rename(temporaryPath, path) == 0;
+    }
+    if (!isWritten) {
+        remove(temporaryPath);
+    }
+
+    return isWritten;
+}
@@ -1,67 +1,39 @@
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "SDL.h"
 #include "SDL_keycode.h"
 #include "framework.h"
+#include "framework_private.h"
 #include "glsys.h"
+#include "glsys_file.h"
+#include "glsys_program_cache.h"
 
-static void      simulationLoop(SDL_Window *window);
+static void      simulationLoop(SDL_Window *window, unsigned frameCount);
 static bool      handleEvent(SDL_Event *event);
-static GLchar   *loadTextFileIntoString(const char *filename);
 
-static GLchar *
-loadTextFileIntoString(const char *filename)
-{
-    int ret;
-
-    FILE * const inputObj = fopen(filename, "rb");
-    assert(inputObj != NULL);
-    ret = fseek(inputObj, 0, SEEK_END);
-    assert(ret == 0);
-    long const fileLength = ftell(inputObj);
-    assert(fileLength > 0);
-    ret = fseek(inputObj, 0, SEEK_SET);
-    assert(ret == 0);
-    char * const buffer = (GLchar *)malloc((unsigned long)fileLength + 1 /*NUL*/);
-    
-    size_t totalBytesRead = 0;
-    do {
-        size_t const currentBytesRead = fread(buffer, 1, (unsigned long)fileLength, inputObj);
-        if (currentBytesRead == 0 && ferror(inputObj) != 0) {
-            printf("Error reading from %s. errno is %d\n", filename, errno);
-            assert(0);
-        }
-        totalBytesRead += currentBytesRead;
-    } while (totalBytesRead < (size_t)fileLength);
-
-    fclose(inputObj);
-    buffer[fileLength] = '\0';
+static GltutDefaultSettings const  *s_pSettings;
 
-    return buffer;
-}
-
-GLuint
-frameworkLoadShader(GLenum shaderType, const char *filename)
+static void
+compileShader(GLuint shader)
 {
-    GLuint shader;
     GLint status;
-    const GLchar *shaderSource;
-
-    shader = glCreateShader(shaderType);
-    shaderSource = loadTextFileIntoString(filename);
-    glShaderSource(shader, 1, &shaderSource, NULL);
 
     glCompileShader(shader);
     glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
     if (status == GL_FALSE) {
         GLint infoLogLength;
+        GLint shaderType;
         GLchar *strInfoLog;
         const char *strShaderType;
 
         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+        glGetShaderiv(shader, GL_SHADER_TYPE, &shaderType);
         strInfoLog = (GLchar *)malloc(infoLogLength + 1);
         glGetShaderInfoLog(shader, infoLogLength, NULL, strInfoLog);
         switch (shaderType) {
@@ -78,7 +50,177 @@ frameworkLoadShader(GLenum shaderType, const char *filename)
         fprintf(stderr, "Compile failure in %s shader:\n%s\n", strShaderType, strInfoLog);
         free(strInfoLog);
     }
-    free((void *)shaderSource);
+}
+
+static void
+printLinkLog(GLuint program)
+{
+    GLint infoLogLength;
+    GLchar *strInfoLog;
+
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
+    strInfoLog = (char *)malloc(infoLogLength + 1);
+    glGetProgramInfoLog(program, infoLogLength, NULL, strInfoLog);
+    fprintf(stderr, "Linker failure: %s\n", strInfoLog);
+    free(strInfoLog);
+}
+
+#ifndef GL_ES
+
+// With a program cache, frameworkLoadShader only sets the source and
+// frameworkCreateProgram compiles it when the cache misses. Linked
+// binaries are keyed by the driver strings, the shaders' types and
+// sources, and the attribute locations.
+static bool         s_isProgramCacheEnabled;
+static uint64_t     s_driverHash;
+
+static void
+programCacheInit(const char *directory)
+{
+    GLint formatCount = 0;
+
+    if (directory == NULL) {
+        return;
+    }
+    if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    }
+    if (formatCount <= 0) {
+        fprintf(stderr, "The driver cannot return program binaries, not caching them\n");
+        return;
+    }
+    s_driverHash = GLSYS_HASH_SEED;
+    s_driverHash = glsysHashString(s_driverHash, (const char *)glGetString(GL_VENDOR));
+    s_driverHash = glsysHashString(s_driverHash, (const char *)glGetString(GL_RENDERER));
+    s_driverHash = glsysHashString(s_driverHash, (const char *)glGetString(GL_VERSION));
+    s_isProgramCacheEnabled = true;
+}
+
+// Hashes the source back from GL, so that shaders the tutorial
+// compiled itself are keyed the same way.
+static uint64_t
+hashShader(uint64_t hash, GLuint shader)
+{
+    GLint shaderType;
+    GLint sourceLength;
+    GLchar *source;
+
+    glGetShaderiv(shader, GL_SHADER_TYPE, &shaderType);
+    glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &sourceLength);
+    hash = glsysHash(hash, &shaderType, sizeof(shaderType));
+    source = (GLchar *)malloc((size_t)sourceLength + 1);
+    assert(source != NULL);
+    glGetShaderSource(shader, sourceLength + 1, NULL, source);
+    source[sourceLength] = '\0';
+    hash = glsysHashString(hash, source);
+    free(source);
+
+    return hash;
+}
+
+static uint64_t
+programKey(GLuint vertexShader,
+           GLuint fragmentShader,
+           const FrameworkShaderAttribLocation *pAttribLocations,
+           size_t attribLocationCount)
+{
+    uint64_t key = s_driverHash;
+
+    key = hashShader(key, vertexShader);
+    key = hashShader(key, fragmentShader);
+    for (size_t i = 0; i < attribLocationCount; ++i) {
+        key = glsysHashString(key, pAttribLocations[i].name);
+        key = glsysHash(key, &pAttribLocations[i].location, sizeof(pAttribLocations[i].location));
+    }
+
+    return key;
+}
+
+// Returns a linked program, or 0 when there is no usable binary.
+static GLuint
+loadCachedProgram(uint64_t key)
+{
+    GlsysProgramBinary binary;
+    GLuint program;
+    GLint status = GL_FALSE;
+
+    if (!glsysProgramCacheLoad(s_pSettings->programCacheDir, key, &binary)) {
+        return 0;
+    }
+    program = glCreateProgram();
+    if (binary.size <= INT_MAX) {
+        glProgramBinary(program, binary.format, binary.data, (GLsizei)binary.size);
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+    }
+    glsysProgramCacheRelease(&binary);
+    if (status == GL_FALSE) {
+        // Stale after a driver update, say: link from source instead.
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+static void
+storeProgram(GLuint program, uint64_t key)
+{
+    GLint size = 0;
+    GLenum format;
+    void *data;
+
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) {
+        return;
+    }
+    data = malloc((size_t)size);
+    assert(data != NULL);
+    glGetProgramBinary(program, size, &size, &format, data);
+    if (!glsysProgramCacheStore(s_pSettings->programCacheDir, key, format, data, (size_t)size)) {
+        fprintf(stderr, "Could not cache a program binary in %s\n", s_pSettings->programCacheDir);
+    }
+    free(data);
+}
+
+static void
+compileIfDeferred(GLuint shader)
+{
+    GLint status;
+
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        compileShader(shader);
+    }
+}
+
+#endif // GL_ES
+
+GLuint
+frameworkLoadShader(GLenum shaderType, const char *filename)
+{
+    GLuint shader;
+    GlsysFile source;
+    GLint sourceLength;
+
+    shader = glCreateShader(shaderType);
+    if (!glsysFileOpen(filename, &source)) {
+        fprintf(stderr, "Error reading from %s. errno is %d\n", filename, errno);
+        assert(0);
+        glDeleteShader(shader);
+        return 0;
+    }
+    assert(source.size <= INT_MAX);
+    sourceLength = (GLint)source.size;
+    // The source is copied, so the file can go right away.
+    glShaderSource(shader, 1, &source.data, &sourceLength);
+    glsysFileClose(&source);
+
+#ifndef GL_ES
+    if (s_isProgramCacheEnabled) {
+        return shader;
+    }
+#endif
+    compileShader(shader);
 
     return shader;
 }
@@ -91,6 +233,19 @@ frameworkCreateProgram(GLuint vertexShader,
 {
     GLuint program;
     GLint status;
+#ifndef GL_ES
+    uint64_t key = 0;
+
+    if (s_isProgramCacheEnabled) {
+        key = programKey(vertexShader, fragmentShader, pAttribLocations, attribLocationCount);
+        program = loadCachedProgram(key);
+        if (program != 0) {
+            return program;
+        }
+        compileIfDeferred(vertexShader);
+        compileIfDeferred(fragmentShader);
+    }
+#endif
 
     program = glCreateProgram();
     glAttachShader(program, vertexShader);
@@ -98,19 +253,22 @@ frameworkCreateProgram(GLuint vertexShader,
     for (size_t i = 0; i < attribLocationCount; ++i) {
         glBindAttribLocation(program, pAttribLocations[i].location, pAttribLocations[i].name);
     }
+#ifndef GL_ES
+    if (s_isProgramCacheEnabled) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+#endif
     glLinkProgram(program);
 
     glGetProgramiv(program, GL_LINK_STATUS, &status);
     if (status == GL_FALSE) {
-        GLint infoLogLength;
-        GLchar *strInfoLog;
-
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
-        strInfoLog = (char *)malloc(infoLogLength + 1);
-        glGetProgramInfoLog(program, infoLogLength, NULL, strInfoLog);
-        fprintf(stderr, "Linker failure: %s\n", strInfoLog);
-        free(strInfoLog);
+        printLinkLog(program);
+    }
+#ifndef GL_ES
+    if (status != GL_FALSE && s_isProgramCacheEnabled) {
+        storeProgram(program, key);
     }
+#endif
     glDetachShader(program, vertexShader);
     glDetachShader(program, fragmentShader);
 
@@ -133,7 +291,7 @@ handleEvent(SDL_Event *event)
         break;
     case SDL_WINDOWEVENT:
         if (event->window.event == SDL_WINDOWEVENT_RESIZED) {
-            gltutReshape(event->window.data1, event->window.data2);
+            frameworkRenderReshape(event->window.data1, event->window.data2);
         }
         break;
     default:
@@ -144,20 +302,77 @@ handleEvent(SDL_Event *event)
 }
 
 static void
-simulationLoop(SDL_Window *window)
+simulationLoop(SDL_Window *window, unsigned frameCount)
 {
     SDL_Event event;
     bool isDone = false;
+    unsigned frame = 0;
 
     while (!isDone) {
         while(SDL_PollEvent(&event) == 1 && !isDone) {
             isDone = handleEvent(&event);
         }
+        frameworkProfileBeginFrame();
+        frameworkRenderBeginFrame();
+        frameworkProfileBegin("gltutDisplay");
         gltutDisplay();
-        SDL_GL_SwapWindow(window);
+        frameworkJobSystemEndFrame();
+        frameworkProfileEnd();
+        frameworkRenderEndFrame(window);
+        if (frameCount != 0 && ++frame == frameCount) {
+            isDone = true;
+        }
     }
 }
 
+// Command line options override the tutorial's settings.
+static bool
+parseArguments(int argc, char **argv, GltutDefaultSettings *pSettings, const char **pCapturePath)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            pSettings->isHeadless = true;
+        } else if (strcmp(argv[i], "--render-thread") == 0) {
+            pSettings->useRenderThread = true;
+        } else if (strcmp(argv[i], "--gl-state-cache") == 0) {
+            pSettings->useGlStateCache = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            char *end;
+            unsigned long const frameCount = strtoul(argv[++i], &end, 10);
+
+            if (end == argv[i] || *end != '\0' || frameCount > UINT_MAX) {
+                return false;
+            }
+            pSettings->frameCount = (unsigned)frameCount;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            pSettings->profilePath = argv[++i];
+        } else if (strcmp(argv[i], "--program-cache") == 0 && i + 1 < argc) {
+            pSettings->programCacheDir = argv[++i];
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            *pCapturePath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    // Only the offscreen framebuffer is read back.
+    return *pCapturePath == NULL || pSettings->isHeadless;
+}
+
+void
+frameworkRenderSystemInit(void)
+{
+    glsysInit();
+    frameworkProfileGpuInit();
+#ifndef GL_ES
+    programCacheInit(s_pSettings->programCacheDir);
+#endif
+    if (s_pSettings->isHeadless) {
+        frameworkOffscreenInit(s_pSettings->windowWidth, s_pSettings->windowHeight);
+    }
+    gltutPostRenderSystemInit();
+}
+
 int
 main(int argc, char** argv)
 {
@@ -166,14 +381,30 @@ main(int argc, char** argv)
     SDL_Window *mainWindow;
     int retval;
     const char *errorStr;
-
-    (void) argc;
-    (void) argv;
+    const char *capturePath = NULL;
 
     gltutDefaultSettingsInit(&settings);
+    if (!parseArguments(argc, argv, &settings, &capturePath)) {
+        fprintf(stderr, "usage: %s [--headless] [--frames N] [--profile FILE.csv|FILE.json]\n"
+                        "       [--program-cache DIR] [--capture FILE.ppm]\n"
+                        "       [--render-thread] [--gl-state-cache]\n"
+                        "--capture writes the last frame of a headless run.\n", argv[0]);
+        return 1;
+    }
+    if (settings.useRenderThread && !settings.recordsCommands) {
+        fprintf(stderr, "%s calls GL from gltutDisplay; ignoring --render-thread\n", settings.windowTitle);
+        settings.useRenderThread = false;
+    }
+    s_pSettings = &settings;
 
+    if (settings.isHeadless) {
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+    }
     retval = SDL_Init(SDL_INIT_VIDEO);
-    assert(retval == 0);
+    if (retval != 0) {
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
     
 #ifdef GL_ES
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
@@ -192,7 +423,8 @@ main(int argc, char** argv)
                                   SDL_WINDOWPOS_CENTERED,
                                   settings.windowWidth,
                                   settings.windowHeight,
-                                  SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+                                  SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE |
+                                  (settings.isHeadless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN));
     assert(mainWindow != NULL);
 
     mainContext = SDL_GL_CreateContext(mainWindow);
@@ -202,15 +434,47 @@ main(int argc, char** argv)
         SDL_ClearError();
     }
 
-    glsysInit();
+    frameworkProfileInit(settings.profilePath);
+    frameworkJobSystemInit();
 
-    gltutPostRenderSystemInit();
+    glsysEnableStateCache(settings.useGlStateCache);
+    if (!settings.useRenderThread || !frameworkRenderThreadStart(mainWindow, mainContext)) {
+        frameworkRenderSystemInit();
+    }
+    if (settings.isHeadless) {
+        // No window events will size the viewport.
+        frameworkRenderReshape(settings.windowWidth, settings.windowHeight);
+    }
+    frameworkJobSystemEndFrame();
+
+    simulationLoop(mainWindow, settings.frameCount);
 
-    simulationLoop(mainWindow);
+    frameworkRenderThreadStop();
+    frameworkJobSystemShutdown();
+    frameworkProfileGpuShutdown();
+
+    if (capturePath != NULL && !frameworkOffscreenWriteImage(capturePath)) {
+        fprintf(stderr, "Could not write %s\n", capturePath);
+        retval = 1;
+    }
+    if (settings.isHeadless) {
+        frameworkOffscreenShutdown();
+    }
+    if (!frameworkProfileShutdown()) {
+        fprintf(stderr, "Could not write %s\n", settings.profilePath);
+        retval = 1;
+    }
+
+    if (settings.useGlStateCache) {
+        GlsysStateCacheStats stats;
+
+        glsysGetStateCacheStats(&stats);
+        printf("GL state cache: %lu calls issued, %lu skipped\n", stats.issuedCalls, stats.skippedCalls);
+    }
 
     SDL_GL_DeleteContext(mainContext);
     SDL_DestroyWindow(mainWindow);
     SDL_Quit();
 
-    return 0;
+    return retval;
 }
@@ -1,12 +1,42 @@
 #ifndef GLTUT_FRAMEWORK_H
 #define GLTUT_FRAMEWORK_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "glsys.h"
 
 typedef struct GltutDefaultSettings {
     int          windowWidth;
     int          windowHeight;
     const char  *windowTitle;
+    // Set by a tutorial whose gltutDisplay only records frameworkCmd*
+    // commands and never calls GL, so that it may use a render thread.
+    bool         recordsCommands;
+    // Replay the recorded commands on a render thread that owns the GL
+    // context, while the main thread records the next frame.
+    // gltutPostRenderSystemInit and gltutReshape then run on the render
+    // thread. Ignored unless recordsCommands is set. Also set by
+    // --render-thread.
+    bool         useRenderThread;
+    // Skip redundant binds and enables with glsysEnableStateCache, and
+    // report the calls skipped on exit. Also set by --gl-state-cache.
+    bool         useGlStateCache;
+    // Render into a framebuffer object through SDL's offscreen video
+    // driver, which needs no display. Also set by --headless.
+    bool         isHeadless;
+    // Frames to run before exiting, or 0 to run until the window is
+    // closed. Also set by --frames N.
+    unsigned     frameCount;
+    // Write per-frame CPU and GPU times, draw calls and uploaded bytes,
+    // and the profile markers, to this file on exit: as Chrome trace
+    // JSON if it ends in .json, as CSV otherwise. Also set by --profile.
+    const char  *profilePath;
+    // Keep linked program binaries in this existing directory, and load
+    // them instead of compiling and linking when the shaders, attribute
+    // locations and driver are unchanged. Also set by --program-cache.
+    const char  *programCacheDir;
 } GltutDefaultSettings;
 
 #define GLTUT_DEFAULT_WINDOW_HEIGHT 500
@@ -15,13 +45,57 @@ typedef struct GltutDefaultSettings {
 #define GLTUT_DEFAULT_SETTINGS_INITIALIZER      \
     {.windowWidth=GLTUT_DEFAULT_WINDOW_WIDTH,   \
      .windowHeight=GLTUT_DEFAULT_WINDOW_HEIGHT, \
-     .windowTitle=GLTUT_DEFAULT_WINDOW_TITLE}
+     .windowTitle=GLTUT_DEFAULT_WINDOW_TITLE,   \
+     .recordsCommands=false,                    \
+     .useRenderThread=false,                    \
+     .useGlStateCache=false,                    \
+     .isHeadless=false,                         \
+     .frameCount=0,                             \
+     .profilePath=NULL,                         \
+     .programCacheDir=NULL}
 
 typedef struct FrameworkShaderAttribLocation {
     const char  *name;
     GLuint       location;
 } FrameworkShaderAttribLocation;
 
+// Work-stealing job system, run by one worker thread per additional
+// core, started with the first submitted job, with the main thread
+// helping whenever it waits. Jobs may only be created between the start
+// and the end of a frame, from any thread running a job or the main
+// thread, and their handles are recycled once gltutDisplay returns.
+// Every created job must be submitted; the frame does not end before
+// all of them have finished.
+typedef struct FrameworkJob FrameworkJob;
+typedef void (*FrameworkJobFunc)(void *context);
+// Called with [first, end) of a parallel-for range.
+typedef void (*FrameworkParallelForFunc)(void *context, size_t first, size_t end);
+
+// A ring of per-frame data in a buffer that stays mapped, so that
+// uniforms and vertices are written with plain stores instead of GL
+// calls. Used on the thread that owns the GL context.
+typedef struct FrameworkStreamBuffer FrameworkStreamBuffer;
+
+// Runs on the thread that owns the GL context, with a copy of the data
+// recorded with it.
+typedef void (*FrameworkRenderCallback)(const void *data, size_t size);
+
+// A fixed set of CPU tasks run once per frame. A task may only depend
+// on tasks added before it, so the graph has no cycles.
+#define FRAMEWORK_FRAME_GRAPH_MAX_TASKS 16
+
+typedef struct FrameworkFrameTask {
+    FrameworkJobFunc   func;
+    void              *context;
+    // Bit i is set when the task depends on task i.
+    unsigned           dependencies;
+} FrameworkFrameTask;
+
+typedef struct FrameworkFrameGraph {
+    size_t              taskCount;
+    FrameworkFrameTask  tasks[FRAMEWORK_FRAME_GRAPH_MAX_TASKS];
+} FrameworkFrameGraph;
+
 void    gltutPostRenderSystemInit(void);
 void    gltutDisplay(void);
 void    gltutReshape(int width, int height);
@@ -33,4 +107,81 @@ GLuint  frameworkCreateProgram(GLuint vertexShader,
                                const FrameworkShaderAttribLocation *pAttribLocations,
                                size_t attribLocationCount);
 
+unsigned        frameworkJobThreadCount(void);
+// The job runs once it is submitted and all its dependencies have
+// finished. Dependencies must be added before submitting.
+FrameworkJob   *frameworkJobCreate(FrameworkJobFunc func, void *context);
+void            frameworkJobAddDependency(FrameworkJob *job, FrameworkJob *dependency);
+void            frameworkJobSubmit(FrameworkJob *job);
+// Runs other jobs until job has finished.
+void            frameworkJobWait(FrameworkJob *job);
+// Splits [0, count) into ranges of at least minRangeSize, runs them on
+// all threads and returns once they have finished.
+void            frameworkParallelFor(size_t count,
+                                     size_t minRangeSize,
+                                     FrameworkParallelForFunc func,
+                                     void *context);
+
+void            frameworkFrameGraphInit(FrameworkFrameGraph *pGraph);
+// Returns the new task's index, for the dependencies of later tasks.
+size_t          frameworkFrameGraphAddTask(FrameworkFrameGraph *pGraph,
+                                           FrameworkJobFunc func,
+                                           void *context,
+                                           const size_t *pDependencies,
+                                           size_t dependencyCount);
+// Runs every task, each after its dependencies, and waits for them.
+void            frameworkFrameGraphRun(const FrameworkFrameGraph *pGraph);
+
+// Paired on each thread to time what runs between them when profiling.
+// Markers nested deeper than FRAMEWORK_PROFILE_MAX_DEPTH are not
+// recorded. The name is kept until exit.
+#define FRAMEWORK_PROFILE_MAX_DEPTH 16
+
+void    frameworkProfileBegin(const char *name);
+void    frameworkProfileEnd(void);
+
+// Returns NULL if the driver lacks GL_ARB_buffer_storage. Uniform
+// buffer allocations are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,
+// others to 16 bytes.
+FrameworkStreamBuffer  *frameworkStreamBufferCreate(GLenum target, size_t size);
+void                    frameworkStreamBufferDestroy(FrameworkStreamBuffer *stream);
+// Returns where to write size bytes, and their offset in the buffer.
+// Waits for the GPU only when the ring is full of data a frame in
+// flight may still read. Returns NULL when the allocation does not fit
+// beside the rest of the current frame's.
+void                   *frameworkStreamBufferAlloc(FrameworkStreamBuffer *stream,
+                                                   size_t size,
+                                                   GLintptr *pOffset);
+// For indexed targets, such as GL_UNIFORM_BUFFER.
+void                    frameworkStreamBufferBindRange(FrameworkStreamBuffer *stream,
+                                                       GLuint index,
+                                                       GLintptr offset,
+                                                       GLsizeiptr size);
+// Fences the frame's allocations, once its draws have been issued.
+void                    frameworkStreamBufferEndFrame(FrameworkStreamBuffer *stream);
+
+// Commands recorded from gltutDisplay and replayed, in order, once it
+// returns; on the render thread if useRenderThread is set. Every value
+// and data block is copied when it is recorded.
+void    frameworkCmdViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void    frameworkCmdClear(const GLfloat color[4], GLfloat depth, GLbitfield mask);
+void    frameworkCmdUseProgram(GLuint program);
+void    frameworkCmdEnableVertexAttribArray(GLuint index);
+void    frameworkCmdDisableVertexAttribArray(GLuint index);
+void    frameworkCmdBindBuffer(GLenum target, GLuint buffer);
+void    frameworkCmdVertexAttribPointer(GLuint index,
+                                        GLint size,
+                                        GLenum type,
+                                        GLboolean normalized,
+                                        GLsizei stride,
+                                        uintptr_t offset);
+void    frameworkCmdBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+void    frameworkCmdUniform1f(GLint location, GLfloat v0);
+void    frameworkCmdUniform2f(GLint location, GLfloat v0, GLfloat v1);
+void    frameworkCmdUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+void    frameworkCmdUniformMatrix4fv(GLint location, GLboolean transpose, const GLfloat *value);
+void    frameworkCmdDrawArrays(GLenum mode, GLint first, GLsizei count);
+void    frameworkCmdDrawElements(GLenum mode, GLsizei count, GLenum type, uintptr_t offset);
+void    frameworkCmdCallback(FrameworkRenderCallback func, const void *data, size_t size);
+
 #endif // GLTUT_FRAMEWORK_H
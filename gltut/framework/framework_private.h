@@ -0,0 +1,56 @@
+#ifndef GLTUT_FRAMEWORK_PRIVATE_H
+#define GLTUT_FRAMEWORK_PRIVATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "SDL.h"
+
+// Called by framework.c around the tutorial's callbacks.
+
+// Loads GL, sets up headless rendering if it is asked for and calls
+// gltutPostRenderSystemInit, on the thread that owns the context.
+void    frameworkRenderSystemInit(void);
+
+void    frameworkJobSystemInit(void);
+void    frameworkJobSystemShutdown(void);
+// Waits for every job of the frame and recycles them.
+void    frameworkJobSystemEndFrame(void);
+
+// Makes the context current on a new render thread, which initializes
+// the tutorial before this returns. Returns false, with the context
+// still current, if the thread cannot be started.
+bool    frameworkRenderThreadStart(SDL_Window *window, SDL_GLContext context);
+// Waits for the recorded frames and makes the context current again.
+void    frameworkRenderThreadStop(void);
+// Around gltutDisplay: the end replays the commands and swaps, or hands
+// them to the render thread.
+void    frameworkRenderBeginFrame(void);
+void    frameworkRenderEndFrame(SDL_Window *window);
+// Calls gltutReshape on the thread that owns the context.
+void    frameworkRenderReshape(int width, int height);
+
+// Creates and binds the framebuffer object headless runs render into.
+void    frameworkOffscreenInit(int width, int height);
+void    frameworkOffscreenShutdown(void);
+// Writes the framebuffer object's colors as a binary PPM image.
+bool    frameworkOffscreenWriteImage(const char *path);
+
+// Profiling is off unless there is a path to write the stats to.
+void    frameworkProfileInit(const char *path);
+// Ends the previous frame and starts the next, on the main thread.
+void    frameworkProfileBeginFrame(void);
+// On the thread that owns the context, for bytes written with no GL
+// call that glsys could count, such as into a mapped buffer.
+void    frameworkProfileCountUpload(size_t size);
+// On the thread that owns the context, the last around each replay.
+void    frameworkProfileGpuInit(void);
+void    frameworkProfileGpuBeginFrame(void);
+void    frameworkProfileGpuEndFrame(void);
+// Waits for the queries in flight and deletes them.
+void    frameworkProfileGpuShutdown(void);
+// Prints a summary and writes the stats, returning false if they could
+// not be written.
+bool    frameworkProfileShutdown(void);
+
+#endif // GLTUT_FRAMEWORK_PRIVATE_H
@@ -0,0 +1,483 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "SDL.h"
+#include "framework.h"
+#include "framework_private.h"
+
+// Every thread, the main one first, owns a queue of ready jobs. It
+// pushes and pops at the bottom, newest first, and idle threads steal
+// the oldest jobs from the top of the others' queues. Jobs come from a
+// pool that is reset at the end of each frame. The workers are started
+// by the first submitted job, so a tutorial that never submits one
+// runs on the main thread alone. Workers sleep on a semaphore, and a
+// thread waiting for jobs sleeps on a condition, while there is no job
+// to run.
+
+#define JOB_MAX_WORKERS 15
+#define JOB_POOL_SIZE 2048
+#define JOB_QUEUE_SIZE 1024
+// Held by a job; the last one is moved to a relay job when there are
+// more.
+#define JOB_MAX_DEPENDENTS FRAMEWORK_FRAME_GRAPH_MAX_TASKS
+// Parallel-for ranges per thread, so that stealing can even out ranges
+// that take longer than others.
+#define JOB_RANGES_PER_THREAD 4
+
+struct FrameworkJob {
+    FrameworkJobFunc            func;
+    FrameworkParallelForFunc    rangeFunc;
+    void                       *context;
+    size_t                      first;
+    size_t                      end;
+    FrameworkJob               *parent;
+    // The job itself and its unfinished children.
+    SDL_atomic_t                unfinished;
+    // Unfinished dependencies, plus one until the job is submitted.
+    SDL_atomic_t                pendingDependencies;
+    // Guards isFinished and the dependents.
+    SDL_SpinLock                lock;
+    bool                        isFinished;
+    // Runs nothing, and only holds the dependents that did not fit in
+    // the job whose last dependent it is.
+    bool                        isRelay;
+    int                         dependentCount;
+    FrameworkJob               *dependents[JOB_MAX_DEPENDENTS];
+};
+
+typedef struct JobQueue {
+    SDL_SpinLock    lock;
+    size_t          top;
+    size_t          bottom;
+    FrameworkJob   *jobs[JOB_QUEUE_SIZE];
+} JobQueue;
+
+static JobQueue         s_queues[JOB_MAX_WORKERS + 1];
+static SDL_Thread      *s_workers[JOB_MAX_WORKERS];
+// The queues past the main thread's, whether or not their workers
+// could be started.
+static unsigned         s_workerCount;
+static unsigned         s_startedWorkerCount;
+static SDL_atomic_t     s_areWorkersStarted;
+static SDL_SpinLock     s_startLock;
+// Posted once per pushed job, to wake a worker.
+static SDL_sem         *s_readyJobs;
+// Signalled when a job is pushed or finishes, if a thread waits.
+static SDL_mutex       *s_waitLock;
+static SDL_cond        *s_waitCondition;
+static SDL_atomic_t     s_waiterCount;
+static SDL_atomic_t     s_isQuitting;
+static SDL_TLSID        s_queueTls;
+static FrameworkJob     s_jobPool[JOB_POOL_SIZE];
+static SDL_atomic_t     s_jobPoolNext;
+static SDL_atomic_t     s_unfinishedJobs;
+
+static void     runJob(FrameworkJob *job);
+
+// The waiter counts itself before it looks for work one last time, and
+// the signaller only takes the lock when it sees a waiter, so that one
+// of the two always sees the other.
+static void
+wakeWaiters(void)
+{
+    if (SDL_AtomicGet(&s_waiterCount) > 0) {
+        SDL_LockMutex(s_waitLock);
+        SDL_CondBroadcast(s_waitCondition);
+        SDL_UnlockMutex(s_waitLock);
+    }
+}
+
+// Threads outside the job system share the main thread's queue.
+static size_t
+currentQueueIndex(void)
+{
+    JobQueue const *queue = SDL_TLSGet(s_queueTls);
+
+    return (queue != NULL) ? (size_t)(queue - s_queues) : 0;
+}
+
+static void
+pushJob(FrameworkJob *job)
+{
+    JobQueue *queue = &s_queues[currentQueueIndex()];
+    bool isPushed = false;
+
+    SDL_AtomicLock(&queue->lock);
+    if (queue->bottom - queue->top < JOB_QUEUE_SIZE) {
+        queue->jobs[queue->bottom % JOB_QUEUE_SIZE] = job;
+        ++queue->bottom;
+        isPushed = true;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+
+    if (isPushed) {
+        SDL_SemPost(s_readyJobs);
+        wakeWaiters();
+    } else {
+        runJob(job);
+    }
+}
+
+static FrameworkJob *
+popJob(JobQueue *queue)
+{
+    FrameworkJob *job = NULL;
+
+    SDL_AtomicLock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        --queue->bottom;
+        job = queue->jobs[queue->bottom % JOB_QUEUE_SIZE];
+    }
+    SDL_AtomicUnlock(&queue->lock);
+
+    return job;
+}
+
+static FrameworkJob *
+stealJob(JobQueue *queue)
+{
+    FrameworkJob *job = NULL;
+
+    SDL_AtomicLock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        job = queue->jobs[queue->top % JOB_QUEUE_SIZE];
+        ++queue->top;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+
+    return job;
+}
+
+static FrameworkJob *
+findJob(void)
+{
+    size_t const queueCount = s_workerCount + 1;
+    size_t const own = currentQueueIndex();
+    FrameworkJob *job = popJob(&s_queues[own]);
+
+    for (size_t i = 1; job == NULL && i < queueCount; ++i) {
+        job = stealJob(&s_queues[(own + i) % queueCount]);
+    }
+
+    return job;
+}
+
+static void
+releaseDependency(FrameworkJob *job)
+{
+    if (SDL_AtomicDecRef(&job->pendingDependencies)) {
+        pushJob(job);
+    }
+}
+
+static void
+finishJob(FrameworkJob *job)
+{
+    FrameworkJob *dependents[JOB_MAX_DEPENDENTS];
+    int dependentCount;
+
+    if (!SDL_AtomicDecRef(&job->unfinished)) {
+        return;
+    }
+
+    SDL_AtomicLock(&job->lock);
+    job->isFinished = true;
+    dependentCount = job->dependentCount;
+    for (int i = 0; i < dependentCount; ++i) {
+        dependents[i] = job->dependents[i];
+    }
+    SDL_AtomicUnlock(&job->lock);
+
+    for (int i = 0; i < dependentCount; ++i) {
+        releaseDependency(dependents[i]);
+    }
+    if (job->parent != NULL) {
+        finishJob(job->parent);
+    }
+    SDL_AtomicAdd(&s_unfinishedJobs, -1);
+    wakeWaiters();
+}
+
+static void
+runJob(FrameworkJob *job)
+{
+    frameworkProfileBegin("job");
+    if (job->func != NULL) {
+        job->func(job->context);
+    } else if (job->rangeFunc != NULL) {
+        job->rangeFunc(job->context, job->first, job->end);
+    }
+    frameworkProfileEnd();
+    finishJob(job);
+}
+
+// Runs ready jobs until the count reaches zero, sleeping while there
+// are none.
+static void
+helpUntilFinished(SDL_atomic_t *pUnfinished)
+{
+    while (SDL_AtomicGet(pUnfinished) > 0) {
+        FrameworkJob *job = findJob();
+
+        if (job == NULL) {
+            SDL_LockMutex(s_waitLock);
+            SDL_AtomicIncRef(&s_waiterCount);
+            job = findJob();
+            if (job == NULL && SDL_AtomicGet(pUnfinished) > 0) {
+                SDL_CondWait(s_waitCondition, s_waitLock);
+            }
+            SDL_AtomicAdd(&s_waiterCount, -1);
+            SDL_UnlockMutex(s_waitLock);
+        }
+        if (job != NULL) {
+            runJob(job);
+        }
+    }
+}
+
+static int
+workerMain(void *queue)
+{
+    SDL_TLSSet(s_queueTls, queue, NULL);
+    for (;;) {
+        FrameworkJob *job;
+
+        SDL_SemWait(s_readyJobs);
+        if (SDL_AtomicGet(&s_isQuitting) != 0) {
+            break;
+        }
+        job = findJob();
+        if (job != NULL) {
+            runJob(job);
+        }
+    }
+
+    return 0;
+}
+
+static void
+startWorkers(void)
+{
+    if (SDL_AtomicGet(&s_areWorkersStarted) != 0) {
+        return;
+    }
+    SDL_AtomicLock(&s_startLock);
+    if (SDL_AtomicGet(&s_areWorkersStarted) == 0) {
+        for (unsigned i = 0; i < s_workerCount; ++i) {
+            s_workers[s_startedWorkerCount] = SDL_CreateThread(workerMain, "gltut job worker", &s_queues[i + 1]);
+            // The jobs pushed to a queue with no worker are stolen.
+            if (s_workers[s_startedWorkerCount] != NULL) {
+                ++s_startedWorkerCount;
+            }
+        }
+        SDL_AtomicSet(&s_areWorkersStarted, 1);
+    }
+    SDL_AtomicUnlock(&s_startLock);
+}
+
+void
+frameworkJobSystemInit(void)
+{
+    int const cpuCount = SDL_GetCPUCount();
+
+    s_workerCount = (cpuCount > 1) ? (unsigned)cpuCount - 1 : 0;
+    s_workerCount = (s_workerCount < JOB_MAX_WORKERS) ? s_workerCount : JOB_MAX_WORKERS;
+    s_readyJobs = SDL_CreateSemaphore(0);
+    s_waitLock = SDL_CreateMutex();
+    s_waitCondition = SDL_CreateCond();
+    s_queueTls = SDL_TLSCreate();
+    assert(s_readyJobs != NULL && s_waitLock != NULL && s_waitCondition != NULL && s_queueTls != 0);
+    SDL_TLSSet(s_queueTls, &s_queues[0], NULL);
+}
+
+void
+frameworkJobSystemShutdown(void)
+{
+    frameworkJobSystemEndFrame();
+    SDL_AtomicSet(&s_isQuitting, 1);
+    for (unsigned i = 0; i < s_startedWorkerCount; ++i) {
+        SDL_SemPost(s_readyJobs);
+    }
+    for (unsigned i = 0; i < s_startedWorkerCount; ++i) {
+        SDL_WaitThread(s_workers[i], NULL);
+    }
+    s_workerCount = 0;
+    s_startedWorkerCount = 0;
+    SDL_AtomicSet(&s_areWorkersStarted, 0);
+    SDL_AtomicSet(&s_isQuitting, 0);
+    SDL_DestroySemaphore(s_readyJobs);
+    SDL_DestroyCond(s_waitCondition);
+    SDL_DestroyMutex(s_waitLock);
+    s_readyJobs = NULL;
+    s_waitCondition = NULL;
+    s_waitLock = NULL;
+}
+
+void
+frameworkJobSystemEndFrame(void)
+{
+    helpUntilFinished(&s_unfinishedJobs);
+    SDL_AtomicSet(&s_jobPoolNext, 0);
+}
+
+unsigned
+frameworkJobThreadCount(void)
+{
+    return s_workerCount + 1;
+}
+
+FrameworkJob *
+frameworkJobCreate(FrameworkJobFunc func, void *context)
+{
+    int const index = SDL_AtomicAdd(&s_jobPoolNext, 1);
+    FrameworkJob *job;
+
+    assert(index < JOB_POOL_SIZE && "too many jobs in one frame");
+    job = &s_jobPool[index];
+    job->func = func;
+    job->rangeFunc = NULL;
+    job->context = context;
+    job->first = 0;
+    job->end = 0;
+    job->parent = NULL;
+    SDL_AtomicSet(&job->unfinished, 1);
+    SDL_AtomicSet(&job->pendingDependencies, 1);
+    job->lock = 0;
+    job->isFinished = false;
+    job->isRelay = false;
+    job->dependentCount = 0;
+    SDL_AtomicIncRef(&s_unfinishedJobs);
+
+    return job;
+}
+
+// With the unfinished dependency's lock held, which also guards its
+// relay jobs: they cannot run before it finishes.
+static void
+addDependent(FrameworkJob *dependency, FrameworkJob *job)
+{
+    FrameworkJob *relay;
+
+    if (dependency->dependentCount < JOB_MAX_DEPENDENTS) {
+        dependency->dependents[dependency->dependentCount++] = job;
+        return;
+    }
+    relay = dependency->dependents[JOB_MAX_DEPENDENTS - 1];
+    if (!relay->isRelay) {
+        relay = frameworkJobCreate(NULL, NULL);
+        relay->isRelay = true;
+        relay->dependents[relay->dependentCount++] = dependency->dependents[JOB_MAX_DEPENDENTS - 1];
+        // Already submitted, and waiting on the dependency alone.
+        SDL_AtomicSet(&relay->pendingDependencies, 1);
+        dependency->dependents[JOB_MAX_DEPENDENTS - 1] = relay;
+    }
+    addDependent(relay, job);
+}
+
+void
+frameworkJobAddDependency(FrameworkJob *job, FrameworkJob *dependency)
+{
+    SDL_AtomicLock(&dependency->lock);
+    if (!dependency->isFinished) {
+        addDependent(dependency, job);
+        SDL_AtomicIncRef(&job->pendingDependencies);
+    }
+    SDL_AtomicUnlock(&dependency->lock);
+}
+
+void
+frameworkJobSubmit(FrameworkJob *job)
+{
+    startWorkers();
+    releaseDependency(job);
+}
+
+void
+frameworkJobWait(FrameworkJob *job)
+{
+    helpUntilFinished(&job->unfinished);
+}
+
+void
+frameworkParallelFor(size_t count, size_t minRangeSize, FrameworkParallelForFunc func, void *context)
+{
+    size_t const rangeCount = (size_t)frameworkJobThreadCount() * JOB_RANGES_PER_THREAD;
+    size_t rangeSize = (count + rangeCount - 1) / rangeCount;
+    FrameworkJob *parent;
+
+    rangeSize = (rangeSize > minRangeSize) ? rangeSize : minRangeSize;
+    if (s_workerCount == 0 || rangeSize >= count) {
+        if (count > 0) {
+            func(context, 0, count);
+        }
+        return;
+    }
+
+    // The parent only counts its unfinished children, and finishes its
+    // own part right away.
+    parent = frameworkJobCreate(NULL, NULL);
+    for (size_t first = 0; first < count; first += rangeSize) {
+        FrameworkJob *range = frameworkJobCreate(NULL, context);
+
+        range->rangeFunc = func;
+        range->first = first;
+        range->end = (count - first > rangeSize) ? first + rangeSize : count;
+        range->parent = parent;
+        SDL_AtomicIncRef(&parent->unfinished);
+        frameworkJobSubmit(range);
+    }
+    finishJob(parent);
+    frameworkJobWait(parent);
+}
+
+void
+frameworkFrameGraphInit(FrameworkFrameGraph *pGraph)
+{
+    pGraph->taskCount = 0;
+}
+
+size_t
+frameworkFrameGraphAddTask(FrameworkFrameGraph *pGraph,
+                           FrameworkJobFunc func,
+                           void *context,
+                           const size_t *pDependencies,
+                           size_t dependencyCount)
+{
+    size_t const index = pGraph->taskCount;
+    FrameworkFrameTask *task;
+
+    assert(index < FRAMEWORK_FRAME_GRAPH_MAX_TASKS);
+    task = &pGraph->tasks[index];
+    task->func = func;
+    task->context = context;
+    task->dependencies = 0;
+    for (size_t i = 0; i < dependencyCount; ++i) {
+        assert(pDependencies[i] < index);
+        task->dependencies |= 1u << pDependencies[i];
+    }
+    ++pGraph->taskCount;
+
+    return index;
+}
+
+void
+frameworkFrameGraphRun(const FrameworkFrameGraph *pGraph)
+{
+    FrameworkJob *jobs[FRAMEWORK_FRAME_GRAPH_MAX_TASKS];
+
+    for (size_t i = 0; i < pGraph->taskCount; ++i) {
+        jobs[i] = frameworkJobCreate(pGraph->tasks[i].func, pGraph->tasks[i].context);
+        for (size_t d = 0; d < i; ++d) {
+            if ((pGraph->tasks[i].dependencies & (1u << d)) != 0) {
+                frameworkJobAddDependency(jobs[i], jobs[d]);
+            }
+        }
+    }
+    for (size_t i = 0; i < pGraph->taskCount; ++i) {
+        frameworkJobSubmit(jobs[i]);
+    }
+    for (size_t i = 0; i < pGraph->taskCount; ++i) {
+        frameworkJobWait(jobs[i]);
+    }
+}
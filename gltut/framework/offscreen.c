@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "framework.h"
+#include "framework_private.h"
+#include "glsys.h"
+
+// Headless contexts may have no default framebuffer at all, so the
+// tutorial draws into this one, bound in its place for the whole run.
+
+#ifdef GL_ES
+#define OFFSCREEN_COLOR_FORMAT GL_RGBA4
+#define OFFSCREEN_DEPTH_FORMAT GL_DEPTH_COMPONENT16
+#else
+#define OFFSCREEN_COLOR_FORMAT GL_RGBA8
+#define OFFSCREEN_DEPTH_FORMAT GL_DEPTH_COMPONENT24
+#endif
+
+static GLuint   s_framebuffer;
+static GLuint   s_renderbuffers[2];
+static int      s_width;
+static int      s_height;
+
+void
+frameworkOffscreenInit(int width, int height)
+{
+    GLenum status;
+
+    s_width = width;
+    s_height = height;
+    glGenFramebuffers(1, &s_framebuffer);
+    glGenRenderbuffers(2, s_renderbuffers);
+    glBindFramebuffer(GL_FRAMEBUFFER, s_framebuffer);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, s_renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, OFFSCREEN_COLOR_FORMAT, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, s_renderbuffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, s_renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, OFFSCREEN_DEPTH_FORMAT, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, s_renderbuffers[1]);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    assert(status == GL_FRAMEBUFFER_COMPLETE);
+    (void)status;
+}
+
+void
+frameworkOffscreenShutdown(void)
+{
+    if (s_framebuffer == 0) {
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &s_framebuffer);
+    glDeleteRenderbuffers(2, s_renderbuffers);
+    s_framebuffer = 0;
+}
+
+bool
+frameworkOffscreenWriteImage(const char *path)
+{
+    size_t const rowSize = 4 * (size_t)s_width;
+    unsigned char *pixels;
+    FILE *file;
+    bool isWritten;
+
+    assert(s_framebuffer != 0);
+    pixels = malloc(rowSize * (size_t)s_height);
+    file = fopen(path, "wb");
+    if (pixels == NULL || file == NULL) {
+        free(pixels);
+        if (file != NULL) {
+            fclose(file);
+        }
+        return false;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, s_width, s_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    // GL rows go bottom up, PPM rows top down.
+    isWritten = fprintf(file, "P6\n%d %d\n255\n", s_width, s_height) > 0;
+    for (int y = s_height - 1; isWritten && y >= 0; --y) {
+        unsigned char const *row = &pixels[rowSize * (size_t)y];
+
+        for (int x = 0; isWritten && x < s_width; ++x) {
+            isWritten = fwrite(&row[4 * x], 1, 3, file) == 3;
+        }
+    }
+    isWritten = (fclose(file) == 0) && isWritten;
+    free(pixels);
+
+    return isWritten;
+}
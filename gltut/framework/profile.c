@@ -0,0 +1,502 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "framework.h"
+#include "framework_private.h"
+#include "glsys.h"
+
+// Frames are timed on the main thread, from the start of one to the
+// start of the next. Each replayed frame gets a GL_TIME_ELAPSED query,
+// and a GL_TIMESTAMP query to place it on the CPU timeline. Queries are
+// read back from a ring once the GPU has answered them, so the CPU never
+// waits; a frame whose ring slot is still busy is left untimed. All
+// times are nanoseconds since frameworkProfileInit. Draw calls and
+// uploads are counted by glsys as they reach the driver, on the thread
+// that owns the context, from the end of one replay to the end of the
+// next.
+
+#define PROFILE_GPU_RING_SIZE 4
+#define PROFILE_INITIAL_CAPACITY 1024
+
+typedef struct FrameStats {
+    uint64_t    start;
+    uint64_t    cpuTime;
+} FrameStats;
+
+typedef struct GpuFrameStats {
+    bool            isTimed;
+    int64_t         start;
+    uint64_t        gpuTime;
+    unsigned long   drawCalls;
+    size_t          uploadedBytes;
+} GpuFrameStats;
+
+typedef struct Marker {
+    const char     *name;
+    unsigned long   threadId;
+    uint64_t        start;
+    uint64_t        duration;
+} Marker;
+
+typedef struct MarkerStack {
+    unsigned        depth;
+    const char     *names[FRAMEWORK_PROFILE_MAX_DEPTH];
+    uint64_t        starts[FRAMEWORK_PROFILE_MAX_DEPTH];
+} MarkerStack;
+
+typedef struct GpuQuerySlot {
+    GLuint      elapsed;
+    GLuint      timestamp;
+    size_t      frame;
+    bool        isPending;
+} GpuQuerySlot;
+
+static bool             s_isEnabled;
+static const char      *s_path;
+static uint64_t         s_startCounter;
+static uint64_t         s_counterFrequency;
+static SDL_TLSID        s_markerStackTls;
+
+// Main thread only.
+static FrameStats      *s_frames;
+static size_t           s_frameCount;
+static size_t           s_frameCapacity;
+
+// Guarded by s_markerLock; markers end on any thread.
+static SDL_SpinLock     s_markerLock;
+static Marker          *s_markers;
+static size_t           s_markerCount;
+static size_t           s_markerCapacity;
+
+// The thread that owns the GL context only.
+static bool             s_hasTimerQuery;
+static bool             s_isGpuFrameTimed;
+static int64_t          s_gpuClockOffset;
+static GpuQuerySlot     s_gpuSlots[PROFILE_GPU_RING_SIZE];
+static size_t           s_gpuFrame;
+static GpuFrameStats   *s_gpuFrames;
+static size_t           s_gpuFrameCapacity;
+static size_t           s_mappedBytes;
+
+static uint64_t
+now(void)
+{
+    uint64_t const ticks = SDL_GetPerformanceCounter() - s_startCounter;
+
+    // Split so that ticks * 10^9 cannot overflow.
+    return ticks / s_counterFrequency * UINT64_C(1000000000) +
+           ticks % s_counterFrequency * UINT64_C(1000000000) / s_counterFrequency;
+}
+
+// Makes room for count elements, zeroing the new ones.
+static void *
+reserve(void *data, size_t *pCapacity, size_t count, size_t elementSize)
+{
+    size_t capacity = (*pCapacity > 0) ? *pCapacity : PROFILE_INITIAL_CAPACITY;
+
+    if (count <= *pCapacity) {
+        return data;
+    }
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    data = realloc(data, capacity * elementSize);
+    assert(data != NULL);
+    memset((unsigned char *)data + *pCapacity * elementSize, 0, (capacity - *pCapacity) * elementSize);
+    *pCapacity = capacity;
+
+    return data;
+}
+
+void
+frameworkProfileInit(const char *path)
+{
+    s_isEnabled = (path != NULL);
+    s_path = path;
+    if (!s_isEnabled) {
+        return;
+    }
+    s_startCounter = SDL_GetPerformanceCounter();
+    s_counterFrequency = SDL_GetPerformanceFrequency();
+    s_markerStackTls = SDL_TLSCreate();
+    assert(s_markerStackTls != 0);
+}
+
+void
+frameworkProfileBegin(const char *name)
+{
+    MarkerStack *stack;
+
+    if (!s_isEnabled) {
+        return;
+    }
+    stack = SDL_TLSGet(s_markerStackTls);
+    if (stack == NULL) {
+        stack = calloc(1, sizeof(*stack));
+        assert(stack != NULL);
+        SDL_TLSSet(s_markerStackTls, stack, free);
+    }
+    // Deeper markers, such as those of jobs run while a job waits, are
+    // counted so that they pair up but not recorded.
+    if (stack->depth < FRAMEWORK_PROFILE_MAX_DEPTH) {
+        stack->names[stack->depth] = name;
+        stack->starts[stack->depth] = now();
+    }
+    ++stack->depth;
+}
+
+void
+frameworkProfileEnd(void)
+{
+    MarkerStack *stack;
+    Marker marker;
+
+    if (!s_isEnabled) {
+        return;
+    }
+    stack = SDL_TLSGet(s_markerStackTls);
+    assert(stack != NULL && stack->depth > 0 && "frameworkProfileEnd without frameworkProfileBegin");
+    --stack->depth;
+    if (stack->depth >= FRAMEWORK_PROFILE_MAX_DEPTH) {
+        return;
+    }
+    marker.name = stack->names[stack->depth];
+    marker.threadId = SDL_ThreadID();
+    marker.start = stack->starts[stack->depth];
+    marker.duration = now() - marker.start;
+
+    SDL_AtomicLock(&s_markerLock);
+    s_markers = reserve(s_markers, &s_markerCapacity, s_markerCount + 1, sizeof(*s_markers));
+    s_markers[s_markerCount++] = marker;
+    SDL_AtomicUnlock(&s_markerLock);
+}
+
+static void
+endFrame(uint64_t time)
+{
+    if (s_frameCount > 0) {
+        FrameStats *frame = &s_frames[s_frameCount - 1];
+
+        frame->cpuTime = time - frame->start;
+    }
+}
+
+void
+frameworkProfileBeginFrame(void)
+{
+    uint64_t time;
+
+    if (!s_isEnabled) {
+        return;
+    }
+    time = now();
+    endFrame(time);
+    s_frames = reserve(s_frames, &s_frameCapacity, s_frameCount + 1, sizeof(*s_frames));
+    s_frames[s_frameCount++].start = time;
+}
+
+void
+frameworkProfileCountUpload(size_t size)
+{
+    if (s_isEnabled) {
+        s_mappedBytes += size;
+    }
+}
+
+#ifndef GL_ES
+
+// Returns false if the slot's queries are still busy.
+static bool
+collectGpuQueries(GpuQuerySlot *slot, bool isWaiting)
+{
+    GLint isAvailable = GL_TRUE;
+    GLuint64 elapsed;
+    GLuint64 timestamp;
+    GpuFrameStats *frame;
+
+    if (!slot->isPending) {
+        return true;
+    }
+    // The timestamp was queried first, so it is ready when this is.
+    if (!isWaiting) {
+        glGetQueryObjectiv(slot->elapsed, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    }
+    if (!isAvailable) {
+        return false;
+    }
+    glGetQueryObjectui64v(slot->elapsed, GL_QUERY_RESULT, &elapsed);
+    glGetQueryObjectui64v(slot->timestamp, GL_QUERY_RESULT, &timestamp);
+    slot->isPending = false;
+
+    s_gpuFrames = reserve(s_gpuFrames, &s_gpuFrameCapacity, slot->frame + 1, sizeof(*s_gpuFrames));
+    frame = &s_gpuFrames[slot->frame];
+    frame->isTimed = true;
+    frame->start = (int64_t)timestamp + s_gpuClockOffset;
+    frame->gpuTime = elapsed;
+
+    return true;
+}
+
+#endif
+
+void
+frameworkProfileGpuInit(void)
+{
+#ifndef GL_ES
+    GLint64 gpuTime;
+#endif
+
+    glsysEnableCallStats(s_isEnabled);
+#ifndef GL_ES
+    s_hasTimerQuery = s_isEnabled && SDL_GL_ExtensionSupported("GL_ARB_timer_query");
+    if (!s_hasTimerQuery) {
+        return;
+    }
+    for (int i = 0; i < PROFILE_GPU_RING_SIZE; ++i) {
+        glGenQueries(1, &s_gpuSlots[i].elapsed);
+        glGenQueries(1, &s_gpuSlots[i].timestamp);
+    }
+    // Both clocks are read back to back, which is close enough to line
+    // the GPU frames up with the CPU markers.
+    glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+    s_gpuClockOffset = (int64_t)now() - gpuTime;
+#endif
+}
+
+void
+frameworkProfileGpuBeginFrame(void)
+{
+#ifndef GL_ES
+    GpuQuerySlot *slot = &s_gpuSlots[s_gpuFrame % PROFILE_GPU_RING_SIZE];
+
+    if (!s_hasTimerQuery) {
+        return;
+    }
+    for (int i = 0; i < PROFILE_GPU_RING_SIZE; ++i) {
+        collectGpuQueries(&s_gpuSlots[i], false);
+    }
+    s_isGpuFrameTimed = !slot->isPending;
+    if (s_isGpuFrameTimed) {
+        glQueryCounter(slot->timestamp, GL_TIMESTAMP);
+        glBeginQuery(GL_TIME_ELAPSED, slot->elapsed);
+    }
+#endif
+}
+
+void
+frameworkProfileGpuEndFrame(void)
+{
+    GlsysCallStats stats;
+    GpuFrameStats *frame;
+#ifndef GL_ES
+    GpuQuerySlot *slot = &s_gpuSlots[s_gpuFrame % PROFILE_GPU_RING_SIZE];
+
+    if (s_hasTimerQuery && s_isGpuFrameTimed) {
+        glEndQuery(GL_TIME_ELAPSED);
+        slot->frame = s_gpuFrame;
+        slot->isPending = true;
+    }
+#endif
+    if (!s_isEnabled) {
+        return;
+    }
+    glsysGetCallStats(&stats);
+    glsysResetCallStats();
+    s_gpuFrames = reserve(s_gpuFrames, &s_gpuFrameCapacity, s_gpuFrame + 1, sizeof(*s_gpuFrames));
+    frame = &s_gpuFrames[s_gpuFrame];
+    frame->drawCalls = stats.drawCalls;
+    frame->uploadedBytes = stats.uploadedBytes + s_mappedBytes;
+    s_mappedBytes = 0;
+    ++s_gpuFrame;
+}
+
+void
+frameworkProfileGpuShutdown(void)
+{
+#ifndef GL_ES
+    if (!s_hasTimerQuery) {
+        return;
+    }
+    for (int i = 0; i < PROFILE_GPU_RING_SIZE; ++i) {
+        collectGpuQueries(&s_gpuSlots[i], true);
+        glDeleteQueries(1, &s_gpuSlots[i].elapsed);
+        glDeleteQueries(1, &s_gpuSlots[i].timestamp);
+    }
+    s_hasTimerQuery = false;
+#endif
+}
+
+static bool
+isGpuFrameTimed(size_t frame)
+{
+    return frame < s_gpuFrameCapacity && s_gpuFrames[frame].isTimed;
+}
+
+// Zero for the frames never replayed.
+static GpuFrameStats const *
+gpuFrame(size_t frame)
+{
+    static GpuFrameStats const sk_emptyFrame;
+
+    return (frame < s_gpuFrameCapacity) ? &s_gpuFrames[frame] : &sk_emptyFrame;
+}
+
+static int
+compareTimes(const void *a, const void *b)
+{
+    uint64_t const x = *(const uint64_t *)a;
+    uint64_t const y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void
+printTimeSummary(const char *label, uint64_t *times, size_t count)
+{
+    uint64_t sum = 0;
+
+    if (count == 0) {
+        return;
+    }
+    qsort(times, count, sizeof(*times), compareTimes);
+    for (size_t i = 0; i < count; ++i) {
+        sum += times[i];
+    }
+    // The nearest rank, ceil(0.99 count).
+    printf("%s frame ms: min %.3f, avg %.3f, p99 %.3f over %zu frames\n",
+           label,
+           (double)times[0] * 1e-6,
+           (double)sum / (double)count * 1e-6,
+           (double)times[(count * 99 + 99) / 100 - 1] * 1e-6,
+           count);
+}
+
+static void
+printSummary(void)
+{
+    uint64_t *times = malloc((s_frameCount + 1) * sizeof(*times));
+    size_t gpuCount = 0;
+
+    assert(times != NULL);
+    for (size_t i = 0; i < s_frameCount; ++i) {
+        times[i] = s_frames[i].cpuTime;
+    }
+    printTimeSummary("CPU", times, s_frameCount);
+    for (size_t i = 0; i < s_frameCount; ++i) {
+        if (isGpuFrameTimed(i)) {
+            times[gpuCount++] = s_gpuFrames[i].gpuTime;
+        }
+    }
+    printTimeSummary("GPU", times, gpuCount);
+    free(times);
+}
+
+static void
+writeCsv(FILE *file)
+{
+    fprintf(file, "frame,start_ms,cpu_ms,gpu_ms,draw_calls,uploaded_bytes\n");
+    for (size_t i = 0; i < s_frameCount; ++i) {
+        FrameStats const *frame = &s_frames[i];
+
+        fprintf(file, "%zu,%.6f,%.6f,", i, (double)frame->start * 1e-6, (double)frame->cpuTime * 1e-6);
+        if (isGpuFrameTimed(i)) {
+            fprintf(file, "%.6f", (double)s_gpuFrames[i].gpuTime * 1e-6);
+        }
+        fprintf(file, ",%lu,%zu\n", gpuFrame(i)->drawCalls, gpuFrame(i)->uploadedBytes);
+    }
+}
+
+static void
+writeJsonString(FILE *file, const char *string)
+{
+    fputc('"', file);
+    for (; *string != '\0'; ++string) {
+        unsigned char const c = (unsigned char)*string;
+
+        if (c == '"' || c == '\\') {
+            fprintf(file, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// Chrome's trace event format, in microseconds. The CPU frames and
+// markers are process 0, one track per thread; the GPU frames are
+// process 1.
+static void
+writeChromeTrace(FILE *file)
+{
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}");
+    for (size_t i = 0; i < s_frameCount; ++i) {
+        FrameStats const *frame = &s_frames[i];
+
+        fprintf(file, ",\n{\"name\":\"frame %zu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+                i, (double)frame->start * 1e-3, (double)frame->cpuTime * 1e-3);
+        fprintf(file, ",\n{\"name\":\"frame stats\",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,"
+                      "\"args\":{\"draw calls\":%lu,\"uploaded bytes\":%zu}}",
+                (double)frame->start * 1e-3, gpuFrame(i)->drawCalls, gpuFrame(i)->uploadedBytes);
+        if (isGpuFrameTimed(i)) {
+            fprintf(file, ",\n{\"name\":\"frame %zu\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+                    i, (double)s_gpuFrames[i].start * 1e-3, (double)s_gpuFrames[i].gpuTime * 1e-3);
+        }
+    }
+    for (size_t i = 0; i < s_markerCount; ++i) {
+        Marker const *marker = &s_markers[i];
+
+        fprintf(file, ",\n{\"name\":");
+        writeJsonString(file, marker->name);
+        fprintf(file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+                marker->threadId, (double)marker->start * 1e-3, (double)marker->duration * 1e-3);
+    }
+    fprintf(file, "\n]}\n");
+}
+
+bool
+frameworkProfileShutdown(void)
+{
+    size_t const pathLength = (s_path != NULL) ? strlen(s_path) : 0;
+    FILE *file;
+    bool isWritten;
+
+    if (!s_isEnabled) {
+        return true;
+    }
+    endFrame(now());
+    printSummary();
+
+    file = fopen(s_path, "w");
+    isWritten = (file != NULL);
+    if (isWritten) {
+        if (pathLength >= 5 && strcmp(s_path + pathLength - 5, ".json") == 0) {
+            writeChromeTrace(file);
+        } else {
+            writeCsv(file);
+        }
+        isWritten = !ferror(file);
+        isWritten = (fclose(file) == 0) && isWritten;
+    }
+
+    free(s_frames);
+    free(s_markers);
+    free(s_gpuFrames);
+    s_frames = NULL;
+    s_markers = NULL;
+    s_gpuFrames = NULL;
+    s_frameCount = s_frameCapacity = 0;
+    s_markerCount = s_markerCapacity = 0;
+    s_gpuFrameCapacity = 0;
+    s_isEnabled = false;
+
+    return isWritten;
+}
@@ -0,0 +1,554 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+#include "framework.h"
+#include "framework_private.h"
+#include "glsys.h"
+
+// gltutDisplay records frameworkCmd* calls into a linear command buffer
+// that is replayed after it returns. On the render thread, two buffers
+// alternate: the main thread records frame N + 1 into one while the
+// render thread replays frame N from the other and swaps.
+
+#define COMMAND_BUFFER_INITIAL_CAPACITY 4096
+#define COMMAND_ALIGNMENT 8
+
+typedef enum CommandType {
+    COMMAND_VIEWPORT,
+    COMMAND_CLEAR,
+    COMMAND_USE_PROGRAM,
+    COMMAND_ENABLE_VERTEX_ATTRIB_ARRAY,
+    COMMAND_DISABLE_VERTEX_ATTRIB_ARRAY,
+    COMMAND_BIND_BUFFER,
+    COMMAND_VERTEX_ATTRIB_POINTER,
+    COMMAND_BUFFER_SUB_DATA,
+    COMMAND_UNIFORM_1F,
+    COMMAND_UNIFORM_2F,
+    COMMAND_UNIFORM_3F,
+    COMMAND_UNIFORM_MATRIX_4FV,
+    COMMAND_DRAW_ARRAYS,
+    COMMAND_DRAW_ELEMENTS,
+    COMMAND_CALLBACK
+} CommandType;
+
+// Every command is a header followed by its payload, both padded to
+// COMMAND_ALIGNMENT. size covers the header, the payload and any data
+// copied after the payload.
+typedef struct CommandHeader {
+    uint32_t    type;
+    uint32_t    size;
+} CommandHeader;
+
+typedef struct ViewportCommand {
+    GLint       x;
+    GLint       y;
+    GLsizei     width;
+    GLsizei     height;
+} ViewportCommand;
+
+typedef struct ClearCommand {
+    GLfloat     color[4];
+    GLfloat     depth;
+    GLbitfield  mask;
+} ClearCommand;
+
+// Use program, enabling and disabling arrays and binding buffers.
+typedef struct BindCommand {
+    GLenum      target;
+    GLuint      name;
+} BindCommand;
+
+typedef struct VertexAttribPointerCommand {
+    GLuint      index;
+    GLint       size;
+    GLenum      type;
+    GLboolean   normalized;
+    GLsizei     stride;
+    uintptr_t   offset;
+} VertexAttribPointerCommand;
+
+// Followed by size bytes of data.
+typedef struct BufferSubDataCommand {
+    GLenum      target;
+    GLintptr    offset;
+    GLsizeiptr  size;
+} BufferSubDataCommand;
+
+// As many values as the command type takes.
+typedef struct UniformCommand {
+    GLint       location;
+    GLboolean   transpose;
+    GLfloat     values[16];
+} UniformCommand;
+
+typedef struct DrawCommand {
+    GLenum      mode;
+    GLint       first;
+    GLsizei     count;
+    GLenum      type;
+    uintptr_t   offset;
+} DrawCommand;
+
+// Followed by size bytes of data.
+typedef struct CallbackCommand {
+    FrameworkRenderCallback func;
+    size_t                  size;
+} CallbackCommand;
+
+typedef struct CommandBuffer {
+    unsigned char  *data;
+    size_t          size;
+    size_t          capacity;
+} CommandBuffer;
+
+static CommandBuffer    s_commandBuffers[2];
+static size_t           s_recordIndex;
+static size_t           s_replayIndex;
+
+static SDL_Thread      *s_renderThread;
+static SDL_Window      *s_window;
+static SDL_GLContext    s_context;
+static SDL_sem         *s_initialized;
+// Buffers the main thread may record into, and recorded frames.
+static SDL_sem         *s_freeBuffers;
+static SDL_sem         *s_recordedFrames;
+static SDL_atomic_t     s_isStopping;
+// The latest window size, applied by the render thread before replaying.
+static SDL_SpinLock     s_reshapeLock;
+static bool             s_hasReshape;
+static int              s_reshapeWidth;
+static int              s_reshapeHeight;
+
+static size_t
+alignCommandSize(size_t size)
+{
+    return (size + COMMAND_ALIGNMENT - 1) / COMMAND_ALIGNMENT * COMMAND_ALIGNMENT;
+}
+
+// Appends a command with room for dataSize bytes after its payload and
+// returns the payload.
+static void *
+appendCommand(CommandType type, size_t payloadSize, size_t dataSize)
+{
+    CommandBuffer *buffer = &s_commandBuffers[s_recordIndex];
+    size_t const size = alignCommandSize(sizeof(CommandHeader)) + alignCommandSize(payloadSize + dataSize);
+    CommandHeader *header;
+
+    assert(size <= UINT32_MAX);
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = (buffer->capacity > 0) ? buffer->capacity : COMMAND_BUFFER_INITIAL_CAPACITY;
+
+        while (capacity < buffer->size + size) {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data != NULL);
+        buffer->capacity = capacity;
+    }
+    header = (CommandHeader *)(buffer->data + buffer->size);
+    header->type = (uint32_t)type;
+    header->size = (uint32_t)size;
+    buffer->size += size;
+
+    return (unsigned char *)header + alignCommandSize(sizeof(CommandHeader));
+}
+
+static void
+replayCommands(CommandBuffer const *buffer)
+{
+    size_t offset = 0;
+
+    while (offset < buffer->size) {
+        CommandHeader const *header = (CommandHeader const *)(buffer->data + offset);
+        void const *payload = (unsigned char const *)header + alignCommandSize(sizeof(CommandHeader));
+
+        switch ((CommandType)header->type) {
+        case COMMAND_VIEWPORT: {
+            ViewportCommand const *command = payload;
+
+            glViewport(command->x, command->y, command->width, command->height);
+            break;
+        }
+        case COMMAND_CLEAR: {
+            ClearCommand const *command = payload;
+
+            glClearColor(command->color[0], command->color[1], command->color[2], command->color[3]);
+            glClearDepthf(command->depth);
+            glClear(command->mask);
+            break;
+        }
+        case COMMAND_USE_PROGRAM:
+            glUseProgram(((BindCommand const *)payload)->name);
+            break;
+        case COMMAND_ENABLE_VERTEX_ATTRIB_ARRAY:
+            glEnableVertexAttribArray(((BindCommand const *)payload)->name);
+            break;
+        case COMMAND_DISABLE_VERTEX_ATTRIB_ARRAY:
+            glDisableVertexAttribArray(((BindCommand const *)payload)->name);
+            break;
+        case COMMAND_BIND_BUFFER: {
+            BindCommand const *command = payload;
+
+            glBindBuffer(command->target, command->name);
+            break;
+        }
+        case COMMAND_VERTEX_ATTRIB_POINTER: {
+            VertexAttribPointerCommand const *command = payload;
+
+            glVertexAttribPointer(command->index, command->size, command->type, command->normalized,
+                                  command->stride, (void const *)command->offset);
+            break;
+        }
+        case COMMAND_BUFFER_SUB_DATA: {
+            BufferSubDataCommand const *command = payload;
+
+            glBufferSubData(command->target, command->offset, command->size, command + 1);
+            break;
+        }
+        case COMMAND_UNIFORM_1F: {
+            UniformCommand const *command = payload;
+
+            glUniform1f(command->location, command->values[0]);
+            break;
+        }
+        case COMMAND_UNIFORM_2F: {
+            UniformCommand const *command = payload;
+
+            glUniform2f(command->location, command->values[0], command->values[1]);
+            break;
+        }
+        case COMMAND_UNIFORM_3F: {
+            UniformCommand const *command = payload;
+
+            glUniform3f(command->location, command->values[0], command->values[1], command->values[2]);
+            break;
+        }
+        case COMMAND_UNIFORM_MATRIX_4FV: {
+            UniformCommand const *command = payload;
+
+            glUniformMatrix4fv(command->location, 1, command->transpose, command->values);
+            break;
+        }
+        case COMMAND_DRAW_ARRAYS: {
+            DrawCommand const *command = payload;
+
+            glDrawArrays(command->mode, command->first, command->count);
+            break;
+        }
+        case COMMAND_DRAW_ELEMENTS: {
+            DrawCommand const *command = payload;
+
+            glDrawElements(command->mode, command->count, command->type, (void const *)command->offset);
+            break;
+        }
+        case COMMAND_CALLBACK: {
+            CallbackCommand const *command = payload;
+
+            command->func(command + 1, command->size);
+            break;
+        }
+        default:
+            assert(0 && "unknown command");
+            break;
+        }
+        offset += header->size;
+    }
+}
+
+static void
+applyReshape(void)
+{
+    bool hasReshape;
+    int width;
+    int height;
+
+    SDL_AtomicLock(&s_reshapeLock);
+    hasReshape = s_hasReshape;
+    width = s_reshapeWidth;
+    height = s_reshapeHeight;
+    s_hasReshape = false;
+    SDL_AtomicUnlock(&s_reshapeLock);
+
+    if (hasReshape) {
+        gltutReshape(width, height);
+    }
+}
+
+static int
+renderThreadMain(void *unused)
+{
+    (void)unused;
+
+    SDL_GL_MakeCurrent(s_window, s_context);
+    frameworkRenderSystemInit();
+    SDL_SemPost(s_initialized);
+
+    for (;;) {
+        SDL_SemWait(s_recordedFrames);
+        if (SDL_AtomicGet(&s_isStopping) != 0) {
+            break;
+        }
+        applyReshape();
+        frameworkProfileBegin("replay");
+        frameworkProfileGpuBeginFrame();
+        replayCommands(&s_commandBuffers[s_replayIndex]);
+        frameworkProfileGpuEndFrame();
+        frameworkProfileEnd();
+        s_replayIndex ^= 1;
+        SDL_GL_SwapWindow(s_window);
+        SDL_SemPost(s_freeBuffers);
+    }
+    SDL_GL_MakeCurrent(s_window, NULL);
+
+    return 0;
+}
+
+bool
+frameworkRenderThreadStart(SDL_Window *window, SDL_GLContext context)
+{
+    s_window = window;
+    s_context = context;
+    s_initialized = SDL_CreateSemaphore(0);
+    s_freeBuffers = SDL_CreateSemaphore(2);
+    s_recordedFrames = SDL_CreateSemaphore(0);
+    if (s_initialized == NULL || s_freeBuffers == NULL || s_recordedFrames == NULL) {
+        return false;
+    }
+
+    // The context can only be current on one thread.
+    SDL_GL_MakeCurrent(window, NULL);
+    s_renderThread = SDL_CreateThread(renderThreadMain, "gltut render", NULL);
+    if (s_renderThread == NULL) {
+        SDL_GL_MakeCurrent(window, context);
+        return false;
+    }
+    SDL_SemWait(s_initialized);
+
+    return true;
+}
+
+void
+frameworkRenderThreadStop(void)
+{
+    if (s_renderThread == NULL) {
+        return;
+    }
+
+    // Let the render thread finish the frames it has.
+    SDL_SemWait(s_freeBuffers);
+    SDL_SemWait(s_freeBuffers);
+    SDL_AtomicSet(&s_isStopping, 1);
+    SDL_SemPost(s_recordedFrames);
+    SDL_WaitThread(s_renderThread, NULL);
+    s_renderThread = NULL;
+
+    // The main thread deletes the context.
+    SDL_GL_MakeCurrent(s_window, s_context);
+    SDL_DestroySemaphore(s_initialized);
+    SDL_DestroySemaphore(s_freeBuffers);
+    SDL_DestroySemaphore(s_recordedFrames);
+}
+
+void
+frameworkRenderBeginFrame(void)
+{
+    if (s_renderThread != NULL) {
+        SDL_SemWait(s_freeBuffers);
+    }
+    s_commandBuffers[s_recordIndex].size = 0;
+}
+
+void
+frameworkRenderEndFrame(SDL_Window *window)
+{
+    if (s_renderThread != NULL) {
+        SDL_SemPost(s_recordedFrames);
+        s_recordIndex ^= 1;
+    } else {
+        frameworkProfileBegin("replay");
+        frameworkProfileGpuBeginFrame();
+        replayCommands(&s_commandBuffers[s_recordIndex]);
+        frameworkProfileGpuEndFrame();
+        frameworkProfileEnd();
+        SDL_GL_SwapWindow(window);
+    }
+}
+
+void
+frameworkRenderReshape(int width, int height)
+{
+    if (s_renderThread != NULL) {
+        SDL_AtomicLock(&s_reshapeLock);
+        s_hasReshape = true;
+        s_reshapeWidth = width;
+        s_reshapeHeight = height;
+        SDL_AtomicUnlock(&s_reshapeLock);
+    } else {
+        gltutReshape(width, height);
+    }
+}
+
+void
+frameworkCmdViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    ViewportCommand *command = appendCommand(COMMAND_VIEWPORT, sizeof(*command), 0);
+
+    command->x = x;
+    command->y = y;
+    command->width = width;
+    command->height = height;
+}
+
+void
+frameworkCmdClear(const GLfloat color[4], GLfloat depth, GLbitfield mask)
+{
+    ClearCommand *command = appendCommand(COMMAND_CLEAR, sizeof(*command), 0);
+
+    memcpy(command->color, color, sizeof(command->color));
+    command->depth = depth;
+    command->mask = mask;
+}
+
+static void
+appendBind(CommandType type, GLenum target, GLuint name)
+{
+    BindCommand *command = appendCommand(type, sizeof(*command), 0);
+
+    command->target = target;
+    command->name = name;
+}
+
+void
+frameworkCmdUseProgram(GLuint program)
+{
+    appendBind(COMMAND_USE_PROGRAM, 0, program);
+}
+
+void
+frameworkCmdEnableVertexAttribArray(GLuint index)
+{
+    appendBind(COMMAND_ENABLE_VERTEX_ATTRIB_ARRAY, 0, index);
+}
+
+void
+frameworkCmdDisableVertexAttribArray(GLuint index)
+{
+    appendBind(COMMAND_DISABLE_VERTEX_ATTRIB_ARRAY, 0, index);
+}
+
+void
+frameworkCmdBindBuffer(GLenum target, GLuint buffer)
+{
+    appendBind(COMMAND_BIND_BUFFER, target, buffer);
+}
+
+void
+frameworkCmdVertexAttribPointer(GLuint index,
+                                GLint size,
+                                GLenum type,
+                                GLboolean normalized,
+                                GLsizei stride,
+                                uintptr_t offset)
+{
+    VertexAttribPointerCommand *command = appendCommand(COMMAND_VERTEX_ATTRIB_POINTER, sizeof(*command), 0);
+
+    command->index = index;
+    command->size = size;
+    command->type = type;
+    command->normalized = normalized;
+    command->stride = stride;
+    command->offset = offset;
+}
+
+void
+frameworkCmdBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    BufferSubDataCommand *command = appendCommand(COMMAND_BUFFER_SUB_DATA, sizeof(*command), (size_t)size);
+
+    command->target = target;
+    command->offset = offset;
+    command->size = size;
+    memcpy(command + 1, data, (size_t)size);
+}
+
+static void
+appendUniform(CommandType type, GLint location, const GLfloat *values, size_t count)
+{
+    UniformCommand *command = appendCommand(type, sizeof(*command), 0);
+
+    command->location = location;
+    command->transpose = GL_FALSE;
+    memcpy(command->values, values, count * sizeof(*values));
+}
+
+void
+frameworkCmdUniform1f(GLint location, GLfloat v0)
+{
+    appendUniform(COMMAND_UNIFORM_1F, location, &v0, 1);
+}
+
+void
+frameworkCmdUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    GLfloat const values[2] = {v0, v1};
+
+    appendUniform(COMMAND_UNIFORM_2F, location, values, 2);
+}
+
+void
+frameworkCmdUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    GLfloat const values[3] = {v0, v1, v2};
+
+    appendUniform(COMMAND_UNIFORM_3F, location, values, 3);
+}
+
+void
+frameworkCmdUniformMatrix4fv(GLint location, GLboolean transpose, const GLfloat *value)
+{
+    UniformCommand *command = appendCommand(COMMAND_UNIFORM_MATRIX_4FV, sizeof(*command), 0);
+
+    command->location = location;
+    command->transpose = transpose;
+    memcpy(command->values, value, sizeof(command->values));
+}
+
+void
+frameworkCmdDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    DrawCommand *command = appendCommand(COMMAND_DRAW_ARRAYS, sizeof(*command), 0);
+
+    command->mode = mode;
+    command->first = first;
+    command->count = count;
+    command->type = 0;
+    command->offset = 0;
+}
+
+void
+frameworkCmdDrawElements(GLenum mode, GLsizei count, GLenum type, uintptr_t offset)
+{
+    DrawCommand *command = appendCommand(COMMAND_DRAW_ELEMENTS, sizeof(*command), 0);
+
+    command->mode = mode;
+    command->first = 0;
+    command->count = count;
+    command->type = type;
+    command->offset = offset;
+}
+
+void
+frameworkCmdCallback(FrameworkRenderCallback func, const void *data, size_t size)
+{
+    CallbackCommand *command = appendCommand(COMMAND_CALLBACK, sizeof(*command), size);
+
+    command->func = func;
+    command->size = size;
+    if (size > 0) {
+        memcpy(command + 1, data, size);
+    }
+}
@@ -0,0 +1,209 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "framework.h"
+#include "framework_private.h"
+
+#ifndef GL_ES
+
+// The buffer is mapped once, persistently and coherently, so that the
+// CPU writes land in it with no GL call. Each frame's allocations end
+// with a fence; the ring only waits on one when it is about to write
+// over data a frame still in flight may read.
+
+#define STREAM_MAX_FRAMES 4
+// The largest base alignment of a std140 member, a vec4.
+#define STREAM_DEFAULT_ALIGNMENT 16
+
+typedef struct StreamFence {
+    GLsync  sync;
+    // The head when the frame was fenced.
+    size_t  end;
+} StreamFence;
+
+struct FrameworkStreamBuffer {
+    GLenum          target;
+    GLuint          buffer;
+    unsigned char  *data;
+    size_t          size;
+    size_t          alignment;
+    // Positions count the bytes since the buffer was created, so that
+    // they only grow; the offset in the buffer is a position modulo the
+    // size. The GPU may still read anything from tail to head.
+    size_t          head;
+    size_t          tail;
+    StreamFence     fences[STREAM_MAX_FRAMES];
+    size_t          firstFence;
+    size_t          fenceCount;
+};
+
+static size_t
+roundUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static void
+waitOldestFence(FrameworkStreamBuffer *stream)
+{
+    StreamFence *fence = &stream->fences[stream->firstFence];
+    GLenum status;
+
+    assert(stream->fenceCount > 0);
+    // Flushes once, so that the wait cannot be on commands never sent.
+    status = glClientWaitSync(fence->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence->sync, 0, 1000000);
+    }
+    assert(status != GL_WAIT_FAILED);
+    glDeleteSync(fence->sync);
+    stream->tail = fence->end;
+    stream->firstFence = (stream->firstFence + 1) % STREAM_MAX_FRAMES;
+    --stream->fenceCount;
+}
+
+FrameworkStreamBuffer *
+frameworkStreamBufferCreate(GLenum target, size_t size)
+{
+    GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    FrameworkStreamBuffer *stream;
+    GLint alignment = STREAM_DEFAULT_ALIGNMENT;
+
+    if (!SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")) {
+        return NULL;
+    }
+    stream = calloc(1, sizeof(*stream));
+    assert(stream != NULL);
+    if (target == GL_UNIFORM_BUFFER) {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    }
+    assert(alignment > 0);
+    stream->target = target;
+    stream->alignment = (size_t)alignment;
+    // Wrapping to the start keeps allocations aligned.
+    stream->size = roundUp(size, stream->alignment);
+
+    glGenBuffers(1, &stream->buffer);
+    glBindBuffer(target, stream->buffer);
+    glBufferStorage(target, (GLsizeiptr)stream->size, NULL, flags);
+    stream->data = glMapBufferRange(target, 0, (GLsizeiptr)stream->size, flags);
+    glBindBuffer(target, 0);
+    if (stream->data == NULL) {
+        glDeleteBuffers(1, &stream->buffer);
+        free(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+void
+frameworkStreamBufferDestroy(FrameworkStreamBuffer *stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+    while (stream->fenceCount > 0) {
+        waitOldestFence(stream);
+    }
+    // Deleting the buffer unmaps it.
+    glDeleteBuffers(1, &stream->buffer);
+    free(stream);
+}
+
+void *
+frameworkStreamBufferAlloc(FrameworkStreamBuffer *stream, size_t size, GLintptr *pOffset)
+{
+    size_t position = roundUp(stream->head, stream->alignment);
+
+    assert(size > 0 && size <= stream->size);
+    if ((position % stream->size) + size > stream->size) {
+        // Allocations are never split across the end of the buffer.
+        position = roundUp(position, stream->size);
+    }
+    while (position + size - stream->tail > stream->size) {
+        if (stream->fenceCount == 0) {
+            // Only the current frame is left in the ring.
+            return NULL;
+        }
+        waitOldestFence(stream);
+    }
+
+    stream->head = position + size;
+    *pOffset = (GLintptr)(position % stream->size);
+    frameworkProfileCountUpload(size);
+
+    return stream->data + *pOffset;
+}
+
+void
+frameworkStreamBufferBindRange(FrameworkStreamBuffer *stream, GLuint index, GLintptr offset, GLsizeiptr size)
+{
+    glBindBufferRange(stream->target, index, stream->buffer, offset, size);
+}
+
+void
+frameworkStreamBufferEndFrame(FrameworkStreamBuffer *stream)
+{
+    StreamFence *fence;
+
+    if (stream->fenceCount == STREAM_MAX_FRAMES) {
+        waitOldestFence(stream);
+    }
+    fence = &stream->fences[(stream->firstFence + stream->fenceCount) % STREAM_MAX_FRAMES];
+    fence->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fence->end = stream->head;
+    ++stream->fenceCount;
+}
+
+#else // GL_ES
+
+// OpenGL ES 2.0 has neither buffer storage nor uniform buffers.
+
+FrameworkStreamBuffer *
+frameworkStreamBufferCreate(GLenum target, size_t size)
+{
+    (void)target;
+    (void)size;
+
+    return NULL;
+}
+
+void
+frameworkStreamBufferDestroy(FrameworkStreamBuffer *stream)
+{
+    assert(stream == NULL);
+    (void)stream;
+}
+
+void *
+frameworkStreamBufferAlloc(FrameworkStreamBuffer *stream, size_t size, GLintptr *pOffset)
+{
+    (void)stream;
+    (void)size;
+    (void)pOffset;
+    assert(0);
+
+    return NULL;
+}
+
+void
+frameworkStreamBufferBindRange(FrameworkStreamBuffer *stream, GLuint index, GLintptr offset, GLsizeiptr size)
+{
+    (void)stream;
+    (void)index;
+    (void)offset;
+    (void)size;
+    assert(0);
+}
+
+void
+frameworkStreamBufferEndFrame(FrameworkStreamBuffer *stream)
+{
+    (void)stream;
+    assert(0);
+}
+
+#endif // GL_ES
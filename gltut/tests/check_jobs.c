@@ -0,0 +1,231 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "SDL.h"
+#include "framework.h"
+#include "framework_private.h"
+#include "greatest.h"
+
+// The scheduling differs from run to run, but every check below is on
+// what must hold for any order, so the results do not.
+
+// Enough for several parallel-for ranges on every thread.
+#define TEST_INDEX_COUNT 1000
+// Past two relay jobs' worth of dependents.
+#define TEST_DEPENDENT_COUNT 50
+// Each test repeats its frame to give races a chance to show.
+#define TEST_FRAME_COUNT 50
+
+typedef struct OrderedJob {
+    SDL_atomic_t   *pNext;
+    int             position;
+} OrderedJob;
+
+typedef struct DependentJob {
+    SDL_atomic_t   *pIsDependencyDone;
+    SDL_atomic_t   *pRunCount;
+    SDL_atomic_t   *pEarlyCount;
+} DependentJob;
+
+static SDL_atomic_t s_hits[TEST_INDEX_COUNT];
+
+static void
+countRange(void *context, size_t first, size_t end)
+{
+    (void)context;
+    for (size_t i = first; i < end; ++i) {
+        SDL_AtomicAdd(&s_hits[i], 1);
+    }
+}
+
+static void
+takePosition(void *context)
+{
+    OrderedJob *job = context;
+
+    job->position = SDL_AtomicAdd(job->pNext, 1);
+}
+
+static void
+markDone(void *context)
+{
+    SDL_AtomicSet(context, 1);
+}
+
+static void
+checkDependency(void *context)
+{
+    DependentJob const *job = context;
+
+    if (SDL_AtomicGet(job->pIsDependencyDone) == 0) {
+        SDL_AtomicAdd(job->pEarlyCount, 1);
+    }
+    SDL_AtomicAdd(job->pRunCount, 1);
+}
+
+static void
+increment(void *context)
+{
+    SDL_AtomicAdd(context, 1);
+}
+
+TEST
+parallelForVisitsEachIndexOnce(void)
+{
+    static size_t const sk_cases[][2] = {
+        // count, minRangeSize
+        {0, 1},
+        {1, 1},
+        {7, 1},
+        {TEST_INDEX_COUNT, 1},
+        {TEST_INDEX_COUNT, 64},
+        {TEST_INDEX_COUNT, 2 * TEST_INDEX_COUNT}
+    };
+
+    for (size_t c = 0; c < sizeof(sk_cases) / sizeof(sk_cases[0]); ++c) {
+        size_t const count = sk_cases[c][0];
+
+        for (int frame = 0; frame < TEST_FRAME_COUNT; ++frame) {
+            for (size_t i = 0; i < TEST_INDEX_COUNT; ++i) {
+                SDL_AtomicSet(&s_hits[i], 0);
+            }
+            frameworkParallelFor(count, sk_cases[c][1], countRange, NULL);
+            for (size_t i = 0; i < TEST_INDEX_COUNT; ++i) {
+                ASSERT_EQ((i < count) ? 1 : 0, SDL_AtomicGet(&s_hits[i]));
+            }
+            frameworkJobSystemEndFrame();
+        }
+    }
+    PASS();
+}
+
+TEST
+dependenciesRunFirst(void)
+{
+    for (int frame = 0; frame < TEST_FRAME_COUNT; ++frame) {
+        SDL_atomic_t next;
+        OrderedJob ordered[4];
+        FrameworkJob *jobs[4];
+
+        // 0 before 1 and 2, which are both before 3. The jobs are
+        // submitted last first, so only the dependencies hold them back.
+        SDL_AtomicSet(&next, 0);
+        for (int i = 0; i < 4; ++i) {
+            ordered[i].pNext = &next;
+            ordered[i].position = -1;
+            jobs[i] = frameworkJobCreate(takePosition, &ordered[i]);
+        }
+        frameworkJobAddDependency(jobs[1], jobs[0]);
+        frameworkJobAddDependency(jobs[2], jobs[0]);
+        frameworkJobAddDependency(jobs[3], jobs[1]);
+        frameworkJobAddDependency(jobs[3], jobs[2]);
+        for (int i = 3; i >= 0; --i) {
+            frameworkJobSubmit(jobs[i]);
+        }
+        frameworkJobWait(jobs[3]);
+
+        ASSERT_EQ(0, ordered[0].position);
+        ASSERT(ordered[1].position > 0 && ordered[1].position < 3);
+        ASSERT(ordered[2].position > 0 && ordered[2].position < 3);
+        ASSERT_EQ(3, ordered[3].position);
+        frameworkJobSystemEndFrame();
+    }
+    PASS();
+}
+
+TEST
+manyDependentsWaitForTheirDependency(void)
+{
+    for (int frame = 0; frame < TEST_FRAME_COUNT; ++frame) {
+        SDL_atomic_t isDone;
+        SDL_atomic_t runCount;
+        SDL_atomic_t earlyCount;
+        DependentJob dependents[TEST_DEPENDENT_COUNT];
+        FrameworkJob *dependency;
+
+        SDL_AtomicSet(&isDone, 0);
+        SDL_AtomicSet(&runCount, 0);
+        SDL_AtomicSet(&earlyCount, 0);
+        dependency = frameworkJobCreate(markDone, &isDone);
+        for (int i = 0; i < TEST_DEPENDENT_COUNT; ++i) {
+            FrameworkJob *job;
+
+            dependents[i].pIsDependencyDone = &isDone;
+            dependents[i].pRunCount = &runCount;
+            dependents[i].pEarlyCount = &earlyCount;
+            job = frameworkJobCreate(checkDependency, &dependents[i]);
+            frameworkJobAddDependency(job, dependency);
+            frameworkJobSubmit(job);
+        }
+        frameworkJobSubmit(dependency);
+        frameworkJobSystemEndFrame();
+
+        ASSERT_EQ(TEST_DEPENDENT_COUNT, SDL_AtomicGet(&runCount));
+        ASSERT_EQ(0, SDL_AtomicGet(&earlyCount));
+    }
+    PASS();
+}
+
+TEST
+endFrameWaitsForEveryJob(void)
+{
+    for (int frame = 0; frame < TEST_FRAME_COUNT; ++frame) {
+        SDL_atomic_t count;
+
+        SDL_AtomicSet(&count, 0);
+        for (int i = 0; i < TEST_DEPENDENT_COUNT; ++i) {
+            frameworkJobSubmit(frameworkJobCreate(increment, &count));
+        }
+        frameworkJobSystemEndFrame();
+
+        ASSERT_EQ(TEST_DEPENDENT_COUNT, SDL_AtomicGet(&count));
+    }
+    PASS();
+}
+
+TEST
+frameGraphRunsTasksInOrder(void)
+{
+    for (int frame = 0; frame < TEST_FRAME_COUNT; ++frame) {
+        SDL_atomic_t next;
+        OrderedJob ordered[FRAMEWORK_FRAME_GRAPH_MAX_TASKS];
+        FrameworkFrameGraph graph;
+
+        // Each task depends on the one before it.
+        SDL_AtomicSet(&next, 0);
+        frameworkFrameGraphInit(&graph);
+        for (size_t i = 0; i < FRAMEWORK_FRAME_GRAPH_MAX_TASKS; ++i) {
+            size_t const previous = i - 1;
+
+            ordered[i].pNext = &next;
+            ordered[i].position = -1;
+            frameworkFrameGraphAddTask(&graph, takePosition, &ordered[i],
+                                       (i > 0) ? &previous : NULL, (i > 0) ? 1 : 0);
+        }
+        frameworkFrameGraphRun(&graph);
+
+        for (int i = 0; i < FRAMEWORK_FRAME_GRAPH_MAX_TASKS; ++i) {
+            ASSERT_EQ(i, ordered[i].position);
+        }
+        frameworkJobSystemEndFrame();
+    }
+    PASS();
+}
+
+GREATEST_MAIN_DEFS();
+
+int
+main(int argc, char *argv[])
+{
+    GREATEST_MAIN_BEGIN();
+
+    frameworkJobSystemInit();
+    RUN_TEST(parallelForVisitsEachIndexOnce);
+    RUN_TEST(dependenciesRunFirst);
+    RUN_TEST(manyDependentsWaitForTheirDependency);
+    RUN_TEST(endFrameWaitsForEveryJob);
+    RUN_TEST(frameGraphRunsTasksInOrder);
+    frameworkJobSystemShutdown();
+
+    GREATEST_MAIN_END();
+}
@@ -4,9 +4,12 @@
 #include <stdlib.h>
 #include "SDL_timer.h"
 #include "framework.h"
+#include "frustum.h"
 #include "glsys.h"
 #include "matrix.h"
+#include "quaternion.h"
 #include "scalar.h"
+#include "transform.h"
 #include "vector.h"
 
 #define ARRAY_COUNT(array) (sizeof(array)/sizeof(array[0]))
@@ -16,21 +19,31 @@
 #define RED_COLOR   1.0f, 0.0f, 0.0f, 1.0f
 #define BROWN_COLOR 0.5f, 0.5f, 0.0f, 1.0f
 
+// Enough for every instance of several frames in flight, each padded to
+// the largest GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT drivers use.
+#define INSTANCE_STREAM_SIZE (64 * 1024)
+#define INSTANCE_BLOCK_BINDING 0
+
 typedef enum EVertexAttrIndex {
     VERTEX_ATTR_INDEX_POSITION,
     VERTEX_ATTR_INDEX_COLOR
 } EVertexAttrIndex;
 
-typedef void (*InstanceTransformFunc)(TmMat4 *,float);
+typedef TmQuat (*InstanceRotationFunc)(float);
+
+typedef struct Instance {
+    InstanceRotationFunc    rotationFunc;
+    TmVec3                  offset;
+} Instance;
 
-static void     nullRotation(TmMat4 *pOut, float elapsedTime);
-static void     rotateX(TmMat4 *pOut, float elapsedTime);
-static void     rotateY(TmMat4 *pOut, float elapsedTime);
-static void     rotateZ(TmMat4 *pOut, float elapsedTime);
-static void     rotateAxis(TmMat4 *pOut, float elapsedTime);
+static TmQuat   nullRotation(float elapsedTime);
+static TmQuat   rotateX(float elapsedTime);
+static TmQuat   rotateY(float elapsedTime);
+static TmQuat   rotateZ(float elapsedTime);
+static TmQuat   rotateAxis(float elapsedTime);
 static float    computeAngleRadians(float elapsedTime, float loopDuration);
 static float    calcFrustumScale(float fovDegrees);
-static void     constructInstanceMatrix(TmMat4 *pOut, InstanceTransformFunc transformFunc, float elapsedTime);
+static void     initializeInstances();
 static void     initializeProgram();
 static void     initializeVertexBuffer();
 static void     initializeVertexArray();
@@ -45,8 +58,21 @@ static GLuint s_theProgram;
 static GLint  s_modelToCameraMatrixUnif;
 static GLint  s_cameraToClipMatrixUnif;
 
+#ifndef GL_ES
+// Each draw's model to camera matrix is written here when the driver
+// supports persistent mapping, instead of with glUniformMatrix4fv, and
+// read by s_blockProgram. s_theProgram draws whatever does not fit.
+static FrameworkStreamBuffer *s_instanceStream;
+static GLuint s_blockProgram;
+static GLint  s_blockCameraToClipMatrixUnif;
+#endif
+
 static int const sk_numberOfVertices = 8;
 
+// Bounds every vertex below; the instances only rotate and translate,
+// so it also bounds them in camera space.
+static TmScalar const sk_boundingRadius = 1.7320508f;
+
 static float const sk_vertexData[] = {
     +1.0f, +1.0f, +1.0f,
     -1.0f, -1.0f, +1.0f,
@@ -95,6 +121,23 @@ calcFrustumScale(float fovDegrees)
     return 1.0f / tan(fovRadians / 2.0f);
 }
 
+static void
+uploadCameraToClipMatrix(void)
+{
+    TmMat4f upload;
+
+    tmMat4ToFloat(&upload, &s_cameraToClipMatrix);
+    glUseProgram(s_theProgram);
+    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&upload);
+#ifndef GL_ES
+    if (s_blockProgram != 0) {
+        glUseProgram(s_blockProgram);
+        glUniformMatrix4fv(s_blockCameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&upload);
+    }
+#endif
+    glUseProgram(0);
+}
+
 static void
 initializeProgram()
 {
@@ -111,9 +154,26 @@ initializeProgram()
                                          fragmentShader,
                                          skShaderAttribLocations,
                                          ARRAY_COUNT(skShaderAttribLocations));
-
     s_modelToCameraMatrixUnif = glGetUniformLocation(s_theProgram, "u_modelToCameraMatrix");
     s_cameraToClipMatrixUnif = glGetUniformLocation(s_theProgram, "u_cameraToClipMatrix");
+    glDeleteShader(vertexShader);
+
+#ifndef GL_ES
+    s_instanceStream = frameworkStreamBufferCreate(GL_UNIFORM_BUFFER, INSTANCE_STREAM_SIZE);
+    if (s_instanceStream != NULL) {
+        vertexShader = frameworkLoadShader(GL_VERTEX_SHADER, "pos_color_block_transform.vert");
+        s_blockProgram = frameworkCreateProgram(vertexShader,
+                                                fragmentShader,
+                                                skShaderAttribLocations,
+                                                ARRAY_COUNT(skShaderAttribLocations));
+        glUniformBlockBinding(s_blockProgram,
+                              glGetUniformBlockIndex(s_blockProgram, "InstanceBlock"),
+                              INSTANCE_BLOCK_BINDING);
+        s_blockCameraToClipMatrixUnif = glGetUniformLocation(s_blockProgram, "u_cameraToClipMatrix");
+        glDeleteShader(vertexShader);
+    }
+#endif
+    glDeleteShader(fragmentShader);
 
     s_frustumScale = calcFrustumScale(45.0f);
     s_cameraToClipMatrix.m11 = s_frustumScale;
@@ -121,13 +181,8 @@ initializeProgram()
     s_cameraToClipMatrix.m33 = (sk_zFar + sk_zNear) / (sk_zNear - sk_zFar);
     s_cameraToClipMatrix.m43 = -1.0f;
     s_cameraToClipMatrix.m34 = (2.0 * sk_zFar * sk_zNear) / (sk_zNear - sk_zFar);
-    
-    glUseProgram(s_theProgram);
-    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&s_cameraToClipMatrix);
-    glUseProgram(0);
-    
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+
+    uploadCameraToClipMatrix();
 }
 
 static void
@@ -158,10 +213,7 @@ void
 gltutReshape(int width, int height)
 {
     s_cameraToClipMatrix.m11 = s_frustumScale * (height / (float)width);
-
-    glUseProgram(s_theProgram);
-    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&s_cameraToClipMatrix);
-    glUseProgram(0);
+    uploadCameraToClipMatrix();
 
     glViewport(0, 0, (GLsizei)width, (GLsizei)height);
 }
@@ -183,6 +235,7 @@ gltutPostRenderSystemInit(void)
     initializeProgram();
     initializeVertexBuffer();
     initializeVertexArray();
+    initializeInstances();
 
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
@@ -203,119 +256,104 @@ computeAngleRadians(float elapsedTime, float loopDuration)
     return currentTimeThroughLoop * scale;
 }
 
-void
-nullRotation(TmMat4 *pOut, float elapsedTime)
+TmQuat
+nullRotation(float elapsedTime)
 {
-    (void) elapsedTime;
- 
-    pOut->m34 = -25.0f;
+    (void)elapsedTime;
+
+    return TM_QUAT_IDENTITY;
 }
 
-void
-rotateX(TmMat4 *pOut, float elapsedTime)
+TmQuat
+rotateX(float elapsedTime)
 {
-    float const angleRadians = computeAngleRadians(elapsedTime, 3.0f);
-    float const angleCos = cosf(angleRadians);
-    float const angleSin = sinf(angleRadians);
-
-    pOut->m22 = angleCos;
-    pOut->m23 = -angleSin;
-    pOut->m32 = angleSin;
-    pOut->m33 = angleCos;
-    
-    pOut->m14 = -5.0f;
-    pOut->m24 = -5.0f;
-    pOut->m34 = -25.0f;
+    TmVec3 const axis = {1.0f, 0.0f, 0.0f};
+    TmQuat rotation;
+
+    return *tmQuatFromAxisAngle(&rotation, &axis, computeAngleRadians(elapsedTime, 3.0f));
 }
 
-void
-rotateY(TmMat4 *pOut, float elapsedTime)
+TmQuat
+rotateY(float elapsedTime)
 {
-    float const angleRadians = computeAngleRadians(elapsedTime, 2.0f);
-    float const angleCos = cosf(angleRadians);
-    float const angleSin = sinf(angleRadians);
-
-    pOut->m11 = angleCos;
-    pOut->m13 = angleSin;
-    pOut->m31 = -angleSin;
-    pOut->m33 = angleCos;
-    
-    pOut->m14 = -5.0f;
-    pOut->m24 = 5.0f;
-    pOut->m34 = -25.0f;
+    TmVec3 const axis = {0.0f, 1.0f, 0.0f};
+    TmQuat rotation;
+
+    return *tmQuatFromAxisAngle(&rotation, &axis, computeAngleRadians(elapsedTime, 2.0f));
 }
 
-void
-rotateZ(TmMat4 *pOut, float elapsedTime)
+TmQuat
+rotateZ(float elapsedTime)
 {
-    float const angleRadians = computeAngleRadians(elapsedTime, 2.0f);
-    float const angleCos = cosf(angleRadians);
-    float const angleSin = sinf(angleRadians);
-
-    pOut->m11 = angleCos;
-    pOut->m12 = -angleSin;
-    pOut->m21 = angleSin;
-    pOut->m22 = angleCos;
-    
-    pOut->m14 = 5.0f;
-    pOut->m24 = 5.0f;
-    pOut->m34 = -25.0f;
+    TmVec3 const axis = {0.0f, 0.0f, 1.0f};
+    TmQuat rotation;
+
+    return *tmQuatFromAxisAngle(&rotation, &axis, computeAngleRadians(elapsedTime, 2.0f));
 }
 
-void
-rotateAxis(TmMat4 *pOut, float elapsedTime)
+TmQuat
+rotateAxis(float elapsedTime)
 {
-    float const angleRadians = computeAngleRadians(elapsedTime, 2.0f);
-    float const cosine = cosf(angleRadians);
-    float const oneMinusCosine = 1.0f - cosine;
-    float const sine = sinf(angleRadians);
-
-    TmVec3 axisOriginal = {1.0f, 1.0f, 1.0f};
+    TmVec3 const axisOriginal = {1.0f, 1.0f, 1.0f};
     TmVec3 axis;
+    TmQuat rotation;
 
     tmVec3Normalize(&axis, &axisOriginal);
 
-    pOut->m11 = (axis.x * axis.x) + ((1.0f - axis.x * axis.x) * cosine);
-    pOut->m12 = axis.x * axis.y * oneMinusCosine - (axis.z * sine);
-    pOut->m13 = axis.x * axis.z * oneMinusCosine + (axis.y * sine);
+    return *tmQuatFromAxisAngle(&rotation, &axis, computeAngleRadians(elapsedTime, 2.0f));
+}
 
-    pOut->m21 = axis.x * axis.y * oneMinusCosine + (axis.z * sine);
-    pOut->m22 = (axis.y * axis.y) + ((1.0f - axis.y * axis.y) * cosine);
-    pOut->m23 = axis.y * axis.z * oneMinusCosine - (axis.x * sine);
+static Instance const sk_instances[] = {
+    {.rotationFunc=nullRotation, .offset={0.0f, 0.0f, -25.0f}},
+    {.rotationFunc=rotateX, .offset={-5.0f, -5.0f, -25.0f}},
+    {.rotationFunc=rotateY, .offset={-5.0f, 5.0f, -25.0f}},
+    {.rotationFunc=rotateZ, .offset={5.0f, 5.0f, -25.0f}},
+    {.rotationFunc=rotateAxis, .offset={5.0f, -5.0f, -25.0f}}
+};
 
-    pOut->m31 = axis.x * axis.z * oneMinusCosine - (axis.y * sine);
-    pOut->m32 = axis.y * axis.z * oneMinusCosine + (axis.x * sine);
-    pOut->m33 = (axis.z * axis.z) + ((1.0f - axis.z * axis.z) * cosine);
+// Instances before this one never change.
+static size_t const sk_staticInstanceCount = 1;
 
-    pOut->m14 = 5.0f;
-    pOut->m24 = -5.0f;
-    pOut->m34 = -25.0f;
-}
+// One node per instance, in the order of sk_instances.
+static TmTransformHierarchy s_instances;
 
 void
-constructInstanceMatrix(TmMat4 *pOut, InstanceTransformFunc transformFunc, float elapsedTime)
+initializeInstances(void)
 {
-    *pOut = TM_MAT4_IDENTITY;
-    transformFunc(pOut, elapsedTime);
-}
+    bool isInitialized = tmTransformHierarchyInit(&s_instances, ARRAY_COUNT(sk_instances));
 
-static InstanceTransformFunc s_instanceFunctions[] = {nullRotation,
-                                                      rotateX,
-                                                      rotateY,
-                                                      rotateZ,
-                                                      rotateAxis};
+    assert(isInitialized);
+    (void)isInitialized;
+    for (size_t i = 0; i < ARRAY_COUNT(sk_instances); ++i) {
+        TmQuat const rotation = sk_instances[i].rotationFunc(0.0f);
+        uint32_t const node = tmTransformHierarchyAdd(&s_instances, TM_TRANSFORM_NO_PARENT);
+
+        tmTransformHierarchySetTranslation(&s_instances, node, &sk_instances[i].offset);
+        tmTransformHierarchySetRotation(&s_instances, node, &rotation);
+    }
+}
 
 void
 gltutDisplay(void)
 {
+    size_t const instanceCount = ARRAY_COUNT(sk_instances);
+    TmSphere bounds[ARRAY_COUNT(sk_instances)];
+    uint32_t visible[TM_FRUSTUM_MASK_WORDS(ARRAY_COUNT(sk_instances))];
+    TmFrustum frustum;
     uintptr_t colorDataOffset;
     float elapsedTime;
+    bool isStreaming = false;
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClearDepthf(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+#ifndef GL_ES
+    isStreaming = (s_instanceStream != NULL);
+    glUseProgram(isStreaming ? s_blockProgram : s_theProgram);
+#else
     glUseProgram(s_theProgram);
+#endif
 
     glEnableVertexAttribArray(VERTEX_ATTR_INDEX_POSITION);
     glEnableVertexAttribArray(VERTEX_ATTR_INDEX_COLOR);
@@ -327,14 +365,58 @@ gltutDisplay(void)
     glVertexAttribPointer(VERTEX_ATTR_INDEX_COLOR, 4, GL_FLOAT, GL_FALSE, 0, (void *)colorDataOffset);
 
     elapsedTime = SDL_GetTicks() / 1000.0f;
-    for (size_t i = 0; i < ARRAY_COUNT(s_instanceFunctions); ++i) {
-        TmMat4 modelToCamera;
+    // Only the rotating instances are touched; the update skips the rest.
+    for (size_t i = sk_staticInstanceCount; i < instanceCount; ++i) {
+        TmQuat const rotation = sk_instances[i].rotationFunc(elapsedTime);
+
+        tmTransformHierarchySetRotation(&s_instances, (uint32_t)i, &rotation);
+    }
+    tmTransformHierarchyUpdate(&s_instances);
+    for (size_t i = 0; i < instanceCount; ++i) {
+        TmMat4 const *modelToCamera = &s_instances.worlds[i];
 
-        constructInstanceMatrix(&modelToCamera, s_instanceFunctions[i], elapsedTime);
-        glUniformMatrix4fv(s_modelToCameraMatrixUnif, 1, GL_FALSE, (GLfloat *)&modelToCamera);
-        glDrawElements(GL_TRIANGLES, ARRAY_COUNT(sk_indexData), GL_UNSIGNED_SHORT, 0);
+        bounds[i].center = (TmVec3){modelToCamera->m14, modelToCamera->m24, modelToCamera->m34};
+        bounds[i].radius = sk_boundingRadius;
     }
 
+    // Only instances that may be on screen are submitted.
+    tmFrustumFromMat4(&frustum, &s_cameraToClipMatrix);
+    tmFrustumCullSphereBatch(visible, &frustum, bounds, instanceCount);
+    for (size_t word = 0; word < ARRAY_COUNT(visible); ++word) {
+        for (uint32_t bits = visible[word]; bits != 0; bits &= bits - 1) {
+            size_t const i = (word * 32) + (size_t)__builtin_ctz(bits);
+
+#ifndef GL_ES
+            if (isStreaming) {
+                GLintptr offset;
+                TmMat4f *upload = frameworkStreamBufferAlloc(s_instanceStream, sizeof(*upload), &offset);
+
+                if (upload != NULL) {
+                    tmMat4ToFloat(upload, &s_instances.worlds[i]);
+                    frameworkStreamBufferBindRange(s_instanceStream, INSTANCE_BLOCK_BINDING, offset, sizeof(*upload));
+                } else {
+                    // The ring cannot hold the frame; the rest of it
+                    // is drawn with uniforms.
+                    isStreaming = false;
+                    glUseProgram(s_theProgram);
+                }
+            }
+#endif
+            if (!isStreaming) {
+                TmMat4f upload;
+
+                glUniformMatrix4fv(s_modelToCameraMatrixUnif, 1, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_instances.worlds[i]));
+            }
+            glDrawElements(GL_TRIANGLES, ARRAY_COUNT(sk_indexData), GL_UNSIGNED_SHORT, 0);
+        }
+    }
+
+#ifndef GL_ES
+    if (s_instanceStream != NULL) {
+        frameworkStreamBufferEndFrame(s_instanceStream);
+    }
+#endif
+
     glDisableVertexAttribArray(VERTEX_ATTR_INDEX_POSITION);
     glDisableVertexAttribArray(VERTEX_ATTR_INDEX_COLOR);
     glUseProgram(0);
@@ -7,6 +7,7 @@
 #include "glsys.h"
 #include "matrix.h"
 #include "scalar.h"
+#include "transform.h"
 #include "vector.h"
 
 #define ARRAY_COUNT(array) (sizeof(array)/sizeof(array[0]))
@@ -21,16 +22,21 @@ typedef enum EVertexAttrIndex {
     VERTEX_ATTR_INDEX_COLOR
 } EVertexAttrIndex;
 
-typedef void (*InstanceTransformFunc)(TmMat4 *,float);
+typedef TmVec3 (*InstanceScaleFunc)(float);
 
-static void     nullScale(TmMat4 *pOut, float elapsedTime);
-static void     staticUniformScale(TmMat4 *pOut, float elapsedTime);
-static void     staticNonUniformScale(TmMat4 *pOut, float elapsedTime);
-static void     dynamicUniformScale(TmMat4 *pOut, float elapsedTime);
-static void     dynamicNonUniformScale(TmMat4 *pOut, float elapsedTime);
+typedef struct Instance {
+    InstanceScaleFunc   scaleFunc;
+    TmVec3              offset;
+} Instance;
+
+static TmVec3   nullScale(float elapsedTime);
+static TmVec3   staticUniformScale(float elapsedTime);
+static TmVec3   staticNonUniformScale(float elapsedTime);
+static TmVec3   dynamicUniformScale(float elapsedTime);
+static TmVec3   dynamicNonUniformScale(float elapsedTime);
 static float    calcLerpFactor(float elapsedTime, float loopDuration);
 static float    calcFrustumScale(float fovDegrees);
-static void     constructInstanceMatrix(TmMat4 *pOut, InstanceTransformFunc transformFunc, float elapsedTime);
+static void     initializeInstances();
 static void     initializeProgram();
 static void     initializeVertexBuffer();
 static void     initializeVertexArray();
@@ -100,6 +106,7 @@ initializeProgram()
 {
     static float const sk_zNear = 1.0f;
     static float const sk_zFar = 45.0f;
+    TmMat4f upload;
 
     GLuint vertexShader;
     GLuint fragmentShader;
@@ -123,7 +130,7 @@ initializeProgram()
     s_cameraToClipMatrix.m34 = (2.0 * sk_zFar * sk_zNear) / (sk_zNear - sk_zFar);
     
     glUseProgram(s_theProgram);
-    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&s_cameraToClipMatrix);
+    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_cameraToClipMatrix));
     glUseProgram(0);
     
     glDeleteShader(vertexShader);
@@ -157,10 +164,12 @@ gltutDefaultSettingsInit(GltutDefaultSettings *pSettings)
 void
 gltutReshape(int width, int height)
 {
+    TmMat4f upload;
+
     s_cameraToClipMatrix.m11 = s_frustumScale * (height / (float)width);
 
     glUseProgram(s_theProgram);
-    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&s_cameraToClipMatrix);
+    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_cameraToClipMatrix));
     glUseProgram(0);
 
     glViewport(0, 0, (GLsizei)width, (GLsizei)height);
@@ -183,6 +192,7 @@ gltutPostRenderSystemInit(void)
     initializeProgram();
     initializeVertexBuffer();
     initializeVertexArray();
+    initializeInstances();
 
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
@@ -204,62 +214,43 @@ calcLerpFactor(float elapsedTime, float loopDuration)
     return value * 2.0f;
 }
 
-void
-nullScale(TmMat4 *pOut, float elapsedTime)
+TmVec3
+nullScale(float elapsedTime)
 {
     (void)elapsedTime;
-    
-    pOut->m14 = 0.0f;
-    pOut->m24 = 0.0f;
-    pOut->m34 = -45.0f;
+
+    return (TmVec3){.x=1.0f, .y=1.0f, .z=1.0f};
 }
 
-void
-staticUniformScale(TmMat4 *pOut, float elapsedTime)
+TmVec3
+staticUniformScale(float elapsedTime)
 {
     (void)elapsedTime;
 
-    pOut->m11 = 4.0f;
-    pOut->m22 = 4.0f;
-    pOut->m33 = 4.0f;
-    
-    pOut->m14 = -10.0f;
-    pOut->m24 = -10.0f;
-    pOut->m34 = -45.0f;
+    return (TmVec3){.x=4.0f, .y=4.0f, .z=4.0f};
 }
 
-void
-staticNonUniformScale(TmMat4 *pOut, float elapsedTime)
+TmVec3
+staticNonUniformScale(float elapsedTime)
 {
     (void)elapsedTime;
 
-    pOut->m11 = 0.5f;
-    pOut->m22 = 1.0f;
-    pOut->m33 = 10.0f;
-
-    pOut->m14 = -10.0f;
-    pOut->m24 = 10.0f;
-    pOut->m34 = -45.0f;
+    return (TmVec3){.x=0.5f, .y=1.0f, .z=10.0f};
 }
 
-void
-dynamicUniformScale(TmMat4 *pOut, float elapsedTime)
+TmVec3
+dynamicUniformScale(float elapsedTime)
 {
     static float const sk_loopDuration = 3.0f;
     float scale;
 
     scale = tmScalarMix(1.0f, 4.0f, calcLerpFactor(elapsedTime, sk_loopDuration));
-    pOut->m11 = scale;
-    pOut->m22 = scale;
-    pOut->m33 = scale;
 
-    pOut->m14 = 10.0f;
-    pOut->m24 = 10.0f;
-    pOut->m34 = -45.0f;
+    return (TmVec3){.x=scale, .y=scale, .z=scale};
 }
 
-void
-dynamicNonUniformScale(TmMat4 *pOut, float elapsedTime)
+TmVec3
+dynamicNonUniformScale(float elapsedTime)
 {
     static float const xLoopDuration = 3.0f;
     static float const zLoopDuration = 5.0f;
@@ -268,27 +259,39 @@ dynamicNonUniformScale(TmMat4 *pOut, float elapsedTime)
 
     xScale = tmScalarMix(1.0f, 0.5f, calcLerpFactor(elapsedTime, xLoopDuration));
     zScale = tmScalarMix(1.0f, 0.5f, calcLerpFactor(elapsedTime, zLoopDuration));
-    pOut->m11 = xScale;
-    pOut->m22 = 1.0f;
-    pOut->m33 = zScale;
-    
-    pOut->m14 = 10.0f;
-    pOut->m24 = -10.0f;
-    pOut->m34 = -45.0f;
+
+    return (TmVec3){.x=xScale, .y=1.0f, .z=zScale};
 }
 
+static Instance const sk_instances[] = {
+    {.scaleFunc=nullScale, .offset={0.0f, 0.0f, -45.0f}},
+    {.scaleFunc=staticUniformScale, .offset={-10.0f, -10.0f, -45.0f}},
+    {.scaleFunc=staticNonUniformScale, .offset={-10.0f, 10.0f, -45.0f}},
+    {.scaleFunc=dynamicUniformScale, .offset={10.0f, 10.0f, -45.0f}},
+    {.scaleFunc=dynamicNonUniformScale, .offset={10.0f, -10.0f, -45.0f}}
+};
+
+// Instances before this one never change.
+static size_t const sk_staticInstanceCount = 3;
+
+// One node per instance, in the order of sk_instances.
+static TmTransformHierarchy s_instances;
+
 void
-constructInstanceMatrix(TmMat4 *pOut, InstanceTransformFunc transformFunc, float elapsedTime)
+initializeInstances(void)
 {
-    *pOut = TM_MAT4_IDENTITY;
-    transformFunc(pOut, elapsedTime);
-}
+    bool isInitialized = tmTransformHierarchyInit(&s_instances, ARRAY_COUNT(sk_instances));
 
-static InstanceTransformFunc s_instanceFunctions[] = {nullScale,
-                                                     staticUniformScale,
-                                                     staticNonUniformScale,
-                                                     dynamicUniformScale,
-                                                     dynamicNonUniformScale};
+    assert(isInitialized);
+    (void)isInitialized;
+    for (size_t i = 0; i < ARRAY_COUNT(sk_instances); ++i) {
+        TmVec3 const scale = sk_instances[i].scaleFunc(0.0f);
+        uint32_t const node = tmTransformHierarchyAdd(&s_instances, TM_TRANSFORM_NO_PARENT);
+
+        tmTransformHierarchySetTranslation(&s_instances, node, &sk_instances[i].offset);
+        tmTransformHierarchySetScale(&s_instances, node, &scale);
+    }
+}
 
 void
 gltutDisplay(void)
@@ -312,11 +315,17 @@ gltutDisplay(void)
     glVertexAttribPointer(VERTEX_ATTR_INDEX_COLOR, 4, GL_FLOAT, GL_FALSE, 0, (void *)colorDataOffset);
 
     elapsedTime = SDL_GetTicks() / 1000.0f;
-    for (size_t i = 0; i < ARRAY_COUNT(s_instanceFunctions); ++i) {
-        TmMat4 modelToCamera;
+    // Only the changing instances are touched; the update skips the rest.
+    for (size_t i = sk_staticInstanceCount; i < ARRAY_COUNT(sk_instances); ++i) {
+        TmVec3 const scale = sk_instances[i].scaleFunc(elapsedTime);
+
+        tmTransformHierarchySetScale(&s_instances, (uint32_t)i, &scale);
+    }
+    tmTransformHierarchyUpdate(&s_instances);
+    for (size_t i = 0; i < s_instances.count; ++i) {
+        TmMat4f upload;
 
-        constructInstanceMatrix(&modelToCamera, s_instanceFunctions[i], elapsedTime);
-        glUniformMatrix4fv(s_modelToCameraMatrixUnif, 1, GL_FALSE, (GLfloat *)&modelToCamera);
+        glUniformMatrix4fv(s_modelToCameraMatrixUnif, 1, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_instances.worlds[i]));
         glDrawElements(GL_TRIANGLES, ARRAY_COUNT(sk_indexData), GL_UNSIGNED_SHORT, 0);
     }
 
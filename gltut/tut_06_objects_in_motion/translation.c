@@ -6,6 +6,7 @@
 #include "framework.h"
 #include "glsys.h"
 #include "matrix.h"
+#include "transform.h"
 #include "vector.h"
 
 #define ARRAY_COUNT(array) (sizeof(array)/sizeof(array[0]))
@@ -26,7 +27,7 @@ static TmVec3   stationaryOffset(float elapsedTime);
 static TmVec3   ovalOffset(float elapsedTime);
 static TmVec3   bottomCircleOffset(float elapsedTime);
 static float    calcFrustumScale(float fovDegrees);
-static void     constructInstanceMatrix(TmMat4 *pOut, InstanceOffsetFunc offsetFunc, float elapsedTime);
+static void     initializeInstances();
 static void     initializeProgram();
 static void     initializeVertexBuffer();
 static void     initializeVertexArray();
@@ -96,6 +97,7 @@ initializeProgram()
 {
     static float const sk_zNear = 1.0f;
     static float const sk_zFar = 45.0f;
+    TmMat4f upload;
 
     GLuint vertexShader;
     GLuint fragmentShader;
@@ -119,7 +121,7 @@ initializeProgram()
     s_cameraToClipMatrix.m34 = (2.0 * sk_zFar * sk_zNear) / (sk_zNear - sk_zFar);
     
     glUseProgram(s_theProgram);
-    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&s_cameraToClipMatrix);
+    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_cameraToClipMatrix));
     glUseProgram(0);
     
     glDeleteShader(vertexShader);
@@ -148,15 +150,18 @@ gltutDefaultSettingsInit(GltutDefaultSettings *pSettings)
     name = strrchr(__FILE__, '/');
     name = (name != NULL) ? name + 1 : __FILE__;
     pSettings->windowTitle = name;
+    pSettings->recordsCommands = true;
 }
 
 void
 gltutReshape(int width, int height)
 {
+    TmMat4f upload;
+
     s_cameraToClipMatrix.m11 = s_frustumScale * (height / (float)width);
 
     glUseProgram(s_theProgram);
-    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)&s_cameraToClipMatrix);
+    glUniformMatrix4fv(s_cameraToClipMatrixUnif, 1, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_cameraToClipMatrix));
     glUseProgram(0);
 
     glViewport(0, 0, (GLsizei)width, (GLsizei)height);
@@ -179,6 +184,7 @@ gltutPostRenderSystemInit(void)
     initializeProgram();
     initializeVertexBuffer();
     initializeVertexArray();
+    initializeInstances();
 
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
@@ -221,53 +227,68 @@ bottomCircleOffset(float elapsedTime)
                     .z=sinf(currentTimeThroughLoop * scale) * 5.0f - 20.0f};
 }
 
-void
-constructInstanceMatrix(TmMat4 *pOut, InstanceOffsetFunc offsetFunc, float elapsedTime)
-{
-    TmVec3 offset;
-    *pOut = TM_MAT4_IDENTITY;
-    
-    offset = offsetFunc(elapsedTime);
-    pOut->m14 = offset.x;
-    pOut->m24 = offset.y;
-    pOut->m34 = offset.z;
-}
-
 static InstanceOffsetFunc s_instanceFunctions[] = {stationaryOffset,
                                                    ovalOffset,
                                                    bottomCircleOffset};
 
+// Instances before this one never move.
+static size_t const sk_staticInstanceCount = 1;
+
+// One node per instance, in the order of s_instanceFunctions.
+static TmTransformHierarchy s_instances;
+
+void
+initializeInstances(void)
+{
+    bool isInitialized = tmTransformHierarchyInit(&s_instances, ARRAY_COUNT(s_instanceFunctions));
+
+    assert(isInitialized);
+    (void)isInitialized;
+    for (size_t i = 0; i < ARRAY_COUNT(s_instanceFunctions); ++i) {
+        TmVec3 const offset = s_instanceFunctions[i](0.0f);
+        uint32_t const node = tmTransformHierarchyAdd(&s_instances, TM_TRANSFORM_NO_PARENT);
+
+        tmTransformHierarchySetTranslation(&s_instances, node, &offset);
+    }
+}
+
 void
 gltutDisplay(void)
 {
+    static GLfloat const sk_clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     uintptr_t colorDataOffset;
     float elapsedTime;
 
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClearDepthf(1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Recorded here and replayed on the render thread.
+    frameworkCmdClear(sk_clearColor, 1.0f, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(s_theProgram);
+    frameworkCmdUseProgram(s_theProgram);
 
-    glEnableVertexAttribArray(VERTEX_ATTR_INDEX_POSITION);
-    glEnableVertexAttribArray(VERTEX_ATTR_INDEX_COLOR);
+    frameworkCmdEnableVertexAttribArray(VERTEX_ATTR_INDEX_POSITION);
+    frameworkCmdEnableVertexAttribArray(VERTEX_ATTR_INDEX_COLOR);
 
-    glBindBuffer(GL_ARRAY_BUFFER, s_vertexBufferObject);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_indexBufferObject);
-    glVertexAttribPointer(VERTEX_ATTR_INDEX_POSITION, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    frameworkCmdBindBuffer(GL_ARRAY_BUFFER, s_vertexBufferObject);
+    frameworkCmdBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_indexBufferObject);
+    frameworkCmdVertexAttribPointer(VERTEX_ATTR_INDEX_POSITION, 3, GL_FLOAT, GL_FALSE, 0, 0);
     colorDataOffset = sizeof(float) * 3 * sk_numberOfVertices;
-    glVertexAttribPointer(VERTEX_ATTR_INDEX_COLOR, 4, GL_FLOAT, GL_FALSE, 0, (void *)colorDataOffset);
+    frameworkCmdVertexAttribPointer(VERTEX_ATTR_INDEX_COLOR, 4, GL_FLOAT, GL_FALSE, 0, colorDataOffset);
 
     elapsedTime = SDL_GetTicks() / 1000.0f;
-    for (size_t i = 0; i < ARRAY_COUNT(s_instanceFunctions); ++i) {
-        TmMat4 modelToCamera;
+    // Only the moving instances are touched; the update skips the rest.
+    for (size_t i = sk_staticInstanceCount; i < ARRAY_COUNT(s_instanceFunctions); ++i) {
+        TmVec3 const offset = s_instanceFunctions[i](elapsedTime);
 
-        constructInstanceMatrix(&modelToCamera, s_instanceFunctions[i], elapsedTime);
-        glUniformMatrix4fv(s_modelToCameraMatrixUnif, 1, GL_FALSE, (GLfloat *)&modelToCamera);
-        glDrawElements(GL_TRIANGLES, ARRAY_COUNT(sk_indexData), GL_UNSIGNED_SHORT, 0);
+        tmTransformHierarchySetTranslation(&s_instances, (uint32_t)i, &offset);
     }
+    tmTransformHierarchyUpdate(&s_instances);
+    for (size_t i = 0; i < s_instances.count; ++i) {
+        TmMat4f upload;
 
-    glDisableVertexAttribArray(VERTEX_ATTR_INDEX_POSITION);
-    glDisableVertexAttribArray(VERTEX_ATTR_INDEX_COLOR);
-    glUseProgram(0);
+        frameworkCmdUniformMatrix4fv(s_modelToCameraMatrixUnif, GL_FALSE, (GLfloat *)tmMat4ToFloat(&upload, &s_instances.worlds[i]));
+        frameworkCmdDrawElements(GL_TRIANGLES, ARRAY_COUNT(sk_indexData), GL_UNSIGNED_SHORT, 0);
+    }
+
+    frameworkCmdDisableVertexAttribArray(VERTEX_ATTR_INDEX_POSITION);
+    frameworkCmdDisableVertexAttribArray(VERTEX_ATTR_INDEX_COLOR);
+    frameworkCmdUseProgram(0);
 }
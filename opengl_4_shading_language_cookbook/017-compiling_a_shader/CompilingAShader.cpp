@@ -72,9 +72,10 @@ main(int argc, char** argv) {
         (void)fprintf(stderr, "Error creating vertex shader.\n");
         exit(EXIT_FAILURE);
     }
-    const GLchar* shaderCode = FileUtil::loadFileAsString("basic.vert");
-    glShaderSource(vertShader, 1, &shaderCode, NULL);
-    delete [] shaderCode;
+    FileUtil::File shaderFile("basic.vert");
+    const GLchar* shaderCode = shaderFile.data();
+    GLint const shaderLength = shaderFile.length();
+    glShaderSource(vertShader, 1, &shaderCode, &shaderLength);
     glCompileShader(vertShader);
 
     GLint result;
@@ -5,106 +5,18 @@
 #include <SDL2/SDL.h>
 
 #include "ArrayCount.h"
-#include "FileUtil.h"
+#include "ShaderBatch.h"
 #include "glsys.h"
 
 #define WINDOW_SIZE 640
 #define ARRAY_COUNT(array) (sizeof(array) / sizeof(array[0]))
 #define DSA_ENABLED() 0
 
-struct ShaderProgramSource {
-    GLenum shaderType;
-    const char* sourceFilename;
-};
-
-void printShaderInfoLog(GLuint shaderHandle, const char* name) {
-    GLint logLength;
-    glGetShaderiv(shaderHandle, GL_INFO_LOG_LENGTH, &logLength);
-    if (logLength > 0) {
-        char* logBuffer = new char[logLength];
-        GLsizei bytesCopied;
-        glGetShaderInfoLog(shaderHandle, logLength, &bytesCopied, logBuffer);
-        (void)fprintf(stderr, "Shader '%s' info log:\n%s\n", name, logBuffer);
-        delete [] logBuffer;
-    }
-}
-
-GLuint compileShader(GLenum shaderType, const char* filename) {
-    GLuint shaderHandle = glCreateShader(shaderType);
-    if (shaderHandle != 0) {
-        const GLchar* shaderCode = FileUtil::loadFileAsString(filename);
 #if DSA_ENABLED()
-        const GLchar* srcArray[] = {"#version 450\n#line 2\n",
-                                    shaderCode};
+#define GLSL_PREAMBLE "#version 450\n#line 2\n"
 #else
-        const GLchar* srcArray[] = {"#version 430\n#line 2\n",
-                                    shaderCode};
+#define GLSL_PREAMBLE "#version 430\n#line 2\n"
 #endif
-        glShaderSource(shaderHandle, ArrayCount(srcArray), srcArray, NULL);
-        delete [] shaderCode;
-        glCompileShader(shaderHandle);
-
-        GLint result;
-        glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &result);
-        if (result == GL_TRUE) {
-            (void)printf("Shader '%s' compilation was successful!\n", filename);
-            // Print warnings, if available
-            printShaderInfoLog(shaderHandle, filename);
-        } else {
-            (void)fprintf(stderr, "Shader compilation failed for '%s'!\n", filename);
-            printShaderInfoLog(shaderHandle, filename);
-            glDeleteShader(shaderHandle);
-            shaderHandle = 0;
-        }
-    } else {
-        (void)fprintf(stderr, "Error creating shader for '%s'.\n", filename);
-    }
-    return shaderHandle;
-}
-
-void printProgramInfoLog(GLuint programHandle) {
-    GLint logLength;
-    glGetProgramiv(programHandle, GL_INFO_LOG_LENGTH, &logLength);
-    if (logLength > 0) {
-        char* logBuffer = new char[logLength];
-        GLsizei bytesCopied;
-        glGetProgramInfoLog(programHandle, logLength, &bytesCopied, logBuffer);
-        (void)fprintf(stderr, "Program info log:\n%s\n", logBuffer);
-        delete [] logBuffer;
-    }
-}
-
-GLuint linkShaderProgram(const ShaderProgramSource* sources, size_t numSources) {
-    assert(numSources != 0);
-    GLuint programHandle = glCreateProgram();
-    if (programHandle != 0) {
-        for (size_t i = 0; i < numSources; ++i) {
-            GLuint shaderHandle = compileShader(sources[i].shaderType, sources[i].sourceFilename);
-            if (shaderHandle != 0) {
-                glAttachShader(programHandle, shaderHandle);
-                glDeleteShader(shaderHandle);
-            }
-        }
-        glLinkProgram(programHandle);
-
-        GLint linkStatus;
-        glGetProgramiv(programHandle, GL_LINK_STATUS, &linkStatus);
-        if (linkStatus == GL_TRUE) {
-            (void)printf("Shader link was successful!\n");
-            printProgramInfoLog(programHandle);
-        } else {
-            (void)fprintf(stderr, "Shader link failed!\n");
-            printProgramInfoLog(programHandle);
-            glDeleteProgram(programHandle);
-            programHandle = 0;
-        }
-    } else {
-        (void)fprintf(stderr, "Error creating shader program handle.\n");
-        exit(EXIT_FAILURE);
-    }
-    
-    return programHandle;
-}
 
 class Simulation {
 public:
@@ -119,7 +31,8 @@ private:
     void render();
     
     SDL_Window* m_window;
-    GLuint m_programHandle;
+    ShaderBatch m_shaderBatch;
+    size_t m_programIndex;
     GLuint m_vboHandles[2];
     GLuint m_vaoHandle;
 };
@@ -153,7 +66,9 @@ void Simulation::render()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(m_programHandle);
+    // Waits for the link the first time only.
+    GLuint const programHandle = m_shaderBatch.program(m_programIndex);
+    glUseProgram(programHandle);
     glBindVertexArray(m_vaoHandle);
     glDrawArrays(GL_TRIANGLES, 0, 3);
     glBindVertexArray(0);
@@ -237,12 +152,12 @@ void Simulation::initializeBuffers()
 
 Simulation::Simulation(SDL_Window* window)
   : m_window(window)
-  , m_programHandle(0)
+  , m_shaderBatch(GLSL_PREAMBLE)
+  , m_programIndex(0)
 {
-
-    ShaderProgramSource programSources[] = {{GL_VERTEX_SHADER, "basic.vert"},
+    ShaderBatch::Source programSources[] = {{GL_VERTEX_SHADER, "basic.vert"},
                                             {GL_FRAGMENT_SHADER, "basic.frag"}};
-    m_programHandle = linkShaderProgram(programSources, ARRAY_COUNT(programSources));
+    m_programIndex = m_shaderBatch.add(programSources, ARRAY_COUNT(programSources));
 
     initializeBuffers();
 }
@@ -251,7 +166,6 @@ Simulation::~Simulation()
 {
     glDeleteVertexArrays(1, &m_vaoHandle);
     glDeleteBuffers(ARRAY_COUNT(m_vboHandles), m_vboHandles);
-    glDeleteProgram(m_programHandle);
 }
 
 int main(int argc, char** argv)
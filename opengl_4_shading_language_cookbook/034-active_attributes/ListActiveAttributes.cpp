@@ -32,9 +32,10 @@ GLuint compileShader(GLenum shaderType, const char* filename)
 {
     GLuint shaderHandle = glCreateShader(shaderType);
     if (shaderHandle != 0) {
-        const GLchar* shaderCode = FileUtil::loadFileAsString(filename);
-        glShaderSource(shaderHandle, 1, &shaderCode, NULL);
-        delete [] shaderCode;
+        FileUtil::File shaderFile(filename);
+        const GLchar* shaderCode = shaderFile.data();
+        GLint const shaderLength = shaderFile.length();
+        glShaderSource(shaderHandle, 1, &shaderCode, &shaderLength);
         glCompileShader(shaderHandle);
 
         GLint result;
@@ -1,3 +0,0 @@
-namespace FileUtil {
-    char* loadFileAsString(const char* filename);
-}
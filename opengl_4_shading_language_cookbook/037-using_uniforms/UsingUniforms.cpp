@@ -3,118 +3,32 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include <SDL2/SDL.h>
 
 #include "glsys.h"
 #include "ArrayCount.h"
-#include "FileUtil.h"
+#include "ShaderProgram.h"
 
 #define WINDOW_SIZE 640
 #define ARRAY_COUNT(array) (sizeof(array) / sizeof(array[0]))
 #define DSA_ENABLED() (GLSYS_FEATURE_VERSION == GL_VERSION_4_5)
 
-struct ShaderProgramSource {
-    GLenum shaderType;
-    const char* sourceFilename;
-};
-
-void printShaderInfoLog(GLuint shaderHandle, const char* name) {
-    GLint logLength;
-    glGetShaderiv(shaderHandle, GL_INFO_LOG_LENGTH, &logLength);
-    if (logLength > 0) {
-        char* logBuffer = new char[logLength];
-        GLsizei bytesCopied;
-        glGetShaderInfoLog(shaderHandle, logLength, &bytesCopied, logBuffer);
-        (void)fprintf(stderr, "Shader '%s' info log:\n%s\n", name, logBuffer);
-        delete [] logBuffer;
-    }
-}
-
-GLuint compileShader(GLenum shaderType, const char* filename) {
-    GLuint shaderHandle = glCreateShader(shaderType);
-    if (shaderHandle != 0) {
-        const GLchar* shaderCode = FileUtil::loadFileAsString(filename);
 #if DSA_ENABLED()
-        const GLchar* srcArray[] = {"#version 450\n#line 2\n",
-                                    shaderCode};
+#define GLSL_PREAMBLE "#version 450\n#line 2\n"
 #else
-        const GLchar* srcArray[] = {"#version 430\n#line 2\n",
-                                    shaderCode};
+#define GLSL_PREAMBLE "#version 430\n#line 2\n"
 #endif
-        glShaderSource(shaderHandle, ArrayCount(srcArray), srcArray, NULL);
-        delete [] shaderCode;
-        glCompileShader(shaderHandle);
-
-        GLint result;
-        glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &result);
-        if (result == GL_TRUE) {
-            (void)printf("Shader '%s' compilation was successful!\n", filename);
-            // Print warnings, if available
-            printShaderInfoLog(shaderHandle, filename);
-        } else {
-            (void)fprintf(stderr, "Shader compilation failed for '%s'!\n", filename);
-            printShaderInfoLog(shaderHandle, filename);
-            glDeleteShader(shaderHandle);
-            shaderHandle = 0;
-        }
-    } else {
-        (void)fprintf(stderr, "Error creating shader for '%s'.\n", filename);
-    }
-    return shaderHandle;
-}
-
-void printProgramInfoLog(GLuint programHandle) {
-    GLint logLength;
-    glGetProgramiv(programHandle, GL_INFO_LOG_LENGTH, &logLength);
-    if (logLength > 0) {
-        char* logBuffer = new char[logLength];
-        GLsizei bytesCopied;
-        glGetProgramInfoLog(programHandle, logLength, &bytesCopied, logBuffer);
-        (void)fprintf(stderr, "Program info log:\n%s\n", logBuffer);
-        delete [] logBuffer;
-    }
-}
-
-GLuint linkShaderProgram(const ShaderProgramSource* sources, size_t numSources) {
-    assert(numSources != 0);
-    GLuint programHandle = glCreateProgram();
-    if (programHandle != 0) {
-        for (size_t i = 0; i < numSources; ++i) {
-            GLuint shaderHandle = compileShader(sources[i].shaderType, sources[i].sourceFilename);
-            if (shaderHandle != 0) {
-                glAttachShader(programHandle, shaderHandle);
-                glDeleteShader(shaderHandle);
-            }
-        }
-        glLinkProgram(programHandle);
-
-        GLint linkStatus;
-        glGetProgramiv(programHandle, GL_LINK_STATUS, &linkStatus);
-        if (linkStatus == GL_TRUE) {
-            (void)printf("Shader link was successful!\n");
-            printProgramInfoLog(programHandle);
-        } else {
-            (void)fprintf(stderr, "Shader link failed!\n");
-            printProgramInfoLog(programHandle);
-            glDeleteProgram(programHandle);
-            programHandle = 0;
-        }
-    } else {
-        (void)fprintf(stderr, "Error creating shader program handle.\n");
-        exit(EXIT_FAILURE);
-    }
-    
-    return programHandle;
-}
 
 class Simulation {
 public:
-    Simulation(SDL_Window* window);
+    // With a directory, the linked program is cached there and loaded
+    // from it on the next run.
+    Simulation(SDL_Window* window, const char* programCacheDirectory);
     virtual ~Simulation();
 
     void runLoop();
@@ -125,7 +39,8 @@ private:
     void render();
     
     SDL_Window* m_window;
-    GLuint m_programHandle;
+    ShaderProgram m_program;
+    ShaderProgram::UniformHandle m_rotationMatrixHandle;
     GLuint m_vboHandles[2];
     GLuint m_vaoHandle;
     static const uint32_t ROTATION_TIME_MS = 2000;
@@ -162,14 +77,12 @@ void Simulation::render()
     float rotationPercentage = currentTicks / static_cast<float>(ROTATION_TIME_MS);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(m_programHandle);
+    m_program.use();
     float const rotationAngle = glm::two_pi<float>() * rotationPercentage;
     glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f),
                                            rotationAngle,
                                            glm::vec3(0.0f, 0.0f, 1.0f));
-    GLint const location = glGetUniformLocation(m_programHandle, "RotationMatrix");
-    assert(location >= 0);
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(rotationMatrix));
+    m_program.setUniform(m_rotationMatrixHandle, rotationMatrix);
     
     glBindVertexArray(m_vaoHandle);
     glDrawArrays(GL_TRIANGLES, 0, 3);
@@ -252,29 +165,43 @@ void Simulation::initializeBuffers()
 #endif
 }
 
-Simulation::Simulation(SDL_Window* window)
+Simulation::Simulation(SDL_Window* window, const char* programCacheDirectory)
   : m_window(window)
-  , m_programHandle(0)
+  , m_program(GLSL_PREAMBLE)
+  , m_rotationMatrixHandle(ShaderProgram::InvalidUniform)
 {
-
-    ShaderProgramSource programSources[] = {{GL_VERTEX_SHADER, "basic.vert"},
-                                            {GL_FRAGMENT_SHADER, "basic.frag"}};
-    m_programHandle = linkShaderProgram(programSources, ARRAY_COUNT(programSources));
+    if (programCacheDirectory != NULL) {
+        m_program.setBinaryCacheDirectory(programCacheDirectory);
+    }
+    if (!m_program.compileShader(ShaderProgram::ShaderType_Vertex, "basic.vert") ||
+        !m_program.compileShader(ShaderProgram::ShaderType_Fragment, "basic.frag") ||
+        !m_program.link()) {
+        exit(EXIT_FAILURE);
+    }
 
     initializeBuffers();
+
+    // The handle is looked up once, not per frame, and setUniform() skips
+    // the upload when the matrix has not changed.
+    m_rotationMatrixHandle = m_program.uniformHandle("RotationMatrix");
+    assert(m_rotationMatrixHandle != ShaderProgram::InvalidUniform);
 }
 
 Simulation::~Simulation()
 {
     glDeleteVertexArrays(1, &m_vaoHandle);
     glDeleteBuffers(ARRAY_COUNT(m_vboHandles), m_vboHandles);
-    glDeleteProgram(m_programHandle);
 }
 
 int main(int argc, char** argv)
 {
-    (void)argc;
-    (void)argv;
+    const char* programCacheDirectory = NULL;
+    if (argc == 3 && strcmp(argv[1], "--program-cache") == 0) {
+        programCacheDirectory = argv[2];
+    } else if (argc != 1) {
+        (void)fprintf(stderr, "usage: %s [--program-cache DIR]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
 
     printf("Entering main\n");
 
@@ -326,7 +253,7 @@ int main(int argc, char** argv)
 #endif
     
     printf("Starting simulation\n");
-    Simulation* simulation = new Simulation(mainWindow);
+    Simulation* simulation = new Simulation(mainWindow, programCacheDirectory);
     simulation->runLoop();
     delete simulation;
     printf("Ending simulation\n");
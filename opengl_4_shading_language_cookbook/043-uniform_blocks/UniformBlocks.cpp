@@ -1,111 +1,28 @@
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
-#include <cstring>
 
 #include <SDL2/SDL.h>
 
 #include "glsys.h"
 #include "ArrayCount.h"
-#include "FileUtil.h"
+#include "ShaderBatch.h"
+#include "UniformBlockLayout.h"
 
 #define WINDOW_SIZE 640
 #define ARRAY_COUNT(array) (sizeof(array) / sizeof(array[0]))
 #define DSA_ENABLED() (GLSYS_FEATURE_VERSION == GL_VERSION_4_5)
 
-struct ShaderProgramSource {
-    GLenum shaderType;
-    const char* sourceFilename;
-};
-
-void printShaderInfoLog(GLuint shaderHandle, const char* name) {
-    GLint logLength;
-    glGetShaderiv(shaderHandle, GL_INFO_LOG_LENGTH, &logLength);
-    if (logLength > 0) {
-        char* logBuffer = new char[logLength];
-        GLsizei bytesCopied;
-        glGetShaderInfoLog(shaderHandle, logLength, &bytesCopied, logBuffer);
-        (void)fprintf(stderr, "Shader '%s' info log:\n%s\n", name, logBuffer);
-        delete [] logBuffer;
-    }
-}
+// The BlobSettings block in circle.frag.
+typedef UniformBlockLayout<LayoutRule::Std140, glm::vec4, glm::vec4, GLfloat, GLfloat> BlobSettingsLayout;
+static_assert(BlobSettingsLayout::offset(2) == 32 && BlobSettingsLayout::size() == 48,
+              "std140 pads the block to a multiple of a vec4");
 
-GLuint compileShader(GLenum shaderType, const char* filename) {
-    GLuint shaderHandle = glCreateShader(shaderType);
-    if (shaderHandle != 0) {
-        const GLchar* shaderCode = FileUtil::loadFileAsString(filename);
 #if DSA_ENABLED()
-        const GLchar* srcArray[] = {"#version 450\n#line 2\n",
-                                    shaderCode};
+#define GLSL_PREAMBLE "#version 450\n#line 2\n"
 #else
-        const GLchar* srcArray[] = {"#version 430\n#line 2\n",
-                                    shaderCode};
+#define GLSL_PREAMBLE "#version 430\n#line 2\n"
 #endif
-        glShaderSource(shaderHandle, ArrayCount(srcArray), srcArray, NULL);
-        delete [] shaderCode;
-        glCompileShader(shaderHandle);
-
-        GLint result;
-        glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &result);
-        if (result == GL_TRUE) {
-            (void)printf("Shader '%s' compilation was successful!\n", filename);
-            // Print warnings, if available
-            printShaderInfoLog(shaderHandle, filename);
-        } else {
-            (void)fprintf(stderr, "Shader compilation failed for '%s'!\n", filename);
-            printShaderInfoLog(shaderHandle, filename);
-            glDeleteShader(shaderHandle);
-            shaderHandle = 0;
-        }
-    } else {
-        (void)fprintf(stderr, "Error creating shader for '%s'.\n", filename);
-    }
-    return shaderHandle;
-}
-
-void printProgramInfoLog(GLuint programHandle) {
-    GLint logLength;
-    glGetProgramiv(programHandle, GL_INFO_LOG_LENGTH, &logLength);
-    if (logLength > 0) {
-        char* logBuffer = new char[logLength];
-        GLsizei bytesCopied;
-        glGetProgramInfoLog(programHandle, logLength, &bytesCopied, logBuffer);
-        (void)fprintf(stderr, "Program info log:\n%s\n", logBuffer);
-        delete [] logBuffer;
-    }
-}
-
-GLuint linkShaderProgram(const ShaderProgramSource* sources, size_t numSources) {
-    assert(numSources != 0);
-    GLuint programHandle = glCreateProgram();
-    if (programHandle != 0) {
-        for (size_t i = 0; i < numSources; ++i) {
-            GLuint shaderHandle = compileShader(sources[i].shaderType, sources[i].sourceFilename);
-            if (shaderHandle != 0) {
-                glAttachShader(programHandle, shaderHandle);
-                glDeleteShader(shaderHandle);
-            }
-        }
-        glLinkProgram(programHandle);
-
-        GLint linkStatus;
-        glGetProgramiv(programHandle, GL_LINK_STATUS, &linkStatus);
-        if (linkStatus == GL_TRUE) {
-            (void)printf("Shader link was successful!\n");
-            printProgramInfoLog(programHandle);
-        } else {
-            (void)fprintf(stderr, "Shader link failed!\n");
-            printProgramInfoLog(programHandle);
-            glDeleteProgram(programHandle);
-            programHandle = 0;
-        }
-    } else {
-        (void)fprintf(stderr, "Error creating shader program handle.\n");
-        exit(EXIT_FAILURE);
-    }
-    
-    return programHandle;
-}
 
 class Simulation {
 public:
@@ -120,6 +37,8 @@ private:
     void render();
     
     SDL_Window* m_window;
+    ShaderBatch m_shaderBatch;
+    size_t m_programIndex;
     GLuint m_programHandle;
     GLuint m_vertexBufferHandle;
     GLuint m_indexBufferHandle;
@@ -252,59 +171,41 @@ void Simulation::initializeBuffers()
     m_numVertices = ARRAY_COUNT(indices);
 #endif // DSA_ENABLED()
 
+    // The first use of the program, which waits for its link while the
+    // buffers above were set up.
+    m_programHandle = m_shaderBatch.program(m_programIndex);
     GLuint blockIndex = glGetUniformBlockIndex(m_programHandle, "BlobSettings");
     (void)printf("BlobSettings is at block index=%u\n", blockIndex);
-    GLint blockSize;
-    glGetActiveUniformBlockiv(m_programHandle, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
-
-#if 1
-    struct UniformBlockStd140 {
-        GLfloat m_innerColor[4];
-        GLfloat m_outerColor[4];
-        GLfloat m_radiusInner;
-        GLfloat m_radiusOuter;
-    };
-    UniformBlockStd140 uniformBlock = {{1.0f, 1.0f, 0.75f, 1.0f},
-                                       {0.0f, 0.0f, 0.0f, 0.0f},
-                                       0.25f,
-                                       0.45f};
+#if DEBUG
+    static const char* const memberNames[] = {"InnerColor", "OuterColor", "RadiusInner", "RadiusOuter"};
+    if (!checkBlockLayout<BlobSettingsLayout>(m_programHandle, "BlobSettings", memberNames)) {
+        assert(0);
+    }
+#endif
+
+    // Written in place through a mapping, with no copy to stage it in.
+    GLsizeiptr const blockSize = BlobSettingsLayout::size();
+    GLbitfield const mapAccess = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
 #if DSA_ENABLED()
-    glNamedBufferData(m_uniformBufferHandle, sizeof(uniformBlock), &uniformBlock, GL_DYNAMIC_DRAW);
+    glNamedBufferData(m_uniformBufferHandle, blockSize, NULL, GL_DYNAMIC_DRAW);
+    void* blockData = glMapNamedBufferRange(m_uniformBufferHandle, 0, blockSize, mapAccess);
 #else // DSA_ENABLED()
     glBindBuffer(GL_UNIFORM_BUFFER, m_uniformBufferHandle);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(uniformBlock), &uniformBlock, GL_DYNAMIC_DRAW);
+    glBufferData(GL_UNIFORM_BUFFER, blockSize, NULL, GL_DYNAMIC_DRAW);
+    void* blockData = glMapBufferRange(GL_UNIFORM_BUFFER, 0, blockSize, mapAccess);
 #endif // DSA_ENABLED()
-#else
-    static GLfloat const innerColor[] = {1.0f, 1.0f, 0.75f, 1.0f};
-    static GLfloat const outerColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
-    static GLfloat const innerRadius = 0.25f;
-    static GLfloat const outerRadius = 0.45f;
-
-    const GLchar* uniformNames[] = {"InnerColor", "OuterColor", "RadiusInner", "RadiusOuter"};
-    GLuint uniformIndices[ARRAY_COUNT(uniformNames)];
-    glGetUniformIndices(m_programHandle, ARRAY_COUNT(uniformNames), uniformNames, uniformIndices);
-    GLint uniformOffsets[ARRAY_COUNT(uniformIndices)];
-    glGetActiveUniformsiv(m_programHandle, ARRAY_COUNT(uniformIndices), uniformIndices, GL_UNIFORM_OFFSET, uniformOffsets);
-    
-    GLubyte* blockBuffer = new GLubyte[blockSize];
-    (void)printf("InnerColor is at offset=%d\n", uniformOffsets[0]);
-    (void)memcpy(blockBuffer + uniformOffsets[0], innerColor, sizeof(innerColor));
-    (void)printf("OuterColor is at offset=%d\n", uniformOffsets[1]);
-    (void)memcpy(blockBuffer + uniformOffsets[1], outerColor, sizeof(outerColor));
-    (void)printf("RadiusInner is at offset=%d\n", uniformOffsets[2]);
-    (void)memcpy(blockBuffer + uniformOffsets[2], &innerRadius, sizeof(innerRadius));
-    (void)printf("RadiusOuter is at offset=%d\n", uniformOffsets[3]);
-    (void)memcpy(blockBuffer + uniformOffsets[3], &outerRadius, sizeof(outerRadius));
-    bool testBool = true;
-    (void)memcpy(blockBuffer + uniformOffsets[4], &testBool, sizeof(testBool));
+    assert(blockData != NULL);
+    UniformBlockWriter<BlobSettingsLayout> blobSettings(blockData);
+    blobSettings.set<0>(glm::vec4(1.0f, 1.0f, 0.75f, 1.0f));
+    blobSettings.set<1>(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+    blobSettings.set<2>(0.25f);
+    blobSettings.set<3>(0.45f);
 #if DSA_ENABLED()
-    glNamedBufferData(m_uniformBufferHandle, blockSize, blockBuffer, GL_DYNAMIC_DRAW);
+    glUnmapNamedBuffer(m_uniformBufferHandle);
 #else // DSA_ENABLED()
-    glBindBuffer(GL_UNIFORM_BUFFER, m_uniformBufferHandle);
-    glBufferData(GL_UNIFORM_BUFFER, blockSize, blockBuffer, GL_DYNAMIC_DRAW);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
 #endif // DSA_ENABLED()
-    delete [] blockBuffer;
-#endif
+
     GLint blockBindingIndex;
     glGetActiveUniformBlockiv(m_programHandle, blockIndex, GL_UNIFORM_BLOCK_BINDING, &blockBindingIndex);
     (void)printf("The block binding index=%d\n", blockBindingIndex);
@@ -313,6 +214,8 @@ void Simulation::initializeBuffers()
 
 Simulation::Simulation(SDL_Window* window)
   : m_window(window)
+  , m_shaderBatch(GLSL_PREAMBLE)
+  , m_programIndex(0)
   , m_programHandle(0)
   , m_vertexBufferHandle(0)
   , m_indexBufferHandle(0)
@@ -320,9 +223,9 @@ Simulation::Simulation(SDL_Window* window)
   , m_numVertices(0)
   , m_uniformBufferHandle(0)
 {
-    ShaderProgramSource programSources[] = {{GL_VERTEX_SHADER, "circle.vert"},
+    ShaderBatch::Source programSources[] = {{GL_VERTEX_SHADER, "circle.vert"},
                                             {GL_FRAGMENT_SHADER, "circle.frag"}};
-    m_programHandle = linkShaderProgram(programSources, ARRAY_COUNT(programSources));
+    m_programIndex = m_shaderBatch.add(programSources, ARRAY_COUNT(programSources));
 
     initializeBuffers();
 }
@@ -333,7 +236,6 @@ Simulation::~Simulation()
     glDeleteBuffers(1, &m_vertexBufferHandle);
     glDeleteBuffers(1, &m_indexBufferHandle);
     glDeleteBuffers(1, &m_uniformBufferHandle);
-    glDeleteProgram(m_programHandle);
 }
 
 int main(int argc, char** argv)
@@ -1,34 +1,30 @@
 #include <cassert>
+#include <cerrno>
 #include <climits>
 #include <cstdio>
 
-namespace FileUtil {
-    char* loadFileAsString(const char* filename) {
-        int ret;
+#include "FileUtil.h"
 
-        FILE* const inputObj = fopen(filename, "rb");
-        assert(inputObj != NULL);
-        ret = fseek(inputObj, 0, SEEK_END);
-        assert(ret == 0);
-        long const fileLength = ftell(inputObj);
-        assert(fileLength > 0 && fileLength != LONG_MAX);
-        ret = fseek(inputObj, 0, SEEK_SET);
-        assert(ret == 0);
-        char* const buffer = new char[fileLength + 1];
-    
-        size_t totalBytesRead = 0;
-        do {
-            size_t const currentBytesRead = fread(buffer, 1, (unsigned long)fileLength, inputObj);
-            if (currentBytesRead == 0 && ferror(inputObj) != 0) {
-                fprintf(stderr, "Error reading from %s. errno is %d\n", filename, errno);
-                assert(0);
-            }
-            totalBytesRead += currentBytesRead;
-        } while (totalBytesRead < (size_t)fileLength);
+namespace FileUtil {
+    File::File(const char* filename)
+      : m_isOpen(glsysFileOpen(filename, &m_file))
+    {
+        if (!m_isOpen) {
+            fprintf(stderr, "Error reading from %s. errno is %d\n", filename, errno);
+            assert(0);
+            m_file.data = "";
+            m_file.size = 0;
+        }
+        assert(m_file.size <= INT_MAX);
+    }
 
-        fclose(inputObj);
-        buffer[fileLength] = '\0';
+    File::~File() {
+        if (m_isOpen) {
+            glsysFileClose(&m_file);
+        }
+    }
 
-        return buffer;
+    int File::length() const {
+        return (int)m_file.size;
     }
 }
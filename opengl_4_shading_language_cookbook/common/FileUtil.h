@@ -1,3 +1,26 @@
+#ifndef FILE_UTIL_H
+#define FILE_UTIL_H
+
+#include "glsys_file.h"
+
 namespace FileUtil {
-    char* loadFileAsString(const char* filename);
+    // A whole file, memory-mapped where possible. The contents are not
+    // NUL-terminated, so pass length() along to glShaderSource.
+    class File {
+    public:
+        explicit File(const char* filename);
+        ~File();
+
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+        const char* data() const { return m_file.data; }
+        int length() const;
+
+    private:
+        GlsysFile m_file;
+        bool m_isOpen;
+    };
 }
+
+#endif // FILE_UTIL_H
@@ -0,0 +1,173 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ArrayCount.h"
+#include "FileUtil.h"
+#include "ShaderBatch.h"
+
+// From GL_KHR_parallel_shader_compile, which is newer than glcorearb.h.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+    bool hasExtension(const char* name)
+    {
+        GLint numExtensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+        for (GLint i = 0; i < numExtensions; ++i) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension != NULL && strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void printShaderInfoLog(GLuint shaderHandle, const char* name)
+    {
+        GLint logLength;
+        glGetShaderiv(shaderHandle, GL_INFO_LOG_LENGTH, &logLength);
+        if (logLength > 0) {
+            char* logBuffer = new char[logLength];
+            GLsizei bytesCopied;
+            glGetShaderInfoLog(shaderHandle, logLength, &bytesCopied, logBuffer);
+            (void)fprintf(stderr, "Shader '%s' info log:\n%s\n", name, logBuffer);
+            delete [] logBuffer;
+        }
+    }
+
+    void printProgramInfoLog(GLuint programHandle)
+    {
+        GLint logLength;
+        glGetProgramiv(programHandle, GL_INFO_LOG_LENGTH, &logLength);
+        if (logLength > 0) {
+            char* logBuffer = new char[logLength];
+            GLsizei bytesCopied;
+            glGetProgramInfoLog(programHandle, logLength, &bytesCopied, logBuffer);
+            (void)fprintf(stderr, "Program info log:\n%s\n", logBuffer);
+            delete [] logBuffer;
+        }
+    }
+}
+
+ShaderBatch::ShaderBatch(const char* preamble)
+  : m_preamble(preamble != NULL ? preamble : ""),
+    m_hasCompletionStatus(hasExtension("GL_KHR_parallel_shader_compile") ||
+                          hasExtension("GL_ARB_parallel_shader_compile"))
+{
+}
+
+ShaderBatch::~ShaderBatch()
+{
+    for (Entry& entry : m_entries) {
+        for (GLuint shaderHandle : entry.shaderHandles) {
+            glDeleteShader(shaderHandle);
+        }
+        glDeleteProgram(entry.programHandle);
+    }
+}
+
+size_t ShaderBatch::add(const Source* sources, size_t numSources)
+{
+    assert(numSources != 0);
+    Entry entry;
+    entry.programHandle = glCreateProgram();
+    entry.isFinished = false;
+    if (entry.programHandle == 0) {
+        (void)fprintf(stderr, "Error creating shader program handle.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < numSources; ++i) {
+        GLuint shaderHandle = glCreateShader(sources[i].shaderType);
+        if (shaderHandle == 0) {
+            (void)fprintf(stderr, "Error creating shader for '%s'.\n", sources[i].sourceFilename);
+            continue;
+        }
+        FileUtil::File shaderFile(sources[i].sourceFilename);
+        const GLchar* srcArray[] = {m_preamble, shaderFile.data()};
+        // The preamble is NUL-terminated, the file is not.
+        GLint const lengthArray[] = {-1, shaderFile.length()};
+        glShaderSource(shaderHandle, ArrayCount(srcArray), srcArray, lengthArray);
+        glCompileShader(shaderHandle);
+        glAttachShader(entry.programHandle, shaderHandle);
+        entry.shaderHandles.push_back(shaderHandle);
+        entry.filenames.push_back(sources[i].sourceFilename);
+    }
+    // Linking waits on the compiles in the driver, not here; a failed
+    // compile shows up as a failed link.
+    glLinkProgram(entry.programHandle);
+
+    m_entries.push_back(entry);
+    return m_entries.size() - 1;
+}
+
+bool ShaderBatch::isComplete()
+{
+    bool complete = true;
+    for (Entry& entry : m_entries) {
+        if (entry.isFinished) {
+            continue;
+        }
+        GLint completionStatus = GL_FALSE;
+        if (m_hasCompletionStatus) {
+            glGetProgramiv(entry.programHandle, GL_COMPLETION_STATUS_KHR, &completionStatus);
+        }
+        if (completionStatus == GL_TRUE) {
+            finish(entry);
+        } else {
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+GLuint ShaderBatch::program(size_t index)
+{
+    assert(index < m_entries.size());
+    Entry& entry = m_entries[index];
+    if (!entry.isFinished) {
+        finish(entry);
+    }
+    return entry.programHandle;
+}
+
+// Reports the compile and link results, which waits for them if they are
+// not done yet.
+void ShaderBatch::finish(Entry& entry)
+{
+    for (size_t i = 0; i < entry.shaderHandles.size(); ++i) {
+        GLuint const shaderHandle = entry.shaderHandles[i];
+        const char* filename = entry.filenames[i];
+        GLint result;
+        glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &result);
+        if (result == GL_TRUE) {
+            (void)printf("Shader '%s' compilation was successful!\n", filename);
+            // Print warnings, if available
+            printShaderInfoLog(shaderHandle, filename);
+        } else {
+            (void)fprintf(stderr, "Shader compilation failed for '%s'!\n", filename);
+            printShaderInfoLog(shaderHandle, filename);
+        }
+        // Attached, so it lives on until the program is deleted.
+        glDeleteShader(shaderHandle);
+    }
+    entry.shaderHandles.clear();
+    entry.filenames.clear();
+
+    GLint linkStatus;
+    glGetProgramiv(entry.programHandle, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_TRUE) {
+        (void)printf("Shader link was successful!\n");
+        printProgramInfoLog(entry.programHandle);
+    } else {
+        (void)fprintf(stderr, "Shader link failed!\n");
+        printProgramInfoLog(entry.programHandle);
+        glDeleteProgram(entry.programHandle);
+        entry.programHandle = 0;
+    }
+    entry.isFinished = true;
+}
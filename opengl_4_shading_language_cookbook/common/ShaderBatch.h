@@ -0,0 +1,53 @@
+#ifndef SHADER_BATCH_H
+#define SHADER_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "glsys.h"
+
+// Compiles and links a batch of programs without waiting on each shader
+// in turn. add() issues every compile and the link at once, so that a
+// driver with GL_KHR_parallel_shader_compile can work on them on its own
+// threads. Only program() blocks, and only the first time it is called
+// for a program that is still being linked.
+class ShaderBatch {
+public:
+    struct Source {
+        GLenum shaderType;
+        const char* sourceFilename;
+    };
+
+    // The preamble, if any, goes before each file, e.g. for the
+    // #version line.
+    explicit ShaderBatch(const char* preamble);
+    // Deletes the programs.
+    ~ShaderBatch();
+
+    ShaderBatch(const ShaderBatch&) = delete;
+    ShaderBatch& operator=(const ShaderBatch&) = delete;
+
+    // Returns the index of the program, for program().
+    size_t add(const Source* sources, size_t numSources);
+    // Whether every program has been linked. Never blocks: without the
+    // extension, this only counts the programs already asked for.
+    bool isComplete();
+    // The linked program, or 0 if it failed to compile or link.
+    GLuint program(size_t index);
+
+private:
+    struct Entry {
+        GLuint programHandle;
+        std::vector<GLuint> shaderHandles;
+        std::vector<const char*> filenames;
+        bool isFinished;
+    };
+
+    void finish(Entry& entry);
+
+    const char* m_preamble;
+    bool m_hasCompletionStatus;
+    std::vector<Entry> m_entries;
+};
+
+#endif // SHADER_BATCH_H
@@ -1,21 +1,29 @@
-#include <cassert.h>
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <cstring>
 
 #include "ArrayCount.h"
 #include "FileUtil.h"
 #include "glsys.h"
+#include "glsys_program_cache.h"
+#include "ShaderProgram.h"
 
-ShaderProgram::ShaderProgram()
-  : m_programHandle(0)
+ShaderProgram::ShaderProgram(const char* preamble)
+  : m_preamble(preamble != NULL ? preamble : ""),
+    m_binaryCacheDirectory(nullptr),
+    m_sourceHash(glsysHashString(GLSYS_HASH_SEED, m_preamble)),
+    m_programHandle(0),
     m_wasLinked(false)
 {
     m_programHandle = glCreateProgram();
-    assert(programHandle != 0);
+    assert(m_programHandle != 0);
 }
 
 ShaderProgram::~ShaderProgram()
 {
-    if (programHandle != 0) {
-        glDeleteProgram(programHandle);
+    if (m_programHandle != 0) {
+        glDeleteProgram(m_programHandle);
     }
 }
 
@@ -32,6 +40,41 @@ void ShaderProgram::printShaderInfoLog(GLuint shaderHandle, const char* name)
     }
 }
 
+void ShaderProgram::printProgramInfoLog()
+{
+    GLint logLength;
+    glGetProgramiv(m_programHandle, GL_INFO_LOG_LENGTH, &logLength);
+    if (logLength > 0) {
+        char* logBuffer = new char[logLength];
+        GLsizei bytesCopied;
+        glGetProgramInfoLog(m_programHandle, logLength, &bytesCopied, logBuffer);
+        (void)fprintf(stderr, "Program info log:\n%s\n", logBuffer);
+        delete [] logBuffer;
+    }
+}
+
+void ShaderProgram::setBinaryCacheDirectory(const char* directory)
+{
+    m_binaryCacheDirectory = directory;
+}
+
+bool ShaderProgram::compileAttachedShader(GLuint shaderHandle, const char* name)
+{
+    glCompileShader(shaderHandle);
+
+    GLint result;
+    glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &result);
+    if (result == GL_TRUE) {
+        (void)printf("Shader '%s' compilation was successful.\n", name);
+        // Print warnings, if available
+        printShaderInfoLog(shaderHandle, name);
+    } else {
+        (void)fprintf(stderr, "Shader compilation failed for '%s'!\n", name);
+        printShaderInfoLog(shaderHandle, name);
+    }
+    return result == GL_TRUE;
+}
+
 bool ShaderProgram::compileShader(ShaderProgram::ShaderType shaderType, const char* filename)
 {
     static GLenum const sk_shaderTypeMap[] = {GL_VERTEX_SHADER,
@@ -42,23 +85,28 @@ bool ShaderProgram::compileShader(ShaderProgram::ShaderType shaderType, const ch
     GLuint shaderHandle = glCreateShader(sk_shaderTypeMap[shaderType]);
     assert(shaderHandle != 0);
     if (shaderHandle != 0) {
-        const GLchar* shaderCode = FileUtil::loadFileAsString(filename);
-        glShaderSource(shaderHandle, 1, &shaderCode, NULL);
-        delete [] shaderCode;
-        glCompileShader(shaderHandle);
-
-        GLint result;
-        glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &result);
-        if (result == GL_TRUE) {
+        FileUtil::File shaderFile(filename);
+        const GLchar* srcArray[] = {m_preamble, shaderFile.data()};
+        // The preamble is NUL-terminated, the file is not.
+        GLint const lengthArray[] = {-1, shaderFile.length()};
+        glShaderSource(shaderHandle, ArrayCount(srcArray), srcArray, lengthArray);
+        m_sourceHash = glsysHash(m_sourceHash, &sk_shaderTypeMap[shaderType], sizeof(GLenum));
+        m_sourceHash = glsysHash(m_sourceHash, shaderFile.data(), shaderFile.length());
+        m_sourceHash = glsysHash(m_sourceHash, "", 1);
+
+        // Attached shaders are only deleted with the program, so a
+        // deferred one can still be compiled by link().
+        if (m_binaryCacheDirectory != nullptr) {
             success = true;
-            (void)printf("Shader '%s' compilation was successful. Attaching...\n", filename);
             glAttachShader(m_programHandle, shaderHandle);
             glDeleteShader(shaderHandle);
-            // Print warnings, if available
-            printShaderInfoLog(shaderHandle, filename);
+            m_pendingShaders.push_back(PendingShader{shaderHandle, filename});
+        } else if (compileAttachedShader(shaderHandle, filename)) {
+            success = true;
+            (void)printf("Attaching '%s'...\n", filename);
+            glAttachShader(m_programHandle, shaderHandle);
+            glDeleteShader(shaderHandle);
         } else {
-            (void)fprintf(stderr, "Shader compilation failed for '%s'!\n", filename);
-            printShaderInfoLog(shaderHandle, filename);
             glDeleteShader(shaderHandle);
             shaderHandle = 0;
         }
@@ -68,9 +116,76 @@ bool ShaderProgram::compileShader(ShaderProgram::ShaderType shaderType, const ch
     return success;
 }
 
+uint64_t ShaderProgram::binaryCacheKey() const
+{
+    uint64_t key = m_sourceHash;
+    key = glsysHashString(key, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    key = glsysHashString(key, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    key = glsysHashString(key, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    return key;
+}
+
+bool ShaderProgram::loadProgramBinary(uint64_t key)
+{
+    GlsysProgramBinary binary;
+    if (!glsysProgramCacheLoad(m_binaryCacheDirectory, key, &binary)) {
+        return false;
+    }
+
+    GLint linkStatus = GL_FALSE;
+    if (binary.size <= INT_MAX) {
+        glProgramBinary(m_programHandle, binary.format, binary.data, static_cast<GLsizei>(binary.size));
+        glGetProgramiv(m_programHandle, GL_LINK_STATUS, &linkStatus);
+    }
+    glsysProgramCacheRelease(&binary);
+    // A rejected binary leaves the program unlinked, with its shaders
+    // still attached.
+    return linkStatus == GL_TRUE;
+}
+
+void ShaderProgram::storeProgramBinary(uint64_t key)
+{
+    GLint binaryLength = 0;
+    glGetProgramiv(m_programHandle, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0) {
+        return;
+    }
+
+    char* binaryBuffer = new char[binaryLength];
+    GLenum binaryFormat;
+    glGetProgramBinary(m_programHandle, binaryLength, &binaryLength, &binaryFormat, binaryBuffer);
+    if (!glsysProgramCacheStore(m_binaryCacheDirectory, key, binaryFormat, binaryBuffer, binaryLength)) {
+        (void)fprintf(stderr, "Could not cache the program binary in '%s'.\n", m_binaryCacheDirectory);
+    }
+    delete [] binaryBuffer;
+}
+
 bool ShaderProgram::link()
 {
     assert(!m_wasLinked);
+    uint64_t key = 0;
+    if (m_binaryCacheDirectory != nullptr) {
+        key = binaryCacheKey();
+        if (loadProgramBinary(key)) {
+            m_wasLinked = true;
+            m_pendingShaders.clear();
+            (void)printf("Shader program was loaded from the binary cache.\n");
+            reflectUniforms();
+            return m_wasLinked;
+        }
+
+        bool compiled = true;
+        for (PendingShader const& pendingShader : m_pendingShaders) {
+            compiled = compileAttachedShader(pendingShader.handle, pendingShader.filename.c_str()) && compiled;
+        }
+        m_pendingShaders.clear();
+        if (!compiled) {
+            glDeleteProgram(m_programHandle);
+            m_programHandle = 0;
+            return m_wasLinked;
+        }
+        glProgramParameteri(m_programHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(m_programHandle);
 
     GLint linkStatus;
@@ -79,6 +194,10 @@ bool ShaderProgram::link()
         m_wasLinked = true;
         (void)printf("Shader link was successful!\n");
         printProgramInfoLog();
+        reflectUniforms();
+        if (m_binaryCacheDirectory != nullptr) {
+            storeProgramBinary(key);
+        }
     } else {
         (void)fprintf(stderr, "Shader link failed!\n");
         printProgramInfoLog();
@@ -91,7 +210,132 @@ bool ShaderProgram::link()
 
 bool ShaderProgram::use()
 {
-    glUseProgram(m_programHandle);
+    if (m_wasLinked) {
+        glUseProgram(m_programHandle);
+    }
+    return m_wasLinked;
+}
+
+void ShaderProgram::reflectUniforms()
+{
+    GLint numUniforms = 0;
+    glGetProgramInterfaceiv(m_programHandle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &numUniforms);
+
+    m_uniforms.clear();
+    static GLenum const properties[] = {GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_BLOCK_INDEX};
+    for (int i = 0; i < numUniforms; i++) {
+        GLint results[ArrayCount(properties)];
+        glGetProgramResourceiv(m_programHandle,
+                               GL_UNIFORM,
+                               i,
+                               ArrayCount(properties),
+                               properties,
+                               ArrayCount(results),
+                               NULL,
+                               results);
+        // Block members are set through their buffer.
+        if (results[3] != -1 || results[2] < 0) {
+            continue;
+        }
+
+        std::string name(results[0], '\0');
+        glGetProgramResourceName(m_programHandle, GL_UNIFORM, i, results[0], NULL, &name[0]);
+        name.resize(strlen(name.c_str()));
+
+        Uniform uniform;
+        uniform.name = name;
+        uniform.nameHash = glsysHashString(GLSYS_HASH_SEED, name.c_str());
+        uniform.location = results[2];
+        uniform.type = static_cast<GLenum>(results[1]);
+        uniform.hasValue = false;
+        m_uniforms.push_back(uniform);
+    }
+
+    size_t numSlots = 1;
+    while (numSlots < 2 * m_uniforms.size()) {
+        numSlots *= 2;
+    }
+    m_uniformSlots.assign(numSlots, InvalidUniform);
+    for (size_t i = 0; i < m_uniforms.size(); i++) {
+        size_t slot = m_uniforms[i].nameHash & (numSlots - 1);
+        while (m_uniformSlots[slot] != InvalidUniform) {
+            slot = (slot + 1) & (numSlots - 1);
+        }
+        m_uniformSlots[slot] = static_cast<UniformHandle>(i);
+    }
+}
+
+ShaderProgram::UniformHandle ShaderProgram::uniformHandle(const char* name) const
+{
+    if (m_uniformSlots.empty()) {
+        return InvalidUniform;
+    }
+
+    uint64_t const nameHash = glsysHashString(GLSYS_HASH_SEED, name);
+    size_t const mask = m_uniformSlots.size() - 1;
+    for (size_t slot = nameHash & mask; m_uniformSlots[slot] != InvalidUniform; slot = (slot + 1) & mask) {
+        Uniform const& uniform = m_uniforms[m_uniformSlots[slot]];
+        if (uniform.nameHash == nameHash && uniform.name == name) {
+            return m_uniformSlots[slot];
+        }
+    }
+    return InvalidUniform;
+}
+
+// Remembers the value, returning false if it is the one already set.
+bool ShaderProgram::isNewValue(UniformHandle handle, const void* value, size_t size)
+{
+    assert(handle >= 0 && static_cast<size_t>(handle) < m_uniforms.size());
+    Uniform& uniform = m_uniforms[handle];
+    assert(size <= sizeof(uniform.value));
+    if (uniform.hasValue && memcmp(uniform.value, value, size) == 0) {
+        return false;
+    }
+    (void)memcpy(uniform.value, value, size);
+    uniform.hasValue = true;
+    return true;
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, GLint value)
+{
+    if (handle != InvalidUniform && isNewValue(handle, &value, sizeof(value))) {
+        glUniform1i(m_uniforms[handle].location, value);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, GLfloat value)
+{
+    if (handle != InvalidUniform && isNewValue(handle, &value, sizeof(value))) {
+        glUniform1f(m_uniforms[handle].location, value);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::vec2& value)
+{
+    if (handle != InvalidUniform && isNewValue(handle, &value[0], sizeof(value))) {
+        glUniform2f(m_uniforms[handle].location, value.x, value.y);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::vec3& value)
+{
+    if (handle != InvalidUniform && isNewValue(handle, &value[0], sizeof(value))) {
+        glUniform3f(m_uniforms[handle].location, value.x, value.y, value.z);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::vec4& value)
+{
+    if (handle != InvalidUniform && isNewValue(handle, &value[0], sizeof(value))) {
+        glUniform4f(m_uniforms[handle].location, value.x, value.y, value.z, value.w);
+    }
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::mat4& value)
+{
+    if (handle != InvalidUniform && isNewValue(handle, &value[0][0], sizeof(value))) {
+        glUniformMatrix4fv(m_uniforms[handle].location, 1, GL_FALSE, &value[0][0]);
+    }
 }
 
 void ShaderProgram::printActiveInputs()
@@ -105,13 +349,13 @@ void ShaderProgram::printActiveInputs()
     GLenum properties[] = {GL_NAME_LENGTH, GL_TYPE, GL_LOCATION};
     (void)printf("Active input resources:\n");
     for (int i = 0; i < numInputs; i++) {
-        GLint propertyValues[ARRAY_COUNT(properties)];
+        GLint propertyValues[ArrayCount(properties)];
         glGetProgramResourceiv(m_programHandle,
                                GL_PROGRAM_INPUT,
                                i,
-                               ARRAY_COUNT(properties),
+                               ArrayCount(properties),
                                properties,
-                               ARRAY_COUNT(propertyValues),
+                               ArrayCount(propertyValues),
                                NULL,
                                propertyValues);
         char* nameBuffer = new char[propertyValues[0]];
@@ -141,9 +385,9 @@ void ShaderProgram::printActiveUniforms()
             glGetProgramResourceiv(m_programHandle,
                                    GL_UNIFORM,
                                    i,
-                                   ARRAY_COUNT(properties),
+                                   ArrayCount(properties),
                                    properties,
-                                   ARRAY_COUNT(properties),
+                                   ArrayCount(properties),
                                    NULL,
                                    reinterpret_cast<GLint*>(&results));
 
@@ -162,71 +406,59 @@ void ShaderProgram::printActiveUniforms()
 void ShaderProgram::printActiveUniformBlocks()
 {
     GLint numUniformBlocks = 0;
-    glGetProgramInterfaceiv(m_programHandle, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &numUniformsBlocks);
+    glGetProgramInterfaceiv(m_programHandle, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &numUniformBlocks);
 
     GLint numUniforms = 0;
-    glGetProgramInterfaceiv(m_programHandle, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &numUniforms);
-    
-    static GLenum const properties[] = {GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_BLOCK_INDEX};
+    glGetProgramInterfaceiv(m_programHandle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &numUniforms);
+
+    static GLenum const properties[] = {GL_NAME_LENGTH, GL_TYPE, GL_OFFSET, GL_BLOCK_INDEX};
     struct PropertyResults {
         GLint nameLength;
         GLint type;
-        GLint location;
+        GLint offset;
         GLint blockIndex;
     };
-    PropertyResults* propertyResults = new PropertyResults[numUniforms];
-    static_assert(ArrayCount(properties) == sizeof(propertyResults[0])/sizeof(propertyResults[0].nameLength),
+    std::vector<PropertyResults> propertyResults(numUniforms);
+    static_assert(ArrayCount(properties) == sizeof(PropertyResults)/sizeof(GLint),
                   "PropertyResults is not the right size.");
 
     for (int uniformIndex = 0; uniformIndex < numUniforms; uniformIndex++) {
         glGetProgramResourceiv(m_programHandle,
                                GL_UNIFORM,
                                uniformIndex,
-                               ARRAY_COUNT(properties),
+                               ArrayCount(properties),
                                properties,
-                               ARRAY_COUNT(properties),
+                               ArrayCount(properties),
                                NULL,
                                reinterpret_cast<GLint*>(&propertyResults[uniformIndex]));
     }
 
+    static GLenum const blockProperties[] = {GL_NAME_LENGTH, GL_BUFFER_BINDING};
     for (int blockIndex = 0; blockIndex < numUniformBlocks; blockIndex++) {
-        GLint blockBindingIndex;
-        glGetActiveUniformBlockiv(m_programHandle, blockIndex, GL_UNIFORM_BLOCK_BINDING, &blockBindingIndex);
-        glBindBufferBase(GL_UNIFORM_BUFFER, blockBindingIndex, m_uniformBufferHandle);
-
-        // get the uniform block name
-        GLenum blockNameProperty = GL_NAME_LENGTH;
-        GLint blockNameLength;
+        GLint blockResults[ArrayCount(blockProperties)];
         glGetProgramResourceiv(m_programHandle,
                                GL_UNIFORM_BLOCK,
                                blockIndex,
-                               1,
-                               &blockNameProperty,
-                               1,
+                               ArrayCount(blockProperties),
+                               blockProperties,
+                               ArrayCount(blockResults),
                                NULL,
-                               &blockNameLength);
+                               blockResults);
 
-        char* blockNameBuffer = new char[blockNameLength];
-        glGetProgramResourceName(m_programHandle, GL_UNIFORM_BLOCK, results.blockIndex, blockNameLength, NULL, blockNameBuffer);
-        (void)printf("Uniform Block %s (binding index=%d)\n", blockNameBuffer, blockBindingIndex);
+        char* blockNameBuffer = new char[blockResults[0]];
+        glGetProgramResourceName(m_programHandle, GL_UNIFORM_BLOCK, blockIndex, blockResults[0], NULL, blockNameBuffer);
+        (void)printf("Uniform Block %s (binding index=%d)\n", blockNameBuffer, blockResults[1]);
 
         // find the uniforms that are in this block, and print their info
         for (int uniformIndex = 0; uniformIndex < numUniforms; uniformIndex++) {
-            PropertyResult& result = propertyResults[uniformIndex];
+            PropertyResults const& result = propertyResults[uniformIndex];
             if (result.blockIndex == blockIndex) {
-                GLint uniformOffset;
                 char* nameBuffer = new char[result.nameLength];
-                glGetProgramResourceName(m_programHandle, GL_UNIFORM, i, result.nameLength, NULL, nameBuffer);
-                glGetActiveUniformsiv(m_programHandle,
-                                      1,
-                                      &uniformIndex,
-                                      GL_UNIFORM_OFFSET,
-                                      &uniformOffset);
-                printf("    %s (%s) (offset=%d)\n", nameBuffer, glsysGetTypeString(results.type), uniformOffset);
+                glGetProgramResourceName(m_programHandle, GL_UNIFORM, uniformIndex, result.nameLength, NULL, nameBuffer);
+                (void)printf("    %s (%s) (offset=%d)\n", nameBuffer, glsysGetTypeString(result.type), result.offset);
                 delete [] nameBuffer;
             }
         }
         delete [] blockNameBuffer;
     }
-    delete [] propertyResults;
 }
@@ -1,6 +1,14 @@
 #ifndef SHADER_PROGRAM_H
 #define SHADER_PROGRAM_H
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "glsys.h"
+
 class ShaderProgram {
 public:
     enum ShaderType {
@@ -9,16 +17,41 @@ public:
         ShaderType_Count
     };
     
-    ShaderProgram();
+    // Index of an active uniform, looked up once so that setting it does
+    // no string lookups.
+    typedef int UniformHandle;
+    static UniformHandle const InvalidUniform = -1;
+
+    // The preamble, if any, goes before each file, e.g. for the
+    // #version line.
+    explicit ShaderProgram(const char* preamble);
     virtual ~ShaderProgram();
 
     ShaderProgram(const ShaderProgram&) = delete;
     ShaderProgram& operator=(const ShaderProgram&) = delete;
 
+    // With a directory, link() loads the program binary cached there for
+    // the same sources and driver, and compileShader() leaves compiling to
+    // link() for when there is none. The directory must outlive the program.
+    void setBinaryCacheDirectory(const char* directory);
+
     bool compileShader(ShaderType shaderType, const char* filename);
     bool link();
+    // Returns false, and changes nothing, if the program is not linked.
     bool use();
 
+    // InvalidUniform if the linked program has no such uniform outside of
+    // a block.
+    UniformHandle uniformHandle(const char* name) const;
+    // For the program in use. The GL call is skipped when the value is the
+    // one last set through the same handle.
+    void setUniform(UniformHandle handle, GLint value);
+    void setUniform(UniformHandle handle, GLfloat value);
+    void setUniform(UniformHandle handle, const glm::vec2& value);
+    void setUniform(UniformHandle handle, const glm::vec3& value);
+    void setUniform(UniformHandle handle, const glm::vec4& value);
+    void setUniform(UniformHandle handle, const glm::mat4& value);
+
     void printActiveUniforms();
     void printActiveUniformBlocks();
     void printActiveInputs();
@@ -26,8 +59,39 @@ public:
 private:
     void printShaderInfoLog(GLuint shaderHandle, const char* name);
     void printProgramInfoLog();
+    bool compileAttachedShader(GLuint shaderHandle, const char* name);
+    uint64_t binaryCacheKey() const;
+    bool loadProgramBinary(uint64_t key);
+    void storeProgramBinary(uint64_t key);
+    void reflectUniforms();
+    bool isNewValue(UniformHandle handle, const void* value, size_t size);
+
+    struct PendingShader {
+        GLuint handle;
+        std::string filename;
+    };
+
+    struct Uniform {
+        std::string name;
+        uint64_t nameHash;
+        GLint location;
+        GLenum type;
+        bool hasValue;
+        // The last value set, as raw bytes.
+        GLfloat value[16];
+    };
     
-    std::map<std::string, GLint> m_uniformLocations;
+    std::vector<Uniform> m_uniforms;
+    // Open addressing on the name hashes, into m_uniforms. The size is a
+    // power of two at least twice the uniform count; empty slots hold
+    // InvalidUniform.
+    std::vector<UniformHandle> m_uniformSlots;
+    std::vector<PendingShader> m_pendingShaders;
+    const char* m_preamble;
+    const char* m_binaryCacheDirectory;
+    // Of the preamble, then the shader types and sources in the order
+    // they were compiled.
+    uint64_t m_sourceHash;
     GLuint m_programHandle;
     bool m_wasLinked;
 };
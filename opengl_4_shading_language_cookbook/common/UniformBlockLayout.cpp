@@ -0,0 +1,48 @@
+#include <cstdio>
+
+#include "UniformBlockLayout.h"
+
+bool checkBlockLayout(GLuint programHandle,
+                      LayoutRule rule,
+                      const char* blockName,
+                      const char* const* memberNames,
+                      const size_t* offsets,
+                      size_t numMembers,
+                      size_t size)
+{
+    GLenum const blockInterface = (rule == LayoutRule::Std140) ? GL_UNIFORM_BLOCK : GL_SHADER_STORAGE_BLOCK;
+    GLenum const memberInterface = (rule == LayoutRule::Std140) ? GL_UNIFORM : GL_BUFFER_VARIABLE;
+    bool matches = true;
+
+    GLuint const blockIndex = glGetProgramResourceIndex(programHandle, blockInterface, blockName);
+    if (blockIndex == GL_INVALID_INDEX) {
+        (void)fprintf(stderr, "Block '%s' is not active.\n", blockName);
+        return false;
+    }
+    GLenum const sizeProperty = GL_BUFFER_DATA_SIZE;
+    GLint blockSize;
+    glGetProgramResourceiv(programHandle, blockInterface, blockIndex, 1, &sizeProperty, 1, NULL, &blockSize);
+    // Drivers may leave out the padding at the end; only a block larger
+    // than the buffer laid out for it is an error.
+    if (static_cast<size_t>(blockSize) > size) {
+        (void)fprintf(stderr, "Block '%s' is %d bytes, more than %u.\n", blockName, blockSize, static_cast<unsigned>(size));
+        matches = false;
+    }
+
+    for (size_t i = 0; i < numMembers; i++) {
+        GLuint const memberIndex = glGetProgramResourceIndex(programHandle, memberInterface, memberNames[i]);
+        if (memberIndex == GL_INVALID_INDEX) {
+            // Inactive members are fine, as long as space is left for them.
+            continue;
+        }
+        GLenum const offsetProperty = GL_OFFSET;
+        GLint offset;
+        glGetProgramResourceiv(programHandle, memberInterface, memberIndex, 1, &offsetProperty, 1, NULL, &offset);
+        if (static_cast<size_t>(offset) != offsets[i]) {
+            (void)fprintf(stderr, "'%s' in block '%s' is at offset %d, not %u.\n",
+                          memberNames[i], blockName, offset, static_cast<unsigned>(offsets[i]));
+            matches = false;
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,201 @@
+#ifndef UNIFORM_BLOCK_LAYOUT_H
+#define UNIFORM_BLOCK_LAYOUT_H
+
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+
+#include <glm/glm.hpp>
+
+#include "glsys.h"
+
+// Offsets of the members of a std140 or std430 block, worked out at
+// compile time from the C++ types of its members in declaration order,
+// so that the padding is never written by hand:
+//
+//     typedef UniformBlockLayout<LayoutRule::Std140, glm::vec4, GLfloat, GLfloat[3]> Layout;
+//     static_assert(Layout::offset(2) == 32, "");
+//
+// Members may be GLfloat, GLint, GLuint, the glm vec2/3/4 and ivec2/3/4,
+// mat3 and mat4, or arrays of those. std430 is for shader storage blocks.
+
+enum class LayoutRule {
+    Std140,
+    Std430
+};
+
+namespace UniformBlockDetail {
+    constexpr size_t roundUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    constexpr size_t maxOf(size_t a, size_t b)
+    {
+        return a > b ? a : b;
+    }
+
+    // Size and base alignment of a member in the block, and how its value
+    // is written there.
+    template <typename T, size_t Size, size_t Alignment>
+    struct Basic {
+        static constexpr size_t size(LayoutRule) { return Size; }
+        static constexpr size_t alignment(LayoutRule) { return Alignment; }
+        static void write(LayoutRule, unsigned char* dst, const T& value)
+        {
+            static_assert(sizeof(T) == Size, "Unexpected glm type size");
+            (void)memcpy(dst, &value, sizeof(value));
+        }
+    };
+
+    template <typename T> struct Glsl;
+    template <> struct Glsl<GLfloat> : Basic<GLfloat, 4, 4> {};
+    template <> struct Glsl<GLint> : Basic<GLint, 4, 4> {};
+    template <> struct Glsl<GLuint> : Basic<GLuint, 4, 4> {};
+    template <> struct Glsl<glm::vec2> : Basic<glm::vec2, 8, 8> {};
+    template <> struct Glsl<glm::ivec2> : Basic<glm::ivec2, 8, 8> {};
+    // A vec3 is aligned like a vec4, but a scalar may follow in its last
+    // four bytes.
+    template <> struct Glsl<glm::vec3> : Basic<glm::vec3, 12, 16> {};
+    template <> struct Glsl<glm::ivec3> : Basic<glm::ivec3, 12, 16> {};
+    template <> struct Glsl<glm::vec4> : Basic<glm::vec4, 16, 16> {};
+    template <> struct Glsl<glm::ivec4> : Basic<glm::ivec4, 16, 16> {};
+    template <> struct Glsl<glm::mat4> : Basic<glm::mat4, 64, 16> {};
+
+    // An array of three vec3 columns, each padded to 16 bytes.
+    template <> struct Glsl<glm::mat3> {
+        static constexpr size_t size(LayoutRule) { return 48; }
+        static constexpr size_t alignment(LayoutRule) { return 16; }
+        static void write(LayoutRule, unsigned char* dst, const glm::mat3& value)
+        {
+            for (glm::mat3::length_type column = 0; column < 3; column++) {
+                (void)memcpy(dst + 16 * column, &value[column], sizeof(value[column]));
+            }
+        }
+    };
+
+    // std140 rounds the stride and alignment of array elements up to those
+    // of a vec4; std430 does not.
+    template <typename T, size_t N> struct Glsl<T[N]> {
+        static constexpr size_t stride(LayoutRule rule)
+        {
+            return rule == LayoutRule::Std140
+                ? roundUp(Glsl<T>::size(rule), maxOf(Glsl<T>::alignment(rule), 16))
+                : roundUp(Glsl<T>::size(rule), Glsl<T>::alignment(rule));
+        }
+        static constexpr size_t size(LayoutRule rule) { return N * stride(rule); }
+        static constexpr size_t alignment(LayoutRule rule)
+        {
+            return rule == LayoutRule::Std140
+                ? maxOf(Glsl<T>::alignment(rule), 16)
+                : Glsl<T>::alignment(rule);
+        }
+        static void write(LayoutRule rule, unsigned char* dst, const T (&value)[N])
+        {
+            for (size_t i = 0; i < N; i++) {
+                Glsl<T>::write(rule, dst + i * stride(rule), value[i]);
+            }
+        }
+    };
+
+    template <LayoutRule Rule, typename... Members> struct Offsets;
+
+    template <LayoutRule Rule> struct Offsets<Rule> {
+        static constexpr size_t offset(size_t, size_t) { return 0; }
+        static constexpr size_t end(size_t start) { return start; }
+        static constexpr size_t alignment() { return 1; }
+    };
+
+    // offset() and end() carry the offset of the first byte after the
+    // members before these ones.
+    template <LayoutRule Rule, typename First, typename... Rest>
+    struct Offsets<Rule, First, Rest...> {
+        static constexpr size_t offset(size_t index, size_t start)
+        {
+            return index == 0
+                ? roundUp(start, Glsl<First>::alignment(Rule))
+                : Offsets<Rule, Rest...>::offset(index - 1, roundUp(start, Glsl<First>::alignment(Rule)) + Glsl<First>::size(Rule));
+        }
+        static constexpr size_t end(size_t start)
+        {
+            return Offsets<Rule, Rest...>::end(roundUp(start, Glsl<First>::alignment(Rule)) + Glsl<First>::size(Rule));
+        }
+        static constexpr size_t alignment()
+        {
+            return maxOf(Glsl<First>::alignment(Rule), Offsets<Rule, Rest...>::alignment());
+        }
+    };
+}
+
+template <LayoutRule Rule, typename... Members>
+struct UniformBlockLayout {
+    typedef UniformBlockDetail::Offsets<Rule, Members...> Offsets;
+
+    template <size_t Index>
+    struct Member {
+        typedef typename std::tuple_element<Index, std::tuple<Members...> >::type type;
+    };
+
+    static constexpr LayoutRule rule = Rule;
+    static constexpr size_t count = sizeof...(Members);
+
+    static constexpr size_t offset(size_t index)
+    {
+        return Offsets::offset(index, 0);
+    }
+
+    // The whole block, padded like a struct: to a vec4 under std140, to
+    // the largest member alignment under std430.
+    static constexpr size_t size()
+    {
+        return UniformBlockDetail::roundUp(Offsets::end(0),
+                                           Rule == LayoutRule::Std140
+                                               ? UniformBlockDetail::maxOf(Offsets::alignment(), 16)
+                                               : Offsets::alignment());
+    }
+};
+
+// Writes members straight to their offsets in block memory, such as a
+// mapped buffer, which must hold Layout::size() bytes.
+template <typename Layout>
+class UniformBlockWriter {
+public:
+    explicit UniformBlockWriter(void* data)
+      : m_data(static_cast<unsigned char*>(data))
+    {
+    }
+
+    template <size_t Index>
+    void set(const typename Layout::template Member<Index>::type& value)
+    {
+        static_assert(Index < Layout::count, "No such member");
+        typedef typename Layout::template Member<Index>::type Type;
+        UniformBlockDetail::Glsl<Type>::write(Layout::rule, m_data + Layout::offset(Index), value);
+    }
+
+private:
+    unsigned char* m_data;
+};
+
+// Compares offsets with those the linked program reports, and checks
+// that the block fits in size bytes, printing every mismatch.
+// memberNames are as the program reflects them, e.g. "Lights[0]".
+bool checkBlockLayout(GLuint programHandle,
+                      LayoutRule rule,
+                      const char* blockName,
+                      const char* const* memberNames,
+                      const size_t* offsets,
+                      size_t numMembers,
+                      size_t size);
+
+template <typename Layout>
+bool checkBlockLayout(GLuint programHandle, const char* blockName, const char* const (&memberNames)[Layout::count])
+{
+    size_t offsets[Layout::count];
+    for (size_t i = 0; i < Layout::count; i++) {
+        offsets[i] = Layout::offset(i);
+    }
+    return checkBlockLayout(programHandle, Layout::rule, blockName, memberNames, offsets, Layout::count, Layout::size());
+}
+
+#endif // UNIFORM_BLOCK_LAYOUT_H
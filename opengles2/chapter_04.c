@@ -5,6 +5,7 @@
 
 #include "SDL.h"
 #include "glsys.h"
+#include "glsys_file.h"
 
 #define sdl_print_error_and_exit(user_message) sdl_print_error_and_exit_func(__FILE__, __LINE__, user_message)
 #ifdef NDEBUG
@@ -15,7 +16,6 @@
 
 static void	 sdl_print_error_and_exit_func(const char *function_name, int line, const char *user_message);
 static void	 sdl_check_and_clear_error_func(const char *function_name, int line);
-static GLchar	*load_text_file_into_string(const char *filename);
 static GLuint	 load_shader(const GLenum shader_type, const char *filename);
 static GLuint	 load_program(const char *vertex_shader_filename, const char *fragment_shader_filename);
 
@@ -41,45 +41,24 @@ sdl_check_and_clear_error_func(const char *function_name, int line)
 	}
 }
 
-static GLchar *
-load_text_file_into_string(const char *filename)
-{
-	long	 file_length;
-	size_t	 bytes_read;
-	int	 ret = 0;
-	FILE	*input_obj;
-	char	*buffer = NULL;
-
-	input_obj = fopen(filename, "rb");
-	assert(input_obj != NULL);
-	ret = fseek(input_obj, 0, SEEK_END);
-	assert(ret == 0);
-	file_length = ftell(input_obj);
-	assert(file_length > 0);
-	ret = fseek(input_obj, 0, SEEK_SET);
-	assert(ret == 0);
-	buffer = (GLchar *)malloc((unsigned long)file_length + 1 /*NUL*/);
-    
-	bytes_read = fread(buffer, 1, (unsigned long)file_length, input_obj);
-	if (bytes_read == 0 && ferror(input_obj) != 0)
-		printf("Error reading from %s. errno is %d\n", filename, errno);
-	fclose(input_obj);
-	buffer[file_length] = '\0';
-	return buffer;
-}
-
 static GLuint
 load_shader(const GLenum shader_type, const char *filename)
 {
 	GLint	 	 compile_status = 0, info_log_length = 0;
 	GLuint	 	 shader_handle;
-	const GLchar	*file_buffer;
+	GLint		 file_length;
+	GlsysFile	 file;
 
 	shader_handle = glCreateShader(shader_type);
 	assert(shader_handle != 0);
 
-	file_buffer = load_text_file_into_string(filename);
-	glShaderSource(shader_handle, 1, &file_buffer, NULL);
+	if (!glsysFileOpen(filename, &file)) {
+		printf("Error reading from %s. errno is %d\n", filename, errno);
+		assert(0);
+	}
+	file_length = (GLint)file.size;
+	glShaderSource(shader_handle, 1, &file.data, &file_length);
+	glsysFileClose(&file);
 
 	glCompileShader(shader_handle);
 	glGetShaderiv(shader_handle, GL_COMPILE_STATUS, &compile_status);
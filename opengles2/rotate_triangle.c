@@ -7,6 +7,7 @@
 #include "SDL.h"
 #include "SDL_timer.h"
 #include "glsys.h"
+#include "glsys_file.h"
 #include "matrix.h"
 
 typedef enum EVertexAttrIndex {
@@ -31,50 +32,23 @@ static GLushort const skTriangleIndices[] = {0, 1, 2};
 static void      draw(void);
 static void      simulationLoop(SDL_Window *window);
 static void      setupBuffers(void);
-static GLchar   *loadTextFileIntoString(const char *filename);
 static GLuint    loadShader(const GLenum shader_type, const char *filename);
 static GLuint    loadProgram(const char *vertex_shader_filename, const char *fragment_shader_filename);
 
-static GLchar *
-loadTextFileIntoString(const char *filename)
-{
-    int ret;
-
-    FILE * const inputObj = fopen(filename, "rb");
-    assert(inputObj != NULL);
-    ret = fseek(inputObj, 0, SEEK_END);
-    assert(ret == 0);
-    long const fileLength = ftell(inputObj);
-    assert(fileLength > 0);
-    ret = fseek(inputObj, 0, SEEK_SET);
-    assert(ret == 0);
-    char * const buffer = (GLchar *)malloc((unsigned long)fileLength + 1 /*NUL*/);
-    
-    size_t totalBytesRead = 0;
-    do {
-        size_t const currentBytesRead = fread(buffer, 1, (unsigned long)fileLength, inputObj);
-        if (currentBytesRead == 0 && ferror(inputObj) != 0) {
-            printf("Error reading from %s. errno is %d\n", filename, errno);
-            assert(0);
-        }
-        totalBytesRead += currentBytesRead;
-    } while (totalBytesRead < (size_t)fileLength);
-
-    fclose(inputObj);
-    buffer[fileLength] = '\0';
-
-    return buffer;
-}
-
 static GLuint
 loadShader(const GLenum shaderType, const char *filename)
 {
     GLuint const shaderHandle = glCreateShader(shaderType);
     assert(shaderHandle != 0);
 
-    GLchar const *fileBuffer = loadTextFileIntoString(filename);
-    glShaderSource(shaderHandle, 1, &fileBuffer, NULL);
-    free((void*)fileBuffer);
+    GlsysFile file;
+    if (!glsysFileOpen(filename, &file)) {
+        printf("Error reading from %s. errno is %d\n", filename, errno);
+        assert(0);
+    }
+    GLint const fileLength = (GLint)file.size;
+    glShaderSource(shaderHandle, 1, &file.data, &fileLength);
+    glsysFileClose(&file);
 
     glCompileShader(shaderHandle);
     GLint compileStatus = 0;